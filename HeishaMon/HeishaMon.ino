@@ -19,6 +19,7 @@
 #include "src/rules/rules.h"
 
 #include "webfunctions.h"
+#include "webroutes.h"
 #include "decode.h"
 #include "commands.h"
 #include "rules.h"
@@ -68,6 +69,7 @@ unsigned long badheaderread = 0;
 unsigned long tooshortread = 0;
 unsigned long toolongread = 0;
 unsigned long timeoutread = 0;
+unsigned long frameSequence = 0; //increased on every decoded heatpump frame, used as etag of the data pages
 float readpercentage = 0;
 static int uploadpercentage = 0;
 
@@ -114,10 +116,6 @@ PubSubClient mqtt_client(mqtt_wifi_client);
 
 bool firstConnectSinceBoot = true; //if this is true there is no first connection made yet
 
-struct timerqueue_t **timerqueue = NULL;
-int timerqueue_size = 0;
-
-
 /*
     check_wifi will process wifi reconnecting managing
 */
@@ -275,7 +273,7 @@ void log_message(char* string)
       mqtt_client.disconnect();
     }
   }
-  websocket_write_all(log_line, strlen(log_line));
+  websocket_log(log_line, strlen(log_line));
   free(log_line);
 }
 
@@ -359,8 +357,12 @@ bool readSerial()
 
       if (data_length == DATASIZE)  {  //receive a full data block
         if  (data[3] == 0x10) { //decode the normal data block
+          rules_event_batch_start();
           decode_heatpump_data(data, actData, mqtt_client, log_message, heishamonSettings.mqtt_topic_base, heishamonSettings.updateAllTime);
           memcpy(actData, data, DATASIZE);
+          frameSequence++;
+          rules_sample(RULES_DATA_MAIN);
+          rules_event_batch_flush();
           {
             char mqtt_topic[256];
             sprintf(mqtt_topic, "%s/raw/data", heishamonSettings.mqtt_topic_base);
@@ -370,8 +372,12 @@ bool readSerial()
           return true;
         } else if (data[3] == 0x21) { //decode the new model extra data block
           extraDataBlockAvailable = true; //set the flag to true so we know we can request this data always
+          rules_event_batch_start();
           decode_heatpump_data_extra(data, actDataExtra, mqtt_client, log_message, heishamonSettings.mqtt_topic_base, heishamonSettings.updateAllTime);
           memcpy(actDataExtra, data, DATASIZE);
+          frameSequence++;
+          rules_sample(RULES_DATA_EXTRA);
+          rules_event_batch_flush();
           {
             char mqtt_topic[256];
             sprintf(mqtt_topic, "%s/raw/dataextra", heishamonSettings.mqtt_topic_base);
@@ -387,8 +393,11 @@ bool readSerial()
       }
       else if (data_length == OPTDATASIZE ) { //optional pcb acknowledge answer
         log_message(_F("Received optional PCB ack answer. Decoding this in OPT topics."));
+        rules_event_batch_start();
         decode_optional_heatpump_data(data, actOptData, mqtt_client, log_message, heishamonSettings.mqtt_topic_base, heishamonSettings.updateAllTime);
         memcpy(actOptData, data, OPTDATASIZE);
+        rules_sample(RULES_DATA_OPT);
+        rules_event_batch_flush();
         data_length = 0;
         return true;
       }
@@ -490,8 +499,12 @@ void mqtt_callback(char* topic, byte* payload, unsigned int length) {
     else if (strcmp((char*)"panasonic_heat_pump/data", topic) == 0) {  // check for raw heatpump input
       sprintf_P(log_msg, PSTR("Received raw heatpump data from MQTT"));
       log_message(log_msg);
+      rules_event_batch_start();
       decode_heatpump_data(msg, actData, mqtt_client, log_message, heishamonSettings.mqtt_topic_base, heishamonSettings.updateAllTime);
       memcpy(actData, msg, DATASIZE);
+      frameSequence++;
+      rules_sample(RULES_DATA_MAIN);
+      rules_event_batch_flush();
 #endif
     } else if (strncmp(topic_command, mqtt_topic_opentherm, strlen(mqtt_topic_opentherm)) == 0)  {
       char* topic_otcommand = topic_command + strlen(mqtt_topic_opentherm) + 1; //strip the opentherm subtopic from the topic
@@ -526,105 +539,60 @@ void setupOTA() {
 
 int8_t webserver_cb(struct webserver_t *client, void *dat) {
   switch (client->step) {
-    case WEBSERVER_CLIENT_REQUEST_METHOD: {
-        if (strcmp_P((char *)dat, PSTR("POST")) == 0) {
-          client->route = 110;
-        }
-        return 0;
-      } break;
     case WEBSERVER_CLIENT_REQUEST_URI: {
-        if (strcmp_P((char *)dat, PSTR("/")) == 0) {
-          client->route = 1;
-        } else if (strcmp_P((char *)dat, PSTR("/tablerefresh")) == 0) {
-          client->route = 10;
-        } else if (strcmp_P((char *)dat, PSTR("/json")) == 0) {
-          client->route = 20;
-        } else if (strcmp_P((char *)dat, PSTR("/reboot")) == 0) {
-          client->route = 30;
-        } else if (strcmp_P((char *)dat, PSTR("/debug")) == 0) {
-          client->route = 40;
-          log_message(_F("Debug URL requested"));
-        } else if (strcmp_P((char *)dat, PSTR("/wifiscan")) == 0) {
-          client->route = 50;
-        } else if (strcmp_P((char *)dat, PSTR("/togglelog")) == 0) {
-          client->route = 1;
-          log_message(_F("Toggled mqtt log flag"));
-          heishamonSettings.logMqtt ^= true;
-        } else if (strcmp_P((char *)dat, PSTR("/togglehexdump")) == 0) {
-          client->route = 1;
-          log_message(_F("Toggled hexdump log flag"));
-          heishamonSettings.logHexdump ^= true;
-        } else if (strcmp_P((char *)dat, PSTR("/hotspot-detect.html")) == 0 ||
-                   strcmp_P((char *)dat, PSTR("/fwlink")) == 0 ||
-                   strcmp_P((char *)dat, PSTR("/generate_204")) == 0 ||
-                   strcmp_P((char *)dat, PSTR("/gen_204")) == 0 ||
-                   strcmp_P((char *)dat, PSTR("/popup")) == 0) {
-          client->route = 80;
-        } else if (strcmp_P((char *)dat, PSTR("/factoryreset")) == 0) {
-          client->route = 90;
-        } else if (strcmp_P((char *)dat, PSTR("/command")) == 0) {
-          if ((client->userdata = malloc(1)) == NULL) {
-            Serial1.printf(PSTR("Out of memory %s:#%d\n"), __FUNCTION__, __LINE__);
-            ESP.restart();
-            exit(-1);
-          }
-          ((char *)client->userdata)[0] = 0;
-          client->route = 100;
-        } else if (client->route == 110) {
-          // Only accept settings POST requests
-          if (strcmp_P((char *)dat, PSTR("/savesettings")) == 0) {
-            client->route = 110;
-          } else if (strcmp_P((char *)dat, PSTR("/saverules")) == 0) {
-            client->route = 170;
-
-            if (LittleFS.begin()) {
-              LittleFS.remove("/rules.new");
-              client->userdata = new File(LittleFS.open("/rules.new", "a+"));
-            }
-          } else if (strcmp_P((char *)dat, PSTR("/firmware")) == 0) {
-            if (!Update.isRunning()) {
-              Update.runAsync(true);
-              if (!Update.begin((ESP.getFreeSketchSpace() - 0x1000) & 0xFFFFF000)) {
-                Update.printError(Serial1);
-                return -1;
+        if (findWebRoute(client, (char *)dat) == -1) {
+          return -1;
+        }
+        switch (client->route) {
+          case ROUTE_DEBUG: {
+              log_message(_F("Debug URL requested"));
+            } break;
+          case ROUTE_TOGGLELOG: {
+              log_message(_F("Toggled mqtt log flag"));
+              heishamonSettings.logMqtt ^= true;
+            } break;
+          case ROUTE_TOGGLEHEXDUMP: {
+              log_message(_F("Toggled hexdump log flag"));
+              heishamonSettings.logHexdump ^= true;
+            } break;
+          case ROUTE_SAVERULES: {
+              if (LittleFS.begin()) {
+                LittleFS.remove("/rules.new");
+                client->userdata = new File(LittleFS.open("/rules.new", "a+"));
+              }
+            } break;
+          case ROUTE_FIRMWARE_UPLOAD: {
+              if (!Update.isRunning()) {
+                Update.runAsync(true);
+                if (!Update.begin((ESP.getFreeSketchSpace() - 0x1000) & 0xFFFFF000)) {
+                  Update.printError(Serial1);
+                  return -1;
+                }
+                uploadpercentage = 0;
+                firmwareUploadBegin();
               } else {
-                client->route = 150;
+                // a broken upload is aborted when its connection closes
+                log_message(_F("New firmware update client, while previous isn't finished yet! Rejected."));
+                client->route = ROUTE_NOTFOUND;
+                return -1;
               }
-            } else {
-              Serial1.println(PSTR("New firmware update client, while previous isn't finished yet! Assume broken connection, abort!"));
-              Update.end();
-              return -1;
-            }
-          } else {
-            return -1;
-          }
-        } else if (strcmp_P((char *)dat, PSTR("/settings")) == 0) {
-          client->route = 120;
-        } else if (strcmp_P((char *)dat, PSTR("/getsettings")) == 0) {
-          client->route = 130;
-        } else if (strcmp_P((char *)dat, PSTR("/firmware")) == 0) {
-          client->route = 140;
-        } else if (strcmp_P((char *)dat, PSTR("/rules")) == 0) {
-          client->route = 160;
-        } else {
-          client->route = 0;
+            } break;
         }
-
         return 0;
       } break;
     case WEBSERVER_CLIENT_ARGS: {
         struct arguments_t *args = (struct arguments_t *)dat;
         switch (client->route) {
-          case 10: {
+          case ROUTE_TABLEREFRESH: {
               if (strcmp_P((char *)args->name, PSTR("1wire")) == 0) {
-                client->route = 11;
+                client->route = ROUTE_TABLEREFRESH_DALLAS;
               } else if (strcmp_P((char *)args->name, PSTR("s0")) == 0) {
-                client->route = 12;
+                client->route = ROUTE_TABLEREFRESH_S0;
               } else if (strcmp_P((char *)args->name, PSTR("opentherm")) == 0) {
-                client->route = 13;
+                client->route = ROUTE_TABLEREFRESH_OPENTHERM;
               }
             } break;
-          case 100: {
+          case ROUTE_COMMAND: {
               unsigned char cmd[256] = { 0 };
               char cpy[args->len + 1];
               char log_msg[256] = { 0 };
@@ -672,10 +640,10 @@ int8_t webserver_cb(struct webserver_t *client, void *dat) {
                 }
               }
             } break;
-          case 110: {
+          case ROUTE_SAVESETTINGS: {
               return cacheSettings(client, args);
             } break;
-          case 150: {
+          case ROUTE_FIRMWARE_UPLOAD: {
               if (Update.isRunning() && (!Update.hasError())) {
                 if ((strcmp((char *)args->name, "md5") == 0) && (args->len > 0)) {
                   char md5[args->len + 1];
@@ -697,16 +665,42 @@ int8_t webserver_cb(struct webserver_t *client, void *dat) {
                       sprintf_P(log_msg, PSTR("Uploading new firmware: %d%%"), uploadpercentage * 5);
                       log_message(log_msg);
                     }
+                    firmwareUploadProgress(client, FIRMWARE_UPLOADING);
                   }
                 }
-              } else {
+              } else if (uploadpercentage >= 0) {
+                // the rest of the upload is drained silently
                 log_message((char*)"New firmware POST data but update not running anymore!");
+                uploadpercentage = -1;
+              }
+            } break;
+          case ROUTE_RULETRACE: {
+              char cpy[args->len + 1];
+              memset(&cpy, 0, args->len + 1);
+              snprintf((char *)&cpy, args->len + 1, "%.*s", args->len, args->value);
+
+              if (strcmp_P((char *)args->name, PSTR("level")) == 0 && args->len > 0) {
+                rules_trace_level(atoi(cpy));
+                sprintf_P(log_msg, PSTR("Rules trace level set to %d"), atoi(cpy));
+                log_message(log_msg);
+              } else if (strcmp_P((char *)args->name, PSTR("rule")) == 0 && args->len > 0) {
+                int ret = rules_trace_toggle(atoi(cpy));
+                if (ret > -1) {
+                  sprintf_P(log_msg, PSTR("Trace of rule #%d %s"), atoi(cpy), ret == 1 ? "enabled" : "disabled");
+                } else {
+                  sprintf_P(log_msg, PSTR("Cannot trace rule #%d"), atoi(cpy));
+                }
+                log_message(log_msg);
+              } else if (strcmp_P((char *)args->name, PSTR("budget")) == 0 && args->len > 0) {
+                rules_max_steps(atoi(cpy));
+                sprintf_P(log_msg, PSTR("Rules step budget set to %d"), atoi(cpy));
+                log_message(log_msg);
               }
             } break;
-          case 170: {
+          case ROUTE_SAVERULES: {
               File *f = (File *)client->userdata;
               if (!f || !*f) {
-                client->route = 160;
+                client->route = ROUTE_RULES;
               } else {
                 f->write(args->value, args->len);
               }
@@ -717,43 +711,65 @@ int8_t webserver_cb(struct webserver_t *client, void *dat) {
         struct arguments_t *args = (struct arguments_t *)dat;
         return 0;
       } break;
+    case WEBSERVER_CLIENT_WEBSOCKET_TEXT: {
+        if (strcmp_P((char *)dat, PSTR("values")) == 0) {
+          client->route = ROUTE_WEBSOCKET_VALUES; // push decoded value changes to this client
+        } else if (strcmp_P((char *)dat, PSTR("firmware")) == 0) {
+          client->route = ROUTE_WEBSOCKET_FIRMWARE; // push firmware upload progress to this client
+        }
+        return 0;
+      } break;
     case WEBSERVER_CLIENT_WRITE: {
+        webRouteSample(client);
         switch (client->route) {
-          case 0: {
+          case ROUTE_NOTFOUND: {
               if (client->content == 0) {
                 webserver_send(client, 404, (char *)"text/plain", 13);
                 webserver_send_content_P(client, PSTR("404 Not found"), 13);
               }
               return 0;
             } break;
-          case 1: {
+          case ROUTE_ROOT:
+          case ROUTE_TOGGLELOG:
+          case ROUTE_TOGGLEHEXDUMP: {
               return handleRoot(client, readpercentage, mqttReconnects, &heishamonSettings);
             } break;
-          case 10:
-          case 11:
-          case 12:
-          case 13: {
+          case ROUTE_TABLEREFRESH:
+          case ROUTE_TABLEREFRESH_DALLAS:
+          case ROUTE_TABLEREFRESH_S0:
+          case ROUTE_TABLEREFRESH_OPENTHERM: {
+              if (client->route == ROUTE_TABLEREFRESH && client->content == 0) {
+                if (webserver_send_etag(client, frameSequence) == 1) {
+                  return -1;
+                }
+              }
               return handleTableRefresh(client, actData, actDataExtra, extraDataBlockAvailable);
             } break;
-          case 20: {
+          case ROUTE_JSON: {
+              // the 1wire, s0 and opentherm values don't follow the heatpump frames
+              if (client->content == 0 && !heishamonSettings.use_1wire && !heishamonSettings.use_s0 && !heishamonSettings.opentherm) {
+                if (webserver_send_etag(client, frameSequence) == 1) {
+                  return -1;
+                }
+              }
               return handleJsonOutput(client, actData, actDataExtra, &heishamonSettings, extraDataBlockAvailable);
             } break;
-          case 30: {
+          case ROUTE_REBOOT: {
               return handleReboot(client);
             } break;
-          case 40: {
+          case ROUTE_DEBUG: {
               return handleDebug(client, (char *)data, 203);
             } break;
-          case 50: {
+          case ROUTE_WIFISCAN: {
               return handleWifiScan(client);
             } break;
-          case 80: {
+          case ROUTE_CAPTIVE: {
               return handleSettings(client);
             } break;
-          case 90: {
+          case ROUTE_FACTORYRESET: {
               return handleFactoryReset(client);
             } break;
-          case 100: {
+          case ROUTE_COMMAND: {
               if (client->content == 0) {
                 webserver_send(client, 200, (char *)"text/plain", 0);
                 char *RESTmsg = (char *)client->userdata;
@@ -763,7 +779,7 @@ int8_t webserver_cb(struct webserver_t *client, void *dat) {
               }
               return 0;
             } break;
-          case 110: {
+          case ROUTE_SAVESETTINGS: {
               int ret = saveSettings(client, &heishamonSettings);
               if ((!heishamonSettings.opentherm) && (heishamonSettings.listenonly)) {
                 //make sure we disable TX to heatpump-RX using the mosfet so this line is floating and will not disturb cz-taw1
@@ -773,51 +789,52 @@ int8_t webserver_cb(struct webserver_t *client, void *dat) {
                 digitalWrite(5, HIGH);
               }
               switch (client->route) {
-                case 111: {
+                case ROUTE_SAVESETTINGS_PASSWORD: {
                     return settingsNewPassword(client, &heishamonSettings);
                   } break;
-                case 112: {
+                case ROUTE_SAVESETTINGS_RECONNECT: {
                     return settingsReconnectWifi(client, &heishamonSettings);
                   } break;
-                case 113: {
+                case ROUTE_SAVESETTINGS_REDIRECT: {
                     webserver_send(client, 301, (char *)"text/plain", 0);
                   } break;
               }
               return 0;
             } break;
-          case 111: {
+          case ROUTE_SAVESETTINGS_PASSWORD: {
               return settingsNewPassword(client, &heishamonSettings);
             } break;
-          case 112: {
+          case ROUTE_SAVESETTINGS_RECONNECT: {
               return settingsReconnectWifi(client, &heishamonSettings);
             } break;
-          case 120: {
+          case ROUTE_SETTINGS: {
               return handleSettings(client);
             } break;
-          case 130: {
+          case ROUTE_GETSETTINGS: {
               return getSettings(client, &heishamonSettings);
             } break;
-          case 140: {
+          case ROUTE_FIRMWARE: {
               return showFirmware(client);
             } break;
-          case 150: {
+          case ROUTE_FIRMWARE_UPLOAD: {
+              if (client->content > 0) {
+                return 0;
+              }
               log_message((char*)"In /firmware client write part");
-              if (Update.isRunning()) {
-                if (Update.end(true)) {
-                  log_message((char*)"Firmware update success");
-                  timerqueue_insert(2, 0, -2); // Start reboot sequence
-                  return showFirmwareSuccess(client);
-                } else {
-                  Update.printError(Serial1);
-                  return showFirmwareFail(client);
-                }
+              if (Update.isRunning() && Update.end(true)) {
+                log_message((char*)"Firmware update success");
+                timerqueue_insert(2, 0, -2); // Start reboot sequence
+                firmwareUploadProgress(client, FIRMWARE_FLASHED);
+                return showFirmwareSuccess(client);
               }
-              return 0;
+              Update.printError(Serial1);
+              firmwareUploadProgress(client, FIRMWARE_FAILED);
+              return showFirmwareFail(client);
             } break;
-          case 160: {
+          case ROUTE_RULES: {
               return showRules(client);
             } break;
-          case 170: {
+          case ROUTE_SAVERULES: {
               File *f = (File *)client->userdata;
               if (f) {
                 if (*f) {
@@ -829,6 +846,25 @@ int8_t webserver_cb(struct webserver_t *client, void *dat) {
               timerqueue_insert(0, 1, -4);
               webserver_send(client, 301, (char *)"text/plain", 0);
             } break;
+          case ROUTE_RULES_STATS: {
+              return showRulesStats(client);
+            } break;
+          case ROUTE_RULES_MEMORY: {
+              return showRulesMemory(client);
+            } break;
+          case ROUTE_RULETRACE: {
+              webserver_send(client, 301, (char *)"text/plain", 0);
+            } break;
+          case ROUTE_WEBASSET: {
+              return handleWebAsset(client);
+            } break;
+          case ROUTE_STATS: {
+              return showWebStats(client);
+            } break;
+          case ROUTE_METRICS: {
+              struct readStatsStruct reads = { totalreads, goodreads, badcrcread, badheaderread, tooshortread, toolongread, timeoutread };
+              return handleMetrics(client, &reads, mqttReconnects, actData, actDataExtra, &heishamonSettings, extraDataBlockAvailable);
+            } break;
           default: {
               webserver_send(client, 301, (char *)"text/plain", 0);
             } break;
@@ -838,21 +874,24 @@ int8_t webserver_cb(struct webserver_t *client, void *dat) {
     case WEBSERVER_CLIENT_CREATE_HEADER: {
         struct header_t *header = (struct header_t *)dat;
         switch (client->route) {
-          case 113: {
+          case ROUTE_SAVESETTINGS_REDIRECT: {
               header->ptr += sprintf_P((char *)header->buffer, PSTR("Location: /settings"));
               return -1;
             } break;
-          case 60:
-          case 70: {
-              header->ptr += sprintf_P((char *)header->buffer, PSTR("Location: /"));
-              return -1;
-            } break;
-          case 170: {
+          case ROUTE_SAVERULES:
+          case ROUTE_RULETRACE: {
               header->ptr += sprintf_P((char *)header->buffer, PSTR("Location: /rules"));
               return -1;
             } break;
+          case ROUTE_WEBASSET: {
+              if (client->gzip == 1) {
+                header->ptr += sprintf_P((char *)header->buffer, PSTR("Content-Encoding: gzip\r\nVary: Accept-Encoding\r\n"));
+              } else {
+                header->ptr += sprintf_P((char *)header->buffer, PSTR("Vary: Accept-Encoding"));
+              }
+            } break;
           default: {
-              if (client->route != 0) {
+              if (client->route != ROUTE_NOTFOUND) {
                 header->ptr += sprintf_P((char *)header->buffer, PSTR("Access-Control-Allow-Origin: *"));
               }
             } break;
@@ -860,13 +899,14 @@ int8_t webserver_cb(struct webserver_t *client, void *dat) {
         return 0;
       } break;
     case WEBSERVER_CLIENT_CLOSE: {
+        webRouteDone(client);
         switch (client->route) {
-          case 100: {
+          case ROUTE_COMMAND: {
               if (client->userdata != NULL) {
                 free(client->userdata);
               }
             } break;
-          case 110: {
+          case ROUTE_SAVESETTINGS: {
               struct websettings_t *tmp = NULL;
               while (client->userdata) {
                 tmp = (struct websettings_t *)client->userdata;
@@ -874,8 +914,16 @@ int8_t webserver_cb(struct webserver_t *client, void *dat) {
                 free(tmp);
               }
             } break;
-          case 160:
-          case 170: {
+          case ROUTE_FIRMWARE_UPLOAD: {
+              // the connection broke off before the upload was complete
+              if (Update.isRunning()) {
+                log_message(_F("Firmware upload aborted"));
+                Update.end(false);
+                firmwareUploadProgress(client, FIRMWARE_FAILED);
+              }
+            } break;
+          case ROUTE_RULES:
+          case ROUTE_SAVERULES: {
               if (client->userdata != NULL) {
                 File *f = (File *)client->userdata;
                 if (f) {
@@ -1027,6 +1075,15 @@ void timer_cb(int nr) {
           setupWifi(&heishamonSettings);
         } break;
       case -4: {
+          // check the new ruleset first, so a broken one leaves the running rules alone
+          int check = rules_check("/rules.new");
+          if (check == -1) {
+            logprintln_P(F("new ruleset failed to parse, keeping the running ruleset"));
+            break;
+          }
+          if (check == 1) {
+            logprintln_P(F("not enough memory to check the new ruleset first"));
+          }
           if (rules_parse("/rules.new") == -1) {
             logprintln_P(F("new ruleset failed to parse, using previous ruleset"));
             rules_parse("/rules.txt");
@@ -1051,6 +1108,9 @@ void setup() {
   char *up = getUptime();
   free(up);
 
+  //a new boot must not match etags handed out before
+  frameSequence = ESP.random();
+
   setupSerial();
   setupSerial1();
 
@@ -1256,7 +1316,7 @@ void loop() {
     log_message((char*)message.c_str());
 
     String stats;
-    stats.reserve(384);
+    stats.reserve(512);
     stats += F("{\"uptime\":");
     stats += String(millis());
     stats += F(",\"voltage\":");
@@ -1283,6 +1343,29 @@ void loop() {
     stats += toolongread;
     stats += F(",\"timeout reads\":");
     stats += timeoutread;
+    {
+      unsigned long ruleInvocations = 0, ruleTime = 0, rulePreemptions = 0;
+      int slowestRule = -1;
+      rules_stats_summary(&ruleInvocations, &ruleTime, &slowestRule, &rulePreemptions);
+      stats += F(",\"rule invocations\":");
+      stats += ruleInvocations;
+      stats += F(",\"rule time\":");
+      stats += ruleTime;
+      stats += F(",\"slowest rule\":");
+      stats += slowestRule;
+      stats += F(",\"rule preemptions\":");
+      stats += rulePreemptions;
+    }
+    {
+      unsigned long timersFired = 0, avgJitter = 0, maxJitter = 0;
+      timerqueue_stats(&timersFired, &avgJitter, &maxJitter);
+      stats += F(",\"timers fired\":");
+      stats += timersFired;
+      stats += F(",\"avg timer jitter\":");
+      stats += avgJitter;
+      stats += F(",\"max timer jitter\":");
+      stats += maxJitter;
+    }
     stats += F(",\"version\":\"");
     stats += heishamon_version;
     stats += F("\"}");
@@ -1302,4 +1385,6 @@ void loop() {
   }
 
   timerqueue_update();
+
+  rules_loop();
 }
@@ -8,6 +8,7 @@
 extern byte initialQuery[INITIALQUERYSIZE];
 #define PANASONICQUERYSIZE 110
 extern byte panasonicQuery[PANASONICQUERYSIZE];
+extern byte panasonicSendQuery[PANASONICQUERYSIZE];
 
 
 
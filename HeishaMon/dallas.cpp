@@ -127,6 +127,20 @@ void dallasJsonOutput(struct webserver_t *client) {
   webserver_send_content_P(client, PSTR("]"), 1);
 }
 
+void dallasMetricsOutput(struct webserver_t *client) {
+  webserver_send_content_P(client, PSTR("# HELP heishamon_dallas_temperature_celsius Temperature of the 1wire sensor.\n# TYPE heishamon_dallas_temperature_celsius gauge\n"), 127);
+  for (int i = 0; i < dallasDevicecount; i++) {
+    if (actDallasData[i].temperature == -127.0) { // no valid reading yet
+      continue;
+    }
+    char temp[16];
+    char str[96];
+    dtostrf(actDallasData[i].temperature, 0, 2, temp);
+    int len = snprintf_P(str, sizeof(str), PSTR("heishamon_dallas_temperature_celsius{sensor=\"%s\"} %s\n"), actDallasData[i].address, temp);
+    webserver_send_content(client, str, len);
+  }
+}
+
 void dallasTableOutput(struct webserver_t *client) {
   for (int i = 0; i < dallasDevicecount; i++) {
     webserver_send_content_P(client, PSTR("<tr><td>"), 8);
@@ -21,5 +21,6 @@ void dallasLoop(PubSubClient &mqtt_client, void (*log_message)(char*), char* mqt
 void initDallasSensors(void (*log_message)(char*), unsigned int updataAllDallasTimeSettings, unsigned int dallasTimerWaitSettings, unsigned int dallasResolution);
 void dallasJsonOutput(struct webserver_t *client);
 void dallasTableOutput(struct webserver_t *client);
+void dallasMetricsOutput(struct webserver_t *client);
 
 #endif
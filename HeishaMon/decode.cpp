@@ -1,6 +1,7 @@
 #include "decode.h"
 #include "commands.h"
 #include "rules.h"
+#include "webfunctions.h"
 #include "src/common/progmem.h"
 
 unsigned long lastalldatatime = 0;
@@ -300,8 +301,10 @@ void decode_heatpump_data(char* data, char* actData, PubSubClient &mqtt_client,
       sprintf_P(mqtt_topic, PSTR("%s/%s/%s"), mqtt_topic_base, mqtt_topic_values, topics[Topic_Number]);
       mqtt_client.publish(mqtt_topic, Topic_Value.c_str(), MQTT_RETAIN_VALUES);
       rules_event_cb(_F("@"), topics[Topic_Number]);
+      websocketValueChanged(false, Topic_Number, Topic_Value.c_str());
     }
   }
+  websocketValuesFlush();
 }
 
 void decode_heatpump_data_extra(char* data, char* actDataExtra, PubSubClient &mqtt_client, void (*log_message)(char*), char* mqtt_topic_base, unsigned int updateAllTime) {
@@ -322,8 +325,10 @@ void decode_heatpump_data_extra(char* data, char* actDataExtra, PubSubClient &mq
       sprintf_P(mqtt_topic, PSTR("%s/%s/%s"), mqtt_topic_base, mqtt_topic_xvalues, xtopics[Topic_Number]);
       mqtt_client.publish(mqtt_topic, Topic_Value.c_str(), MQTT_RETAIN_VALUES);
       rules_event_cb(_F("@"), xtopics[Topic_Number]);
+      websocketValueChanged(true, Topic_Number, Topic_Value.c_str());
     }
   }
+  websocketValuesFlush();
 }
 
 void decode_optional_heatpump_data(char* data, char* actOptData, PubSubClient & mqtt_client, void (*log_message)(char*), char* mqtt_topic_base, unsigned int updateAllTime) {
@@ -25,7 +25,6 @@ static const char menuJS[] PROGMEM =
   "</script>";
 
 static const char websocketJS[] PROGMEM =
-  "<script>"
   "  var bConnected = false;"
   "  function startWebsockets() {"
   "    if(typeof MozWebSocket != \"undefined\") {"
@@ -38,10 +37,15 @@ static const char websocketJS[] PROGMEM =
   "    if(oWebsocket) {"
   "      oWebsocket.onopen = function(evt) {"
   "        bConnected = true;"
+  "        oWebsocket.send('values');"
   "      };"
   ""
   "      oWebsocket.onclose = function(evt) {"
   "        console.log('onclose: ' + evt);"
+  "        bConnected = false;"
+  "        if(document.getElementById('Heatpump').style.display == 'block') {"
+  "          refreshTable('Heatpump');"
+  "        }"
   "      };"
   ""
   "      oWebsocket.onerror = function(evt) {"
@@ -49,6 +53,10 @@ static const char websocketJS[] PROGMEM =
   "      };"
   ""
   "      oWebsocket.onmessage = function(evt) {"
+  "        if(evt.data.substring(0, 10) == '{\"values\":') {"
+  "          updateValues(JSON.parse(evt.data).values);"
+  "          return;"
+  "        }"
   "        let obj = document.getElementById(\"cli\");"
   "        let chk = document.getElementById(\"autoscroll\");"
   "        obj.value += evt.data + \"\\n\";"
@@ -58,10 +66,23 @@ static const char websocketJS[] PROGMEM =
   "      }"
   "    }"
   "  }"
-  "</script>";
+  ""
+  "  function updateValues(values) {"
+  "    let rows = document.getElementById(\"heishavalues\").rows;"
+  "    let index = {};"
+  "    for(let i = 0; i < rows.length; i++) {"
+  "      index[rows[i].cells[0].textContent] = rows[i];"
+  "    }"
+  "    for(let i = 0; i < values.length; i++) {"
+  "      let row = index[values[i][0]];"
+  "      if(row && row.cells.length == 4) {"
+  "        row.cells[2].textContent = values[i][1];"
+  "        row.cells[3].textContent = values[i][2];"
+  "      }"
+  "    }"
+  "  }";
 
 static const char refreshJS[] PROGMEM =
-  "<script>"
   " let timeout;"
   " document.body.onload=function() {"
   "    openTable('Heatpump');"
@@ -107,9 +128,10 @@ static const char refreshJS[] PROGMEM =
   "       break;"
   "   }"
   "  clearTimeout(timeout);"
-  "  timeout=setTimeout(refreshTable, 30000, tableName);"
+  "  if(tableName != 'Heatpump' || !bConnected) {" // heatpump values are pushed over the websocket
+  "    timeout=setTimeout(refreshTable, 30000, tableName);"
   "  }"
-  "</script>";
+  "  }";
 
 static const char selectJS[] PROGMEM =
   "<script>"
@@ -125,7 +147,6 @@ static const char selectJS[] PROGMEM =
   "</script>";
 
 static const char settingsJS[] PROGMEM =
-  "<script type=\"text/javascript\">"
   "    function ShowHideListenOnlyTable(listenonlyEnabled) {"
   "        var listenonlysettings = document.getElementById(\"listenonlysettings\");"
   "        listenonlysettings.style.display = listenonlyEnabled.checked ? \"none\" : \"none\";"
@@ -142,8 +163,7 @@ static const char settingsJS[] PROGMEM =
   "        var ppkwh = document.getElementById('s0_ppkwh_'+port).value;"
   "        var interval = document.getElementById('s0_interval_'+port).value;"
   "        document.getElementById('s0_minwatt_'+port).innerHTML = Math.round((3600 * 1000 / ppkwh) / interval);"
-  "    }"
-  "</script>";
+  "    }";
 
 /*static const char heatingCurveJS[] PROGMEM =
   "<script src=\"https://ajax.googleapis.com/ajax/libs/jquery/3.4.1/jquery.min.js\"></script>"
@@ -256,7 +276,51 @@ static const char showRulesPage2[] PROGMEM =
   "</textarea><br />"
   "    <input class=\"w3-green w3-button\" type=\"submit\" value=\"Save\">"
   "  </form>"
-  "</div>";
+  "  <p>Trace level: <a href=\"/ruletrace?level=0\">off</a> | <a href=\"/ruletrace?level=1\">summary</a> | <a href=\"/ruletrace?level=2\">full</a></p>"
+  "  <form accept-charset=\"UTF-8\" action=\"/ruletrace\" method=\"GET\">"
+  "    Trace rule # <input name=\"rule\" type=\"number\" min=\"1\" style=\"width:4em\">"
+  "    <input class=\"w3-green w3-button\" type=\"submit\" value=\"Toggle\">"
+  "  </form>"
+  "  <form accept-charset=\"UTF-8\" action=\"/ruletrace\" method=\"GET\">"
+  "    Step budget <input name=\"budget\" type=\"number\" min=\"0\" style=\"width:6em\">"
+  "    <input class=\"w3-green w3-button\" type=\"submit\" value=\"Set\">"
+  "  </form>"
+  "  <h3>Memory</h3>"
+  "  <p id=\"rules_memory\"></p>"
+  "  <table class=\"w3-table-all\" id=\"rules_memory_table\" style=\"width:auto;margin:auto\">"
+  "    <tr><th>Rule</th><th>Event</th><th>Offset</th><th>Bytecode</th><th>Eval stack</th><th>Locals</th><th>Globals</th></tr>"
+  "  </table>"
+  "</div>"
+  "<script>"
+  "var getRulesMemory = function() {"
+  "  var request = new XMLHttpRequest();"
+  "  request.onreadystatechange = function() {"
+  "    if(request.readyState === 4 && request.status === 200) {"
+  "      var mem = JSON.parse(request.responseText);"
+  "      var used = mem.bytecode + mem.rollstat + mem.locals;"
+  "      document.getElementById('rules_memory').innerText = 'Mempool: ' + used + ' / ' + mem.size + ' bytes used, ' + mem.strings + ' bytes for strings, ' + mem.heap + ' bytes of variables on the heap';"
+  "    }"
+  "  };"
+  "  request.open('GET', '/rules/memory', true);"
+  "  request.send();"
+  "  var stats = new XMLHttpRequest();"
+  "  stats.onreadystatechange = function() {"
+  "    if(stats.readyState === 4 && stats.status === 200) {"
+  "      var table = document.getElementById('rules_memory_table');"
+  "      JSON.parse(stats.responseText).forEach(function(item) {"
+  "        var row = table.insertRow(-1);"
+  "        var m = item.memory;"
+  "        [item.rule, item.event, m.offset, m.ast, m.eval, m.locals + (m.pooled ? '' : ' (heap)'), m.globals].forEach(function(val) {"
+  "          row.insertCell(-1).innerText = val;"
+  "        });"
+  "      });"
+  "    }"
+  "  };"
+  "  stats.open('GET', '/rules/stats', true);"
+  "  stats.send();"
+  "};"
+  "getRulesMemory();"
+  "</script>";
 
 static const char webBodyFactoryResetWarning[] PROGMEM =
   "<div class=\"w3-container w3-center\">"
@@ -299,7 +363,6 @@ static const char webBodySettings1[] PROGMEM =
   "</div>";
 
 static const char webCSS[] PROGMEM =
-  "<style>"
   "/* W3.CSS 4.15 December 2020 by Jan Egil and Borge Refsnes */"
   "html{box-sizing:border-box}*,*:before,*:after{box-sizing:inherit}"
   "/* Extract from normalize.css by Nicolas Gallagher and Jonathan Neal git.io/normalize */"
@@ -538,8 +601,7 @@ static const char webCSS[] PROGMEM =
   ".w3-theme {color:#fff !important; background-color:#f44336 !important}"
   ".w3-btn { margin-bottom:10px; }"
   ".heishatable { display: none; }"
-  "#cli{ background: black; color: white; width: 100%; height: 400px!important; }"
-  "</style>";
+  "#cli{ background: black; color: white; width: 100%; height: 400px!important; }";
 
 
 static const char changewifissidJS[] PROGMEM =
@@ -551,7 +613,6 @@ static const char changewifissidJS[] PROGMEM =
   "</script>";
 
 static const char populatescanwifiJS[] PROGMEM =
-  "<script>"
   "var refreshWifiScan = function () {"
   " var selectList = document.getElementById('wifi_ssid_select');"
   " var request = new XMLHttpRequest();"
@@ -580,8 +641,7 @@ static const char populatescanwifiJS[] PROGMEM =
   " request.send();"
   " setTimeout(refreshWifiScan,10000);"
   "};"
-  "setTimeout(refreshWifiScan,500);"
-  "</script>";
+  "setTimeout(refreshWifiScan,500);";
 
 
 static const char settingsForm1[] PROGMEM =
@@ -887,7 +947,6 @@ static const char settingsForm2[] PROGMEM =
   "</div>";
 
 const char populategetsettingsJS[] PROGMEM =
-  "<script>"
   "var getSettings = function() {"
   "  var request = new XMLHttpRequest();"
   "  request.onreadystatechange = function(response) {"
@@ -939,8 +998,7 @@ const char populategetsettingsJS[] PROGMEM =
   "  request.open('GET', '/getsettings', true);"
   "  request.send();"
   "};"
-  "getSettings();"
-  "</script>";
+  "getSettings();";
 
 static const char showFirmwarePage[] PROGMEM =
   "<script>"
@@ -960,6 +1018,34 @@ static const char showFirmwarePage[] PROGMEM =
   "  function _(el) {  "
   "    return document.getElementById(el);  "
   "  }  "
+  "  var bFlashProgress = false;"
+  "  function startWebsockets() {"
+  "    if(typeof WebSocket == \"undefined\") {"
+  "      return;"
+  "    }"
+  "    var oWebsocket = new WebSocket(\"ws://\" + location.host + \":80/ws\");"
+  "    oWebsocket.onopen = function(evt) {"
+  "      oWebsocket.send('firmware');"
+  "    };"
+  "    oWebsocket.onmessage = function(evt) {"
+  "      if(evt.data.substring(0, 12) != '{\"firmware\":') {"
+  "        return;"
+  "      }"
+  "      var fw = JSON.parse(evt.data).firmware;"
+  "      var info = 'Flashed ' + Math.round(fw.flashed / 1024) + ' of ' + Math.round(fw.total / 1024) + ' kB at ' + (fw.rate / 1024).toFixed(1) + ' kB/s';"
+  "      bFlashProgress = true;"
+  "      if(fw.state == 'flashed') {"
+  "        _(\"progressBar\").value = 100;"
+  "        info = 'Flashed at ' + (fw.rate / 1024).toFixed(1) + ' kB/s, MD5 ' + fw.md5;"
+  "      } else if(fw.state == 'failed') {"
+  "        info = 'Flashing failed' + (fw.md5 != '' ? ', MD5 of the upload was ' + fw.md5 : '');"
+  "      } else if(fw.total > 0) {"
+  "        _(\"progressBar\").value = Math.round((fw.flashed / fw.total) * 100);"
+  "      }"
+  "      _(\"flashinfo\").innerText = info;"
+  "    };"
+  "  }"
+  "  startWebsockets();"
   "  "
   "  function uploadFile() {  "
   "    _(\"updatebutton\").disabled = true;"
@@ -986,6 +1072,9 @@ static const char showFirmwarePage[] PROGMEM =
   "  }  "
   "  "
   "  function progressHandler(event) {  "
+  "    if (bFlashProgress) {"
+  "      return;"
+  "    }"
   "    var percent = (event.loaded / event.total) * 100;  "
   "    _(\"progressBar\").value = Math.round(percent);  "
   "  }  "
@@ -1003,7 +1092,7 @@ static const char showFirmwarePage[] PROGMEM =
   "       <input type=\"file\" accept=\".bin,.bin.gz\" id=\"firmware\" name=\"firmware\" onchange=\"getMD5();\"><br><br>"
   "       <label for=\"md5\">MD5 checksum:</label><input type=\"text\" id=\"md5\" name=\"md5\" value=\"\" size=\"32\" minlength=\"32\" maxlength=\"32\"><br><br><b>Warning</b><br>If you leave the MD5 checksum empty there will be no check on the uploaded firmware which could cause a bricked HeishaMon!<br>In this case but also other unforseen errors during update requires you to be able to restore the firmware using a TTL cable!<br><br>"
   "   </form>"
-  "   <button id=\"updatebutton\" onclick=\"uploadFile()\">Update Firmware</button><br><progress id=\"progressBar\" value=\"0\" max=\"100\" style=\"width:300px;\"></progress><p id=\"status\"></p>"
+  "   <button id=\"updatebutton\" onclick=\"uploadFile()\">Update Firmware</button><br><progress id=\"progressBar\" value=\"0\" max=\"100\" style=\"width:300px;\"></progress><p id=\"flashinfo\"></p><p id=\"status\"></p>"
   "</div>";
 
 static const char firmwareSuccessResponse[] PROGMEM =
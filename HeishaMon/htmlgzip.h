@@ -0,0 +1,524 @@
+/*
+ * Generated by Tools/gzipassets.py from htmlcode.h, do not edit.
+ */
+
+#ifndef _HTMLGZIP_H_
+#define _HTMLGZIP_H_
+
+/* webCSS: 23398 bytes, 5246 compressed */
+static const uint8_t webCSS_gz[] PROGMEM = {
+  0x1f,0x8b,0x08,0x00,0x00,0x00,0x00,0x00,0x02,0x03,0xad,0x5c,0x4b,0x93,0xe3,0x38,
+  0x72,0x3e,0xfb,0x5f,0xd0,0xd3,0x31,0x11,0x5d,0x1d,0xa4,0x9a,0x7a,0x97,0xa4,0xf0,
+  0xc6,0xee,0xb4,0x67,0x1d,0xde,0xc3,0x1e,0x76,0xd6,0xf6,0x61,0xa2,0x0f,0x10,0x09,
+  0x49,0xdc,0xe2,0x43,0x4b,0x52,0x5d,0xa5,0x66,0xe8,0xbf,0x1b,0x6f,0x26,0x80,0x84,
+  0xaa,0xe5,0x70,0x55,0x4c,0x8f,0x98,0xc8,0x4c,0x24,0x12,0x89,0xc4,0x87,0x24,0x54,
+  0x9f,0x3f,0x45,0xff,0x33,0x9f,0x7c,0xf9,0xed,0xb7,0x68,0x31,0x99,0x2e,0xa3,0x7f,
+  0xa7,0x19,0xad,0xf6,0xb4,0x8d,0x66,0xe9,0x2c,0x8d,0xf6,0xd7,0xe8,0x2f,0xa4,0x8e,
+  0x7e,0x3d,0x16,0x65,0x44,0xea,0x3c,0xfa,0xa5,0x69,0x8f,0x34,0xfa,0x1b,0x3d,0x74,
+  0x35,0xed,0xa2,0x4f,0x9f,0x4f,0x7d,0x55,0x0e,0xfb,0xe6,0x2d,0xe9,0x8a,0xef,0x45,
+  0x7d,0xdc,0xee,0x9b,0x36,0xa7,0x6d,0xc2,0x28,0xb7,0x4f,0xf1,0xa7,0xed,0x9e,0x1e,
+  0x9a,0x96,0xb2,0x0f,0xe4,0xd0,0xd3,0x16,0x32,0x16,0xf5,0x89,0xb6,0x45,0x7f,0xfb,
+  0xfc,0x29,0xfa,0xf5,0xad,0x6f,0x49,0xd6,0x47,0x87,0xb6,0xa9,0xa2,0xba,0x69,0x2b,
+  0x52,0x16,0xdf,0xe9,0x24,0xeb,0x3a,0xde,0xfd,0x5f,0x8b,0xac,0x29,0x49,0x17,0xfd,
+  0x07,0x29,0x4b,0x72,0x64,0x42,0xc2,0x8e,0xbf,0x34,0x35,0xe9,0x4f,0xcc,0xb2,0xbf,
+  0x52,0x52,0x46,0xc7,0xa2,0x9f,0x14,0xcd,0x67,0x23,0xab,0x0d,0x4b,0xaa,0x2e,0xe9,
+  0xe9,0x5b,0xcf,0x3b,0xa5,0x09,0xc9,0xff,0x71,0xe9,0xfa,0xed,0x34,0x4d,0x7f,0xde,
+  0x25,0xaf,0x74,0xff,0x52,0xf4,0x78,0xeb,0x6d,0xdf,0xe4,0xd7,0xa1,0x22,0xed,0xb1,
+  0xa8,0xb7,0xe9,0x8d,0xb4,0x7d,0x91,0x95,0x34,0x26,0x5d,0x91,0xd3,0x38,0xa7,0x3d,
+  0x29,0xca,0x2e,0x3e,0x14,0xc7,0x8c,0x9c,0xfb,0xa2,0xa9,0xf9,0xc7,0x0b,0x1b,0xe5,
+  0xa1,0x69,0xd8,0x20,0xe3,0x13,0x25,0xcc,0x05,0x71,0x45,0x8a,0x3a,0xae,0x68,0x7d,
+  0x89,0x6b,0xf2,0x2d,0xee,0x68,0xc6,0x59,0x87,0xbc,0xe8,0xce,0x25,0xb9,0x6e,0xf7,
+  0x65,0x93,0xbd,0xdc,0xba,0x4b,0xc5,0x7a,0xb9,0x1a,0x6a,0x59,0x74,0x7d,0x52,0xf4,
+  0xb4,0xba,0x91,0x4b,0x5e,0x34,0x71,0x46,0xea,0x6f,0xa4,0x8b,0xcf,0x6d,0x73,0x6c,
+  0x69,0xd7,0xc5,0xdf,0x98,0x01,0x8d,0xe1,0x2e,0xea,0xb2,0xa8,0x69,0x22,0x55,0x69,
+  0x9e,0xe1,0x1b,0xe5,0xe6,0x92,0x32,0x61,0x9e,0x38,0xd6,0xdb,0x3d,0xe9,0x28,0x67,
+  0x93,0x1a,0xb7,0x75,0xd3,0x7f,0xfc,0x3d,0x6b,0xea,0xbe,0x6d,0xca,0xee,0xeb,0x93,
+  0xd1,0x55,0x37,0x35,0xdd,0x9d,0x68,0x71,0x3c,0xf5,0x6c,0xc4,0xbf,0x9f,0x8a,0x3c,
+  0xa7,0xf5,0xd7,0x98,0x99,0xc2,0x9a,0x7b,0x6a,0xf1,0xdd,0xc8,0xb0,0x27,0xd9,0xcb,
+  0xb1,0x6d,0x2e,0x75,0x9e,0xb0,0xd9,0x69,0xda,0x2d,0x9b,0xc1,0xba,0x3b,0x93,0x96,
+  0xd6,0xfd,0x8d,0x6c,0xd9,0x6c,0x16,0xdf,0x98,0xc3,0xb6,0xa7,0x86,0x99,0x33,0x34,
+  0x97,0x5e,0x58,0xfa,0x5a,0xe4,0xfd,0x89,0x3b,0x74,0xbf,0x6f,0x7f,0xef,0x8b,0xbe,
+  0xa4,0x5f,0x07,0x13,0x30,0x7d,0xdf,0x54,0xd2,0x0c,0x31,0x27,0x39,0xcd,0x9a,0x96,
+  0x70,0x9f,0x6d,0x59,0x2f,0xb4,0xe5,0x0a,0xc2,0x2d,0x51,0xce,0xe4,0x69,0x7e,0xdb,
+  0xc7,0x1d,0x1b,0x59,0x7d,0x1c,0x0e,0x6c,0x88,0x6c,0x8e,0xc5,0x78,0xf6,0x4d,0xc9,
+  0xd8,0x6e,0xf9,0xa1,0x96,0xe4,0xae,0xbf,0x96,0x74,0x5b,0xf4,0xcc,0x41,0xd9,0x8d,
+  0xf9,0xff,0x05,0x0c,0x67,0xfb,0xe1,0x70,0x48,0x77,0x72,0x4c,0x1f,0xd2,0x34,0xbd,
+  0x75,0x2c,0xa2,0x4a,0x25,0xc7,0xc2,0x64,0xfb,0xcc,0xc2,0xa3,0xbb,0xb0,0x7e,0x2e,
+  0x67,0x40,0x5d,0x2f,0x7f,0xde,0x89,0x21,0x6a,0x17,0xee,0xce,0x4d,0x57,0x08,0x1b,
+  0x5b,0xca,0x1c,0xc8,0xbc,0xb1,0x0b,0x4d,0x0c,0xd3,0x36,0xa8,0xe1,0x27,0xe9,0x64,
+  0xb6,0x64,0xb3,0xcf,0x95,0xf7,0xcd,0x99,0x3f,0xf3,0x47,0x19,0x5f,0x3a,0x20,0xa7,
+  0xb4,0x8a,0x16,0xe9,0xf9,0xed,0x56,0x54,0x47,0xed,0x3e,0x39,0x24,0x31,0x39,0x59,
+  0xc3,0x82,0xf4,0x65,0x9f,0xb3,0xa8,0xa1,0x71,0x47,0x2a,0x65,0xe6,0x81,0x54,0x45,
+  0x79,0xdd,0x56,0x4d,0xdd,0xb0,0x79,0xca,0x68,0x6c,0x3e,0xed,0xc6,0x61,0x30,0xd5,
+  0xb7,0x93,0xb5,0x4c,0x79,0xa8,0xb0,0x39,0xe5,0x0b,0xda,0x84,0xc7,0x8e,0x4f,0xea,
+  0xa1,0x6c,0x5e,0xb7,0xdf,0x8a,0xae,0xd8,0x97,0xf4,0xb6,0xbf,0x30,0xf3,0xeb,0xb8,
+  0xa8,0xcf,0x97,0x9e,0x85,0x7a,0xc9,0x82,0x3d,0xe6,0x73,0xc5,0xe2,0x81,0xc4,0xcd,
+  0xb9,0xe7,0xbe,0x95,0x76,0xe8,0x75,0xbf,0x33,0xab,0xcb,0x6a,0x86,0x53,0x66,0x69,
+  0x1d,0x42,0x7d,0xca,0xde,0x06,0x11,0x19,0x22,0x08,0x59,0xc2,0x91,0x71,0xa4,0x39,
+  0x7e,0xef,0xaf,0x67,0xfa,0x6f,0xf2,0xe1,0xab,0x7a,0x62,0x2b,0x85,0xf6,0xfa,0x81,
+  0x4d,0x40,0x55,0xf4,0x5f,0x07,0x9d,0x13,0xc8,0xf9,0x4c,0x09,0x53,0x95,0xd1,0xad,
+  0x94,0x52,0x9a,0xb6,0xdb,0xa4,0x6a,0xbe,0x27,0x87,0x26,0xbb,0x74,0x49,0x51,0xd7,
+  0x6c,0x91,0x5b,0xba,0x83,0xed,0xb2,0xb7,0x60,0xb3,0xea,0xdf,0x6f,0xf7,0x67,0x77,
+  0x77,0x26,0x79,0xce,0xe7,0x25,0xd5,0x36,0x8d,0x32,0x2d,0xa3,0x3b,0x06,0xa1,0x8d,
+  0xca,0x1a,0xb4,0x4d,0x9b,0x62,0x37,0xea,0x05,0xbc,0x9d,0x9e,0xdf,0xd4,0x4a,0x8b,
+  0x7e,0x11,0x5d,0xfc,0x9d,0xb9,0x9d,0x85,0x27,0x2d,0x73,0xa6,0x53,0x99,0x2b,0xb8,
+  0xba,0xa6,0x2c,0xf2,0xe8,0x43,0x96,0xf2,0x5f,0x33,0xd9,0xd1,0xec,0xfc,0x66,0x86,
+  0x30,0x99,0xb3,0xd8,0x8e,0x26,0xab,0x99,0xf8,0xdf,0x9a,0x07,0x7a,0x49,0x8f,0xb4,
+  0xce,0x07,0xb9,0xfc,0x74,0xa4,0xe8,0xd4,0xd3,0x13,0x36,0xed,0x4c,0xd5,0x9b,0xca,
+  0x23,0x22,0x8f,0x1b,0x7f,0xec,0x5e,0x4f,0x2c,0x71,0x26,0x22,0xa2,0xb7,0x72,0x23,
+  0xb8,0xe9,0x10,0x1c,0x83,0x87,0x5c,0xfa,0xe6,0x26,0x87,0x9a,0x9d,0x68,0xf6,0xc2,
+  0xc2,0xda,0x84,0x04,0x61,0xf9,0xf1,0xeb,0x30,0x3a,0x58,0x92,0xeb,0x0b,0xdf,0x0c,
+  0xf9,0xe4,0xa8,0xe8,0x10,0x33,0xc3,0xfa,0x29,0xea,0xc4,0x0a,0x30,0x8f,0x91,0x39,
+  0xcd,0x66,0x1c,0xd4,0x02,0x02,0x46,0x74,0x2c,0xd0,0xb2,0x13,0x1a,0x7a,0xdc,0x78,
+  0xe1,0xd9,0x9d,0x4e,0x9f,0xcd,0xe1,0xc0,0xbc,0xbc,0x4d,0x98,0x13,0x6d,0xf1,0xb1,
+  0x4f,0x49,0x00,0x29,0x12,0xd3,0x2c,0x16,0xc7,0x28,0x73,0x28,0x4a,0x9a,0x5c,0xce,
+  0x65,0x43,0x72,0x6d,0x68,0x70,0x25,0xec,0xe0,0x1a,0x16,0x7b,0x37,0xdb,0x8b,0xa9,
+  0xda,0xbf,0xe5,0xa6,0x1b,0x8b,0xcd,0x13,0xe6,0x9c,0xff,0xa6,0x6d,0x4e,0x6a,0xc2,
+  0x92,0x51,0xdd,0x31,0x0b,0xdb,0xe2,0x00,0x53,0xce,0x92,0x85,0x04,0x4c,0x9d,0xd3,
+  0xc9,0xf2,0x26,0x36,0x6f,0x3d,0x69,0xc9,0xdb,0x56,0x6e,0x47,0xb7,0xd3,0x14,0xa4,
+  0xdc,0xf9,0x8a,0xb9,0xe1,0x34,0x83,0x14,0x9e,0x14,0x4f,0x73,0x40,0x99,0x2d,0x38,
+  0x65,0x01,0x29,0x82,0x67,0x09,0x28,0xd3,0x67,0x4e,0x59,0x41,0x0a,0xd7,0x3c,0x79,
+  0x9d,0x4b,0x5b,0xad,0xa1,0x08,0x8a,0x6c,0x33,0x83,0xb1,0x19,0x0c,0x59,0x70,0x65,
+  0x97,0xb6,0x63,0xb9,0xdf,0x62,0x51,0x34,0xd1,0x6e,0x92,0x30,0x9e,0xa4,0xd9,0x88,
+  0xe3,0xd3,0x2c,0x3e,0xcd,0xe3,0xd3,0x22,0x3e,0x2d,0x63,0x6d,0xa6,0xe2,0xfb,0xe9,
+  0x37,0x7a,0x6c,0x68,0xf4,0x5f,0xff,0xf9,0x53,0xfc,0xa7,0xb6,0x20,0xa5,0xe7,0x61,
+  0x95,0x4d,0x17,0xa9,0x59,0x82,0x53,0x36,0xfe,0x28,0x15,0x7d,0xb3,0x55,0x44,0x87,
+  0x92,0xf6,0x32,0x4a,0x49,0xc6,0xa3,0x5e,0xf8,0x4b,0xe7,0x1d,0xb6,0xa8,0x54,0x02,
+  0xe2,0x7b,0x11,0x58,0xd5,0x94,0x52,0xad,0x6f,0x36,0xea,0x2b,0x2a,0x72,0xe4,0x9b,
+  0x94,0xb5,0x3e,0x61,0xc8,0xf3,0xfd,0xca,0xd9,0x04,0x2b,0x36,0xb1,0x25,0x07,0x14,
+  0xd6,0x92,0x17,0xea,0xc4,0x72,0x8f,0xcd,0xa7,0x84,0x6f,0xc3,0xca,0x1c,0xc6,0x5c,
+  0x92,0x73,0x47,0xb7,0xfa,0x83,0xb6,0x53,0x0f,0x83,0x65,0x83,0xd1,0x04,0x2b,0x7f,
+  0xdc,0x30,0x85,0x56,0xc6,0xca,0x32,0xc1,0x23,0x5b,0x58,0xa2,0xeb,0x5b,0xdb,0x08,
+  0x46,0x70,0x40,0x0b,0x90,0xce,0xf3,0x5c,0x46,0x47,0xdf,0x16,0x67,0x2e,0xcc,0x17,
+  0x03,0x93,0xd8,0xd6,0xfd,0x29,0xc9,0x4e,0x45,0x99,0x7f,0xa4,0xdf,0x68,0xfd,0xe4,
+  0x03,0xa8,0x0f,0x87,0x29,0xff,0xbd,0xb9,0x7d,0x01,0xc9,0x26,0xcf,0x51,0xc1,0xc3,
+  0xe1,0x9e,0xd4,0x0f,0xf4,0x27,0x50,0x1a,0x97,0x1e,0xed,0x15,0x24,0x31,0xf0,0x4b,
+  0x69,0xb3,0x94,0x85,0x42,0x75,0xbe,0x4a,0xed,0xbb,0x8c,0x21,0x06,0xe5,0xbb,0xa8,
+  0x3f,0xc5,0x1e,0x29,0x97,0xdb,0xb5,0x0c,0x01,0xd9,0x32,0x8e,0x80,0x35,0xc7,0xe0,
+  0xe1,0xe4,0x7a,0x3f,0x77,0x09,0x27,0x93,0xb3,0xd9,0x4a,0x8e,0xd8,0x7f,0xf6,0x8c,
+  0xb3,0xae,0xcb,0x72,0x07,0x3a,0x2c,0xe9,0xa1,0x77,0xc1,0x18,0x0b,0x70,0x68,0xc1,
+  0x69,0x7b,0x28,0x5a,0x06,0xc5,0x85,0x07,0xa1,0x35,0x39,0xde,0xa0,0x0c,0xb9,0xd7,
+  0x68,0x49,0x6a,0x8b,0x13,0x6e,0xcb,0x98,0x6f,0xf6,0x7d,0x2d,0xc4,0x54,0x16,0x56,
+  0xc1,0x29,0xf6,0x7d,0x0c,0xf3,0xef,0xe0,0xb8,0xb9,0x92,0x1d,0xba,0xba,0x46,0xb8,
+  0x26,0xd3,0xa8,0x87,0xa2,0x45,0x07,0xf6,0x9e,0xeb,0xcd,0xad,0x6e,0xf0,0x26,0x6e,
+  0xc7,0xd3,0x19,0x63,0x38,0x37,0x85,0x78,0xb4,0xb7,0xe1,0xd7,0x96,0x9c,0xf5,0xd0,
+  0x74,0xd8,0x70,0x70,0x79,0x22,0x39,0xb3,0x27,0x8d,0xb4,0xe5,0x51,0x1a,0xb5,0xc7,
+  0x3d,0xf9,0x98,0xc6,0xe2,0x77,0x32,0x7b,0x8a,0xd3,0x88,0xd3,0x65,0x7e,0xb1,0x1b,
+  0xa7,0x9b,0x27,0xcc,0x5d,0xe6,0x48,0xd7,0x5c,0xd8,0x16,0xc8,0xbc,0x50,0xb2,0x8d,
+  0x53,0x0e,0x4e,0x37,0x5d,0x3a,0x9e,0x24,0x04,0x62,0x54,0x0d,0x2f,0x7c,0xab,0x41,
+  0xe8,0x1c,0xff,0x20,0xd4,0xce,0x27,0xba,0x84,0x5b,0x14,0x45,0xdc,0x2a,0x36,0x63,
+  0x7c,0xf6,0x65,0x20,0xf0,0xe1,0xdb,0x04,0x89,0xde,0x34,0x6d,0x50,0x5e,0x64,0xc7,
+  0x33,0x1e,0x2e,0xcd,0x2b,0x65,0xdb,0x3e,0x4f,0x66,0xfd,0x75,0x9b,0x4e,0xe6,0x37,
+  0xa8,0x30,0xfa,0x14,0x6f,0xc7,0xcf,0x83,0x72,0x7c,0xc2,0xd7,0x79,0xdf,0x49,0x13,
+  0x54,0x97,0x50,0x0a,0xac,0x68,0x68,0x8c,0x3f,0x29,0xa3,0x02,0x92,0x1f,0x75,0x02,
+  0x3e,0x22,0xab,0x9d,0x9d,0x8e,0x76,0x63,0x0a,0xba,0x1b,0xa1,0x32,0xce,0x9f,0x47,
+  0xf0,0x97,0xb4,0x62,0x5b,0xe0,0x14,0x3c,0x15,0x88,0xce,0x75,0x9e,0xe5,0xd0,0xec,
+  0xd2,0x6d,0x97,0xec,0xe8,0x25,0x33,0xd2,0x20,0x0e,0xca,0x02,0x16,0x27,0x1c,0x08,
+  0x39,0xd8,0x78,0x3c,0x5c,0x48,0x76,0x96,0xb3,0x06,0x6f,0xad,0xbc,0x9b,0xc3,0x85,
+  0xdc,0xb6,0x24,0x66,0xd1,0xfa,0x47,0x55,0x99,0x33,0x9a,0xa6,0xec,0x8b,0x73,0xac,
+  0xbc,0xcd,0x9d,0x90,0xf0,0x63,0x13,0x3b,0xff,0x33,0xcf,0x7a,0xe7,0x40,0x28,0x23,
+  0x02,0x85,0x3b,0xc0,0x3e,0x5f,0x03,0x0e,0x39,0x3f,0x3e,0x9f,0x75,0xf6,0xe7,0xad,
+  0x6c,0xbf,0x39,0xb3,0x43,0x82,0x3c,0x79,0x0f,0x63,0xec,0x2c,0x41,0xeb,0x20,0x0e,
+  0x48,0xd2,0x1c,0xc5,0x11,0xa5,0x9d,0xdc,0xbc,0xc5,0x21,0x0b,0x38,0x69,0x67,0x55,
+  0x2a,0x76,0x30,0x17,0x05,0x3d,0xc7,0xf2,0x3f,0xd8,0x78,0x15,0x84,0x12,0xc7,0x33,
+  0xad,0x78,0xc3,0x57,0x33,0xdc,0x9c,0x7f,0x54,0xaf,0x5c,0x01,0x6d,0x73,0x66,0x21,
+  0x5a,0x27,0x19,0x3b,0xb9,0xbf,0xc4,0x16,0x49,0xc6,0xb1,0x7f,0xea,0x46,0xc3,0xd2,
+  0xce,0x59,0x37,0x5f,0x11,0x70,0xfb,0xd8,0xa9,0x3c,0x0a,0x3b,0x25,0x1c,0x44,0xd6,
+  0xdd,0x05,0x6c,0xb3,0xef,0xed,0x9e,0xb0,0xf0,0x10,0x34,0xea,0x0f,0x11,0x48,0x20,
+  0x3f,0xd2,0x57,0x50,0xe2,0x41,0x23,0xb4,0x03,0x94,0xf7,0x38,0xa6,0x03,0xbc,0x3b,
+  0x14,0x99,0xec,0xac,0x02,0x93,0x99,0x1e,0xb2,0x67,0x53,0xcb,0xce,0x47,0xbb,0x8a,
+  0x9d,0x8e,0x54,0x38,0xac,0x58,0xaa,0x37,0x2b,0x17,0x2c,0xe6,0xef,0x2c,0x38,0x73,
+  0xfa,0xb6,0x95,0x58,0x45,0x1c,0xdb,0xc4,0x50,0xc5,0x81,0x6d,0x90,0xc2,0x1c,0xe8,
+  0x6b,0xac,0x29,0x3e,0xfb,0x81,0xc0,0x31,0xac,0x01,0xf6,0x0c,0xfa,0xee,0x49,0xab,
+  0x0f,0x64,0x22,0x12,0x95,0xa2,0x94,0x5b,0x81,0x0f,0xc5,0xe8,0x3c,0x14,0x6f,0x34,
+  0xff,0xd7,0xa2,0x3a,0x37,0x6d,0x4f,0xea,0x7e,0xb4,0x70,0x67,0x1f,0x34,0x65,0x22,
+  0x6b,0x65,0xd0,0x45,0xfe,0x84,0xc6,0x77,0x18,0xc4,0xfc,0x0d,0xce,0x6a,0xba,0xa7,
+  0x0c,0x0d,0xd6,0x77,0x7b,0xc0,0x43,0x1c,0xcc,0xca,0x0f,0x77,0xad,0x0e,0xc3,0x3f,
+  0xd4,0xa1,0xda,0xb1,0x41,0x1e,0x70,0xf1,0x99,0x9b,0xae,0xe5,0x69,0x89,0x97,0x54,
+  0x3f,0xf0,0x7f,0x61,0x26,0x93,0x21,0x23,0xb6,0x98,0x68,0xb2,0xe8,0xd4,0xb9,0x2a,
+  0x27,0xe5,0xa0,0xe7,0x65,0xee,0x44,0xa1,0xda,0x83,0xc4,0xa9,0x46,0xcc,0xb7,0x3d,
+  0xb3,0x3b,0xb1,0x5b,0xa5,0x22,0x62,0xac,0x64,0x05,0xc3,0xc5,0x9a,0x69,0x3f,0x60,
+  0x18,0x60,0x91,0x78,0xe5,0x09,0x6d,0x1b,0xc1,0xcc,0xe2,0x69,0x34,0x78,0xf4,0xbf,
+  0x5c,0x05,0xb8,0x6a,0x3b,0x16,0x4d,0x7c,0x8f,0x0b,0x46,0x57,0x6b,0xb4,0xed,0x2b,
+  0x3e,0x46,0x3d,0x89,0xd0,0xe9,0x0e,0x30,0x04,0xd8,0x3d,0xd2,0xdc,0x68,0xfa,0x94,
+  0x2a,0x60,0x88,0x6b,0x7e,0x51,0xbc,0xf6,0xf7,0x5a,0xd6,0x09,0xe9,0xe5,0xc4,0x8e,
+  0xb2,0x3b,0x0c,0xdf,0xca,0x0e,0xcc,0x08,0x2c,0xfd,0xf8,0xe2,0xc1,0x96,0x8d,0xf1,
+  0x4e,0xd7,0x33,0xe7,0x64,0xa0,0x7f,0xdb,0x60,0x15,0x86,0x7e,0xe5,0xc8,0x8f,0x62,
+  0x33,0x38,0xe4,0x64,0x19,0x40,0xe3,0x6e,0x4c,0xc3,0xf1,0xfa,0x7d,0x2a,0x23,0x45,
+  0xab,0x37,0x7e,0x69,0x88,0x3f,0x3f,0xd2,0xa4,0x00,0x84,0xe2,0x22,0xf6,0x6e,0xe5,
+  0xee,0xce,0x2d,0xed,0xce,0x4d,0x2d,0x2a,0x14,0xce,0x04,0x8c,0xb5,0x17,0x33,0xcd,
+  0x06,0xd3,0xc8,0x97,0x39,0xb1,0x4d,0x53,0x6f,0x7a,0x38,0xf1,0x4c,0x6a,0x5a,0x02,
+  0x26,0xf9,0x0c,0x18,0x5a,0xbe,0x6c,0x4c,0x33,0x7f,0xb2,0x1b,0x13,0xed,0x4a,0x8b,
+  0xc9,0x50,0x01,0x33,0x3f,0xdb,0xb9,0x0a,0x0c,0x0d,0x98,0x59,0x52,0xd2,0x7a,0xcf,
+  0x40,0x66,0xef,0x3f,0xca,0x37,0x56,0x6a,0x45,0x6e,0x9d,0x2a,0xa4,0x52,0xd0,0xf4,
+  0x27,0xe5,0x9a,0x52,0xc8,0x9d,0x48,0x79,0x90,0x88,0xf9,0x54,0xb4,0xea,0x08,0xf8,
+  0xda,0x80,0x87,0x53,0x4b,0xe9,0x3f,0x2f,0xa4,0xd5,0x86,0xa8,0xcf,0x83,0xb7,0x40,
+  0xcc,0x14,0x31,0xd5,0x93,0x6e,0xaa,0xa2,0xee,0x79,0x32,0xe7,0x3f,0xa0,0x65,0xa6,
+  0xe3,0x71,0x35,0x59,0xf1,0x1f,0xd0,0x34,0x37,0x7b,0xe3,0x64,0xc3,0x7f,0x40,0xd3,
+  0x42,0x35,0xcd,0xe7,0x9e,0xc2,0xa5,0x6a,0x5a,0x4c,0x3d,0x85,0x2b,0xdd,0xb4,0xf1,
+  0x14,0xae,0x55,0xd3,0xd2,0xb7,0xf0,0x59,0x35,0xad,0x7c,0x0b,0x37,0xaa,0x69,0xed,
+  0x5b,0x38,0x4d,0xf5,0x90,0x7d,0x13,0xa7,0xda,0x1d,0x1b,0xdf,0xc6,0xa9,0x76,0xc8,
+  0xc6,0x18,0xf9,0xc7,0x8a,0xe6,0x05,0x89,0x3e,0x8e,0x9b,0xda,0x2a,0x65,0xe0,0xf2,
+  0x69,0xd0,0x42,0x55,0xd0,0xbd,0x55,0xd8,0xbd,0xd5,0xdc,0x9a,0xc0,0x90,0xab,0xab,
+  0xc5,0x18,0x0f,0x41,0xa7,0x57,0x61,0xa7,0x57,0x2b,0x13,0x58,0x41,0xef,0x57,0x61,
+  0xef,0x57,0xcf,0x56,0x10,0x06,0xa7,0xa2,0xda,0x78,0xf1,0x19,0x9c,0x9b,0xea,0xce,
+  0xdc,0x54,0x77,0xe6,0xa6,0x42,0xe6,0x06,0x99,0x9c,0xcd,0x66,0x0e,0x27,0xa7,0x0c,
+  0x4e,0x4e,0x19,0x9e,0x9c,0x32,0x1c,0xfb,0x65,0x38,0xf6,0xcb,0xf0,0x34,0x94,0xe1,
+  0xd8,0x2f,0xc3,0xde,0x2f,0xc3,0xb1,0x5f,0x86,0x63,0xbf,0xbc,0xe3,0xdf,0xf2,0x8e,
+  0x7f,0x4b,0xcc,0xbf,0x2a,0xcb,0x83,0xf7,0x67,0x60,0xaf,0xef,0xfa,0x96,0xf6,0xd9,
+  0x69,0x00,0x08,0x6a,0x9b,0x88,0xad,0x4b,0x51,0xe4,0x29,0x3d,0x31,0x00,0x0c,0xa2,
+  0x4a,0xbe,0x2f,0x58,0x92,0x62,0x4f,0xb7,0x04,0xad,0xad,0x43,0xe2,0x1a,0x5d,0x1c,
+  0xde,0x3c,0x6b,0x4c,0xa2,0xf4,0x98,0xaa,0xf1,0x74,0xa1,0x5b,0x74,0x22,0x1f,0xec,
+  0xdc,0xeb,0x26,0x48,0xc6,0x35,0xf8,0x15,0xbf,0x51,0x03,0x83,0x71,0x43,0xa0,0xdc,
+  0x27,0xda,0x65,0x95,0x2c,0x50,0x99,0x36,0x5c,0xf2,0x54,0xea,0xbd,0x5d,0x17,0x54,
+  0x59,0x44,0xe5,0xe5,0x74,0x88,0x33,0xc7,0x03,0x82,0x74,0xf6,0x89,0x6d,0x61,0x62,
+  0x77,0x8d,0xf5,0xa3,0xbd,0xe9,0x62,0xfc,0x10,0x76,0xa1,0x58,0x0c,0x08,0x99,0xa5,
+  0x34,0xfa,0x72,0x96,0x2e,0xf5,0x5a,0x72,0xdc,0xbc,0x59,0xc2,0xc5,0x67,0xc8,0x02,
+  0x2a,0x4a,0x01,0x14,0x91,0xa6,0x11,0x7f,0x81,0x00,0x40,0x9c,0x63,0xb4,0xc4,0xdd,
+  0x10,0x60,0xcf,0xf5,0x6c,0xda,0xe8,0x4d,0x32,0xef,0x8b,0x92,0x86,0xcf,0x2d,0x36,
+  0xa8,0x7b,0x47,0x02,0x29,0xb4,0xfc,0x8b,0x9e,0x96,0x44,0xbe,0xc4,0xbf,0x33,0x39,
+  0x52,0x71,0x10,0x2c,0x39,0xdc,0x1a,0x78,0x8d,0x92,0xf1,0xbd,0x11,0xde,0x1d,0x4c,
+  0x00,0xbc,0xfd,0x98,0x2e,0xcc,0x95,0xba,0x2a,0x7a,0x9f,0x69,0x3c,0xac,0x85,0x0c,
+  0x7b,0x7f,0x0a,0xbc,0x9e,0x50,0x26,0xf7,0xa8,0x87,0x85,0xdd,0x7a,0xf5,0x8c,0x87,
+  0x9d,0xca,0xac,0xe6,0x00,0xe3,0xc7,0xd7,0x92,0x37,0xdd,0xdf,0x46,0x30,0x95,0x1b,
+  0xa3,0x52,0x04,0x48,0xc9,0xc2,0xfb,0xfe,0xea,0x95,0x15,0x03,0x95,0x6b,0xc5,0x4b,
+  0xa7,0xe0,0xea,0x45,0x06,0xb8,0xd9,0xcc,0x98,0x35,0xe2,0xe6,0x12,0x8e,0x43,0x84,
+  0x15,0x5c,0xec,0x52,0x85,0xcc,0x08,0xaa,0x1d,0xde,0x33,0xd0,0x14,0x15,0xc5,0xd1,
+  0x19,0xe6,0xec,0x14,0x54,0x31,0xac,0xd4,0x9d,0x3a,0xe3,0x77,0xb3,0xb4,0x98,0x48,
+  0x59,0xa7,0x94,0x95,0x4f,0x95,0x1f,0x9d,0x93,0x34,0x38,0x2c,0xd9,0x65,0x1c,0x9e,
+  0x94,0xc5,0xf9,0xfa,0x06,0x84,0x55,0xe5,0x4f,0xd2,0x78,0xd4,0x32,0xe3,0x5d,0x8d,
+  0xd6,0x49,0x3e,0x70,0x36,0x97,0x07,0x77,0x75,0x8a,0x57,0xe3,0xd9,0x69,0xe5,0xef,
+  0x9c,0xc7,0x97,0x4f,0xc6,0xd2,0xd9,0x0d,0x96,0x74,0x99,0x52,0xae,0x71,0xf0,0x6b,
+  0x58,0xb0,0x5c,0xe0,0x8a,0x88,0xde,0x11,0x19,0x6d,0x95,0x2f,0x24,0xed,0xbc,0xdf,
+  0x95,0xe5,0x28,0x5b,0xf0,0xbd,0x0e,0x51,0x51,0xb5,0x05,0xfa,0x52,0x72,0x85,0xfd,
+  0x2c,0xfb,0xe5,0x1f,0xc6,0x2b,0x36,0xe2,0x13,0xbf,0x1b,0xf6,0x31,0x61,0x0d,0x31,
+  0xff,0xe7,0x49,0xbc,0x21,0xb9,0xcf,0x62,0xf5,0x1b,0x18,0xa5,0xd5,0x6b,0xa0,0xd3,
+  0xf7,0xbb,0x44,0x7b,0x0c,0xb9,0x47,0x77,0xa9,0xdc,0xf4,0x7f,0xec,0x13,0xed,0x92,
+  0xa9,0x0e,0xfa,0x77,0xf4,0xab,0x08,0xd9,0xa0,0xeb,0xde,0xf5,0xad,0xdb,0xa9,0x9c,
+  0xe6,0xf7,0xfb,0x35,0xab,0xe2,0xff,0xaf,0xeb,0xb1,0x26,0x00,0xea,0x92,0xaa,0x4d,
+  0xd6,0xbe,0x91,0x0a,0x7a,0x40,0xb6,0x3b,0x93,0x3a,0x2c,0xef,0xbd,0x04,0xc1,0xd9,
+  0x4c,0xfa,0xd3,0xcd,0xda,0x1f,0xbe,0x63,0x24,0xde,0x2b,0x5a,0x76,0xbe,0x0f,0xbc,
+  0x7c,0x92,0x89,0x43,0x02,0x0a,0x9b,0x63,0xa6,0x36,0x14,0xc1,0x11,0x8f,0xbc,0x2a,
+  0xab,0xdb,0xcc,0x0b,0xc8,0xac,0xb6,0x1f,0x9b,0xe3,0xd9,0xe2,0x78,0xc3,0x58,0x0c,
+  0x2e,0x57,0x3c,0x28,0xd3,0x7c,0xb4,0xcb,0x94,0x50,0xdc,0x92,0xca,0x1f,0xac,0xe2,
+  0x85,0xdb,0x30,0xd6,0x2f,0xbc,0x16,0x58,0xdc,0xf0,0xc5,0x9c,0x62,0x87,0xcb,0x70,
+  0xaf,0x8d,0x65,0xe6,0xf1,0x2a,0x56,0xf4,0x0c,0xce,0x1f,0x22,0x3c,0xc6,0xba,0xd2,
+  0xc8,0x35,0x49,0xf9,0xcd,0x48,0xe3,0x13,0xd9,0xaa,0x36,0x35,0x51,0xea,0x05,0x07,
+  0x1b,0xfd,0x8e,0x69,0x3c,0xd8,0xe4,0xaa,0x78,0xc4,0x3e,0xf0,0xa0,0xb3,0xee,0xd9,
+  0x7c,0x69,0xea,0x8e,0xdf,0x41,0x8e,0x7f,0xca,0x9a,0x4b,0x5b,0xb0,0xb8,0xac,0xe9,
+  0xeb,0x4f,0x3b,0xe4,0xc6,0x10,0x17,0x1f,0x60,0x89,0x13,0x2f,0xde,0xc2,0x4a,0xe1,
+  0x6c,0x7c,0x17,0x29,0x56,0xe5,0x62,0x7c,0xef,0xb5,0xf8,0xf2,0xa7,0x3f,0x2f,0xd3,
+  0xdd,0x2b,0x6b,0x4d,0xf8,0x9b,0xf4,0xed,0xbe,0xa5,0xe4,0x25,0xe1,0xcf,0x37,0xcb,
+  0x58,0xa9,0x3b,0x6b,0x8b,0xaa,0x6b,0xea,0x5d,0xe8,0xae,0x87,0xfd,0x36,0x76,0xe1,
+  0xbd,0x8d,0xe5,0x14,0x30,0xa6,0xa9,0x3e,0x60,0x11,0x35,0xc1,0xfc,0x43,0x32,0xb3,
+  0x5f,0xe0,0x33,0xeb,0xa3,0x25,0xf2,0x8a,0x7e,0xc5,0x5f,0xe0,0xf3,0xc6,0x29,0xf6,
+  0x02,0x7f,0xf6,0x64,0x34,0x27,0xb2,0x40,0x22,0x56,0xac,0x56,0x8b,0x5c,0x14,0x58,
+  0x04,0x54,0x89,0x8b,0x02,0x8b,0x77,0x2e,0x0a,0xf0,0x3b,0x78,0x03,0xa9,0x8b,0x4a,
+  0xde,0x77,0x50,0x94,0x68,0xd6,0x45,0x45,0x7d,0x28,0x6a,0x06,0xe5,0x23,0x9e,0x48,
+  0x48,0x7b,0xfb,0xe3,0x0b,0xbd,0x1e,0x5a,0x52,0xd1,0x2e,0xd2,0x72,0xe9,0xcf,0xc3,
+  0x98,0xfa,0xda,0xa6,0x17,0x79,0x3e,0xa7,0xc7,0xa7,0x1b,0xc7,0x1a,0x7e,0xdb,0x7c,
+  0xb9,0x11,0xad,0x12,0x36,0x89,0x4e,0x29,0x0b,0x24,0xee,0x67,0x60,0x83,0x24,0xb0,
+  0x21,0x8d,0x36,0xc0,0xce,0x15,0x3f,0xd3,0x6f,0xde,0xe4,0xde,0x96,0xe0,0x69,0x2a,
+  0x3b,0x1f,0x1b,0xad,0xde,0x14,0x19,0x74,0xc7,0x29,0x51,0x3a,0x79,0xee,0x60,0x27,
+  0x9c,0x38,0xf0,0x4b,0xf7,0x40,0x4f,0xc4,0x60,0xde,0xd8,0x89,0xa5,0x95,0x43,0x36,
+  0xff,0xb5,0xc3,0xd8,0x87,0xe2,0x63,0x6c,0xac,0xa7,0x85,0xd5,0xd3,0xd8,0x24,0xfb,
+  0x13,0x77,0x9b,0xe7,0xe2,0xd5,0x8b,0xdd,0xb5,0xdc,0x06,0x03,0x06,0xd8,0x68,0x21,
+  0x6c,0x81,0x78,0x13,0x14,0x30,0x41,0xe8,0x10,0x36,0xc8,0x6a,0x07,0x66,0x84,0x02,
+  0x59,0x01,0x2b,0x1c,0x04,0x11,0x36,0x43,0x30,0x86,0xec,0x90,0x5a,0x84,0x21,0xaa,
+  0xc8,0x82,0x59,0xa2,0x41,0x5b,0xc0,0x14,0x17,0x73,0x87,0x6d,0x91,0x9c,0x21,0x63,
+  0x94,0x1e,0x61,0x8d,0xbe,0x89,0x8e,0x99,0x63,0xc0,0x42,0xc0,0x9e,0xef,0x0d,0xeb,
+  0x63,0xf0,0x3a,0x17,0xe4,0x74,0xb2,0xc2,0xba,0xe6,0x6d,0x2a,0x26,0xcc,0x42,0xea,
+  0x32,0x52,0xb2,0x35,0xf6,0x24,0x23,0xc2,0x21,0x4f,0x9d,0x95,0x25,0x2f,0x2e,0x80,
+  0xd7,0x81,0x22,0xfb,0x8a,0x91,0x46,0x94,0x74,0x9c,0x81,0xdf,0xc4,0xf5,0x65,0xb6,
+  0xe2,0x7a,0xf3,0x10,0x3c,0xe4,0xab,0x31,0x82,0xec,0xa4,0x47,0xad,0xbe,0xd4,0x60,
+  0xae,0x58,0xac,0x52,0x28,0xc0,0xaf,0xe9,0xfa,0x42,0x9c,0xea,0x08,0x4e,0x2d,0x29,
+  0x76,0xb6,0x02,0x2a,0x67,0x4b,0xbb,0x91,0xe5,0xa1,0xb1,0x71,0x2d,0x1b,0x8f,0x2d,
+  0xbd,0x0a,0x9f,0x70,0xd9,0x58,0x52,0x88,0x43,0x91,0x36,0x18,0x4e,0x70,0x09,0x48,
+  0xb7,0x10,0xd8,0x32,0x1c,0x8a,0x92,0xc5,0xe6,0xd6,0x90,0x3f,0x72,0xc7,0x3c,0xd9,
+  0xdd,0xd9,0x5d,0xf9,0x22,0xeb,0xa5,0x2b,0xc1,0xed,0x77,0x0d,0x64,0x23,0xf2,0x24,
+  0x0d,0x74,0xee,0xe8,0xb9,0x20,0xba,0x5d,0x3c,0x8c,0x5a,0xc5,0xa3,0x33,0x40,0x41,
+  0xb3,0x87,0x20,0xa5,0x46,0xf3,0x95,0xd8,0xd8,0xad,0x64,0x30,0x5d,0xf6,0x45,0x7d,
+  0x85,0x77,0x80,0x59,0xf4,0xbb,0x25,0x00,0xe7,0x9b,0x20,0x7c,0xe7,0x76,0xcb,0x48,
+  0x12,0xea,0xd9,0xb7,0x9b,0x1d,0x1e,0x89,0xd1,0xec,0xfb,0xc7,0x0e,0xcb,0x9b,0xcb,
+  0xc3,0xaf,0x34,0xb8,0x3c,0x1e,0x13,0xbf,0x10,0xed,0x31,0x79,0x5c,0x0b,0xbf,0xbb,
+  0x7f,0x5c,0xaa,0x7d,0x03,0x58,0x56,0x7e,0x6f,0x3c,0x25,0xca,0x22,0xd5,0xe0,0xbc,
+  0xd5,0x74,0x18,0x45,0xc6,0xf2,0x39,0x05,0xd9,0xeb,0xb6,0xeb,0x8b,0xc3,0x15,0xb2,
+  0x29,0x92,0xc3,0x28,0xcb,0x62,0x7e,0xa1,0xcc,0xad,0xca,0x49,0x10,0x95,0x9a,0xdb,
+  0xcb,0x68,0x3b,0x7e,0xe5,0x17,0x57,0xc5,0xf7,0x2b,0xfc,0x06,0x74,0x50,0xc4,0x54,
+  0x32,0xc2,0x57,0x99,0x70,0x41,0xb1,0x31,0x41,0x1c,0xf8,0x23,0x42,0x72,0x17,0x81,
+  0x0f,0xf7,0xc5,0xd8,0x28,0xf8,0x4b,0x7d,0x30,0xa6,0xd5,0xfd,0x5e,0xb8,0xf9,0x40,
+  0x42,0x8d,0xe7,0xae,0x10,0x37,0x1e,0x88,0x88,0xb1,0xdc,0x15,0x10,0x76,0x03,0x09,
+  0x39,0x8e,0xbb,0x22,0xea,0xdb,0x74,0x06,0xb1,0xbb,0x30,0xdf,0xaf,0x6a,0x01,0xc0,
+  0xef,0xae,0x59,0xc1,0x60,0xbe,0x5c,0x15,0x62,0x10,0xc1,0x10,0xec,0x06,0x32,0xaa,
+  0x10,0xf8,0xc1,0x8e,0xe5,0xc4,0xc3,0x9a,0x5c,0x98,0x55,0x4e,0xb7,0x55,0xa7,0x43,
+  0x98,0x35,0xa8,0x97,0xf9,0x4a,0x9f,0x35,0x16,0xf2,0x6e,0x34,0xce,0xeb,0xdd,0xd8,
+  0x08,0xa8,0x94,0xc9,0x44,0x33,0xf3,0x04,0x18,0x21,0xa9,0x49,0x73,0x4f,0x57,0x56,
+  0xa5,0xd6,0x99,0x18,0xdd,0x14,0x76,0x90,0xe6,0x98,0x2d,0x2c,0x3d,0x76,0x8f,0xae,
+  0x9e,0x3b,0xf6,0xcc,0x67,0xf6,0x9b,0x89,0xd9,0x3d,0x3d,0xf3,0x59,0x50,0xcf,0xe2,
+  0xd9,0xd2,0x63,0x67,0x54,0x57,0xcf,0x22,0xe8,0xf4,0x64,0x65,0x8f,0x6b,0x75,0x77,
+  0x5c,0xab,0xf0,0xb8,0x98,0xf0,0x7d,0x5d,0x1e,0xf7,0xdd,0x11,0x78,0xdc,0x77,0xfd,
+  0xe6,0x71,0xdf,0x9d,0x2d,0x93,0x21,0xc0,0x8d,0x07,0x2c,0x1d,0xa8,0x66,0x6c,0xdb,
+  0x50,0xd7,0x18,0xe5,0x66,0x3f,0x5e,0x3f,0x04,0x9e,0x43,0x6f,0x35,0xba,0x99,0x70,
+  0xfc,0xbe,0x2a,0xc0,0x11,0xbc,0x52,0x14,0xba,0x9f,0x09,0x24,0x1c,0x5d,0xbe,0xac,
+  0x7d,0x9b,0x1a,0xb0,0x7f,0xfe,0x14,0x7d,0xe1,0xda,0xf8,0x57,0xa7,0x05,0x22,0xe5,
+  0xdf,0x19,0x03,0x06,0x88,0xe7,0xc7,0xc6,0x76,0x38,0x64,0xd3,0x74,0xed,0x96,0xeb,
+  0xff,0x79,0x21,0x50,0x2d,0x7b,0x7c,0x4c,0x6b,0x9a,0x1e,0xd8,0x8f,0xeb,0xfa,0xf2,
+  0x42,0x81,0x56,0xfe,0x68,0x6b,0xb5,0x44,0x10,0xad,0xb3,0xe9,0x66,0xf5,0xe7,0xb9,
+  0x1b,0x0e,0x02,0x32,0x38,0xba,0x47,0xe2,0x63,0x76,0x3f,0xaf,0xbf,0xfc,0xfa,0xeb,
+  0x2f,0xae,0xdd,0x6d,0xf3,0x5a,0x43,0xc3,0xf9,0xf3,0x63,0x96,0xaf,0x37,0xcb,0xe5,
+  0xe2,0xd9,0x05,0x26,0x57,0x02,0xd5,0xf2,0xc7,0x47,0xbd,0xbc,0xcf,0xf2,0x05,0xe2,
+  0x65,0x81,0x9d,0x1d,0x57,0x0b,0x1a,0xbc,0xc6,0x2f,0x69,0x04,0xe1,0x23,0xd7,0xc7,
+  0x46,0xb7,0x4a,0xd7,0xf9,0xf3,0xde,0xb1,0x83,0x75,0x47,0x6b,0xfb,0x14,0x41,0x1f,
+  0xf4,0x9a,0x2c,0x60,0xa1,0xf3,0xed,0x6a,0x07,0xd4,0x07,0x67,0x7c,0x9f,0xcd,0x17,
+  0xc4,0xe9,0xa3,0xa8,0xf3,0xe2,0xd8,0x00,0xf5,0x92,0xf0,0x98,0xf5,0xf3,0xc3,0x72,
+  0xba,0x5f,0x3a,0x9a,0x5f,0x4e,0xe4,0xa5,0x00,0x8a,0xc5,0xf3,0x83,0x2b,0x36,0xa5,
+  0xab,0x67,0x0f,0x36,0x15,0x95,0x1d,0xff,0xd5,0x83,0x91,0x9f,0xe5,0x79,0x36,0xdf,
+  0xb8,0x87,0x58,0x96,0xb4,0x8e,0x50,0xaf,0x24,0x3c,0x9a,0x61,0x36,0xcf,0xa9,0x3b,
+  0x8b,0x39,0xa5,0x67,0x5f,0x3d,0xa0,0x3e,0xe6,0xeb,0xc3,0x61,0xb9,0x9e,0xcd,0xdc,
+  0x6d,0xa5,0xa8,0x5f,0x80,0x72,0xfe,0xf8,0x98,0x56,0xba,0x99,0xd2,0x95,0x9b,0x6f,
+  0xce,0x97,0xf6,0x5c,0x42,0xa3,0x25,0xe1,0x31,0xcd,0x9b,0x6c,0xb6,0xde,0xa3,0x3e,
+  0xf1,0xd4,0x03,0xea,0x83,0xab,0x72,0x3d,0x27,0x7b,0x37,0xb3,0xb7,0xea,0x0b,0x44,
+  0x52,0x77,0x6b,0xbe,0xc1,0xf3,0xa3,0x7e,0x5e,0x2c,0xe6,0xf3,0x95,0x0b,0xa7,0x49,
+  0x0d,0x95,0xf2,0xc7,0x07,0x23,0x24,0x3f,0x2c,0xa9,0xab,0xb5,0xa7,0xa4,0x04,0x5a,
+  0xf9,0xe3,0x63,0xb6,0xa6,0xe9,0x66,0xf5,0xec,0xe6,0xdc,0x2b,0xe5,0x5f,0x8f,0x02,
+  0x7a,0x25,0xe1,0xd1,0x88,0xa6,0xfb,0xb9,0x9b,0xef,0xc4,0x95,0x5c,0xa0,0x58,0x3c,
+  0x3f,0xaa,0xd7,0xdf,0x32,0x49,0xf6,0x62,0x25,0x68,0x92,0xbd,0x3c,0xea,0x86,0xd4,
+  0xcf,0xcc,0x57,0xa7,0xbc,0x03,0xf6,0x05,0x67,0x4b,0xf0,0x77,0x83,0xf7,0x46,0xb1,
+  0xa1,0xfc,0x37,0x94,0xb5,0xaf,0x58,0xd2,0x86,0xfd,0x6b,0x22,0xc1,0x38,0x1f,0xb5,
+  0x45,0xbe,0xb9,0x70,0xd7,0x19,0x69,0x5f,0x5c,0x53,0x0c,0x0d,0x58,0xa2,0x68,0x04,
+  0xe1,0x7b,0x78,0x87,0x9c,0xf2,0x5f,0x0f,0xf6,0x96,0xd4,0x59,0x90,0x9a,0xf4,0x68,
+  0xdc,0xe4,0xec,0x07,0xd3,0xee,0x6e,0x93,0x23,0xf1,0xb1,0x1e,0xf2,0x9c,0xf7,0x81,
+  0xf5,0xe0,0x2d,0x28,0x40,0x7d,0x38,0xfa,0x0f,0x1e,0xd0,0x16,0xda,0x1c,0x70,0x67,
+  0x68,0x8f,0x8f,0xc1,0x5b,0x60,0xb2,0x2a,0xe4,0xc0,0xe8,0x91,0xe8,0xce,0x32,0x82,
+  0x95,0x25,0xb3,0x0d,0x98,0x0d,0xcd,0xb5,0x30,0x64,0x81,0x33,0x42,0x43,0xb3,0xe5,
+  0x51,0xfc,0x2b,0x78,0x51,0x10,0xec,0xb4,0xd8,0xba,0x50,0xa4,0x2b,0xfb,0x75,0xe0,
+  0xee,0x48,0xb4,0x35,0xa0,0x98,0x56,0x30,0x3b,0xc0,0xd6,0xd0,0x5c,0x6f,0x20,0xe8,
+  0xd5,0x8c,0xdc,0x5d,0xa0,0x76,0x03,0x58,0xa5,0xb0,0x81,0x84,0x24,0xdc,0xf5,0x8a,
+  0x22,0x56,0x21,0xe0,0xae,0x98,0x91,0x68,0x6b,0x40,0xb1,0x29,0xf0,0x38,0xaa,0x27,
+  0x88,0x52,0x51,0x14,0x2a,0x44,0x3c,0x28,0x0a,0xa8,0xb6,0x0e,0x14,0x6f,0x0a,0x6e,
+  0x17,0x74,0x8e,0x44,0x5b,0xc3,0x7e,0x41,0x48,0x68,0x4c,0x15,0x12,0x59,0x2e,0xc6,
+  0x44,0x31,0xa4,0xe0,0xf5,0x90,0x1e,0xa0,0xba,0x6b,0x0c,0x41,0x8b,0xea,0x2b,0xe7,
+  0x18,0x64,0x74,0x9b,0x5c,0x6d,0x08,0x2e,0x14,0x22,0x0e,0x38,0x34,0x34,0x5b,0x1e,
+  0x45,0x80,0x92,0xd7,0xc5,0x69,0x80,0x6a,0xeb,0x40,0xb1,0xde,0x68,0x36,0xae,0x28,
+  0x88,0xfa,0x50,0x54,0x27,0x44,0xec,0x9d,0x44,0x93,0x1c,0x7f,0x60,0xf8,0x4d,0xfe,
+  0x11,0x33,0x1b,0xc4,0x19,0x9a,0x23,0x8f,0x23,0x35,0xfe,0xc7,0x93,0x5c,0xb8,0xa6,
+  0x68,0xee,0x9a,0x47,0x30,0x99,0xe0,0xf5,0xf6,0x11,0x40,0xb5,0x75,0xe4,0xb3,0x3d,
+  0x4d,0x29,0xa6,0xc3,0x85,0x60,0x23,0xf1,0xce,0x6e,0x0d,0xd3,0x8e,0x0d,0xb6,0x46,
+  0xe2,0x9d,0x8d,0xc6,0xca,0x1c,0x57,0x24,0x71,0x78,0xb9,0x0a,0x4b,0x53,0x7e,0x86,
+  0x5a,0x2f,0xf9,0xef,0xdd,0xfc,0x72,0x0d,0xa6,0x17,0xaf,0x4f,0x14,0x54,0x39,0x2d,
+  0x8e,0x8f,0x30,0xe4,0x24,0x43,0x13,0x81,0x4f,0x76,0x83,0xdb,0x3b,0x06,0xa4,0xec,
+  0x06,0x27,0x93,0x11,0xfe,0x8b,0xbf,0xb3,0x70,0xf7,0x6a,0x48,0x36,0xf5,0x33,0xfd,
+  0x67,0x5e,0x82,0x9b,0xb6,0x96,0xb2,0xb7,0x6d,0x40,0x45,0x55,0xe1,0x55,0x2d,0xf5,
+  0x6e,0xc3,0x29,0x6e,0x8d,0x54,0x54,0x15,0xba,0x95,0xeb,0x77,0x1e,0xd8,0x66,0xee,
+  0xb5,0xa1,0x6a,0xf1,0xfa,0x95,0xb2,0xc5,0x2d,0x63,0x01,0x32,0xaa,0x0c,0xdd,0xe0,
+  0x35,0x8b,0xbd,0xc5,0x03,0x6a,0xc0,0x73,0x58,0xa5,0x6a,0xf4,0x91,0x57,0xb0,0x72,
+  0x9a,0x60,0xdd,0xca,0x6a,0x22,0x61,0x29,0x13,0x55,0xb6,0x29,0xe8,0xd6,0xaf,0x58,
+  0xdc,0x4d,0x1b,0x92,0x51,0x65,0x28,0x0a,0xb0,0xa6,0x2a,0xa0,0xd2,0x47,0x02,0xce,
+  0x44,0x62,0x80,0x40,0xb1,0x78,0x90,0xc0,0xa2,0xa3,0xea,0x50,0x6c,0xa0,0x58,0x5c,
+  0x74,0x00,0xc9,0xf8,0x8a,0xc2,0x0a,0x50,0x66,0x5c,0x15,0x1a,0xb5,0x15,0x1e,0xaf,
+  0x28,0x62,0x50,0x2c,0xde,0x56,0x6f,0xd1,0x03,0x6b,0x1d,0x01,0x0f,0x8a,0x05,0x87,
+  0x0f,0x7e,0x63,0x40,0x31,0x82,0x23,0x14,0x8b,0x83,0x24,0x00,0x15,0x55,0x85,0x42,
+  0x0a,0x2d,0xe4,0x62,0x01,0x8b,0x8e,0xaa,0x43,0xd1,0x05,0x1c,0x55,0x48,0xa7,0x8f,
+  0x30,0x9c,0x75,0x82,0x01,0x0d,0xfd,0x8e,0xd5,0x82,0x1a,0x23,0x11,0xf7,0x1d,0x86,
+  0x39,0xf4,0x5f,0xdc,0xb2,0x51,0x07,0xa0,0xe2,0xaa,0x30,0xf8,0xa1,0x5f,0x47,0xdb,
+  0x00,0x04,0x50,0x03,0x19,0x09,0x41,0x22,0x8a,0xc5,0xc3,0x22,0x16,0x3d,0x10,0x20,
+  0x48,0x49,0x48,0xb1,0xb8,0xb0,0x04,0x92,0x03,0xca,0x82,0x9b,0x8c,0x53,0x0e,0x02,
+  0xe4,0xc0,0x28,0xd3,0x60,0xa6,0xbb,0xa2,0x89,0x0e,0x49,0xb5,0x78,0x96,0x0d,0x26,
+  0x58,0xb4,0xfe,0xe3,0xa6,0xbd,0xeb,0x9d,0x94,0x88,0x98,0x80,0xe2,0x17,0xaf,0x0d,
+  0x77,0x26,0x06,0x64,0xf4,0x1a,0x40,0xa0,0x8c,0xdb,0xe4,0x1b,0x83,0xc1,0x19,0xb7,
+  0x09,0x5f,0x52,0x58,0x15,0x48,0x2f,0x71,0xbf,0x18,0xe4,0xb4,0x84,0xe2,0x6e,0x4d,
+  0xd7,0x77,0x54,0x06,0xf6,0x1f,0xaf,0x10,0xe4,0x24,0xa9,0x35,0x57,0x7c,0x47,0x6d,
+  0x68,0x89,0xf8,0xd5,0x1f,0x2f,0xb4,0x0f,0xa1,0xeb,0x28,0x58,0xad,0xc7,0x6d,0x0a,
+  0x5a,0xeb,0x43,0xfa,0x13,0xad,0x68,0x04,0x20,0x7f,0x04,0xaa,0x43,0x51,0xa8,0xb4,
+  0x1d,0xb9,0xa6,0xf5,0x75,0x34,0x44,0xce,0x65,0x0c,0x7e,0xb5,0x31,0xba,0x4d,0x4e,
+  0xb4,0xe8,0x4e,0x44,0xfe,0x69,0xb7,0x21,0xd2,0x5f,0x17,0x88,0xc4,0x57,0x8b,0xa2,
+  0xdb,0x87,0xac,0x2c,0x06,0xd0,0xcf,0x36,0x12,0xcb,0x74,0x17,0xc9,0xfe,0x22,0xb1,
+  0xfc,0x77,0x91,0xbc,0x40,0x18,0x89,0x2f,0x1e,0x45,0xea,0x5b,0x48,0xd1,0x22,0xb5,
+  0xee,0x8f,0x31,0x6d,0xff,0x0b,0xe8,0x61,0x53,0x1d,0x66,0x5b,0x00,0x00,
+};
+
+/* websocketJS: 1679 bytes, 667 compressed */
+static const uint8_t websocketJS_gz[] PROGMEM = {
+  0x1f,0x8b,0x08,0x00,0x00,0x00,0x00,0x00,0x02,0x03,0x8d,0x54,0x4d,0x73,0x9b,0x30,
+  0x10,0xfd,0x2b,0x5b,0x0e,0x01,0xe2,0x8e,0xec,0xa4,0x3d,0x74,0x4c,0x7d,0x69,0x27,
+  0x33,0x49,0x67,0xda,0x1e,0x92,0x69,0x0f,0xae,0x0f,0x02,0x96,0x8f,0x46,0x91,0x18,
+  0x49,0xc4,0x71,0x33,0xfe,0xef,0x5d,0x01,0x06,0xdc,0xd8,0x6e,0x38,0x18,0xa3,0xdd,
+  0x7d,0x6f,0xdf,0xdb,0x05,0x80,0x47,0xae,0x21,0xfe,0xac,0xa4,0xc4,0xc4,0x62,0x0a,
+  0x0b,0xc8,0xb8,0x30,0x18,0x01,0x64,0xb5,0x4c,0x6c,0xa9,0x24,0x18,0xcb,0xb5,0xfd,
+  0x89,0xb1,0x51,0xc9,0x3d,0x5a,0x13,0x84,0xf0,0x0c,0x74,0x95,0x59,0x60,0x37,0x15,
+  0xaa,0x0c,0xbe,0xaa,0x3f,0x14,0xbe,0x6d,0xc2,0xf0,0x66,0x01,0x5e,0x2d,0x53,0xcc,
+  0x4a,0x89,0xa9,0xd7,0xe5,0x02,0xa8,0x1e,0x80,0x28,0x24,0xae,0xf7,0x8a,0x02,0x6f,
+  0x6d,0xe6,0xd3,0xa9,0x07,0x13,0x10,0x2a,0xe1,0x8e,0x95,0x15,0xca,0x58,0x7a,0xf6,
+  0xe6,0x1f,0x66,0x5e,0x18,0x39,0x88,0x2d,0x20,0x75,0x36,0xe2,0xfd,0x2f,0xe9,0xf4,
+  0x1c,0xee,0x0a,0x84,0xa4,0xe0,0x9a,0x93,0x3a,0x6d,0x80,0x67,0x74,0x03,0x4b,0x87,
+  0x56,0xf3,0x52,0x94,0x32,0x07,0x23,0xb8,0x29,0x80,0x6b,0xa4,0xb6,0x30,0x25,0x0b,
+  0x32,0xa5,0x81,0xc3,0xba,0x44,0x9d,0xc2,0xcd,0x15,0x5c,0xcc,0x20,0xae,0x73,0x38,
+  0x9f,0x1e,0x11,0xf2,0x5a,0x15,0xd3,0xb5,0xe9,0x85,0xb4,0xf6,0x0d,0x50,0x07,0x6c,
+  0x62,0x4a,0xaa,0x0a,0xa5,0x1b,0x48,0x37,0x88,0x00,0x1f,0x87,0x44,0xd8,0x1f,0x9a,
+  0xd5,0x35,0x46,0xbb,0xc8,0x08,0xc4,0xa0,0x4c,0x03,0xff,0x91,0x8b,0x1a,0x8d,0x1f,
+  0x76,0x19,0xdb,0xe8,0x00,0x59,0x22,0x14,0x99,0x7b,0x94,0x2d,0x51,0xd2,0x28,0x81,
+  0x4c,0xa8,0x3c,0xf0,0xbb,0xec,0x39,0xf8,0xa4,0xcd,0xe5,0x45,0x07,0x9b,0xda,0x6d,
+  0x52,0x7b,0x91,0xe0,0x54,0x25,0xf5,0x03,0x4a,0xcb,0x72,0xb4,0x57,0x02,0xdd,0xdf,
+  0x4f,0x9b,0x1b,0x6a,0xf0,0x1a,0xb9,0xad,0xea,0x87,0xca,0x0f,0x99,0xb1,0x1b,0xa2,
+  0x49,0x4b,0x53,0x09,0xbe,0x81,0xc5,0x02,0xfc,0x98,0xdc,0xbc,0xf7,0x47,0xbd,0x00,
+  0x68,0xcc,0x34,0x9a,0xe2,0x8e,0xc7,0x02,0xc7,0xd5,0x3d,0xd9,0xf6,0x84,0x52,0xd4,
+  0x9a,0x26,0xfc,0x5a,0xa5,0x4d,0xf6,0x0b,0xa5,0x07,0x81,0x1f,0xd0,0x18,0x9e,0x9f,
+  0x30,0x91,0x2c,0xa0,0x03,0x96,0x72,0xcb,0x99,0xa9,0x63,0x63,0x35,0x2d,0x60,0x30,
+  0x7b,0x4b,0x3b,0x16,0x36,0x52,0x9f,0xbd,0x76,0x54,0xde,0x7c,0x5f,0x6f,0x5d,0x51,
+  0x0d,0xfe,0x68,0x62,0xc1,0x97,0xdb,0xef,0xdf,0x58,0xc5,0xb5,0xc1,0x1e,0x2d,0x64,
+  0x6d,0xdd,0x60,0x80,0xf3,0xc8,0xd6,0x5a,0xfe,0xeb,0x08,0x80,0xa0,0xcd,0x55,0xf1,
+  0x6f,0xea,0xf2,0xd8,0x38,0xbc,0x44,0x94,0xde,0x00,0xe5,0x0a,0x92,0xe2,0xfe,0x54,
+  0x01,0xaf,0xad,0x32,0x89,0x56,0x42,0x8c,0xea,0x88,0xa4,0x6d,0x0b,0x26,0x0b,0xd8,
+  0x75,0xea,0x5e,0x86,0x5f,0xd2,0x1b,0x6f,0x05,0x61,0xb3,0xa4,0x40,0x32,0x31,0xdd,
+  0x13,0xed,0xea,0x5b,0xd0,0x3b,0x55,0x11,0xfb,0xf0,0x7c,0x8d,0x65,0x5e,0xd8,0x17,
+  0xc3,0xee,0x7e,0xb6,0xa3,0x6f,0xd7,0x9e,0x71,0x9d,0x47,0x2d,0x87,0x53,0xa5,0xd5,
+  0xda,0x9c,0x92,0x55,0x60,0x69,0x0a,0xde,0x8d,0x24,0x64,0x2e,0x3d,0xda,0xd5,0x96,
+  0xf4,0xb9,0x79,0xa2,0xe2,0xe7,0x76,0x15,0xe8,0xa3,0x11,0x34,0xc7,0x74,0x34,0x8b,
+  0xe8,0xf6,0xb1,0x41,0x67,0x02,0x65,0x6e,0x0b,0x3a,0x98,0x4c,0x7a,0x71,0x4d,0xe9,
+  0xd2,0x85,0x97,0xe5,0x8a,0x25,0x28,0x84,0x59,0xce,0x56,0xcc,0xe2,0x93,0xa5,0xd7,
+  0xc7,0x12,0xfd,0x8a,0x50,0xba,0xf8,0xf0,0xc5,0x38,0x40,0xd1,0xb6,0x76,0x90,0xa4,
+  0xd3,0x47,0xb9,0x2d,0x5d,0x9b,0x4a,0x80,0x44,0xb5,0x8a,0x7a,0xf3,0x5d,0xca,0xd9,
+  0x99,0xcb,0x6c,0x1b,0xe9,0xb0,0xdc,0x36,0xbe,0x1f,0x4d,0xa3,0x8f,0x2f,0x2f,0xf7,
+  0x1a,0x25,0xf8,0x01,0xf8,0x62,0x15,0xbd,0xcc,0x7f,0x77,0x3c,0xff,0x72,0x97,0xdf,
+  0x4f,0xee,0x2f,0x88,0xc4,0x2e,0x4d,0x8f,0x06,0x00,0x00,
+};
+
+/* refreshJS: 1307 bytes, 560 compressed */
+static const uint8_t refreshJS_gz[] PROGMEM = {
+  0x1f,0x8b,0x08,0x00,0x00,0x00,0x00,0x00,0x02,0x03,0x8d,0x54,0x6d,0x6f,0xd3,0x30,
+  0x10,0xfe,0x2b,0xb7,0x7c,0x89,0xa3,0x55,0x21,0xc0,0xb7,0x85,0x0a,0xb1,0x51,0x51,
+  0xa4,0x0e,0x24,0xa8,0x04,0x12,0x42,0xc8,0x89,0xaf,0x8b,0x99,0x6b,0x17,0xfb,0xd2,
+  0xae,0xda,0xfa,0xdf,0xb1,0x93,0x34,0x4d,0xa7,0x56,0x9a,0x3f,0x38,0x8e,0xef,0xee,
+  0x79,0xee,0xd5,0xa0,0x90,0x80,0xe4,0x12,0x4d,0x4d,0x39,0x08,0x53,0xd6,0x4b,0xd4,
+  0x94,0x16,0x46,0x6c,0x53,0xa3,0x95,0xe1,0x62,0xbc,0xa8,0x75,0x49,0xd2,0x68,0x96,
+  0xc0,0x23,0xf8,0x65,0x56,0xa8,0xe7,0xbc,0x50,0xc8,0xe2,0x29,0x72,0x5a,0xd5,0xcb,
+  0x55,0x9c,0xe4,0x41,0xd2,0x9b,0xdf,0x21,0x4d,0x14,0x86,0xe3,0xf5,0xf6,0xb3,0x60,
+  0x51,0xa9,0x64,0x94,0xa4,0x6b,0xae,0x6a,0x84,0x31,0x44,0x51,0xa3,0xed,0x88,0x5b,
+  0xfa,0x81,0x85,0x33,0xe5,0x3d,0x92,0x63,0x1e,0x63,0x97,0xc3,0x9e,0x0d,0x02,0xf7,
+  0x8d,0xd1,0xe4,0x41,0x98,0x14,0x23,0xa8,0xad,0x1a,0x35,0xd2,0xd6,0x8d,0x35,0xb7,
+  0xf0,0x50,0x59,0x0f,0xa7,0x71,0x03,0x3f,0x6f,0x67,0x53,0xa2,0xd5,0x37,0xfc,0x57,
+  0xa3,0x23,0xd6,0xb8,0xe3,0xa5,0x69,0xf0,0x95,0xc5,0x9f,0x26,0xf3,0x78,0x0f,0xc0,
+  0x95,0xc3,0x5e,0xec,0x50,0x8b,0x56,0x19,0x40,0x2e,0x58,0x73,0x45,0x9c,0x6a,0x07,
+  0xe3,0x31,0xbc,0xc9,0xb2,0x2e,0x62,0xbf,0x42,0x9a,0x4c,0xf1,0xd7,0xd3,0x9d,0x0b,
+  0x52,0x8a,0x0e,0xa8,0x81,0xf2,0xba,0x07,0x63,0x08,0xa6,0xa9,0xd4,0x1a,0xed,0x74,
+  0x7e,0x3b,0xf3,0x20,0x81,0xc9,0xa2,0x5b,0x19,0xed,0x70,0x8e,0x0f,0x94,0xf7,0x9a,
+  0x21,0x42,0xd6,0x23,0xed,0xba,0x7d,0x77,0xc8,0x8b,0xc5,0x85,0xb7,0xac,0xda,0x0a,
+  0x50,0xd8,0xbf,0xf0,0x25,0x26,0x81,0xcb,0x6d,0x24,0x95,0xd5,0xe0,0xb2,0xf3,0xa0,
+  0xe4,0x0e,0xe1,0x50,0xac,0xab,0x7d,0x4c,0x83,0x0c,0xc7,0x15,0x4a,0x57,0xf1,0xa6,
+  0x44,0xce,0x27,0x2b,0x7e,0xd5,0xa0,0x74,0x64,0xf1,0x08,0x0e,0x5d,0xf0,0xb8,0xeb,
+  0xdd,0x2b,0x2c,0xf2,0xfb,0x7c,0xc0,0xf1,0x3d,0x3b,0x8d,0xee,0xb2,0x33,0xc8,0xef,
+  0x5d,0xf6,0x62,0xf0,0xaf,0xbe,0x98,0x54,0xa1,0x5d,0x9e,0xe6,0x30,0x7b,0xf1,0x39,
+  0xaa,0x5e,0xe1,0xc5,0x8c,0x1f,0xb9,0x52,0xdc,0x9d,0xa6,0x13,0x8d,0xec,0x1c,0xd7,
+  0xeb,0x8d,0xb4,0x78,0xc4,0xd3,0x57,0xf8,0xd0,0x15,0x6d,0x17,0xb7,0x40,0x7f,0xb0,
+  0xed,0x25,0x77,0xba,0xc5,0xdc,0xf5,0xf6,0xc6,0x6b,0xb9,0x50,0x56,0x16,0x75,0x26,
+  0x5c,0x49,0xee,0xa2,0x24,0x1f,0x00,0x2e,0x8c,0x05,0x16,0x50,0xa5,0xc7,0xc9,0x72,
+  0xff,0x79,0xf7,0x9c,0x20,0x55,0xa8,0xef,0xa8,0xf2,0xb2,0xcb,0xcb,0xe4,0xc8,0x9b,
+  0x66,0x86,0x8f,0x95,0x7f,0xc9,0xdf,0x29,0x17,0x62,0xb2,0xf6,0x3f,0x33,0xe9,0x7c,
+  0xe8,0x68,0x59,0x5c,0xa8,0xda,0xfa,0xe0,0x5a,0xdd,0x0f,0xc1,0x8b,0x89,0x90,0x34,
+  0x9c,0x2e,0x38,0x6a,0xe0,0xe6,0x74,0x2a,0xcd,0x02,0x17,0xbc,0x56,0x74,0xf5,0x5c,
+  0xe2,0xcd,0x4a,0x85,0xdc,0xce,0xdb,0x97,0x89,0x75,0x2f,0x54,0x80,0xf0,0xc3,0xd5,
+  0x37,0x38,0x5c,0x8c,0x07,0x7d,0x0d,0x4f,0x4f,0x70,0x51,0xf8,0x02,0x69,0x2c,0x09,
+  0x45,0x17,0x5b,0x67,0x3a,0x76,0x48,0x7b,0xb4,0xe1,0x08,0x8d,0xe0,0x6d,0xe6,0xd7,
+  0x08,0x0e,0x53,0x93,0x37,0xfc,0xbb,0xff,0x3e,0x24,0x7b,0x3f,0x1b,0x05,0x00,0x00,
+};
+
+/* settingsJS: 904 bytes, 321 compressed */
+static const uint8_t settingsJS_gz[] PROGMEM = {
+  0x1f,0x8b,0x08,0x00,0x00,0x00,0x00,0x00,0x02,0x03,0x95,0x90,0x4d,0x4b,0xc3,0x40,
+  0x10,0x86,0xff,0xca,0x90,0x4b,0x53,0x85,0xb8,0x22,0x78,0xb0,0x88,0x20,0x16,0x2a,
+  0xb4,0x78,0x68,0xc1,0x63,0x59,0xb3,0x63,0xb2,0x74,0x3b,0x09,0xd9,0x49,0x4b,0x90,
+  0xfe,0x77,0x37,0x49,0xd3,0xa6,0xa6,0xd6,0xb8,0x97,0x9d,0x9d,0x8f,0x77,0xde,0x67,
+  0x01,0x00,0x3e,0x73,0x0a,0x59,0x27,0x04,0xf3,0x38,0xd9,0x4e,0xb4,0xc2,0xa9,0xb6,
+  0x8c,0xf4,0x46,0xa6,0x58,0xc8,0x0f,0x83,0xbe,0xa9,0xde,0x89,0x7b,0x8f,0xa9,0x4c,
+  0xa8,0x21,0x7c,0xc1,0xfe,0x6c,0x64,0x06,0xc7,0xba,0x45,0x66,0x4d,0x91,0x85,0x47,
+  0x50,0x49,0x98,0xaf,0x91,0x38,0x88,0x90,0xc7,0x06,0xcb,0xf0,0xb9,0x78,0x55,0xbe,
+  0xd7,0xed,0xf6,0x86,0xa3,0x46,0xae,0x5b,0x0c,0x2c,0x17,0x06,0x03,0xa5,0x6d,0x6a,
+  0x64,0xe1,0x84,0x3b,0x6e,0x82,0x30,0xc6,0x70,0x85,0x0a,0x9e,0xc0,0x73,0x79,0xf4,
+  0xe0,0x61,0x1f,0x54,0xb2,0x3b,0x38,0xc7,0xf8,0x22,0x8d,0x91,0xb6,0xe6,0x53,0x55,
+  0x7c,0x9e,0xad,0xae,0xf5,0xe1,0x3a,0xed,0x6c,0x31,0x9d,0x16,0x3a,0x3c,0x27,0xdb,
+  0xdb,0x2c,0x5c,0x66,0x7a,0xc1,0xcc,0x45,0x0d,0x62,0x05,0x9e,0x85,0xb0,0xa2,0x0f,
+  0xc0,0xb1,0xab,0x65,0xfe,0x98,0xec,0x18,0x3f,0x6c,0xfb,0x9f,0xe9,0x30,0x96,0x14,
+  0xe1,0x4c,0xd3,0xbb,0x64,0xf6,0xd3,0x24,0xe3,0x1f,0x6e,0xd3,0x74,0xb5,0x8d,0x2f,
+  0x18,0x1d,0x58,0xb1,0xac,0x7a,0x96,0x83,0xeb,0x6a,0x3c,0xd8,0x48,0x93,0xe3,0xa8,
+  0xad,0xa1,0x89,0x31,0x73,0xe9,0x3f,0x64,0x9a,0xb6,0x5f,0x94,0x2e,0x8d,0xae,0x35,
+  0x6d,0x1d,0xc0,0x61,0x52,0x13,0x61,0x36,0x59,0xcc,0xa6,0x6e,0xe5,0x4c,0x72,0x1c,
+  0x64,0x49,0x4e,0xca,0xf7,0xef,0xee,0x85,0x80,0x2b,0xb8,0x15,0xee,0xba,0xa9,0xd9,
+  0x86,0x2e,0x68,0x36,0xd7,0x3f,0xbd,0xfb,0x06,0x63,0x4e,0x40,0x21,0x88,0x03,0x00,
+  0x00,
+};
+
+/* populatescanwifiJS: 1027 bytes, 448 compressed */
+static const uint8_t populatescanwifiJS_gz[] PROGMEM = {
+  0x1f,0x8b,0x08,0x00,0x00,0x00,0x00,0x00,0x02,0x03,0x95,0x53,0x5d,0x8f,0xd3,0x30,
+  0x10,0xfc,0x2b,0xab,0xbe,0xd8,0xd5,0x1d,0xa1,0x20,0x78,0x8a,0xfa,0x02,0x54,0x70,
+  0xe8,0xe0,0x24,0x52,0x09,0xde,0x4e,0x26,0xde,0x5c,0x0c,0xae,0x1d,0xec,0x75,0x8f,
+  0x0a,0xf5,0xbf,0xe3,0x8f,0x5e,0x2e,0xad,0x0a,0xd2,0x59,0xb2,0x94,0x78,0x67,0x76,
+  0x67,0xc7,0xde,0xad,0x70,0xe0,0xb0,0x73,0xe8,0xfb,0xaf,0xaa,0x53,0x4d,0x2b,0x0c,
+  0x2c,0xa1,0x0b,0xa6,0x25,0x65,0x0d,0xf0,0x39,0xfc,0x81,0x6d,0xc4,0x78,0xd4,0xd8,
+  0xd2,0xb5,0xf2,0x14,0xc3,0xd2,0xb6,0x61,0x83,0x86,0xaa,0x3b,0xa4,0x95,0xc6,0xf4,
+  0xf9,0x66,0x77,0x25,0x39,0xbb,0x8f,0x29,0x6e,0xbd,0x57,0xf2,0xb6,0xe0,0xd9,0xbc,
+  0xce,0x6c,0x87,0xbf,0x02,0x66,0xaa,0xc1,0x7b,0xf8,0xf6,0xe9,0xfa,0x03,0xd1,0xf0,
+  0xa5,0x1c,0xf2,0x88,0x39,0xc4,0x2b,0x6b,0x1c,0x0a,0xb9,0xf3,0x24,0x08,0xdb,0x5e,
+  0x98,0x3b,0x9c,0x88,0xe1,0x51,0xe4,0x60,0x8d,0xc7,0xa4,0x09,0x54,0x07,0xfc,0x81,
+  0x96,0x49,0x4d,0x22,0xc1,0x72,0xb9,0x84,0x57,0x19,0x70,0x84,0x48,0x19,0x83,0xcf,
+  0xd1,0x97,0x8b,0x45,0x89,0xc7,0x95,0xb4,0xfd,0xf0,0xd6,0xdc,0x0c,0xa9,0x40,0x8c,
+  0xc3,0xc7,0xe6,0xe6,0x73,0x35,0x08,0xe7,0x71,0x92,0xbd,0x94,0x5d,0xe3,0x6f,0x8a,
+  0x5a,0xf3,0x7a,0x82,0x03,0x95,0x32,0x06,0x5d,0x22,0xa7,0xf6,0x83,0xd6,0xf5,0x63,
+  0x6d,0x89,0x9d,0x08,0x9a,0x6c,0x2e,0x3f,0x35,0xb6,0x8d,0x2d,0x11,0x1e,0x32,0x73,
+  0x56,0x00,0x6c,0xac,0x3e,0xa5,0x55,0x5b,0xa1,0x43,0xf2,0x89,0xb1,0xb3,0x61,0x2a,
+  0x95,0x59,0x93,0xf5,0x40,0xd3,0x5c,0xbd,0x3b,0x0f,0x2c,0x82,0x51,0x46,0x30,0xb9,
+  0x80,0x67,0x31,0xbd,0x92,0x12,0xcd,0x31,0xe2,0xf1,0x69,0x54,0x62,0x18,0xd0,0xc8,
+  0xb7,0xbd,0xd2,0x92,0x1f,0x11,0x1f,0x94,0x4f,0xcc,0xae,0x3a,0xeb,0x56,0xa2,0xed,
+  0xf9,0x78,0xbf,0x8a,0x70,0x33,0x5e,0x4d,0x31,0xe8,0xa9,0xce,0x00,0x9c,0x98,0x92,
+  0x72,0x56,0xe9,0x3e,0x4e,0x01,0x07,0x5b,0xc6,0x38,0x5c,0xc0,0x0c,0x9e,0xc5,0x7d,
+  0x51,0xce,0x5c,0x3c,0x1c,0x39,0xff,0x68,0xf1,0xb8,0xb7,0xfd,0x28,0x62,0x02,0xf7,
+  0xb4,0xd3,0x58,0x49,0xe5,0x07,0x2d,0x76,0xb1,0xde,0xec,0xbb,0xb6,0xed,0xcf,0x59,
+  0x41,0xee,0xeb,0xbc,0xf7,0x93,0x01,0x88,0xc9,0x39,0x7b,0xbf,0x5a,0xb3,0x4b,0x60,
+  0xcf,0xd3,0x63,0xf2,0x71,0x22,0xe3,0x4f,0xf2,0x7b,0x32,0x28,0x3e,0x6a,0x48,0x83,
+  0xe3,0x91,0xd6,0x6a,0x83,0x36,0x10,0x3f,0x99,0xe2,0xcb,0x17,0x8b,0xb8,0xe6,0xf5,
+  0xbe,0xfe,0x0f,0xe6,0x75,0x42,0xfc,0x05,0xed,0xec,0x5f,0x69,0x03,0x04,0x00,0x00,
+};
+
+/* populategetsettingsJS: 1779 bytes, 598 compressed */
+static const uint8_t populategetsettingsJS_gz[] PROGMEM = {
+  0x1f,0x8b,0x08,0x00,0x00,0x00,0x00,0x00,0x02,0x03,0xad,0x55,0xef,0x6f,0xda,0x30,
+  0x10,0xfd,0x57,0x4e,0xf9,0x50,0x82,0xda,0x65,0xa1,0xda,0xb7,0x8c,0x4a,0xab,0x56,
+  0xad,0x9b,0xda,0x22,0x0d,0xa4,0x4d,0xaa,0xaa,0xca,0x24,0x07,0x78,0x18,0x3b,0xb3,
+  0x1d,0x48,0x54,0xf1,0xbf,0xef,0x9c,0x34,0x10,0x7e,0x29,0x9d,0x36,0x3e,0x04,0x3b,
+  0xbe,0x7b,0xef,0xdd,0xf3,0xc5,0x5e,0x32,0x0d,0x53,0xb4,0x43,0xb4,0x96,0xcb,0xa9,
+  0x81,0x3e,0x4c,0x32,0x19,0x5b,0xae,0xa4,0xdf,0x85,0x17,0x80,0x25,0xad,0x6b,0xfc,
+  0x9d,0xa1,0xb1,0xb4,0x26,0x71,0x05,0x3f,0xef,0xef,0x6e,0xad,0x4d,0xbf,0x57,0x2f,
+  0xfd,0x6e,0x04,0x75,0x40,0xa0,0xa4,0x46,0x96,0x14,0xc6,0x32,0x8b,0xf1,0x8c,0xc9,
+  0x29,0x36,0xf1,0x34,0x9a,0x54,0x49,0x83,0x25,0x2e,0x00,0x9f,0xf8,0x75,0x5e,0x99,
+  0x35,0x74,0x59,0xd0,0xef,0xf7,0xe1,0xc3,0x6b,0xc4,0x4e,0x8c,0x03,0xcd,0x4c,0xb9,
+  0x7e,0x19,0x86,0x9b,0x88,0x4a,0xe1,0x2f,0xa3,0xe4,0x20,0x75,0x2c,0xae,0x82,0x6f,
+  0xc3,0xc1,0x43,0x90,0x32,0x6d,0xb0,0xc1,0x50,0x71,0x8f,0x30,0xb7,0x4e,0x71,0xf5,
+  0x9b,0x28,0xed,0xbb,0xf4,0x39,0x16,0xc0,0x65,0x13,0xa5,0x81,0x5f,0x31,0xa0,0x20,
+  0xe0,0x44,0xc5,0xd9,0x02,0xa5,0x0d,0xc8,0xb1,0x1b,0x81,0x6e,0x68,0xae,0x8b,0x07,
+  0xb6,0x40,0x9f,0x20,0xb6,0xb8,0xa5,0x70,0x14,0x81,0x40,0x39,0xb5,0x33,0xb8,0x82,
+  0x70,0x07,0xaf,0x5c,0xfe,0xa4,0x35,0x2b,0x7c,0xcf,0x92,0x20,0xef,0x02,0x3c,0x99,
+  0x2d,0xc6,0xa8,0xdd,0x28,0x65,0xc6,0xac,0x94,0x4e,0xbc,0x6e,0xc0,0x65,0x82,0xf9,
+  0xc0,0x41,0x3d,0x86,0x4f,0x81,0x2d,0x52,0xf2,0xee,0x0a,0xde,0xf5,0xf6,0xd0,0x00,
+  0xaa,0x80,0x25,0x13,0x99,0x73,0xbc,0x51,0xc7,0x23,0xe9,0x7a,0x8a,0x9a,0xa1,0xeb,
+  0x68,0x4f,0xc8,0x16,0x9c,0xcc,0x05,0x2f,0x9e,0x61,0x3c,0x1f,0xab,0xdc,0x83,0xb3,
+  0xb3,0x03,0x24,0x17,0x71,0x8a,0xbd,0x4c,0xc4,0x84,0xf8,0xad,0xce,0x30,0xda,0x0d,
+  0x21,0x1e,0xca,0xdf,0x14,0xe4,0x09,0x6e,0x2c,0x4a,0x25,0x45,0xe1,0x9d,0x28,0x09,
+  0x60,0x38,0x53,0xab,0x5b,0x9e,0xe0,0x5d,0x19,0x3b,0xa0,0xd8,0x11,0x1b,0x0b,0xac,
+  0x04,0x77,0xf7,0x08,0xd6,0x2d,0x84,0xbd,0x15,0xd7,0xd8,0xce,0xf5,0x99,0x09,0xc1,
+  0xcc,0x3f,0xf0,0x98,0xb0,0x9d,0x64,0x18,0xbe,0x99,0xa0,0x6d,0xb7,0x34,0x4b,0xb8,
+  0xf2,0x0e,0xb8,0xea,0xc6,0xce,0x69,0x37,0xc2,0x88,0xfe,0x3e,0xc2,0xa6,0x1d,0x69,
+  0x7a,0x7e,0x7e,0x44,0x5d,0x05,0x9e,0x6f,0xda,0xe8,0xb0,0x8f,0x8e,0x24,0x95,0x9b,
+  0x9f,0xb7,0x6c,0xfe,0xa1,0x6b,0x6f,0x2e,0xb2,0x61,0x2c,0x0a,0x8c,0xed,0x29,0x73,
+  0x5d,0xb1,0xf1,0x8c,0x8b,0x44,0xa3,0x24,0x11,0x75,0x47,0xd2,0x8b,0x07,0x95,0xa0,
+  0x89,0x5a,0xed,0xa9,0x93,0xdb,0x4d,0xaa,0x23,0xff,0xde,0xaa,0x66,0x66,0x55,0xce,
+  0xff,0x70,0x6c,0x3b,0xde,0x8e,0x8e,0x1c,0x54,0xd7,0xc5,0xd7,0x84,0xbe,0x3b,0x45,
+  0x0d,0x23,0xa7,0xcf,0xe6,0xf5,0xbc,0xa7,0x43,0xc6,0xd8,0x42,0x60,0x90,0x70,0x93,
+  0x0a,0x56,0x90,0x1c,0x8f,0x3e,0x4b,0xf4,0xda,0xa1,0x6a,0x88,0x67,0x72,0x73,0x71,
+  0x0c,0x67,0x2c,0x54,0x3c,0xdf,0x02,0x55,0x17,0xc2,0x3d,0x97,0x3f,0x98,0xb5,0x7e,
+  0xaf,0x7b,0x62,0xe1,0xb2,0x5e,0xa8,0xaa,0x71,0xcf,0x75,0xf3,0x8a,0x49,0x51,0xfa,
+  0x9d,0x2f,0x37,0xa3,0xce,0x05,0x74,0xde,0x93,0xa6,0x5a,0x06,0xcd,0x9d,0x91,0xcd,
+  0xeb,0xc8,0xa0,0x4c,0xe8,0x7e,0x5a,0x47,0x8d,0x0b,0x8e,0xe6,0x7f,0x00,0x8f,0x0e,
+  0xaf,0x52,0xf3,0x06,0x00,0x00,
+};
+
+#endif
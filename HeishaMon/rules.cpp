@@ -18,13 +18,18 @@
 #include "src/common/strnicmp.h"
 #include "src/common/log.h"
 #include "src/common/timerqueue.h"
+#include "src/common/symtab.h"
+#include "src/common/strpool.h"
+#include "src/common/rollstat.h"
 #include "src/rules/rules.h"
+#include "src/rules/function.h"
 
 #include "dallas.h"
 #include "webfunctions.h"
 #include "decode.h"
 #include "HeishaOT.h"
 #include "commands.h"
+#include "rules.h"
 
 #define MAXCOMMANDSINBUFFER 10
 #define OPTDATASIZE 20
@@ -40,10 +45,20 @@ extern char actDataExtra[DATASIZE];
 extern String openTherm[2];
 static uint8_t parsing = 0;
 
+/*
+ * The string pool is emptied after each
+ * rule run, so variables holding a string
+ * keep their own copy.
+ */
+typedef struct vm_lvchar_t {
+  VM_GENERIC_FIELDS
+  char *value;
+} __attribute__((packed)) vm_lvchar_t;
+
 typedef struct vm_gvchar_t {
   VM_GENERIC_FIELDS
   uint8_t rule;
-  char value[];
+  char *value;
 } __attribute__((packed)) vm_gvchar_t;
 
 typedef struct vm_gvnull_t {
@@ -66,22 +81,167 @@ typedef struct vm_gvfloat_t {
 static struct rules_t **rules = NULL;
 static int nrrules = 0;
 
+/*
+ * When capacity is set the stack lives in
+ * the mempool instead of on the heap.
+ */
 typedef struct varstack_t {
   unsigned int nrbytes;
   unsigned int bufsize;
+  unsigned int capacity;
+  unsigned int nrvars;
   unsigned char *stack;
 } varstack_t;
 
 static struct varstack_t global_varstack;
 
+/*
+ * Values of the global variables kept
+ * while a new ruleset is parsed.
+ */
+typedef struct rules_global_t {
+  char *name;
+  uint8_t type;
+  union {
+    int i;
+    float f;
+    char *s;
+  } value;
+} rules_global_t;
+
+static struct rules_global_t *saved_globals = NULL;
+static int nrsaved = 0;
+
+static struct timerqueue_t *saved_timers = NULL;
+static int nrtimers = 0;
+
+/*
+ * Bytes of the mempool taken by the
+ * bytecode and the local variables.
+ */
+static unsigned int bytecode_pool = 0;
+static unsigned int varstack_pool = 0;
+
+/*
+ * One entry per loaded rule, grown
+ * while the ruleset is parsed.
+ */
+static struct rules_stats_t *rules_stats = NULL;
+static int nrstats = 0;
+
+static uint8_t trace_level = RULES_TRACE_OFF;
+
+/*
+ * Only one rule run can be suspended at a
+ * time. Rules triggered meanwhile are
+ * deferred until that run has completed.
+ * Rules are indexed by an uint8_t, so one
+ * bit per possible rule.
+ */
+#define RULES_DEFERRED_MAX 256
+
+static int8_t suspended = -1;
+static uint32_t suspended_time = 0;
+static uint8_t deferred[RULES_DEFERRED_MAX / 8];
+static uint16_t nrdeferred = 0;
+
+/*
+ * Rules that are fully traced regardless
+ * of the trace level, kept across reloads.
+ */
+static uint8_t trace_rules[RULES_DEFERRED_MAX / 8];
+
+/*
+ * Rules triggered while a frame is decoded,
+ * run once the whole frame was processed.
+ */
+static uint8_t batching = 0;
+static uint8_t pending[RULES_DEFERRED_MAX / 8];
+static uint16_t nrpending = 0;
+
+static void rules_defer(int nr) {
+  if(nr < 0 || nr >= RULES_DEFERRED_MAX) {
+    logprintf_P(F("rules: cannot defer rule #%d"), nr);
+    return;
+  }
+  if((deferred[nr >> 3] & (1 << (nr & 7))) == 0) {
+    deferred[nr >> 3] |= (1 << (nr & 7));
+    nrdeferred++;
+  }
+}
+
+static int rules_pending(int nr) {
+  if(nr < 0 || nr >= RULES_DEFERRED_MAX) {
+    logprintf_P(F("rules: cannot batch rule #%d"), nr);
+    return -1;
+  }
+  if((pending[nr >> 3] & (1 << (nr & 7))) == 0) {
+    pending[nr >> 3] |= (1 << (nr & 7));
+    nrpending++;
+  }
+  return 0;
+}
+
+/*
+ * Heatpump commands assigned during a rule
+ * run. A later assignment to the same command
+ * replaces the earlier value.
+ */
+#define RULES_COMMANDS_MAX (sizeof(commands) / sizeof(commands[0]))
+
+typedef struct rules_command_t {
+  uint8_t id;
+  char *payload;
+} rules_command_t;
+
+static struct rules_command_t rules_commands[RULES_COMMANDS_MAX];
+static uint8_t nrcommands = 0;
+
+/*
+ * Upper bound in microseconds of each
+ * histogram bucket, the last bucket
+ * takes everything above.
+ */
+static const uint16_t rules_stats_bounds[RULES_STATS_BUCKETS-1] PROGMEM = {
+  100, 250, 500, 1000, 2500, 5000, 10000
+};
+
+/*
+ * All names a rule can refer to are kept in one
+ * hash index. The kind of name is stored in the
+ * upper bits of the id, its position in the
+ * source table in the lower bits.
+ */
+#define RULES_SYMBOLS_SIZE 512
+
+#define SYM_COMMAND     1
+#define SYM_OPTCOMMAND  2
+#define SYM_TOPIC       3
+#define SYM_OPTTOPIC    4
+#define SYM_XTOPIC      5
+#define SYM_OT          6
+
+#define SYM_ID(kind, idx) (((kind) << 12) | (idx))
+#define SYM_KIND(id)      ((id) >> 12)
+#define SYM_INDEX(id)     ((id) & 0x0FFF)
+#define SYM_MASK(kind)    (1 << (kind))
+
+#define SYM_VARIABLES (SYM_MASK(SYM_COMMAND) | SYM_MASK(SYM_OPTCOMMAND) | SYM_MASK(SYM_TOPIC) | SYM_MASK(SYM_OPTTOPIC) | SYM_MASK(SYM_XTOPIC))
+
+static uint16_t rules_symbols_slots[RULES_SYMBOLS_SIZE];
+static struct symtab_t rules_symbols = { rules_symbols_slots, RULES_SYMBOLS_SIZE };
+
 static struct vm_vinteger_t vinteger;
 static struct vm_vfloat_t vfloat;
 static struct vm_vnull_t vnull;
+static struct vm_vchar_t vchar;
 
 struct rule_options_t rule_options;
 unsigned char *mempool = (unsigned char *)MMU_SEC_HEAP;
 unsigned int memptr = 0;
 
+static void vm_value_prt(struct rules_t *obj, char *out, int size);
+static void rules_globals_restore(struct rules_t *obj, uint16_t token);
 static void vm_global_value_prt(char *out, int size);
 
 // static int readRuleFromFS(int i) {
@@ -117,6 +277,73 @@ static void vm_global_value_prt(char *out, int size);
   // return 0;
 // }
 
+static void rules_symbols_build(void) {
+  unsigned int x = 0;
+
+  memset(rules_symbols_slots, 0, sizeof(rules_symbols_slots));
+
+  for(x=0;x<sizeof(commands)/sizeof(commands[0]);x++) {
+    symtab_insert(&rules_symbols, symtab_hash_P(commands[x].name), SYM_ID(SYM_COMMAND, x));
+  }
+  for(x=0;x<sizeof(optionalCommands)/sizeof(optionalCommands[0]);x++) {
+    symtab_insert(&rules_symbols, symtab_hash_P(optionalCommands[x].name), SYM_ID(SYM_OPTCOMMAND, x));
+  }
+  for(x=0;x<sizeof(topics)/sizeof(topics[0]);x++) {
+    symtab_insert(&rules_symbols, symtab_hash_P(topics[x]), SYM_ID(SYM_TOPIC, x));
+  }
+  for(x=0;x<sizeof(optTopics)/sizeof(optTopics[0]);x++) {
+    symtab_insert(&rules_symbols, symtab_hash_P(optTopics[x]), SYM_ID(SYM_OPTTOPIC, x));
+  }
+  for(x=0;x<sizeof(xtopics)/sizeof(xtopics[0]);x++) {
+    symtab_insert(&rules_symbols, symtab_hash_P(xtopics[x]), SYM_ID(SYM_XTOPIC, x));
+  }
+  for(x=0;heishaOTDataStruct[x].name != NULL;x++) {
+    symtab_insert(&rules_symbols, symtab_hash(heishaOTDataStruct[x].name, strlen(heishaOTDataStruct[x].name)), SYM_ID(SYM_OT, x));
+  }
+}
+
+/*
+ * Look up a name of one of the kinds in the
+ * mask, returns its symbol id or -1.
+ */
+static int rules_symbol_find(const char *text, unsigned int len, uint8_t kinds) {
+  uint16_t hash = symtab_hash(text, len), probe = 0, id = 0;
+  char name[MAX_TOPIC_LEN];
+
+  while((id = symtab_next(&rules_symbols, hash, &probe)) > 0) {
+    if((SYM_MASK(SYM_KIND(id)) & kinds) == 0) {
+      continue;
+    }
+    switch(SYM_KIND(id)) {
+      case SYM_COMMAND: {
+        strncpy_P(name, commands[SYM_INDEX(id)].name, sizeof(name));
+      } break;
+      case SYM_OPTCOMMAND: {
+        strncpy_P(name, optionalCommands[SYM_INDEX(id)].name, sizeof(name));
+      } break;
+      case SYM_TOPIC: {
+        strncpy_P(name, topics[SYM_INDEX(id)], sizeof(name));
+      } break;
+      case SYM_OPTTOPIC: {
+        strncpy_P(name, optTopics[SYM_INDEX(id)], sizeof(name));
+      } break;
+      case SYM_XTOPIC: {
+        strncpy_P(name, xtopics[SYM_INDEX(id)], sizeof(name));
+      } break;
+      case SYM_OT: {
+        strncpy(name, heishaOTDataStruct[SYM_INDEX(id)].name, sizeof(name));
+      } break;
+    }
+    name[sizeof(name)-1] = '\0';
+
+    if(strlen(name) == len && strnicmp(text, name, len) == 0) {
+      return id;
+    }
+  }
+
+  return -1;
+}
+
 static int get_event(struct rules_t *obj) {
   struct vm_tstart_t *start = (struct vm_tstart_t *)&obj->ast.buffer[0];
   if(obj->ast.buffer[start->go] != TEVENT) {
@@ -127,7 +354,7 @@ static int get_event(struct rules_t *obj) {
 }
 
 static int is_variable(char *text, unsigned int *pos, unsigned int size) {
-  int i = 1, x = 0, match = 0;
+  int i = 1;
 
   if(size == strlen_P(PSTR("ds18b20#2800000000000000")) && strncmp_P((const char *)&text[*pos], PSTR("ds18b20#"), 8) == 0) {
     return 24;
@@ -152,86 +379,16 @@ static int is_variable(char *text, unsigned int *pos, unsigned int size) {
     }
 
     if(text[*pos] == '@') {
-      int nrcommands = sizeof(commands)/sizeof(commands[0]);
-      for(x=0;x<nrcommands;x++) {
-        cmdStruct cmd;
-        memcpy_P(&cmd, &commands[x], sizeof(cmd));
-        size_t len = strlen(cmd.name);
-        if(size-1 == len && strnicmp(&text[(*pos)+1], cmd.name, len) == 0) {
-          i = len+1;
-          match = 1;
-          break;
-        }
-      }
-
-      int nroptcommands = sizeof(optionalCommands)/sizeof(optionalCommands[0]);
-      for(x=0;x<nroptcommands;x++) {
-        optCmdStruct cmd;
-        memcpy_P(&cmd, &optionalCommands[x], sizeof(cmd));
-        size_t len = strlen(cmd.name);
-        if(size-1 == len && strnicmp(&text[(*pos)+1], cmd.name, len) == 0) {
-          i = len+1;
-          match = 1;
-          break;
-        }
-      }
-      if(match == 0) {
-        int nrtopics = sizeof(topics)/sizeof(topics[0]);
-        for(x=0;x<nrtopics;x++) {
-          char cpy[MAX_TOPIC_LEN];
-          memcpy_P(&cpy, topics[x], MAX_TOPIC_LEN);
-          size_t len = strlen(cpy);
-          if(size-1 == len && strnicmp(&text[(*pos)+1], cpy, len) == 0) {
-            i = len+1;
-            match = 1;
-            break;
-          }
-        }
-      }
-      if(match == 0) {
-        int nrtopics = sizeof(optTopics)/sizeof(optTopics[0]);
-        for(x=0;x<nrtopics;x++) {
-          char cpy[MAX_TOPIC_LEN];
-          memcpy_P(&cpy, optTopics[x], MAX_TOPIC_LEN);
-          size_t len = strlen(cpy);
-          if(size-1 == len && strnicmp(&text[(*pos)+1], cpy, len) == 0) {
-            i = len+1;
-            match = 1;
-            break;
-          }
-        }
-      }
-      if(match == 0) {
-        int nrtopics = sizeof(xtopics)/sizeof(xtopics[0]);
-        for(x=0;x<nrtopics;x++) {
-          char cpy[MAX_TOPIC_LEN];
-          memcpy_P(&cpy, xtopics[x], MAX_TOPIC_LEN);
-          size_t len = strlen(cpy);
-          if(size-1 == len && strnicmp(&text[(*pos)+1], cpy, len) == 0) {
-            i = len+1;
-            match = 1;
-            break;
-          }
-        }
-      }
-      if(match == 0) {
+      if(rules_symbol_find(&text[(*pos)+1], size-1, SYM_VARIABLES) == -1) {
         return -1;
       }
+      i = size;
     }
     if(text[*pos] == '?') {
-      int x = 0;
-      while(heishaOTDataStruct[x].name != NULL) {
-        size_t len = strlen(heishaOTDataStruct[x].name);
-        if(size-1 == len && strnicmp(&text[(*pos)+1], heishaOTDataStruct[x].name, len) == 0) {
-          i = len+1;
-          match = 1;
-          break;
-        }
-        x++;
-      }
-      if(match == 0) {
+      if(rules_symbol_find(&text[(*pos)+1], size-1, SYM_MASK(SYM_OT)) == -1) {
         return -1;
       }
+      i = size;
     }
 
     return i;
@@ -240,101 +397,267 @@ static int is_variable(char *text, unsigned int *pos, unsigned int size) {
 }
 
 static int is_event(char *text, unsigned int *pos, unsigned int size) {
-  int i = 1, x = 0, match = 0;
   if(text[*pos] == '@') {
-    int nrcommands = sizeof(commands)/sizeof(commands[0]);
-    for(x=0;x<nrcommands;x++) {
-      cmdStruct cmd;
-      memcpy_P(&cmd, &commands[x], sizeof(cmd));
-      size_t len = strlen(cmd.name);
-      if(size-1 == len && strnicmp(&text[(*pos)+1], cmd.name, len) == 0) {
-        i = len+1;
-        match = 1;
-        break;
-      }
+    if(rules_symbol_find(&text[(*pos)+1], size-1, SYM_VARIABLES) == -1) {
+      return -1;
     }
+    return size;
+  }
 
-    if(match == 0) {
-      int nroptcommands = sizeof(optionalCommands)/sizeof(optionalCommands[0]);
-      for(x=0;x<nroptcommands;x++) {
-        optCmdStruct cmd;
-        memcpy_P(&cmd, &optionalCommands[x], sizeof(cmd));
-        size_t len = strlen(cmd.name);
-        if(size-1 == len && strnicmp(&text[(*pos)+1], cmd.name, len) == 0) {
-          i = len+1;
-          match = 1;
-          break;
-        }
-      }
+  if(text[*pos] == '?') {
+    if(rules_symbol_find(&text[(*pos)+1], size-1, SYM_MASK(SYM_OT)) == -1) {
+      return -1;
     }
-    if(match == 0) {
-      int nrtopics = sizeof(topics)/sizeof(topics[0]);
-      for(x=0;x<nrtopics;x++) {
-        size_t len = strlen_P(topics[x]);
-        char cpy[len];
-        memcpy_P(&cpy, &topics[x], len);
-        if(size-1 == len && strnicmp(&text[(*pos)+1], cpy, len) == 0) {
-          i = len+1;
-          match = 1;
-          break;
-        }
-      }
+    return size;
+  }
+
+  if(size == strlen_P(PSTR("ds18b20#2800000000000000")) && strncmp_P((const char *)&text[*pos], PSTR("ds18b20#"), 8) == 0) {
+    return 24;
+  }
+
+  return size;
+}
+
+/*
+ * Without memory the rules still run,
+ * only their statistics are missing.
+ */
+static void rules_stats_add(int nr, unsigned long parse) {
+  struct rules_stats_t *tmp = NULL;
+
+  if(nr != nrstats + 1) {
+    return;
+  }
+  if((tmp = (struct rules_stats_t *)REALLOC(rules_stats, sizeof(struct rules_stats_t)*nr)) == NULL) {
+    logprintf_P(F("rules: no statistics for rule #%d"), nr);
+    return;
+  }
+  rules_stats = tmp;
+  memset(&rules_stats[nrstats], 0, sizeof(struct rules_stats_t));
+  rules_stats[nrstats].parse = parse;
+  nrstats++;
+}
+
+static void rules_stats_trigger(int nr, uint8_t trigger) {
+  if(nr < 0 || nr >= nrstats) {
+    return;
+  }
+  rules_stats[nr].triggers[trigger]++;
+}
+
+/*
+ * Only top level runs are timed, rules
+ * called from another rule are accounted
+ * in the time of their caller.
+ */
+static void rules_stats_update(int nr, unsigned long elapsed) {
+  struct rules_stats_t *stats = NULL;
+  struct varstack_t *varstack = NULL;
+  uint8_t x = 0;
+
+  if(nr < 0 || nr >= nrstats) {
+    return;
+  }
+
+  stats = &rules_stats[nr];
+  if(stats->invocations == 0 || elapsed < stats->min) {
+    stats->min = elapsed;
+  }
+  if(elapsed > stats->max) {
+    stats->max = elapsed;
+  }
+  stats->invocations++;
+  stats->total += elapsed;
+
+  for(x=0;x<RULES_STATS_BUCKETS-1;x++) {
+    if(elapsed < pgm_read_word(&rules_stats_bounds[x])) {
+      break;
     }
-    if(match == 0) {
-      int nrtopics = sizeof(optTopics)/sizeof(optTopics[0]);
-      for(x=0;x<nrtopics;x++) {
-        size_t len = strlen_P(optTopics[x]);
-        char cpy[len];
-        memcpy_P(&cpy, &optTopics[x], len);
-        if(size-1 == len && strnicmp(&text[(*pos)+1], cpy, len) == 0) {
-          i = len+1;
-          match = 1;
-          break;
-        }
-      }
+  }
+  if(stats->histogram[x] < 0xFFFF) {
+    stats->histogram[x]++;
+  }
+
+  varstack = (struct varstack_t *)rules[nr]->userdata;
+  if(varstack != NULL && varstack->nrbytes > stats->stack) {
+    stats->stack = varstack->nrbytes;
+  }
+}
+
+int rules_count(void) {
+  return nrrules;
+}
+
+/*
+ * Bytes of the global variables
+ * last assigned by a rule.
+ */
+static unsigned int rules_globals_size(uint8_t nr) {
+  struct vm_gvnull_t *val = NULL;
+  unsigned int x = 0, len = 0, bytes = 0;
+
+  for(x=4;alignedbytes(x)<global_varstack.nrbytes;x++) {
+    x = alignedbytes(x);
+    val = (struct vm_gvnull_t *)&global_varstack.stack[x];
+    switch(val->type) {
+      case VINTEGER: {
+        len = sizeof(struct vm_gvinteger_t);
+      } break;
+      case VFLOAT: {
+        len = sizeof(struct vm_gvfloat_t);
+      } break;
+      case VNULL: {
+        len = sizeof(struct vm_gvnull_t);
+      } break;
+      case VCHAR: {
+        len = sizeof(struct vm_gvchar_t);
+      } break;
+      default: {
+        return bytes;
+      } break;
     }
-    if(match == 0) {
-      int nrtopics = sizeof(xtopics)/sizeof(xtopics[0]);
-      for(x=0;x<nrtopics;x++) {
-        size_t len = strlen_P(xtopics[x]);
-        char cpy[len];
-        memcpy_P(&cpy, &xtopics[x], len);
-        if(size-1 == len && strnicmp(&text[(*pos)+1], cpy, len) == 0) {
-          i = len+1;
-          match = 1;
-          break;
-        }
+    if(val->rule == nr) {
+      bytes += alignedbytes(len);
+      if(val->type == VCHAR) {
+        bytes += strlen(((struct vm_gvchar_t *)val)->value)+1;
       }
     }
-    if(match == 0) {
-      return -1;
+    x += len-1;
+  }
+  return bytes;
+}
+
+int rules_memory_json(char *out, int size) {
+  struct varstack_t *varstack = NULL;
+  unsigned int heap = global_varstack.bufsize;
+  int i = 0, pos = 0;
+
+  for(i=0;i<nrrules;i++) {
+    varstack = (struct varstack_t *)rules[i]->userdata;
+    if(varstack->capacity == 0 && varstack->stack != NULL) {
+      heap += varstack->bufsize;
     }
+  }
 
-    return i;
+  pos = snprintf_P(out, size,
+    PSTR("{\"size\":%u,\"bytecode\":%u,\"rollstat\":%u,\"locals\":%u,\"strings\":%u,\"heap\":%u}"),
+    (unsigned int)MEMPOOL_SIZE, bytecode_pool, rollstat_used(), varstack_pool, rule_strings.size, heap
+  );
+  if(pos >= size) {
+    return -1;
   }
+  return pos;
+}
 
-  if(text[*pos] == '?') {
-    int x = 0;
-    while(heishaOTDataStruct[x].name != NULL) {
-      size_t len = strlen(heishaOTDataStruct[x].name);
-      if(size-1 == len && strnicmp(&text[(*pos)+1], heishaOTDataStruct[x].name, len) == 0) {
-        i = len+1;
-        match = 1;
-        break;
-      }
-      x++;
-    }
-    if(match == 0) {
-      return -1;
+int rules_stats_json(int nr, char *out, int size) {
+  struct rules_stats_t *stats = NULL;
+  struct varstack_t *varstack = NULL;
+  const char *event = "";
+  int pos = 0, x = 0;
+
+  if(nr < 0 || nr >= nrrules || nr >= nrstats) {
+    return -1;
+  }
+
+  stats = &rules_stats[nr];
+  if(get_event(rules[nr]) > -1) {
+    event = (char *)&rules[nr]->ast.buffer[get_event(rules[nr])+5];
+  }
+
+  pos += snprintf_P(&out[pos], size-pos,
+    PSTR("{\"rule\":%d,\"event\":\"%s\",\"invocations\":%lu,\"total\":%lu,\"min\":%lu,\"max\":%lu,\"avg\":%lu,\"stack\":%u,\"preempted\":%u,\"parse\":%lu,\"histogram\":["),
+    rules[nr]->nr, event, (unsigned long)stats->invocations, (unsigned long)stats->total,
+    (unsigned long)stats->min, (unsigned long)stats->max,
+    (unsigned long)(stats->invocations > 0 ? stats->total / stats->invocations : 0),
+    stats->stack, stats->preempted, (unsigned long)stats->parse
+  );
+  for(x=0;x<RULES_STATS_BUCKETS && pos < size;x++) {
+    pos += snprintf_P(&out[pos], size-pos, PSTR("%s%u"), (x > 0) ? "," : "", stats->histogram[x]);
+  }
+  if(pos < size) {
+    pos += snprintf_P(&out[pos], size-pos,
+      PSTR("],\"triggers\":{\"event\":%u,\"timer\":%u,\"boot\":%u,\"call\":%u}"),
+      stats->triggers[RULES_TRIGGER_EVENT], stats->triggers[RULES_TRIGGER_TIMER],
+      stats->triggers[RULES_TRIGGER_BOOT], stats->triggers[RULES_TRIGGER_CALL]
+    );
+  }
+  if(pos < size) {
+    varstack = (struct varstack_t *)rules[nr]->userdata;
+    pos += snprintf_P(&out[pos], size-pos,
+      PSTR(",\"memory\":{\"offset\":%u,\"ast\":%u,\"eval\":%u,\"locals\":%u,\"pooled\":%u,\"globals\":%u}}"),
+      (unsigned int)(rules[nr]->ast.buffer - mempool), rules[nr]->ast.bufsize, rules[nr]->varstack.bufsize,
+      (varstack->capacity > 0) ? varstack->capacity : varstack->bufsize, (varstack->capacity > 0),
+      rules_globals_size(rules[nr]->nr)
+    );
+  }
+  if(pos >= size) {
+    return -1;
+  }
+  return pos;
+}
+
+void rules_stats_summary(unsigned long *invocations, unsigned long *total, int *slowest, unsigned long *preempted) {
+  uint32_t max = 0;
+  int i = 0;
+
+  *invocations = 0;
+  *total = 0;
+  *slowest = -1;
+  *preempted = 0;
+
+  for(i=0;i<nrrules && i<nrstats;i++) {
+    *invocations += rules_stats[i].invocations;
+    *total += rules_stats[i].total;
+    *preempted += rules_stats[i].preempted;
+    if(rules_stats[i].invocations > 0 && rules_stats[i].max >= max) {
+      max = rules_stats[i].max;
+      *slowest = rules[i]->nr;
     }
-    return i;
   }
+}
 
-  if(size == strlen_P(PSTR("ds18b20#2800000000000000")) && strncmp_P((const char *)&text[*pos], PSTR("ds18b20#"), 8) == 0) {
-    return 24;
+void rules_max_steps(unsigned int steps) {
+  rule_options.max_steps = steps;
+}
+
+void rules_trace_level(uint8_t level) {
+  if(level > RULES_TRACE_FULL) {
+    level = RULES_TRACE_FULL;
   }
+  trace_level = level;
+}
 
-  return size;
+int rules_trace_toggle(int nr) {
+  if(nr < 1 || nr > RULES_DEFERRED_MAX) {
+    return -1;
+  }
+  nr--;
+  trace_rules[nr >> 3] ^= (1 << (nr & 7));
+  return (trace_rules[nr >> 3] >> (nr & 7)) & 1;
+}
+
+/*
+ * A rule with its trace flag set is always
+ * fully traced, all others follow the
+ * global trace level.
+ */
+static uint8_t rules_trace_get(int nr) {
+  if(nr >= 0 && nr < RULES_DEFERRED_MAX && (trace_rules[nr >> 3] >> (nr & 7)) & 1) {
+    return RULES_TRACE_FULL;
+  }
+  return trace_level;
+}
+
+static void rules_trace_values(int nr) {
+  char out[512];
+  logprintln_P(F("\n>>> local variables"));
+  memset(&out, 0, sizeof(out));
+  vm_value_prt(rules[nr], (char *)&out, sizeof(out));
+  logprintln(out);
+  logprintln_P(F(">>> global variables"));
+  memset(&out, 0, sizeof(out));
+  vm_global_value_prt((char *)&out, sizeof(out));
+  logprintln(out);
 }
 
 static int event_cb(struct rules_t *obj, char *name) {
@@ -346,7 +669,7 @@ static int event_cb(struct rules_t *obj, char *name) {
 
     obj->caller = 0;
 
-    return rule_run(called, 0);
+    return rule_run(called);
   } else {
     for(x=0;x<nrrules;x++) {
       if(get_event(rules[x]) > -1) {
@@ -361,15 +684,40 @@ static int event_cb(struct rules_t *obj, char *name) {
     }
 
     if(called != NULL) {
+      if(parsing == 0) {
+        rules_stats_trigger(x, RULES_TRIGGER_CALL);
+      }
       called->caller = obj->nr;
 
-      return rule_run(called, 0);
+      return rule_run(called);
     } else {
-      return rule_run(obj, 0);
+      return rule_run(obj);
     }
   }
 }
 
+/*
+ * A stack in the mempool can't grow beyond its
+ * capacity, it's moved back to the heap
+ * when it needs more room.
+ */
+static unsigned char *vm_varstack_resize(struct varstack_t *varstack, unsigned int size) {
+  unsigned char *stack = NULL;
+
+  if(varstack->capacity == 0) {
+    return (unsigned char *)REALLOC(varstack->stack, size);
+  }
+  if(size <= varstack->capacity) {
+    return varstack->stack;
+  }
+  if((stack = (unsigned char *)MALLOC(size)) == NULL) {
+    return NULL;
+  }
+  memcpy(stack, varstack->stack, varstack->nrbytes);
+  varstack->capacity = 0;
+  return stack;
+}
+
 static void vm_value_clr(struct rules_t *obj, uint16_t token) {
   struct varstack_t *varstack = (struct varstack_t *)obj->userdata;
   struct vm_tvar_t *var = (struct vm_tvar_t *)&obj->ast.buffer[token];
@@ -422,6 +770,17 @@ static void vm_value_cpy(struct rules_t *obj, uint16_t token) {
           }
           x += sizeof(struct vm_vnull_t)-1;
         } break;
+        case VCHAR: {
+          struct vm_lvchar_t *val = (struct vm_lvchar_t *)&varstack->stack[x];
+          struct vm_tvar_t *foo = (struct vm_tvar_t *)&obj->ast.buffer[val->ret];
+          if(stricmp((char *)foo->token, (char *)&var->token) == 0 && val->ret != token) {
+            var->value = foo->value;
+            val->ret = token;
+            foo->value = 0;
+            return;
+          }
+          x += sizeof(struct vm_lvchar_t)-1;
+        } break;
         default: {
           return;
         } break;
@@ -469,6 +828,18 @@ static void vm_value_cpy(struct rules_t *obj, uint16_t token) {
           }
           x += sizeof(struct vm_gvnull_t)-1;
         } break;
+        case VCHAR: {
+          struct vm_gvchar_t *val = (struct vm_gvchar_t *)&varstack->stack[x];
+          struct vm_tvar_t *foo = (struct vm_tvar_t *)&rules[val->rule-1]->ast.buffer[val->ret];
+
+          if(stricmp((char *)foo->token, (char *)var->token) == 0 && val->ret != token) {
+            var->value = x;
+            val->ret = token;
+            val->rule = obj->nr;
+            return;
+          }
+          x += sizeof(struct vm_gvchar_t)-1;
+        } break;
         default: {
           return;
         } break;
@@ -477,40 +848,140 @@ static void vm_value_cpy(struct rules_t *obj, uint16_t token) {
   }
 }
 
-static unsigned char *vm_value_get(struct rules_t *obj, uint16_t token) {
-  struct vm_tvar_t *node = (struct vm_tvar_t *)&obj->ast.buffer[token];
-  int i = 0;
-  if(node->token[0] == '$') {
-    struct varstack_t *varstack = (struct varstack_t *)obj->userdata;
-    if(node->value == 0) {
-      int ret = varstack->nrbytes, suffix = 0;
-      unsigned int size = alignedbytes(varstack->nrbytes + sizeof(struct vm_vnull_t));
-      if((varstack->stack = (unsigned char *)REALLOC(varstack->stack, alignedbuffer(size))) == NULL) {
-        OUT_OF_MEMORY /*LCOV_EXCL_LINE*/
-      }
-      struct vm_vnull_t *value = (struct vm_vnull_t *)&varstack->stack[ret];
-      value->type = VNULL;
-      value->ret = token;
-      node->value = ret;
+/*
+ * Strings are handed to the rules engine
+ * as their interned copy. Without room in
+ * the string pool no value is returned,
+ * which stops the rule.
+ */
+static unsigned char *vm_value_str(const char *str, uint16_t token) {
+  const char *cpy = strpool_intern(&rule_strings, str, strlen(str));
+
+  if(cpy == NULL) {
+    logprintf_P(F("rules: string pool full, cannot store \"%s\""), str);
+    return NULL;
+  }
 
-      varstack->nrbytes = size;
-      varstack->bufsize = alignedbuffer(size);
-    }
+  memset(&vchar, 0, sizeof(struct vm_vchar_t));
+  vchar.type = VCHAR;
+  vchar.ret = token;
+  vchar.value = strpool_offset(&rule_strings, cpy);
 
-    const char *key = (char *)node->token;
-    switch(varstack->stack[node->value]) {
-      case VINTEGER: {
-        struct vm_vinteger_t *na = (struct vm_vinteger_t *)&varstack->stack[node->value];
-      } break;
-      case VFLOAT: {
-        struct vm_vfloat_t *na = (struct vm_vfloat_t *)&varstack->stack[node->value];
-      } break;
-      case VNULL: {
-        struct vm_vnull_t *na = (struct vm_vnull_t *)&varstack->stack[node->value];
-      } break;
-      case VCHAR: {
-        struct vm_vchar_t *na = (struct vm_vchar_t *)&varstack->stack[node->value];
-      } break;
+  return (unsigned char *)&vchar;
+}
+
+/*
+ * Topic values are decimal strings with only a few
+ * fractional digits. Parse them with integer math, so
+ * integral values, which most topics are, never go
+ * through the software float routines on the ESP8266.
+ */
+static unsigned char *vm_value_topic(const char *str, uint16_t token) {
+  const char *p = str;
+  int neg = 0, ip = 0, frac = 0, scale = 1;
+
+  if(*p == '\0') {
+    memset(&vnull, 0, sizeof(struct vm_vnull_t));
+    vnull.type = VNULL;
+    vnull.ret = token;
+
+    return (unsigned char *)&vnull;
+  }
+
+  while(*p == ' ') {
+    p++;
+  }
+
+  if(*p == '-' || *p == '+') {
+    neg = (*p == '-');
+    p++;
+  }
+
+  /*
+   * Topics like the error code are
+   * text instead of a number.
+   */
+  if(!isdigit(*p)) {
+    return vm_value_str(str, token);
+  }
+
+  while(isdigit(*p)) {
+    ip = (ip * 10) + (*p - '0');
+    p++;
+  }
+  if(*p == '.') {
+    p++;
+    while(isdigit(*p)) {
+      if(scale < 100000) {
+        frac = (frac * 10) + (*p - '0');
+        scale *= 10;
+      }
+      p++;
+    }
+  }
+
+  if(*p == 'e' || *p == 'E') {
+    memset(&vfloat, 0, sizeof(struct vm_vfloat_t));
+    vfloat.type = VFLOAT;
+    vfloat.value = atof(str);
+
+    return (unsigned char *)&vfloat;
+  }
+
+  if(frac == 0) {
+    memset(&vinteger, 0, sizeof(struct vm_vinteger_t));
+    vinteger.type = VINTEGER;
+    vinteger.value = neg ? -ip : ip;
+
+    return (unsigned char *)&vinteger;
+  }
+
+  memset(&vfloat, 0, sizeof(struct vm_vfloat_t));
+  vfloat.type = VFLOAT;
+  vfloat.value = (float)ip + ((float)frac / scale);
+  if(neg) {
+    vfloat.value = -vfloat.value;
+  }
+
+  return (unsigned char *)&vfloat;
+}
+
+static unsigned char *vm_value_get(struct rules_t *obj, uint16_t token) {
+  struct vm_tvar_t *node = (struct vm_tvar_t *)&obj->ast.buffer[token];
+  int i = 0;
+  if(node->token[0] == '$') {
+    struct varstack_t *varstack = (struct varstack_t *)obj->userdata;
+    if(node->value == 0) {
+      int ret = varstack->nrbytes, suffix = 0;
+      unsigned int size = alignedbytes(varstack->nrbytes + sizeof(struct vm_vnull_t));
+      if((varstack->stack = vm_varstack_resize(varstack, alignedbuffer(size))) == NULL) {
+        OUT_OF_MEMORY /*LCOV_EXCL_LINE*/
+      }
+      struct vm_vnull_t *value = (struct vm_vnull_t *)&varstack->stack[ret];
+      value->type = VNULL;
+      value->ret = token;
+      node->value = ret;
+
+      varstack->nrbytes = size;
+      varstack->bufsize = alignedbuffer(size);
+    }
+
+    const char *key = (char *)node->token;
+    switch(varstack->stack[node->value]) {
+      case VINTEGER: {
+        struct vm_vinteger_t *na = (struct vm_vinteger_t *)&varstack->stack[node->value];
+      } break;
+      case VFLOAT: {
+        struct vm_vfloat_t *na = (struct vm_vfloat_t *)&varstack->stack[node->value];
+      } break;
+      case VNULL: {
+        struct vm_vnull_t *na = (struct vm_vnull_t *)&varstack->stack[node->value];
+      } break;
+      case VCHAR: {
+        struct vm_lvchar_t *na = (struct vm_lvchar_t *)&varstack->stack[node->value];
+
+        return vm_value_str(na->value, token);
+      } break;
     }
 
     return &varstack->stack[node->value];
@@ -522,7 +993,7 @@ static unsigned char *vm_value_get(struct rules_t *obj, uint16_t token) {
       int ret = varstack->nrbytes, suffix = 0;
 
       unsigned int size = alignedbytes(varstack->nrbytes + sizeof(struct vm_gvnull_t));
-      if((varstack->stack = (unsigned char *)REALLOC(varstack->stack, alignedbuffer(size))) == NULL) {
+      if((varstack->stack = vm_varstack_resize(varstack, alignedbuffer(size))) == NULL) {
         OUT_OF_MEMORY /*LCOV_EXCL_LINE*/
       }
       struct vm_gvnull_t *value = (struct vm_gvnull_t *)&varstack->stack[ret];
@@ -564,110 +1035,31 @@ static unsigned char *vm_value_get(struct rules_t *obj, uint16_t token) {
         return (unsigned char *)&vnull;
       } break;
       case VCHAR: {
-        return NULL;
+        struct vm_gvchar_t *na = (struct vm_gvchar_t *)&varstack->stack[node->value];
+
+        return vm_value_str(na->value, token);
       } break;
     }
 
     return NULL;
   }
   if(node->token[0] == '@') {
-    for(i=0;i<NUMBER_OF_TOPICS;i++) {
-      char cpy[MAX_TOPIC_LEN];
-      memcpy_P(&cpy, topics[i], MAX_TOPIC_LEN);
-      if(stricmp(cpy, (char *)&node->token[1]) == 0) {
-        String dataValue = actData[0] == '\0' ? "" : getDataValue(actData, i);
-        char *str = (char *)dataValue.c_str();
-        if(strlen(str) == 0) {
-          memset(&vnull, 0, sizeof(struct vm_vnull_t));
-          vnull.type = VNULL;
-          vnull.ret = token;
-
-          return (unsigned char *)&vnull;
-        } else {
-          float var = atof(str);
-          float nr = 0;
-
-          // mosquitto_publish
-          if(modff(var, &nr) == 0) {
-            memset(&vinteger, 0, sizeof(struct vm_vinteger_t));
-            vinteger.type = VINTEGER;
-            vinteger.value = (int)var;
-
-            return (unsigned char *)&vinteger;
-          } else {
-            memset(&vfloat, 0, sizeof(struct vm_vfloat_t));
-            vfloat.type = VFLOAT;
-            vfloat.value = var;
-
-            return (unsigned char *)&vfloat;
-          }
-        }
-      }
-    }
-    for(i=0;i<NUMBER_OF_OPT_TOPICS;i++) {
-      char cpy[MAX_TOPIC_LEN];
-      memcpy_P(&cpy, topics[i], MAX_TOPIC_LEN);
-      if(stricmp(cpy, (char *)&node->token[1]) == 0) {
-        String dataValue = actOptData[0] == '\0' ? "" : getOptDataValue(actOptData, i);
-        char *str = (char *)dataValue.c_str();
-        if(strlen(str) == 0) {
-          memset(&vnull, 0, sizeof(struct vm_vnull_t));
-          vnull.type = VNULL;
-          vnull.ret = token;
-
-          return (unsigned char *)&vnull;
-        } else {
-          float var = atof(str);
-          float nr = 0;
-
-          // mosquitto_publish
-          if(modff(var, &nr) == 0) {
-            memset(&vinteger, 0, sizeof(struct vm_vinteger_t));
-            vinteger.type = VINTEGER;
-            vinteger.value = (int)var;
-
-            return (unsigned char *)&vinteger;
-          } else {
-            memset(&vfloat, 0, sizeof(struct vm_vfloat_t));
-            vfloat.type = VFLOAT;
-            vfloat.value = var;
-
-            return (unsigned char *)&vfloat;
-          }
-        }
-      }
-    }
-    for(i=0;i<NUMBER_OF_TOPICS_EXTRA;i++) {
-      char cpy[MAX_TOPIC_LEN];
-      memcpy_P(&cpy, xtopics[i], MAX_TOPIC_LEN);
-      if(stricmp(cpy, (char *)&node->token[1]) == 0) {
-        String dataValue = actDataExtra[0] == '\0' ? "" : getDataValueExtra(actDataExtra, i);
-        char *str = (char *)dataValue.c_str();
-        if(strlen(str) == 0) {
-          memset(&vnull, 0, sizeof(struct vm_vnull_t));
-          vnull.type = VNULL;
-          vnull.ret = token;
-
-          return (unsigned char *)&vnull;
-        } else {
-          float var = atof(str);
-          float nr = 0;
-
-          // mosquitto_publish
-          if(modff(var, &nr) == 0) {
-            memset(&vinteger, 0, sizeof(struct vm_vinteger_t));
-            vinteger.type = VINTEGER;
-            vinteger.value = (int)var;
-
-            return (unsigned char *)&vinteger;
-          } else {
-            memset(&vfloat, 0, sizeof(struct vm_vfloat_t));
-            vfloat.type = VFLOAT;
-            vfloat.value = var;
-
-            return (unsigned char *)&vfloat;
-          }
-        }
+    int id = rules_symbol_find((char *)&node->token[1], strlen((char *)&node->token[1]), SYM_MASK(SYM_TOPIC) | SYM_MASK(SYM_OPTTOPIC) | SYM_MASK(SYM_XTOPIC));
+    if(id > -1) {
+      i = SYM_INDEX(id);
+      switch(SYM_KIND(id)) {
+        case SYM_TOPIC: {
+          String dataValue = actData[0] == '\0' ? "" : getDataValue(actData, i);
+          return vm_value_topic(dataValue.c_str(), token);
+        } break;
+        case SYM_OPTTOPIC: {
+          String dataValue = actOptData[0] == '\0' ? "" : getOptDataValue(actOptData, i);
+          return vm_value_topic(dataValue.c_str(), token);
+        } break;
+        case SYM_XTOPIC: {
+          String dataValue = actDataExtra[0] == '\0' ? "" : getDataValueExtra(actDataExtra, i);
+          return vm_value_topic(dataValue.c_str(), token);
+        } break;
       }
     }
   }
@@ -707,9 +1099,10 @@ static unsigned char *vm_value_get(struct rules_t *obj, uint16_t token) {
     }
   }
   if(node->token[0] == '?') {
-    int x = 0;
-    while(heishaOTDataStruct[x].name != NULL) {
-      if(heishaOTDataStruct[x].rw >= 2 && stricmp((char *)&node->token[1], heishaOTDataStruct[x].name) == 0) {
+    int x = rules_symbol_find((char *)&node->token[1], strlen((char *)&node->token[1]), SYM_MASK(SYM_OT));
+    if(x > -1) {
+      x = SYM_INDEX(x);
+      if(heishaOTDataStruct[x].rw >= 2) {
         if(heishaOTDataStruct[x].type == TBOOL) {
           memset(&vinteger, 0, sizeof(struct vm_vinteger_t));
           vinteger.type = VINTEGER;
@@ -724,9 +1117,7 @@ static unsigned char *vm_value_get(struct rules_t *obj, uint16_t token) {
           // printf("%s %s = %g\n", __FUNCTION__, (char *)node->token, var);
           return (unsigned char *)&vfloat;
         }
-        break;
       }
-      x++;
     }
     logprintf_P(F("err: %s %d"), __FUNCTION__, __LINE__);
   }
@@ -759,7 +1150,7 @@ static int vm_value_del(struct rules_t *obj, uint16_t idx) {
     case VINTEGER: {
       ret = alignedbytes(sizeof(struct vm_vinteger_t));
       memmove(&varstack->stack[idx], &varstack->stack[idx+ret], varstack->nrbytes-idx-ret);
-      if((varstack->stack = (unsigned char *)REALLOC(varstack->stack, alignedbuffer(varstack->nrbytes-ret))) == NULL) {
+      if((varstack->stack = vm_varstack_resize(varstack, alignedbuffer(varstack->nrbytes-ret))) == NULL) {
         OUT_OF_MEMORY /*LCOV_EXCL_LINE*/
       }
       varstack->nrbytes -= ret;
@@ -768,7 +1159,7 @@ static int vm_value_del(struct rules_t *obj, uint16_t idx) {
     case VFLOAT: {
       ret = alignedbytes(sizeof(struct vm_vfloat_t));
       memmove(&varstack->stack[idx], &varstack->stack[idx+ret], varstack->nrbytes-idx-ret);
-      if((varstack->stack = (unsigned char *)REALLOC(varstack->stack,alignedbuffer(varstack->nrbytes-ret))) == NULL) {
+      if((varstack->stack = vm_varstack_resize(varstack, alignedbuffer(varstack->nrbytes-ret))) == NULL) {
         OUT_OF_MEMORY /*LCOV_EXCL_LINE*/
       }
       varstack->nrbytes -= ret;
@@ -777,7 +1168,19 @@ static int vm_value_del(struct rules_t *obj, uint16_t idx) {
     case VNULL: {
       ret = alignedbytes(sizeof(struct vm_vnull_t));
       memmove(&varstack->stack[idx], &varstack->stack[idx+ret], varstack->nrbytes-idx-ret);
-      if((varstack->stack = (unsigned char *)REALLOC(varstack->stack, alignedbuffer(varstack->nrbytes-ret))) == NULL) {
+      if((varstack->stack = vm_varstack_resize(varstack, alignedbuffer(varstack->nrbytes-ret))) == NULL) {
+        OUT_OF_MEMORY /*LCOV_EXCL_LINE*/
+      }
+      varstack->nrbytes -= ret;
+      varstack->bufsize = alignedbuffer(varstack->nrbytes);
+    } break;
+    case VCHAR: {
+      struct vm_lvchar_t *node = (struct vm_lvchar_t *)&varstack->stack[idx];
+      FREE(node->value);
+
+      ret = alignedbytes(sizeof(struct vm_lvchar_t));
+      memmove(&varstack->stack[idx], &varstack->stack[idx+ret], varstack->nrbytes-idx-ret);
+      if((varstack->stack = vm_varstack_resize(varstack, alignedbuffer(varstack->nrbytes-ret))) == NULL) {
         OUT_OF_MEMORY /*LCOV_EXCL_LINE*/
       }
       varstack->nrbytes -= ret;
@@ -813,6 +1216,22 @@ static int vm_value_del(struct rules_t *obj, uint16_t idx) {
         }
         x += sizeof(struct vm_vfloat_t)-1;
       } break;
+      case VNULL: {
+        struct vm_vnull_t *node = (struct vm_vnull_t *)&varstack->stack[x];
+        if(node->ret > 0) {
+          struct vm_tvar_t *tmp = (struct vm_tvar_t *)&obj->ast.buffer[node->ret];
+          tmp->value = x;
+        }
+        x += sizeof(struct vm_vnull_t)-1;
+      } break;
+      case VCHAR: {
+        struct vm_lvchar_t *node = (struct vm_lvchar_t *)&varstack->stack[x];
+        if(node->ret > 0) {
+          struct vm_tvar_t *tmp = (struct vm_tvar_t *)&obj->ast.buffer[node->ret];
+          tmp->value = x;
+        }
+        x += sizeof(struct vm_lvchar_t)-1;
+      } break;
       default: {
         return -1;
       } break;
@@ -822,6 +1241,98 @@ static int vm_value_del(struct rules_t *obj, uint16_t idx) {
   return ret;
 }
 
+static void rules_command_queue(uint8_t id, char *payload) {
+  uint8_t i = 0;
+
+  for(i=0;i<nrcommands;i++) {
+    if(rules_commands[i].id == id) {
+      FREE(rules_commands[i].payload);
+      rules_commands[i].payload = payload;
+      return;
+    }
+  }
+  rules_commands[nrcommands].id = id;
+  rules_commands[nrcommands].payload = payload;
+  nrcommands++;
+}
+
+static uint16_t rules_command_build(struct rules_command_t *command, unsigned char *cmd, char *log_msg) {
+  cmdStruct tmp;
+
+  memcpy_P(&tmp, &commands[command->id], sizeof(tmp));
+  memset(cmd, 0, 256);
+  memset(log_msg, 0, 256);
+
+  return tmp.func(command->payload, cmd, log_msg);
+}
+
+/*
+ * Each command only changes some fields of the
+ * send query, a zero field is left untouched by
+ * the heatpump. Several fields share a byte, e.g.
+ * quiet and powerful mode, so commands are only
+ * combined in a single frame when they change
+ * different bytes.
+ */
+static int rules_command_merge(unsigned char *frame, unsigned char *cmd, uint16_t len) {
+  uint16_t i = 0;
+  uint8_t query = 0;
+
+  if(len != PANASONICQUERYSIZE) {
+    return -1;
+  }
+  for(i=0;i<len;i++) {
+    query = pgm_read_byte(&panasonicSendQuery[i]);
+    if(frame[i] != query && cmd[i] != query) {
+      return -1;
+    }
+  }
+  for(i=0;i<len;i++) {
+    if(cmd[i] != pgm_read_byte(&panasonicSendQuery[i])) {
+      frame[i] = cmd[i];
+    }
+  }
+  return 0;
+}
+
+static void rules_commands_clear(void) {
+  uint8_t i = 0;
+
+  for(i=0;i<nrcommands;i++) {
+    FREE(rules_commands[i].payload);
+  }
+  nrcommands = 0;
+}
+
+static void rules_commands_flush(void) {
+  unsigned char frame[256], cmd[256];
+  char log_msg[256];
+  uint16_t len = 0;
+  uint8_t i = 0, x = 0;
+
+  for(i=0;i<nrcommands;i++) {
+    if(rules_commands[i].payload == NULL) {
+      continue;
+    }
+    len = rules_command_build(&rules_commands[i], frame, log_msg);
+    log_message(log_msg);
+    FREE(rules_commands[i].payload);
+
+    for(x=i+1;x<nrcommands && len == PANASONICQUERYSIZE;x++) {
+      if(rules_commands[x].payload == NULL) {
+        continue;
+      }
+      if(rules_command_merge(frame, cmd, rules_command_build(&rules_commands[x], cmd, log_msg)) == 0) {
+        log_message(log_msg);
+        FREE(rules_commands[x].payload);
+      }
+    }
+
+    send_command(frame, len);
+  }
+  nrcommands = 0;
+}
+
 static void vm_value_set(struct rules_t *obj, uint16_t token, uint16_t val) {
   struct varstack_t *varstack = NULL;
   struct vm_tvar_t *var = (struct vm_tvar_t *)&obj->ast.buffer[token];
@@ -841,9 +1352,6 @@ static void vm_value_set(struct rules_t *obj, uint16_t token, uint16_t val) {
       case VNULL: {
         struct vm_vnull_t *na = (struct vm_vnull_t *)&obj->varstack.buffer[val];
       } break;
-      case VCHAR: {
-        struct vm_vchar_t *na = (struct vm_vchar_t *)&obj->varstack.buffer[val];
-      } break;
     }
 
     /*
@@ -886,6 +1394,17 @@ static void vm_value_set(struct rules_t *obj, uint16_t token, uint16_t val) {
           }
           x += sizeof(struct vm_vnull_t)-1;
         } break;
+        case VCHAR: {
+          struct vm_lvchar_t *node = (struct vm_lvchar_t *)&varstack->stack[x];
+          struct vm_tvar_t *tmp = (struct vm_tvar_t *)&obj->ast.buffer[node->ret];
+          if(stricmp((char *)var->token, (char *)tmp->token) == 0) {
+            var->value = 0;
+            vm_value_del(obj, x);
+            loop = 0;
+            break;
+          }
+          x += sizeof(struct vm_lvchar_t)-1;
+        } break;
         default: {
           return;
         } break;
@@ -905,7 +1424,7 @@ static void vm_value_set(struct rules_t *obj, uint16_t token, uint16_t val) {
     switch(obj->varstack.buffer[val]) {
       case VINTEGER: {
         unsigned int size = alignedbytes(varstack->nrbytes+sizeof(struct vm_vinteger_t));
-        if((varstack->stack = (unsigned char *)REALLOC(varstack->stack, alignedbuffer(size))) == NULL) {
+        if((varstack->stack = vm_varstack_resize(varstack, alignedbuffer(size))) == NULL) {
           OUT_OF_MEMORY /*LCOV_EXCL_LINE*/
         }
         struct vm_vinteger_t *cpy = (struct vm_vinteger_t *)&obj->varstack.buffer[val];
@@ -919,7 +1438,7 @@ static void vm_value_set(struct rules_t *obj, uint16_t token, uint16_t val) {
       } break;
       case VFLOAT: {
         unsigned int size = alignedbytes(varstack->nrbytes+sizeof(struct vm_vfloat_t));
-        if((varstack->stack = (unsigned char *)REALLOC(varstack->stack, alignedbuffer(size))) == NULL) {
+        if((varstack->stack = vm_varstack_resize(varstack, alignedbuffer(size))) == NULL) {
           OUT_OF_MEMORY /*LCOV_EXCL_LINE*/
         }
         struct vm_vfloat_t *cpy = (struct vm_vfloat_t *)&obj->varstack.buffer[val];
@@ -933,7 +1452,7 @@ static void vm_value_set(struct rules_t *obj, uint16_t token, uint16_t val) {
       } break;
       case VNULL: {
         unsigned int size = alignedbytes(varstack->nrbytes+sizeof(struct vm_vnull_t));
-        if((varstack->stack = (unsigned char *)REALLOC(varstack->stack, alignedbuffer(size))) == NULL) {
+        if((varstack->stack = vm_varstack_resize(varstack, alignedbuffer(size))) == NULL) {
           OUT_OF_MEMORY /*LCOV_EXCL_LINE*/
         }
         struct vm_vnull_t *value = (struct vm_vnull_t *)&varstack->stack[ret];
@@ -942,6 +1461,22 @@ static void vm_value_set(struct rules_t *obj, uint16_t token, uint16_t val) {
         varstack->nrbytes = size;
         varstack->bufsize = alignedbuffer(size);
       } break;
+      case VCHAR: {
+        unsigned int size = alignedbytes(varstack->nrbytes+sizeof(struct vm_lvchar_t));
+        if((varstack->stack = vm_varstack_resize(varstack, alignedbuffer(size))) == NULL) {
+          OUT_OF_MEMORY /*LCOV_EXCL_LINE*/
+        }
+        struct vm_vchar_t *cpy = (struct vm_vchar_t *)&obj->varstack.buffer[val];
+        struct vm_lvchar_t *value = (struct vm_lvchar_t *)&varstack->stack[ret];
+        value->type = VCHAR;
+        value->ret = token;
+        if((value->value = STRDUP(strpool_get(&rule_strings, cpy->value))) == NULL) {
+          OUT_OF_MEMORY /*LCOV_EXCL_LINE*/
+        }
+
+        varstack->nrbytes = size;
+        varstack->bufsize = alignedbuffer(size);
+      } break;
       default: {
         return;
       } break;
@@ -957,9 +1492,6 @@ static void vm_value_set(struct rules_t *obj, uint16_t token, uint16_t val) {
       case VFLOAT: {
         struct vm_vfloat_t *na = (struct vm_vfloat_t *)&obj->varstack.buffer[val];
       } break;
-      case VCHAR: {
-        struct vm_vchar_t *na = (struct vm_vchar_t *)&obj->varstack.buffer[val];
-      } break;
       case VNULL: {
         struct vm_vnull_t *na = (struct vm_vnull_t *)&obj->varstack.buffer[val];
       } break;
@@ -979,7 +1511,7 @@ static void vm_value_set(struct rules_t *obj, uint16_t token, uint16_t val) {
 
             ret = alignedbytes(sizeof(struct vm_gvinteger_t));
             memmove(&varstack->stack[x], &varstack->stack[x+ret], varstack->nrbytes-x-ret);
-            if((varstack->stack = (unsigned char *)REALLOC(varstack->stack, alignedbuffer(varstack->nrbytes-ret))) == NULL) {
+            if((varstack->stack = vm_varstack_resize(varstack, alignedbuffer(varstack->nrbytes-ret))) == NULL) {
               OUT_OF_MEMORY /*LCOV_EXCL_LINE*/
             }
             varstack->nrbytes -= ret;
@@ -995,7 +1527,7 @@ static void vm_value_set(struct rules_t *obj, uint16_t token, uint16_t val) {
 
             ret = alignedbytes(sizeof(struct vm_gvfloat_t));
             memmove(&varstack->stack[x], &varstack->stack[x+ret], varstack->nrbytes-x-ret);
-            if((varstack->stack = (unsigned char *)REALLOC(varstack->stack, alignedbuffer(varstack->nrbytes-ret))) == NULL) {
+            if((varstack->stack = vm_varstack_resize(varstack, alignedbuffer(varstack->nrbytes-ret))) == NULL) {
               OUT_OF_MEMORY /*LCOV_EXCL_LINE*/
             }
             varstack->nrbytes -= ret;
@@ -1011,7 +1543,24 @@ static void vm_value_set(struct rules_t *obj, uint16_t token, uint16_t val) {
 
             ret = alignedbytes(sizeof(struct vm_gvnull_t));
             memmove(&varstack->stack[x], &varstack->stack[x+ret], varstack->nrbytes-x-ret);
-            if((varstack->stack = (unsigned char *)REALLOC(varstack->stack, alignedbuffer(varstack->nrbytes-ret))) == NULL) {
+            if((varstack->stack = vm_varstack_resize(varstack, alignedbuffer(varstack->nrbytes-ret))) == NULL) {
+              OUT_OF_MEMORY /*LCOV_EXCL_LINE*/
+            }
+            varstack->nrbytes -= ret;
+            varstack->bufsize = alignedbuffer(varstack->nrbytes);
+          }
+        } break;
+        case VCHAR: {
+          struct vm_gvchar_t *val = (struct vm_gvchar_t *)&varstack->stack[x];
+          struct vm_tvar_t *foo = (struct vm_tvar_t *)&rules[val->rule-1]->ast.buffer[val->ret];
+
+          if(stricmp((char *)foo->token, (char *)var->token) == 0) {
+            move = 1;
+            FREE(val->value);
+
+            ret = alignedbytes(sizeof(struct vm_gvchar_t));
+            memmove(&varstack->stack[x], &varstack->stack[x+ret], varstack->nrbytes-x-ret);
+            if((varstack->stack = vm_varstack_resize(varstack, alignedbuffer(varstack->nrbytes-ret))) == NULL) {
               OUT_OF_MEMORY /*LCOV_EXCL_LINE*/
             }
             varstack->nrbytes -= ret;
@@ -1057,6 +1606,16 @@ static void vm_value_set(struct rules_t *obj, uint16_t token, uint16_t val) {
           }
           x += sizeof(struct vm_gvnull_t)-1;
         } break;
+        case VCHAR: {
+          if(move == 1 && x < varstack->nrbytes) {
+            struct vm_gvchar_t *node = (struct vm_gvchar_t *)&varstack->stack[x];
+            if(node->ret > 0) {
+              struct vm_tvar_t *tmp = (struct vm_tvar_t *)&rules[node->rule-1]->ast.buffer[node->ret];
+              tmp->value = x;
+            }
+          }
+          x += sizeof(struct vm_gvchar_t)-1;
+        } break;
       }
     }
     var = (struct vm_tvar_t *)&obj->ast.buffer[token];
@@ -1068,7 +1627,7 @@ static void vm_value_set(struct rules_t *obj, uint16_t token, uint16_t val) {
     switch(obj->varstack.buffer[val]) {
       case VINTEGER: {
         unsigned int size = alignedbytes(varstack->nrbytes + sizeof(struct vm_gvinteger_t));
-        if((varstack->stack = (unsigned char *)REALLOC(varstack->stack, alignedbuffer(size))) == NULL) {
+        if((varstack->stack = vm_varstack_resize(varstack, alignedbuffer(size))) == NULL) {
           OUT_OF_MEMORY /*LCOV_EXCL_LINE*/
         }
         struct vm_vinteger_t *cpy = (struct vm_vinteger_t *)&obj->varstack.buffer[val];
@@ -1083,7 +1642,7 @@ static void vm_value_set(struct rules_t *obj, uint16_t token, uint16_t val) {
       } break;
       case VFLOAT: {
         unsigned int size = alignedbytes(varstack->nrbytes + sizeof(struct vm_gvfloat_t));
-        if((varstack->stack = (unsigned char *)REALLOC(varstack->stack, alignedbuffer(size))) == NULL) {
+        if((varstack->stack = vm_varstack_resize(varstack, alignedbuffer(size))) == NULL) {
           OUT_OF_MEMORY /*LCOV_EXCL_LINE*/
         }
         struct vm_vfloat_t *cpy = (struct vm_vfloat_t *)&obj->varstack.buffer[val];
@@ -1098,7 +1657,7 @@ static void vm_value_set(struct rules_t *obj, uint16_t token, uint16_t val) {
       } break;
       case VNULL: {
         unsigned int size = alignedbytes(varstack->nrbytes + sizeof(struct vm_gvnull_t));
-        if((varstack->stack = (unsigned char *)REALLOC(varstack->stack, alignedbuffer(size))) == NULL) {
+        if((varstack->stack = vm_varstack_resize(varstack, alignedbuffer(size))) == NULL) {
           OUT_OF_MEMORY /*LCOV_EXCL_LINE*/
         }
         struct vm_gvnull_t *value = (struct vm_gvnull_t *)&varstack->stack[ret];
@@ -1109,6 +1668,23 @@ static void vm_value_set(struct rules_t *obj, uint16_t token, uint16_t val) {
         varstack->nrbytes = size;
         varstack->bufsize = alignedbuffer(size);
       } break;
+      case VCHAR: {
+        unsigned int size = alignedbytes(varstack->nrbytes + sizeof(struct vm_gvchar_t));
+        if((varstack->stack = vm_varstack_resize(varstack, alignedbuffer(size))) == NULL) {
+          OUT_OF_MEMORY /*LCOV_EXCL_LINE*/
+        }
+        struct vm_vchar_t *cpy = (struct vm_vchar_t *)&obj->varstack.buffer[val];
+        struct vm_gvchar_t *value = (struct vm_gvchar_t *)&varstack->stack[ret];
+        value->type = VCHAR;
+        value->ret = token;
+        value->rule = obj->nr;
+        if((value->value = STRDUP(strpool_get(&rule_strings, cpy->value))) == NULL) {
+          OUT_OF_MEMORY /*LCOV_EXCL_LINE*/
+        }
+
+        varstack->nrbytes = size;
+        varstack->bufsize = alignedbuffer(size);
+      } break;
       default: {
         return;
       } break;
@@ -1140,50 +1716,37 @@ static void vm_value_set(struct rules_t *obj, uint16_t token, uint16_t val) {
       case VCHAR: {
         struct vm_vchar_t *na = (struct vm_vchar_t *)&obj->varstack.buffer[val];
 
-        len = snprintf_P(NULL, 0, PSTR("%s"), na->value);
-        if((payload = (char *)MALLOC(len+1)) == NULL) {
+        if((payload = STRDUP(strpool_get(&rule_strings, na->value))) == NULL) {
           OUT_OF_MEMORY
         }
-        snprintf_P(payload, len+1, PSTR("%s"), na->value);
       } break;
     }
 
     if(parsing == 0 && !heishamonSettings.listenonly) {
-      unsigned char cmd[256] = { 0 };
       char log_msg[256] = { 0 };
 
-      for(uint8_t x = 0; x < sizeof(commands) / sizeof(commands[0]); x++) {
-        cmdStruct tmp;
-        memcpy_P(&tmp, &commands[x], sizeof(tmp));
-        if(stricmp((char *)&var->token[1], tmp.name) == 0) {
-          uint16_t len = tmp.func(payload, cmd, log_msg);
-          log_message(log_msg);
-          send_command(cmd, len);
-          break;
-        }
-      }
-
-      memset(&cmd, 256, 0);
-      memset(&log_msg, 256, 0);
+      int id = rules_symbol_find((char *)&var->token[1], strlen((char *)&var->token[1]), SYM_MASK(SYM_COMMAND) | SYM_MASK(SYM_OPTCOMMAND));
 
-      if(heishamonSettings.optionalPCB) {
+      if(id > -1 && SYM_KIND(id) == SYM_COMMAND) {
+        /*
+         * Sent once the rule run has completed
+         */
+        rules_command_queue(SYM_INDEX(id), payload);
+        payload = NULL;
+      } else if(id > -1 && SYM_KIND(id) == SYM_OPTCOMMAND && heishamonSettings.optionalPCB) {
         //optional commands
-        for(uint8_t x = 0; x < sizeof(optionalCommands) / sizeof(optionalCommands[0]); x++) {
-          optCmdStruct tmp;
-          memcpy_P(&tmp, &optionalCommands[x], sizeof(tmp));
-          if(stricmp((char *)&var->token[1], tmp.name) == 0) {
-            uint16_t len = tmp.func(payload, log_msg);
-            log_message(log_msg);
-            break;
-          }
-        }
+        optCmdStruct tmp;
+        memcpy_P(&tmp, &optionalCommands[SYM_INDEX(id)], sizeof(tmp));
+        tmp.func(payload, log_msg);
+        log_message(log_msg);
       }
     }
     FREE(payload);
   } else if(var->token[0] == '?') {
-    int x = 0;
-    while(heishaOTDataStruct[x].name != NULL) {
-      if(heishaOTDataStruct[x].rw <= 2 && stricmp((char *)&var->token[1], heishaOTDataStruct[x].name) == 0) {
+    int x = rules_symbol_find((char *)&var->token[1], strlen((char *)&var->token[1]), SYM_MASK(SYM_OT));
+    if(x > -1) {
+      x = SYM_INDEX(x);
+      if(heishaOTDataStruct[x].rw <= 2) {
         if(heishaOTDataStruct[x].type == TBOOL) {
           switch(obj->varstack.buffer[val]) {
             case VINTEGER: {
@@ -1211,9 +1774,7 @@ static void vm_value_set(struct rules_t *obj, uint16_t token, uint16_t val) {
             } break;
           }
         }
-        break;
       }
-      x++;
     }
   }
 }
@@ -1265,6 +1826,19 @@ static void vm_value_prt(struct rules_t *obj, char *out, int size) {
           }
           x += sizeof(struct vm_vnull_t)-1;
         } break;
+        case VCHAR: {
+          struct vm_lvchar_t *val = (struct vm_lvchar_t *)&varstack->stack[x];
+          switch(obj->ast.buffer[val->ret]) {
+            case TVAR: {
+              struct vm_tvar_t *node = (struct vm_tvar_t *)&obj->ast.buffer[val->ret];
+              pos += snprintf_P(&out[pos], size - pos, PSTR("%s = \"%s\"\n"), node->token, val->value);
+            } break;
+            default: {
+              return;
+            } break;
+          }
+          x += sizeof(struct vm_lvchar_t)-1;
+        } break;
         default: {
           return;
         } break;
@@ -1319,6 +1893,19 @@ static void vm_global_value_prt(char *out, int size) {
         }
         x += sizeof(struct vm_gvnull_t)-1;
       } break;
+      case VCHAR: {
+        struct vm_gvchar_t *val = (struct vm_gvchar_t *)&varstack->stack[x];
+        switch(rules[val->rule-1]->ast.buffer[val->ret]) {
+          case TVAR: {
+            struct vm_tvar_t *node = (struct vm_tvar_t *)&rules[val->rule-1]->ast.buffer[val->ret];
+            pos += snprintf_P(&out[pos], size - pos, PSTR("%d %s = \"%s\"\n"), x, node->token, val->value);
+          } break;
+          default: {
+            return;
+          } break;
+        }
+        x += sizeof(struct vm_gvchar_t)-1;
+      } break;
       default: {
         return;
       } break;
@@ -1326,8 +1913,42 @@ static void vm_global_value_prt(char *out, int size) {
   }
 }
 
+/*
+ * The rolling statistics functions get a window
+ * on the topic in their first argument. Windows
+ * are only set up for constant topics and sizes.
+ */
+static void rules_rollstat_track(struct rules_t *obj, struct vm_tfunction_t *node) {
+  if(node->nrgo != 2 || strncmp(rule_functions[node->token].name, "roll", 4) != 0) {
+    return;
+  }
+  if(obj->ast.buffer[node->go[0]] != TSTRING || obj->ast.buffer[node->go[1]] != TNUMBER) {
+    return;
+  }
+
+  struct vm_tstring_t *name = (struct vm_tstring_t *)&obj->ast.buffer[node->go[0]];
+  struct vm_tnumber_t *size = (struct vm_tnumber_t *)&obj->ast.buffer[node->go[1]];
+  int window = atoi((char *)size->token);
+  int id = rules_symbol_find((char *)name->token, strlen((char *)name->token), SYM_MASK(SYM_TOPIC) | SYM_MASK(SYM_OPTTOPIC) | SYM_MASK(SYM_XTOPIC));
+
+  if(id == -1) {
+    logprintf_P(F("rules: %s has an unknown topic '%s'"), rule_functions[node->token].name, name->token);
+    return;
+  }
+  if(window < ROLLSTAT_MIN_WINDOW || window > ROLLSTAT_MAX_WINDOW) {
+    logprintf_P(F("rules: %s window of '%s' should be between %d and %d samples"), rule_functions[node->token].name, name->token, ROLLSTAT_MIN_WINDOW, ROLLSTAT_MAX_WINDOW);
+    return;
+  }
+  if(rollstat_track((char *)name->token, id, window) == NULL) {
+    logprintf_P(F("rules: not enough memory for %s window of '%s'"), rule_functions[node->token].name, name->token);
+  }
+}
+
 static void vm_clear_values(struct rules_t *obj) {
+  struct varstack_t *varstack = (struct varstack_t *)obj->userdata;
   int i = 0, x = 0;
+
+  varstack->nrvars = 0;
   for(i=x;alignedbytes(i)<obj->ast.nrbytes;i++) {
     i = alignedbytes(i);
     switch(obj->ast.buffer[i]) {
@@ -1356,6 +1977,7 @@ static void vm_clear_values(struct rules_t *obj) {
       case TFUNCTION: {
         struct vm_tfunction_t *node = (struct vm_tfunction_t *)&obj->ast.buffer[i];
         node->value = 0;
+        rules_rollstat_track(obj, node);
         i+=sizeof(struct vm_tfunction_t)+(sizeof(node->go[0])*node->nrgo)-1;
       } break;
       case TCEVENT: {
@@ -1365,6 +1987,11 @@ static void vm_clear_values(struct rules_t *obj) {
       case TVAR: {
         struct vm_tvar_t *node = (struct vm_tvar_t *)&obj->ast.buffer[i];
         node->value = 0;
+        if(node->token[0] == '$') {
+          varstack->nrvars++;
+        } else if(node->token[0] == '#') {
+          rules_globals_restore(obj, i);
+        }
         i+=sizeof(struct vm_tvar_t)+strlen((char *)node->token);
       } break;
       case TEVENT: {
@@ -1375,6 +2002,10 @@ static void vm_clear_values(struct rules_t *obj) {
         struct vm_tnumber_t *node = (struct vm_tnumber_t *)&obj->ast.buffer[i];
         i+=sizeof(struct vm_tnumber_t)+strlen((char *)node->token);
       } break;
+      case TSTRING: {
+        struct vm_tstring_t *node = (struct vm_tstring_t *)&obj->ast.buffer[i];
+        i+=sizeof(struct vm_tstring_t)+strlen((char *)node->token);
+      } break;
       case VINTEGER: {
         struct vm_vinteger_t *node = (struct vm_vinteger_t *)&obj->ast.buffer[i];
         i+=sizeof(struct vm_vinteger_t)-1;
@@ -1394,153 +2025,614 @@ static void vm_clear_values(struct rules_t *obj) {
   }
 }
 
-void rules_timer_cb(int nr) {
-  char *name = NULL;
-  int x = 0, i = 0;
+/*
+ * Runs rule i, or continues the suspended run
+ * of obj on behalf of rule i. The time of all
+ * slices is accounted once the run completes.
+ */
+static void rules_exec(uint8_t i, struct rules_t *obj) {
+  uint8_t trace = rules_trace_get(i);
+  unsigned long elapsed = 0;
+  int ret = 0;
 
-  i = snprintf_P(NULL, 0, PSTR("timer=%d"), nr);
-  if((name = (char *)MALLOC(i+2)) == NULL) {
-    OUT_OF_MEMORY
-  }
-  memset(name, 0, i+2);
-  snprintf_P(name, i+1, PSTR("timer=%d"), nr);
+  rules[i]->timestamp.first = micros();
 
-  // logprintf_P(F("_______ %s %s"), __FUNCTION__, name);
+  ret = rule_run(obj);
 
-  for(x=0;x<nrrules;x++) {
-    if(get_event(rules[x]) > -1 && stricmp((char *)&rules[x]->ast.buffer[get_event(rules[x])+5], name) == 0) {
-      rule_run(rules[x], 0);
-
-      char out[512];
-      memset(&out, 0, 512);
-      logprintln_P(F("\n>>> local variables\n"));
-      vm_value_prt(rules[x], (char *)&out, 512);
-      logprintf_P(F("%s"), out);
-      logprintf_P(F("\n>>> global variables\n"));
-      memset(&out, 0, 512);
-      vm_global_value_prt((char *)&out, 512);
-      logprintf_P(F("%s"), out);
+  rules[i]->timestamp.second = micros();
 
-      break;
+  elapsed = rules[i]->timestamp.second - rules[i]->timestamp.first;
+
+  if(ret == 1) {
+    suspended = i;
+    suspended_time += elapsed;
+    if(i < nrstats && rules_stats[i].preempted < 0xFFFF) {
+      rules_stats[i].preempted++;
+    }
+    if(trace >= RULES_TRACE_SUMMARY) {
+      logprintf_P(F("%s%d %s %d %s"), F("rule #"), rules[i]->nr, F("was suspended after"), elapsed, F("microseconds"));
     }
+    return;
   }
-  FREE(name);
-}
 
-int rules_parse(char *file) {
-  File frules = LittleFS.open(file, "r");
-  if(frules) {
-    parsing = 1;
+  elapsed += suspended_time;
+  suspended = -1;
+  suspended_time = 0;
 
-    if(nrrules > 0) {
-      for(int i=0;i<nrrules;i++) {
-        if(rules[i]->userdata != NULL) {
-          FREE(rules[i]->userdata);
-        }
-      }
-      rules_gc(&rules, nrrules);
-      nrrules = 0;
+  rules_commands_flush();
+
+  rules_stats_update(i, elapsed);
+
+  if(trace >= RULES_TRACE_SUMMARY) {
+    logprintf_P(F("%s%d %s %d %s"), F("rule #"), rules[i]->nr, F("was executed in"), elapsed, F("microseconds"));
+  }
+  if(trace == RULES_TRACE_FULL) {
+    rules_trace_values(i);
+  }
+
+  strpool_reset(&rule_strings);
+}
+
+static int rules_timer_find(int nr) {
+  char name[18];
+  int x = 0;
+
+  snprintf_P(name, sizeof(name), PSTR("timer=%d"), nr);
+
+  for(x=0;x<nrrules;x++) {
+    if(get_event(rules[x]) > -1 && stricmp((char *)&rules[x]->ast.buffer[get_event(rules[x])+5], name) == 0) {
+      return x;
     }
-    memset(mempool, 0, MEMPOOL_SIZE);
+  }
+  return -1;
+}
 
-    FREE(global_varstack.stack);
-    global_varstack.stack = NULL;
-    global_varstack.nrbytes = 4;
+void rules_timer_cb(int nr) {
+  int x = rules_timer_find(nr);
+
+  // logprintf_P(F("_______ %s timer=%d"), __FUNCTION__, nr);
+
+  if(x == -1) {
+    return;
+  }
+
+  rules_stats_trigger(x, RULES_TRIGGER_TIMER);
+
+  if(suspended > -1) {
+    rules_defer(x);
+    return;
+  }
 
+  if(rules_trace_get(x) == RULES_TRACE_FULL) {
+    logprintf_P(F("%s timer=%d %s"), F("===="), nr, F("===="));
+  }
+
+  rules_exec(x, rules[x]);
+}
+
+/*
+ * Copies the running rule timers,
+ * the system timers are left alone.
+ */
+static void rules_timers_save(void) {
+  struct timerqueue_t *node = NULL;
+  int i = 0;
+
+  FREE(saved_timers);
+  nrtimers = 0;
+
+  if(timerqueue_count() == 0) {
+    return;
+  }
+  if((saved_timers = (struct timerqueue_t *)MALLOC(sizeof(struct timerqueue_t)*timerqueue_count())) == NULL) {
+    OUT_OF_MEMORY /*LCOV_EXCL_LINE*/
+  }
+  for(i=0;(node = timerqueue_get(i)) != NULL;i++) {
+    if(node->nr > 0) {
+      memcpy(&saved_timers[nrtimers++], node, sizeof(struct timerqueue_t));
+    }
+  }
+}
+
+/*
+ * Timers set while parsing are dropped. The
+ * saved timers of which the new ruleset still
+ * has a rule continue where they were.
+ */
+static void rules_timers_restore(void) {
+  struct timerqueue_t *node = NULL;
+  int i = 0;
+
+  while((node = timerqueue_get(i)) != NULL) {
+    if(node->nr > 0) {
+      timerqueue_insert(0, 0, node->nr);
+    } else {
+      i++;
+    }
+  }
+  for(i=0;i<nrtimers;i++) {
+    if(rules_timer_find(saved_timers[i].nr) > -1) {
+      timerqueue_restore(&saved_timers[i]);
+    }
+  }
+  FREE(saved_timers);
+  nrtimers = 0;
+}
+
+static void rules_globals_free(void) {
+  int i = 0;
+
+  for(i=0;i<nrsaved;i++) {
+    FREE(saved_globals[i].name);
+    if(saved_globals[i].type == VCHAR) {
+      FREE(saved_globals[i].value.s);
+    }
+  }
+  FREE(saved_globals);
+  nrsaved = 0;
+}
+
+/*
+ * Copies the global variables before the
+ * rules they are linked to are released.
+ */
+static void rules_globals_save(void) {
+  struct vm_gvnull_t *val = NULL;
+  struct vm_tvar_t *var = NULL;
+  unsigned int x = 0, len = 0;
+
+  rules_globals_free();
+
+  for(x=4;alignedbytes(x)<global_varstack.nrbytes;x++) {
+    x = alignedbytes(x);
+    val = (struct vm_gvnull_t *)&global_varstack.stack[x];
+    switch(val->type) {
+      case VINTEGER: {
+        len = sizeof(struct vm_gvinteger_t);
+      } break;
+      case VFLOAT: {
+        len = sizeof(struct vm_gvfloat_t);
+      } break;
+      case VNULL: {
+        len = sizeof(struct vm_gvnull_t);
+      } break;
+      case VCHAR: {
+        len = sizeof(struct vm_gvchar_t);
+      } break;
+      default: {
+        return;
+      } break;
+    }
+    x += len-1;
+
+    if(val->type == VNULL || val->rule == 0 || val->rule > nrrules) {
+      continue;
+    }
+
+    if((saved_globals = (struct rules_global_t *)REALLOC(saved_globals, sizeof(struct rules_global_t)*(nrsaved+1))) == NULL) {
+      OUT_OF_MEMORY /*LCOV_EXCL_LINE*/
+    }
+    struct rules_global_t *global = &saved_globals[nrsaved++];
+    memset(global, 0, sizeof(struct rules_global_t));
+
+    var = (struct vm_tvar_t *)&rules[val->rule-1]->ast.buffer[val->ret];
+    if((global->name = STRDUP((char *)var->token)) == NULL) {
+      OUT_OF_MEMORY /*LCOV_EXCL_LINE*/
+    }
+    global->type = val->type;
+    switch(val->type) {
+      case VINTEGER: {
+        global->value.i = ((struct vm_gvinteger_t *)val)->value;
+      } break;
+      case VFLOAT: {
+        global->value.f = ((struct vm_gvfloat_t *)val)->value;
+      } break;
+      case VCHAR: {
+        if((global->value.s = STRDUP(((struct vm_gvchar_t *)val)->value)) == NULL) {
+          OUT_OF_MEMORY /*LCOV_EXCL_LINE*/
+        }
+      } break;
+    }
+  }
+}
+
+/*
+ * Links a saved global variable to the first
+ * variable token of the new ruleset using it.
+ */
+static void rules_globals_restore(struct rules_t *obj, uint16_t token) {
+  struct vm_tvar_t *node = (struct vm_tvar_t *)&obj->ast.buffer[token];
+  struct varstack_t *varstack = &global_varstack;
+  unsigned int ret = varstack->nrbytes, size = 0;
+  int i = 0;
+
+  for(i=0;i<nrsaved;i++) {
+    if(saved_globals[i].name != NULL && stricmp(saved_globals[i].name, (char *)node->token) == 0) {
+      break;
+    }
+  }
+  if(i == nrsaved) {
+    return;
+  }
+
+  struct rules_global_t *global = &saved_globals[i];
+  switch(global->type) {
+    case VINTEGER: {
+      size = alignedbytes(varstack->nrbytes + sizeof(struct vm_gvinteger_t));
+    } break;
+    case VFLOAT: {
+      size = alignedbytes(varstack->nrbytes + sizeof(struct vm_gvfloat_t));
+    } break;
+    case VCHAR: {
+      size = alignedbytes(varstack->nrbytes + sizeof(struct vm_gvchar_t));
+    } break;
+  }
+  if((varstack->stack = vm_varstack_resize(varstack, alignedbuffer(size))) == NULL) {
+    OUT_OF_MEMORY /*LCOV_EXCL_LINE*/
+  }
+
+  struct vm_gvnull_t *value = (struct vm_gvnull_t *)&varstack->stack[ret];
+  value->type = global->type;
+  value->ret = token;
+  value->rule = obj->nr;
+  switch(global->type) {
+    case VINTEGER: {
+      ((struct vm_gvinteger_t *)value)->value = global->value.i;
+    } break;
+    case VFLOAT: {
+      ((struct vm_gvfloat_t *)value)->value = global->value.f;
+    } break;
+    case VCHAR: {
+      ((struct vm_gvchar_t *)value)->value = global->value.s;
+      global->value.s = NULL;
+    } break;
+  }
+  node->value = ret;
+
+  varstack->nrbytes = size;
+  varstack->bufsize = alignedbuffer(size);
+
+  FREE(global->name);
+}
+
+/*
+ * Releases the string copies held
+ * by the variables of a varstack.
+ */
+static void vm_values_free(struct varstack_t *varstack, uint8_t global) {
+  int x = 0;
+
+  for(x=4;alignedbytes(x)<varstack->nrbytes;x++) {
+    x = alignedbytes(x);
+    switch(varstack->stack[x]) {
+      case VINTEGER: {
+        x += (global ? sizeof(struct vm_gvinteger_t) : sizeof(struct vm_vinteger_t))-1;
+      } break;
+      case VFLOAT: {
+        x += (global ? sizeof(struct vm_gvfloat_t) : sizeof(struct vm_vfloat_t))-1;
+      } break;
+      case VNULL: {
+        x += (global ? sizeof(struct vm_gvnull_t) : sizeof(struct vm_vnull_t))-1;
+      } break;
+      case VCHAR: {
+        if(global) {
+          struct vm_gvchar_t *val = (struct vm_gvchar_t *)&varstack->stack[x];
+          FREE(val->value);
+          x += sizeof(struct vm_gvchar_t)-1;
+        } else {
+          struct vm_lvchar_t *val = (struct vm_lvchar_t *)&varstack->stack[x];
+          FREE(val->value);
+          x += sizeof(struct vm_lvchar_t)-1;
+        }
+      } break;
+      default: {
+        return;
+      } break;
+    }
+  }
+}
+
+/*
+ * Moves the local variable stacks of all rules
+ * into the mempool. A rule holds at most one value
+ * for each local variable token, so that's the
+ * room it gets. Returns the bytes taken.
+ */
+static unsigned int rules_varstack_compact(unsigned char *buffer, unsigned int size) {
+  struct varstack_t *varstack = NULL;
+  unsigned int len = 0, slot = alignedbytes(sizeof(struct vm_lvchar_t));
+  int i = 0;
+
+  if(alignedbytes(sizeof(struct vm_vinteger_t)) > slot) {
+    slot = alignedbytes(sizeof(struct vm_vinteger_t));
+  }
+  if(alignedbytes(sizeof(struct vm_vfloat_t)) > slot) {
+    slot = alignedbytes(sizeof(struct vm_vfloat_t));
+  }
+
+  for(i=0;i<nrrules;i++) {
+    varstack = (struct varstack_t *)rules[i]->userdata;
+    unsigned int need = alignedbuffer(4 + (varstack->nrvars * slot));
+
+    if(need < alignedbuffer(varstack->nrbytes)) {
+      need = alignedbuffer(varstack->nrbytes);
+    }
+    if(varstack->capacity > 0 || len + need > size) {
+      continue;
+    }
+
+    if(varstack->stack != NULL) {
+      memcpy(&buffer[len], varstack->stack, varstack->nrbytes);
+      FREE(varstack->stack);
+    }
+    varstack->stack = &buffer[len];
+    varstack->capacity = need;
+    len += need;
+  }
+  return len;
+}
+
+/*
+ * Reads a ruleset to the end of the pool and
+ * parses it into bytecode from the start of it.
+ * Only the parse times of the running ruleset
+ * are recorded.
+ */
+static int rules_compile(File *frules, unsigned char *pool, unsigned int size, struct rules_t ***list, int *nr, struct pbuf *mem) {
 #define BUFFER_SIZE 128
-    char content[BUFFER_SIZE];
+  char content[BUFFER_SIZE];
+  memset(content, 0, BUFFER_SIZE);
+  int len = frules->size();
+  int chunk = 0, len1 = 0;
+
+  unsigned int txtoffset = alignedbuffer(size-len-5);
+
+  while(1) {
     memset(content, 0, BUFFER_SIZE);
-    int len = frules.size();
-    int chunk = 0, len1 = 0;
-
-    unsigned int txtoffset = alignedbuffer(MEMPOOL_SIZE-len-5);
-
-    while(1) {
-      memset(content, 0, BUFFER_SIZE);
-      frules.seek(chunk*BUFFER_SIZE, SeekSet);
-      if (chunk * BUFFER_SIZE <= len) {
-        frules.readBytes(content, BUFFER_SIZE);
-        len1 = BUFFER_SIZE;
-      } else if ((chunk * BUFFER_SIZE) >= len && (chunk * BUFFER_SIZE) <= len + BUFFER_SIZE) {
-        frules.readBytes(content, len - ((chunk - 1)*BUFFER_SIZE));
-        len1 = len - ((chunk - 1) * BUFFER_SIZE);
-      } else {
-        break;
-      }
-      memcpy(&mempool[txtoffset+(chunk*BUFFER_SIZE)], &content, alignedbuffer(len1));
-      chunk++;
+    frules->seek(chunk*BUFFER_SIZE, SeekSet);
+    if (chunk * BUFFER_SIZE <= len) {
+      frules->readBytes(content, BUFFER_SIZE);
+      len1 = BUFFER_SIZE;
+    } else if ((chunk * BUFFER_SIZE) >= len && (chunk * BUFFER_SIZE) <= len + BUFFER_SIZE) {
+      frules->readBytes(content, len - ((chunk - 1)*BUFFER_SIZE));
+      len1 = len - ((chunk - 1) * BUFFER_SIZE);
+    } else {
+      break;
     }
-    frules.close();
+    memcpy(&pool[txtoffset+(chunk*BUFFER_SIZE)], &content, alignedbuffer(len1));
+    chunk++;
+  }
 
-    struct varstack_t *varstack = (struct varstack_t *)MALLOC(sizeof(struct varstack_t));
+  struct varstack_t *varstack = (struct varstack_t *)MALLOC(sizeof(struct varstack_t));
+  if(varstack == NULL) {
+    OUT_OF_MEMORY
+  }
+  varstack->stack = NULL;
+  varstack->nrbytes = 4;
+  varstack->bufsize = 4;
+  varstack->capacity = 0;
+  varstack->nrvars = 0;
+
+  struct pbuf input;
+  memset(mem, 0, sizeof(struct pbuf));
+  memset(&input, 0, sizeof(struct pbuf));
+
+  mem->payload = pool;
+  mem->len = 0;
+  mem->tot_len = size;
+
+  input.payload = &pool[txtoffset];
+  input.len = txtoffset;
+  input.tot_len = len;
+
+  int ret = 0;
+  unsigned long start = micros();
+  while((ret = rule_initialize(&input, list, nr, mem, varstack)) == 0) {
+    if(pool == mempool) {
+      rules_stats_add(*nr, micros() - start);
+    }
+    varstack = (struct varstack_t *)MALLOC(sizeof(struct varstack_t));
     if(varstack == NULL) {
       OUT_OF_MEMORY
     }
     varstack->stack = NULL;
     varstack->nrbytes = 4;
     varstack->bufsize = 4;
+    varstack->capacity = 0;
+    varstack->nrvars = 0;
+    input.payload = &pool[input.len];
+    start = micros();
+  }
 
-    struct pbuf mem;
-    struct pbuf input;
-    memset(&mem, 0, sizeof(struct pbuf));
-    memset(&input, 0, sizeof(struct pbuf));
-
-    mem.payload = mempool;
-    mem.len = 0;
-    mem.tot_len = MEMPOOL_SIZE;
-
-    input.payload = &mempool[txtoffset];
-    input.len = txtoffset;
-    input.tot_len = len;
-
-    int ret = 0;
-    char *text = (char *)&mempool[txtoffset];
-    while((ret = rule_initialize(&input, &rules, &nrrules, &mem, varstack)) == 0) {
-      varstack = (struct varstack_t *)MALLOC(sizeof(struct varstack_t));
-      if(varstack == NULL) {
-        OUT_OF_MEMORY
+  /*
+   * Either the spare varstack for the next rule
+   * or the one of the rule that failed to parse.
+   */
+  FREE(varstack);
+
+  if(ret == -1) {
+    if(*nr > 0) {
+      for(int i=0;i<*nr-1;i++) {
+        if((*list)[i]->userdata != NULL) {
+          vm_values_free((struct varstack_t *)(*list)[i]->userdata, 0);
+          FREE(((struct varstack_t *)(*list)[i]->userdata)->stack);
+          FREE((*list)[i]->userdata);
+        }
       }
-      varstack->stack = NULL;
-      varstack->nrbytes = 4;
-      varstack->bufsize = 4;
-      input.payload = &mempool[input.len];
+      rules_gc(list, *nr);
     }
+    *list = NULL;
+    *nr = 0;
+    return -1;
+  }
+  return 0;
+}
 
-    logprintf_P(F("rules memory used: %d / %d"), mem.len, mem.tot_len);
+/*
+ * Parses a new ruleset next to the running one,
+ * so a broken ruleset is found before the running
+ * one is released. The state the validation writes
+ * to is swapped out meanwhile. Returns 1 when there
+ * is no memory to check the ruleset this way.
+ */
+int rules_check(char *file) {
+  struct varstack_t globals = global_varstack;
+  struct strpool_t strings = rule_strings;
+  struct rules_t **running = rules;
+  struct pbuf mem;
+  unsigned char *pool = NULL;
+  int nrrunning = nrrules, ret = 0, i = 0;
+
+  File frules = LittleFS.open(file, "r");
+  if(!frules) {
+    return -1;
+  }
+  if((pool = (unsigned char *)MALLOC(MEMPOOL_SIZE)) == NULL) {
+    frules.close();
+    return 1;
+  }
+  memset(pool, 0, MEMPOOL_SIZE);
+
+  parsing = 1;
+  rules_timers_save();
+
+  rules = NULL;
+  nrrules = 0;
+  strpool_init(&rule_strings, NULL, 0);
+  global_varstack.stack = NULL;
+  global_varstack.nrbytes = 4;
 
-    if(nrrules > 1) {
-      FREE(varstack);
+  ret = rules_compile(&frules, pool, MEMPOOL_SIZE, &rules, &nrrules, &mem);
+  frules.close();
+
+  for(i=0;i<nrrules;i++) {
+    if(rules[i]->userdata != NULL) {
+      vm_values_free((struct varstack_t *)rules[i]->userdata, 0);
+      FREE(((struct varstack_t *)rules[i]->userdata)->stack);
+      FREE(rules[i]->userdata);
     }
+  }
+  if(nrrules > 0) {
+    rules_gc(&rules, nrrules);
+  }
+  vm_values_free(&global_varstack, 1);
+  FREE(global_varstack.stack);
+  FREE(pool);
+
+  global_varstack = globals;
+  rule_strings = strings;
+  rules = running;
+  nrrules = nrrunning;
+
+  rules_timers_restore();
+  parsing = 0;
+
+  return ret;
+}
+
+int rules_parse(char *file) {
+  File frules = LittleFS.open(file, "r");
+  if(frules) {
+    parsing = 1;
 
     /*
-     * Clear all timers
+     * The string pool lives in the part of the
+     * mempool that is left after parsing.
      */
-    struct timerqueue_t *node = NULL;
-    while((node = timerqueue_pop()) != NULL) {
-      FREE(node);
+    strpool_init(&rule_strings, NULL, 0);
+    rollstat_init(NULL, 0);
+    bytecode_pool = 0;
+    varstack_pool = 0;
+
+    /*
+     * The global variables and timers are carried
+     * over to the new ruleset. When it fails to parse,
+     * they are kept for the ruleset parsed after it.
+     */
+    if(nrrules > 0) {
+      rules_globals_save();
+      rules_timers_save();
     }
 
+    if(nrrules > 0) {
+      for(int i=0;i<nrrules;i++) {
+        if(rules[i]->userdata != NULL) {
+          struct varstack_t *varstack = (struct varstack_t *)rules[i]->userdata;
+          vm_values_free(varstack, 0);
+          if(varstack->capacity == 0) {
+            FREE(varstack->stack);
+          }
+          FREE(rules[i]->userdata);
+        }
+      }
+      rules_gc(&rules, nrrules);
+      nrrules = 0;
+    }
+    memset(mempool, 0, MEMPOOL_SIZE);
+    FREE(rules_stats);
+    nrstats = 0;
+    memset(&pending, 0, sizeof(pending));
+    nrpending = 0;
+    suspended = -1;
+    suspended_time = 0;
+    memset(&deferred, 0, sizeof(deferred));
+    nrdeferred = 0;
+    rules_commands_clear();
+
+    vm_values_free(&global_varstack, 1);
+    FREE(global_varstack.stack);
+    global_varstack.stack = NULL;
+    global_varstack.nrbytes = 4;
+
+    struct pbuf mem;
+    int ret = rules_compile(&frules, mempool, MEMPOOL_SIZE, &rules, &nrrules, &mem);
+    frules.close();
+
+    logprintf_P(F("rules memory used: %d / %d"), mem.len, mem.tot_len);
+    bytecode_pool = mem.len;
+
+    vm_values_free(&global_varstack, 1);
     FREE(global_varstack.stack);
     global_varstack.stack = NULL;
     global_varstack.nrbytes = 4;
 
     if(ret == -1) {
-      if(nrrules > 0) {
-        for(int i=0;i<nrrules-1;i++) {
-          if(rules[i]->userdata != NULL) {
-            FREE(rules[i]->userdata);
-          }
-        }
-        rules_gc(&rules, nrrules);
-      }
-      nrrules = 0;
+      parsing = 0;
       return -1;
     }
 
+    /*
+     * The windows of the rolling statistics come
+     * first in the part of the mempool left after
+     * parsing, the string pool gets the rest.
+     */
+    unsigned int pool = alignedbuffer(mem.len);
+    if(pool < MEMPOOL_SIZE) {
+      rollstat_init(&mempool[pool], MEMPOOL_SIZE-pool);
+    }
+
     int i = 0;
     for(i=0;i<nrrules;i++) {
       vm_clear_values(rules[i]);
     }
+
+    pool += rollstat_used();
+    if(pool < MEMPOOL_SIZE) {
+      varstack_pool = rules_varstack_compact(&mempool[pool], MEMPOOL_SIZE-pool);
+      pool += varstack_pool;
+    }
+    if(pool < MEMPOOL_SIZE) {
+      strpool_init(&rule_strings, &mempool[pool], MEMPOOL_SIZE-pool);
+    }
+    if(rollstat_used() > 0) {
+      logprintf_P(F("rules rolling statistics: %d bytes"), rollstat_used());
+    }
+    logprintf_P(F("rules local variables: %d bytes"), varstack_pool);
+
+    rules_timers_restore();
+    rules_globals_free();
+    logprintf_P(F("rules string pool: %d bytes"), rule_strings.size);
+
     parsing = 0;
     return 0;
   } else {
@@ -1548,6 +2640,120 @@ int rules_parse(char *file) {
   }
 }
 
+static void rules_event_run(uint8_t i) {
+  struct vm_tevent_t *event = (struct vm_tevent_t *)&rules[i]->ast.buffer[get_event(rules[i])];
+
+  if(suspended > -1) {
+    rules_defer(i);
+    return;
+  }
+
+  if(rules_trace_get(i) == RULES_TRACE_FULL) {
+    logprintf_P(F("%s %s %s"), F("===="), event->token, F("===="));
+    logprintf_P(F("%s %d %s %d"), F(">>> rule"), i, F("nrbytes:"), rules[i]->ast.nrbytes);
+    logprintf_P(F("%s %d"), F(">>> global stack nrbytes:"), global_varstack.nrbytes);
+  }
+
+  rules_exec(i, rules[i]);
+}
+
+/*
+ * Continues the suspended rule run, or else
+ * starts the next deferred rule. Each pass
+ * runs at most one step budget.
+ */
+void rules_loop(void) {
+  uint8_t i = 0;
+
+  if(suspended > -1) {
+    for(i=0;i<nrrules;i++) {
+      if(rules[i]->suspended == 1) {
+        rules_exec(suspended, rules[i]);
+        return;
+      }
+    }
+    suspended = -1;
+    suspended_time = 0;
+  }
+
+  for(i=0;i<nrrules && nrdeferred > 0;i++) {
+    if(deferred[i >> 3] & (1 << (i & 7))) {
+      deferred[i >> 3] &= ~(1 << (i & 7));
+      nrdeferred--;
+      rules_event_run(i);
+      return;
+    }
+  }
+}
+
+static void rules_sample_push(struct rollstat_t *stat, const char *str, uint32_t now) {
+  char *end = NULL;
+  float value = strtof(str, &end);
+
+  if(end != str) {
+    rollstat_push(stat, value, now);
+  }
+}
+
+/*
+ * Adds the new value of each topic with a rolling
+ * window to that window, called once for every
+ * datagram of the given kind that was decoded.
+ */
+void rules_sample(uint8_t data) {
+  struct rollstat_t *stat = NULL;
+  uint32_t now = millis();
+
+  while((stat = rollstat_next(stat)) != NULL) {
+    int i = SYM_INDEX(stat->id);
+    switch(SYM_KIND(stat->id)) {
+      case SYM_TOPIC: {
+        if(data == RULES_DATA_MAIN) {
+          String dataValue = getDataValue(actData, i);
+          rules_sample_push(stat, dataValue.c_str(), now);
+        }
+      } break;
+      case SYM_OPTTOPIC: {
+        if(data == RULES_DATA_OPT) {
+          String dataValue = getOptDataValue(actOptData, i);
+          rules_sample_push(stat, dataValue.c_str(), now);
+        }
+      } break;
+      case SYM_XTOPIC: {
+        if(data == RULES_DATA_EXTRA) {
+          String dataValue = getDataValueExtra(actDataExtra, i);
+          rules_sample_push(stat, dataValue.c_str(), now);
+        }
+      } break;
+    }
+  }
+}
+
+/*
+ * While batching, each rule triggered by one
+ * or more events is only marked and run once
+ * by rules_event_batch_flush.
+ */
+void rules_event_batch_start(void) {
+  batching = 1;
+}
+
+void rules_event_batch_flush(void) {
+  uint8_t i = 0;
+
+  batching = 0;
+
+  for(i=0;i<nrrules && nrpending > 0;i++) {
+    if(pending[i >> 3] & (1 << (i & 7))) {
+      pending[i >> 3] &= ~(1 << (i & 7));
+      nrpending--;
+      rules_event_run(i);
+    }
+  }
+  memset(&pending, 0, sizeof(pending));
+  nrpending = 0;
+}
+
 void rules_event_cb(const char *prefix, const char *name) {
   uint8_t i = 0, len = strlen(name), len1 = strlen(prefix), tlen = 0;
   for(i=0;i<nrrules;i++) {
@@ -1562,27 +2768,11 @@ void rules_event_cb(const char *prefix, const char *name) {
             strnicmp((char *)&event->token[len1], name, len) == 0
           )
         ) {
-        char out[512];
-        logprintf_P(F("%s %s %s"), F("===="), event->token, F("===="));
-        logprintf_P(F("%s %d %s %d"), F(">>> rule"), i, F("nrbytes:"), rules[i]->ast.nrbytes);
-        logprintf_P(F("%s %d"), F(">>> global stack nrbytes:"), global_varstack.nrbytes);
+        rules_stats_trigger(i, RULES_TRIGGER_EVENT);
 
-        rules[i]->timestamp.first = micros();
-
-        rule_run(rules[i], 0);
-
-        rules[i]->timestamp.second = micros();
-
-        logprintf_P(F("%s%d %s %d %s"), F("rule #"), rules[i]->nr, F("was executed in"), rules[i]->timestamp.second - rules[i]->timestamp.first, F("microseconds"));
-
-        logprintln_P(F("\n>>> local variables"));
-        memset(&out, 0, sizeof(out));
-        vm_value_prt(rules[i], (char *)&out, sizeof(out));
-        logprintln(out);
-        logprintln_P(F(">>> global variables"));
-        memset(&out, 0, sizeof(out));
-        vm_global_value_prt((char *)&out, sizeof(out));
-        logprintln(out);
+        if(batching == 0 || rules_pending(i) == -1) {
+          rules_event_run(i);
+        }
         break;
       }
     }
@@ -1592,10 +2782,6 @@ void rules_event_cb(const char *prefix, const char *name) {
   //  rules[i]->varstack.nrbytes = 4;
   //  rules[i]->varstack.bufsize = 4;
   //}
-  int x = 0;
-  for(i=0;i<nrrules;i++) {
-    x += rules[i]->ast.nrbytes;
-  }
 }
 
 void rules_boot(void) {
@@ -1604,27 +2790,20 @@ void rules_boot(void) {
     if(rules[i]->ast.buffer[start->go] == TEVENT) {
       struct vm_tevent_t *event = (struct vm_tevent_t *)&rules[i]->ast.buffer[start->go];
       if(stricmp((char *)&event->token, "System#Boot") == 0) {
-        char out[512];
-        logprintf_P(F("==== SYSTEM#BOOT ===="));
-        logprintf_P(F("%s %d %s %d"), F(">>> rule"), i, F("nrbytes:"), rules[i]->ast.nrbytes);
-        logprintf_P(F("%s %d"), F(">>> global stack nrbytes:"), global_varstack.nrbytes);
-
-        rules[i]->timestamp.first = micros();
-
-        rule_run(rules[i], 0);
+        rules_stats_trigger(i, RULES_TRIGGER_BOOT);
 
-        rules[i]->timestamp.second = micros();
+        if(suspended > -1) {
+          rules_defer(i);
+          break;
+        }
 
-        logprintf_P(F("%s%d %s %d %s"), F("rule #"), rules[i]->nr, F("was executed in"), rules[i]->timestamp.second - rules[i]->timestamp.first, F("microseconds"));
+        if(rules_trace_get(i) == RULES_TRACE_FULL) {
+          logprintf_P(F("==== SYSTEM#BOOT ===="));
+          logprintf_P(F("%s %d %s %d"), F(">>> rule"), i, F("nrbytes:"), rules[i]->ast.nrbytes);
+          logprintf_P(F("%s %d"), F(">>> global stack nrbytes:"), global_varstack.nrbytes);
+        }
 
-        logprintln_P(F("\n>>> local variables"));
-        memset(&out, 0, sizeof(out));
-        vm_value_prt(rules[i], (char *)&out, sizeof(out));
-        logprintln(out);
-        logprintln_P(F(">>> global variables"));
-        memset(&out, 0, sizeof(out));
-        vm_global_value_prt((char *)&out, sizeof(out));
-        logprintln(out);
+        rules_exec(i, rules[i]);
         break;
       }
     }
@@ -1651,6 +2830,8 @@ void rules_setup(void) {
   global_varstack.stack = NULL;
   global_varstack.nrbytes = 4;
 
+  rules_symbols_build();
+
   memset(&rule_options, 0, sizeof(struct rule_options_t));
   rule_options.is_token_cb = is_variable;
   rule_options.is_event_cb = is_event;
@@ -1660,6 +2841,7 @@ void rules_setup(void) {
   rule_options.cpy_token_val_cb = vm_value_cpy;
   rule_options.clr_token_val_cb = vm_value_clr;
   rule_options.event_cb = event_cb;
+  rule_options.max_steps = RULES_MAX_STEPS;
 
   // if(LittleFS.exists("/rules.new")) {
     // logprintln_P(F("new ruleset found, trying to parse it"));
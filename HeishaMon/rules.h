@@ -17,11 +17,56 @@
 
 #include "src/common/mem.h"
 
+#define RULES_STATS_BUCKETS 8
+
+#define RULES_TRIGGER_EVENT 0
+#define RULES_TRIGGER_TIMER 1
+#define RULES_TRIGGER_BOOT  2
+#define RULES_TRIGGER_CALL  3
+#define RULES_TRIGGERS      4
+
+/*
+ * Default number of steps a rule may take
+ * before it yields to the main loop.
+ */
+#define RULES_MAX_STEPS     1000
+
+#define RULES_DATA_MAIN     0
+#define RULES_DATA_OPT      1
+#define RULES_DATA_EXTRA    2
+
+#define RULES_TRACE_OFF     0
+#define RULES_TRACE_SUMMARY 1
+#define RULES_TRACE_FULL    2
+
+typedef struct rules_stats_t {
+  uint32_t invocations;
+  uint32_t total;
+  uint32_t min;
+  uint32_t max;
+  uint16_t histogram[RULES_STATS_BUCKETS];
+  uint16_t stack;
+  uint16_t triggers[RULES_TRIGGERS];
+  uint16_t preempted;
+  uint32_t parse;
+} rules_stats_t;
+
 void rules_loop(void);
 void rules_boot(void);
 int rules_parse(char *file);
+int rules_check(char *file);
 void rules_setup(void);
 void rules_timer_cb(int nr);
 void rules_event_cb(const char *prefix, const char *name);
+void rules_event_batch_start(void);
+void rules_event_batch_flush(void);
+void rules_sample(uint8_t data);
+int rules_count(void);
+int rules_stats_json(int nr, char *out, int size);
+int rules_memory_json(char *out, int size);
+void rules_stats_summary(unsigned long *invocations, unsigned long *total, int *slowest, unsigned long *preempted);
+void rules_max_steps(unsigned int steps);
+void rules_trace_level(uint8_t level);
+int rules_trace_toggle(int nr);
 
 #endif
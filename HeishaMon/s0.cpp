@@ -268,3 +268,27 @@ void s0JsonOutput(struct webserver_t *client) {
   }
   webserver_send_content_P(client, PSTR("]"), 1);
 }
+
+void s0MetricsOutput(struct webserver_t *client) {
+  char str[128];
+  int len = 0;
+
+  webserver_send_content_P(client, PSTR("# HELP heishamon_s0_watt Power measured on the S0 port.\n# TYPE heishamon_s0_watt gauge\n"), 87);
+  for (int i = 0; i < NUM_S0_COUNTERS; i++) {
+    len = snprintf_P(str, sizeof(str), PSTR("heishamon_s0_watt{port=\"%d\"} %u\n"), i + 1, actS0Data[i].watt);
+    webserver_send_content(client, str, len);
+  }
+
+  webserver_send_content_P(client, PSTR("# HELP heishamon_s0_watthour_total Energy counted on the S0 port since boot.\n# TYPE heishamon_s0_watthour_total counter\n"), 120);
+  for (int i = 0; i < NUM_S0_COUNTERS; i++) {
+    len = snprintf_P(str, sizeof(str), PSTR("heishamon_s0_watthour_total{port=\"%d\"} %lu\n"), i + 1, (unsigned long)(actS0Data[i].pulsesTotal * (1000.0 / actS0Settings[i].ppkwh)));
+    webserver_send_content(client, str, len);
+  }
+
+  webserver_send_content_P(client, PSTR("# HELP heishamon_s0_pulses_total Pulses seen on the S0 port.\n# TYPE heishamon_s0_pulses_total counter\n"), 102);
+  for (int i = 0; i < NUM_S0_COUNTERS; i++) {
+    len = snprintf_P(str, sizeof(str), PSTR("heishamon_s0_pulses_total{port=\"%d\",result=\"good\"} %lu\nheishamon_s0_pulses_total{port=\"%d\",result=\"bad\"} %lu\n"),
+                     i + 1, actS0Data[i].goodPulses, i + 1, actS0Data[i].badPulses);
+    webserver_send_content(client, str, len);
+  }
+}
@@ -29,3 +29,4 @@ void restore_s0_Watthour(int s0Port, float watthour);
 void s0Loop(PubSubClient &mqtt_client, void (*log_message)(char*), char* mqtt_topic_base, s0SettingsStruct s0Settings[]);
 void s0TableOutput(struct webserver_t *client);
 void s0JsonOutput(struct webserver_t *client);
+void s0MetricsOutput(struct webserver_t *client);
@@ -0,0 +1,245 @@
+/*
+  Copyright (C) CurlyMo
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "stricmp.h"
+#include "rollstat.h"
+
+static unsigned char *arena = NULL;
+static unsigned int arena_size = 0;
+static unsigned int arena_len = 0;
+static unsigned int arena_pad = 0;
+static struct rollstat_t *rollstats = NULL;
+
+static unsigned int rollstat_align(unsigned int v) {
+  return (v + 3) & ~3;
+}
+
+void rollstat_init(unsigned char *buffer, unsigned int size) {
+  arena_pad = 0;
+
+  /*
+   * The windows hold pointers and floats,
+   * so the arena must be word aligned.
+   */
+  while(((uintptr_t)buffer % 4) != 0 && size > 0) {
+    buffer++;
+    size--;
+    arena_pad++;
+  }
+
+  arena = buffer;
+  arena_size = (buffer == NULL) ? 0 : size;
+  arena_len = 0;
+  rollstats = NULL;
+}
+
+/*
+ * Number of bytes taken from the buffer
+ * given to rollstat_init.
+ */
+unsigned int rollstat_used(void) {
+  return (arena_len > 0) ? arena_len + arena_pad : 0;
+}
+
+struct rollstat_t *rollstat_find(const char *name, uint8_t size) {
+  struct rollstat_t *stat = rollstats;
+
+  while(stat != NULL) {
+    if(stat->size == size && stricmp(stat->name, name) == 0) {
+      return stat;
+    }
+    stat = stat->next;
+  }
+  return NULL;
+}
+
+struct rollstat_t *rollstat_next(struct rollstat_t *stat) {
+  if(stat == NULL) {
+    return rollstats;
+  }
+  return stat->next;
+}
+
+/*
+ * Windows of the same name and size are shared,
+ * returns NULL when the arena is full.
+ */
+struct rollstat_t *rollstat_track(const char *name, uint16_t id, uint8_t size) {
+  struct rollstat_t *stat = NULL, *tail = rollstats;
+  unsigned int need = rollstat_align(sizeof(struct rollstat_t)) + (size * sizeof(float)) + (size * sizeof(uint32_t));
+
+  if(size < ROLLSTAT_MIN_WINDOW) {
+    return NULL;
+  }
+
+  if((stat = rollstat_find(name, size)) != NULL) {
+    return stat;
+  }
+
+  if(arena_len + need > arena_size) {
+    return NULL;
+  }
+
+  stat = (struct rollstat_t *)&arena[arena_len];
+  memset(stat, 0, sizeof(struct rollstat_t));
+  stat->name = name;
+  stat->id = id;
+  stat->size = size;
+  stat->values = (float *)&arena[arena_len + rollstat_align(sizeof(struct rollstat_t))];
+  stat->stamps = (uint32_t *)&stat->values[size];
+
+  arena_len += need;
+
+  if(tail == NULL) {
+    rollstats = stat;
+  } else {
+    while(tail->next != NULL) {
+      tail = tail->next;
+    }
+    tail->next = stat;
+  }
+
+  return stat;
+}
+
+/*
+ * Adding a sample only touches the running sum and
+ * the cached extremes. When the sample that falls out
+ * of the window was one of the extremes they are marked
+ * dirty and rescanned on the next min or max query.
+ */
+void rollstat_push(struct rollstat_t *stat, float value, uint32_t now) {
+  unsigned int i = 0;
+
+  if(stat->len == stat->size) {
+    float old = stat->values[stat->pos];
+    stat->sum -= old;
+    if(old <= stat->min || old >= stat->max) {
+      stat->dirty = 1;
+    }
+  } else {
+    stat->len++;
+  }
+
+  stat->values[stat->pos] = value;
+  stat->stamps[stat->pos] = now;
+  stat->sum += value;
+
+  if(stat->len == 1) {
+    stat->min = value;
+    stat->max = value;
+    stat->dirty = 0;
+  } else if(stat->dirty == 0) {
+    if(value < stat->min) {
+      stat->min = value;
+    }
+    if(value > stat->max) {
+      stat->max = value;
+    }
+  }
+
+  stat->pos = (stat->pos + 1) % stat->size;
+
+  /*
+   * Rebuild the sum once per round to
+   * prevent float rounding errors to add up.
+   */
+  if(stat->pos == 0) {
+    stat->sum = 0;
+    for(i=0;i<stat->len;i++) {
+      stat->sum += stat->values[i];
+    }
+  }
+}
+
+int rollstat_avg(struct rollstat_t *stat, float *out) {
+  if(stat->len == 0) {
+    return -1;
+  }
+  *out = stat->sum / stat->len;
+  return 0;
+}
+
+static void rollstat_rescan(struct rollstat_t *stat) {
+  unsigned int i = 0;
+
+  stat->min = stat->values[0];
+  stat->max = stat->values[0];
+  for(i=1;i<stat->len;i++) {
+    if(stat->values[i] < stat->min) {
+      stat->min = stat->values[i];
+    }
+    if(stat->values[i] > stat->max) {
+      stat->max = stat->values[i];
+    }
+  }
+  stat->dirty = 0;
+}
+
+int rollstat_min(struct rollstat_t *stat, float *out) {
+  if(stat->len == 0) {
+    return -1;
+  }
+  if(stat->dirty == 1) {
+    rollstat_rescan(stat);
+  }
+  *out = stat->min;
+  return 0;
+}
+
+int rollstat_max(struct rollstat_t *stat, float *out) {
+  if(stat->len == 0) {
+    return -1;
+  }
+  if(stat->dirty == 1) {
+    rollstat_rescan(stat);
+  }
+  *out = stat->max;
+  return 0;
+}
+
+/*
+ * Least squares slope of the samples in the
+ * window in units per minute. The sample times
+ * are taken relative to the oldest sample, so
+ * a wrapping clock doesn't matter.
+ */
+int rollstat_slope(struct rollstat_t *stat, float *out) {
+  unsigned int i = 0, first = (stat->len < stat->size) ? 0 : stat->pos;
+  float mx = 0, my = 0, sxx = 0, sxy = 0;
+
+  if(stat->len < 2) {
+    return -1;
+  }
+
+  for(i=0;i<stat->len;i++) {
+    unsigned int x = (first + i) % stat->size;
+    mx += (float)(stat->stamps[x] - stat->stamps[first]) / 60000;
+    my += stat->values[x];
+  }
+  mx /= stat->len;
+  my /= stat->len;
+
+  for(i=0;i<stat->len;i++) {
+    unsigned int x = (first + i) % stat->size;
+    float dx = ((float)(stat->stamps[x] - stat->stamps[first]) / 60000) - mx;
+    sxx += dx * dx;
+    sxy += dx * (stat->values[x] - my);
+  }
+
+  if(sxx <= 0) {
+    return -1;
+  }
+
+  *out = sxy / sxx;
+  return 0;
+}
@@ -0,0 +1,49 @@
+/*
+  Copyright (C) CurlyMo
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef _ROLLSTAT_H_
+#define _ROLLSTAT_H_
+
+#include <stdint.h>
+
+#define ROLLSTAT_MIN_WINDOW 2
+#define ROLLSTAT_MAX_WINDOW 255
+
+/*
+ * Ring buffer with the last samples of a value.
+ * The windows live in a caller provided buffer
+ * and are set up once, so adding a sample never
+ * allocates memory.
+ */
+typedef struct rollstat_t {
+  struct rollstat_t *next;
+  const char *name;
+  uint16_t id;
+  uint8_t size;
+  uint8_t len;
+  uint8_t pos;
+  uint8_t dirty;
+  float sum;
+  float min;
+  float max;
+  float *values;
+  uint32_t *stamps;
+} rollstat_t;
+
+void rollstat_init(unsigned char *buffer, unsigned int size);
+unsigned int rollstat_used(void);
+struct rollstat_t *rollstat_track(const char *name, uint16_t id, uint8_t size);
+struct rollstat_t *rollstat_find(const char *name, uint8_t size);
+struct rollstat_t *rollstat_next(struct rollstat_t *stat);
+void rollstat_push(struct rollstat_t *stat, float value, uint32_t now);
+int rollstat_avg(struct rollstat_t *stat, float *out);
+int rollstat_min(struct rollstat_t *stat, float *out);
+int rollstat_max(struct rollstat_t *stat, float *out);
+int rollstat_slope(struct rollstat_t *stat, float *out);
+
+#endif
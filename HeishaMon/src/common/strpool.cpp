@@ -0,0 +1,174 @@
+/*
+  Copyright (C) CurlyMo
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "strpool.h"
+
+/*
+ * Minimum number of hash slots, the
+ * index grows with one slot for every
+ * 32 bytes of the pool.
+ */
+#define STRPOOL_SLOTS_MIN 8
+
+static const char strpool_empty[] = "";
+
+static uint16_t strpool_hash(const char *str, unsigned int len) {
+  uint32_t hash = 2166136261UL;
+  unsigned int i = 0;
+
+  for(i=0;i<len;i++) {
+    hash ^= (uint8_t)str[i];
+    hash *= 16777619UL;
+  }
+  return (uint16_t)(hash ^ (hash >> 16));
+}
+
+/*
+ * Returns the interned copy of str or NULL.
+ * When it's not there, slot is set to the
+ * slot it should be stored in or -1 when
+ * the index is full.
+ */
+static const char *strpool_find(struct strpool_t *pool, const char *str, unsigned int len, int *slot) {
+  uint16_t *slots = (uint16_t *)pool->buffer;
+  uint16_t hash = strpool_hash(str, len), mask = pool->nrslots - 1, i = 0;
+
+  *slot = -1;
+
+  for(i=0;i<pool->nrslots;i++) {
+    uint16_t pos = (hash + i) & mask;
+    if(slots[pos] == 0) {
+      *slot = pos;
+      return NULL;
+    }
+    const char *tmp = (const char *)&pool->buffer[slots[pos]];
+    if(memcmp(tmp, str, len) == 0 && tmp[len] == '\0') {
+      return tmp;
+    }
+  }
+  return NULL;
+}
+
+void strpool_init(struct strpool_t *pool, unsigned char *buffer, unsigned int size) {
+  unsigned int nrslots = STRPOOL_SLOTS_MIN;
+
+  /*
+   * The index in front of the strings
+   * is read as 16 bits words.
+   */
+  while(((uintptr_t)buffer % sizeof(uint16_t)) != 0 && size > 0) {
+    buffer++;
+    size--;
+  }
+  if(size > 0xFFFF) {
+    size = 0xFFFF;
+  }
+
+  while(nrslots*2 <= size/32) {
+    nrslots *= 2;
+  }
+
+  pool->buffer = buffer;
+  pool->size = size;
+  pool->nrslots = nrslots;
+
+  if(buffer == NULL || size < nrslots*sizeof(uint16_t)*2) {
+    pool->size = 0;
+    pool->nrslots = 0;
+  }
+
+  strpool_reset(pool);
+}
+
+void strpool_reset(struct strpool_t *pool) {
+  if(pool->nrslots > 0) {
+    memset(pool->buffer, 0, pool->nrslots*sizeof(uint16_t));
+  }
+  pool->len = pool->nrslots*sizeof(uint16_t);
+}
+
+const char *strpool_intern(struct strpool_t *pool, const char *str, unsigned int len) {
+  const char *ret = NULL;
+  int slot = -1;
+
+  if(pool->buffer == NULL) {
+    return strpool_empty;
+  }
+  if(pool->nrslots == 0) {
+    return NULL;
+  }
+
+  if((ret = strpool_find(pool, str, len, &slot)) != NULL) {
+    return ret;
+  }
+  if(slot == -1 || pool->len + len + 1 > pool->size) {
+    return NULL;
+  }
+
+  char *cpy = (char *)&pool->buffer[pool->len];
+  memcpy(cpy, str, len);
+  cpy[len] = '\0';
+
+  ((uint16_t *)pool->buffer)[slot] = pool->len;
+  pool->len += len + 1;
+
+  return cpy;
+}
+
+/*
+ * The joined string is written at the end of the
+ * pool first. It's only kept when the result
+ * wasn't already interned.
+ */
+const char *strpool_concat(struct strpool_t *pool, const char *a, const char *b) {
+  unsigned int len1 = strlen(a), len2 = strlen(b);
+  const char *ret = NULL;
+  int slot = -1;
+
+  if(pool->buffer == NULL) {
+    return strpool_empty;
+  }
+  if(pool->nrslots == 0 || pool->len + len1 + len2 + 1 > pool->size) {
+    return NULL;
+  }
+
+  char *cpy = (char *)&pool->buffer[pool->len];
+  memmove(cpy, a, len1);
+  memmove(&cpy[len1], b, len2);
+  cpy[len1+len2] = '\0';
+
+  if((ret = strpool_find(pool, cpy, len1+len2, &slot)) != NULL) {
+    return ret;
+  }
+  if(slot == -1) {
+    return NULL;
+  }
+
+  ((uint16_t *)pool->buffer)[slot] = pool->len;
+  pool->len += len1 + len2 + 1;
+
+  return cpy;
+}
+
+const char *strpool_get(struct strpool_t *pool, uint16_t offset) {
+  if(pool->buffer == NULL) {
+    return strpool_empty;
+  }
+  return (const char *)&pool->buffer[offset];
+}
+
+uint16_t strpool_offset(struct strpool_t *pool, const char *str) {
+  if(pool->buffer == NULL) {
+    return 0;
+  }
+  return (uint16_t)((const unsigned char *)str - pool->buffer);
+}
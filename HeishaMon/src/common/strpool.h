@@ -0,0 +1,40 @@
+/*
+  Copyright (C) CurlyMo
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef _STRPOOL_H_
+#define _STRPOOL_H_
+
+#include <stdint.h>
+
+/*
+ * Interned strings in a caller provided buffer.
+ * Each string is stored only once, so two strings
+ * are equal when their pointers are. Strings are
+ * never freed on their own, the whole pool is
+ * emptied at once by strpool_reset.
+ *
+ * A pool without a buffer takes any string as
+ * an empty one. Code that only cares about the
+ * room a string takes, like the validation of
+ * a parsed rule, can run without a pool.
+ */
+typedef struct strpool_t {
+  unsigned char *buffer;
+  uint16_t size;
+  uint16_t len;
+  uint16_t nrslots;
+} strpool_t;
+
+void strpool_init(struct strpool_t *pool, unsigned char *buffer, unsigned int size);
+void strpool_reset(struct strpool_t *pool);
+const char *strpool_intern(struct strpool_t *pool, const char *str, unsigned int len);
+const char *strpool_concat(struct strpool_t *pool, const char *a, const char *b);
+const char *strpool_get(struct strpool_t *pool, uint16_t offset);
+uint16_t strpool_offset(struct strpool_t *pool, const char *str);
+
+#endif
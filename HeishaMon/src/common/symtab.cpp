@@ -0,0 +1,73 @@
+/*
+  Copyright (C) CurlyMo
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifdef ESP8266
+  #include <Arduino.h>
+#else
+  #define pgm_read_byte(a) (*(const uint8_t *)(a))
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "symtab.h"
+
+/*
+ * FNV-1a over the lowercased name,
+ * folded to 16 bits.
+ */
+uint16_t symtab_hash(const char *text, unsigned int len) {
+  uint32_t hash = 2166136261UL;
+  unsigned int i = 0;
+
+  for(i=0;i<len;i++) {
+    hash ^= (uint8_t)tolower(text[i]);
+    hash *= 16777619UL;
+  }
+  return (uint16_t)(hash ^ (hash >> 16));
+}
+
+uint16_t symtab_hash_P(const char *text) {
+  uint32_t hash = 2166136261UL;
+  char c = 0;
+
+  while((c = pgm_read_byte(text++)) != '\0') {
+    hash ^= (uint8_t)tolower(c);
+    hash *= 16777619UL;
+  }
+  return (uint16_t)(hash ^ (hash >> 16));
+}
+
+int symtab_insert(struct symtab_t *tab, uint16_t hash, uint16_t id) {
+  uint16_t mask = tab->size - 1, i = 0;
+
+  for(i=0;i<tab->size;i++) {
+    uint16_t pos = (hash + i) & mask;
+    if(tab->slots[pos] == 0) {
+      tab->slots[pos] = id;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+/*
+ * Returns the next candidate id for the
+ * hash or 0 when there are no more. The
+ * probe should start at 0.
+ */
+uint16_t symtab_next(struct symtab_t *tab, uint16_t hash, uint16_t *probe) {
+  uint16_t mask = tab->size - 1;
+
+  if(*probe >= tab->size) {
+    return 0;
+  }
+  return tab->slots[(hash + (*probe)++) & mask];
+}
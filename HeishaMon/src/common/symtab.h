@@ -0,0 +1,31 @@
+/*
+  Copyright (C) CurlyMo
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef _SYMTAB_H_
+#define _SYMTAB_H_
+
+#include <stdint.h>
+
+/*
+ * Case-insensitive open addressing index over
+ * names that live in other (PROGMEM) tables.
+ * The slots only hold a non-zero id chosen by
+ * the caller, so the names are never copied
+ * and the caller verifies each candidate.
+ */
+typedef struct symtab_t {
+  uint16_t *slots;
+  uint16_t size;
+} symtab_t;
+
+uint16_t symtab_hash(const char *text, unsigned int len);
+uint16_t symtab_hash_P(const char *text);
+int symtab_insert(struct symtab_t *tab, uint16_t hash, uint16_t id);
+uint16_t symtab_next(struct symtab_t *tab, uint16_t hash, uint16_t *probe);
+
+#endif
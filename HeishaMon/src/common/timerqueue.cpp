@@ -20,76 +20,103 @@
 #include "mem.h"
 #include "timerqueue.h"
 
-static unsigned int lasttime = 0;
-static unsigned int *calls = NULL;
-static unsigned int nrcalls = 0;
+/*
+ * The first timerqueue_size entries form a
+ * binary min-heap ordered on the absolute
+ * deadline, the remaining entries point to
+ * the unused nodes of the pool.
+ */
+static struct timerqueue_t pool[TIMERQUEUE_MAX];
+static struct timerqueue_t *timerqueue[TIMERQUEUE_MAX];
+static int timerqueue_size = 0;
+static int timerqueue_init = 0;
+
+static unsigned long jitter_fired = 0;
+static uint64_t jitter_total = 0;
+static unsigned long jitter_max = 0;
 
-#ifndef ESP8266
-static unsigned int micros() {
+static uint64_t timerqueue_now(void) {
+#ifdef ESP8266
+  return micros64();
+#else
   struct timeval tv;
-  gettimeofday(&tv,NULL);
+  gettimeofday(&tv, NULL);
 
-  return 1000000 * tv.tv_sec + tv.tv_usec;;
-}
+  return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
 #endif
+}
 
-static void timerqueue_sort() {
-  int matched = 1;
-  while(matched) {
-    int a = 0;
-    matched = 0;
-    for(a=0;a<timerqueue_size-1;a++) {
-      if(timerqueue[a]->remove < timerqueue[a+1]->remove ||
-         (timerqueue[a]->remove == timerqueue[a+1]->remove && timerqueue[a]->sec > timerqueue[a+1]->sec) ||
-         (timerqueue[a]->remove == timerqueue[a+1]->remove && timerqueue[a]->sec == timerqueue[a+1]->sec && timerqueue[a]->usec > timerqueue[a+1]->usec)) {
-        struct timerqueue_t *node = timerqueue[a+1];
-        timerqueue[a+1] = timerqueue[a];
-        timerqueue[a] = node;
-        matched = 1;
-        break;
-      }
+static void timerqueue_setup(void) {
+  int a = 0;
+  for(a=0;a<TIMERQUEUE_MAX;a++) {
+    timerqueue[a] = &pool[a];
+  }
+  timerqueue_init = 1;
+}
+
+static void timerqueue_swap(int a, int b) {
+  struct timerqueue_t *node = timerqueue[a];
+  timerqueue[a] = timerqueue[b];
+  timerqueue[b] = node;
+}
+
+static void timerqueue_sift_up(int a) {
+  while(a > 0) {
+    int parent = (a-1)/2;
+    if(timerqueue[parent]->deadline <= timerqueue[a]->deadline) {
+      break;
     }
+    timerqueue_swap(a, parent);
+    a = parent;
   }
 }
 
-struct timerqueue_t *timerqueue_pop() {
-  if(timerqueue_size == 0) {
-    return NULL;
+static void timerqueue_sift_down(int a) {
+  while(1) {
+    int left = (2*a)+1, right = left+1, min = a;
+    if(left < timerqueue_size && timerqueue[left]->deadline < timerqueue[min]->deadline) {
+      min = left;
+    }
+    if(right < timerqueue_size && timerqueue[right]->deadline < timerqueue[min]->deadline) {
+      min = right;
+    }
+    if(min == a) {
+      break;
+    }
+    timerqueue_swap(a, min);
+    a = min;
   }
-  struct timerqueue_t *x = timerqueue[0];
-  timerqueue[0] = timerqueue[timerqueue_size-1];
+}
 
+/*
+ * Move the node at position a just behind
+ * the heap, where it becomes free again.
+ */
+static struct timerqueue_t *timerqueue_remove(int a) {
   timerqueue_size--;
-
-  if(timerqueue_size == 0) {
-    free(timerqueue);
-    timerqueue = NULL;
-  } else {
-    if((timerqueue = (struct timerqueue_t **)realloc(timerqueue, sizeof(struct timerqueue_t *)*timerqueue_size)) == NULL) {
-  #ifdef ESP8266
-      Serial1.printf("Out of memory %s:#%d\n", __FUNCTION__, __LINE__);
-      ESP.restart();
-      exit(-1);
-  #else
-      fprintf(stderr, "Out of memory %s:#%d\n", __FUNCTION__, __LINE__);
-      exit(-1);
-  #endif
-    }
+  if(a != timerqueue_size) {
+    timerqueue_swap(a, timerqueue_size);
+    timerqueue_sift_down(a);
+    timerqueue_sift_up(a);
   }
+  return timerqueue[timerqueue_size];
+}
 
+static int timerqueue_find(int nr) {
   int a = 0;
   for(a=0;a<timerqueue_size;a++) {
-    timerqueue[a]->sec -= x->sec;
-    timerqueue[a]->usec -= x->usec;
-    if(timerqueue[a]->usec < 0) {
-      timerqueue[a]->sec -= 1;
-      timerqueue[a]->usec += 1000000;
+    if(timerqueue[a]->nr == nr) {
+      return a;
     }
   }
+  return -1;
+}
 
-  timerqueue_sort();
-
-  return x;
+struct timerqueue_t *timerqueue_pop() {
+  if(timerqueue_size == 0) {
+    return NULL;
+  }
+  return timerqueue_remove(0);
 }
 
 struct timerqueue_t *timerqueue_peek() {
@@ -99,135 +126,189 @@ struct timerqueue_t *timerqueue_peek() {
   return timerqueue[0];
 }
 
-void timerqueue_insert(int sec, int usec, int nr) {
-  struct timerqueue_t *node = NULL;
-  int a = 0, matched = 0, x = 0, y = 0;
+int timerqueue_count(void) {
+  return timerqueue_size;
+}
 
-  for(a=0;a<timerqueue_size;a++) {
-    if(timerqueue[a]->nr == nr) {
-      timerqueue[a]->sec = sec;
-      timerqueue[a]->usec = usec;
-      if(sec <= 0 && usec <= 0) {
-        timerqueue[a]->remove = 1;
-        for(x=0;x<nrcalls;x++) {
-          if(calls[x] == timerqueue[a]->nr) {
-            if(nrcalls > 0) {
-              for(y=x;y<nrcalls-1;y++) {
-                calls[y] = calls[y+1];
-              }
-              nrcalls--;
-            }
-            break;
-          }
-        }
-      }
-      timerqueue_sort();
-      matched = 1;
-      break;
-    }
+/*
+ * The timer at position a of the queue, the
+ * queue itself is in no particular order.
+ */
+struct timerqueue_t *timerqueue_get(int a) {
+  if(a < 0 || a >= timerqueue_size) {
+    return NULL;
   }
+  return timerqueue[a];
+}
+
+/*
+ * Puts back a copy of a timer taken with
+ * timerqueue_get, with its original
+ * deadline and interval.
+ */
+int timerqueue_restore(struct timerqueue_t *node) {
+  int a = 0;
 
-  if(matched == 1) {
-    while((node = timerqueue_peek()) != NULL) {
-      if(node->remove == 1) {
-        struct timerqueue_t *node = timerqueue_pop();
-        free(node);
+  if(timerqueue_init == 0) {
+    timerqueue_setup();
+  }
+
+  if((a = timerqueue_find(node->nr)) > -1) {
+    timerqueue_remove(a);
+  }
+
+  if(timerqueue_size == TIMERQUEUE_MAX) {
+    return -1;
+  }
+
+  a = timerqueue_size++;
+  timerqueue[a]->deadline = node->deadline;
+  timerqueue[a]->interval = node->interval;
+  timerqueue[a]->nr = node->nr;
+  timerqueue_sift_up(a);
+
+  return 0;
+}
+
+static int timerqueue_schedule(int sec, int usec, uint32_t interval, int nr) {
+  uint64_t deadline = timerqueue_now() + ((int64_t)sec * 1000000) + usec;
+  int a = 0;
+
+  if(timerqueue_init == 0) {
+    timerqueue_setup();
+  }
+
+  if((a = timerqueue_find(nr)) > -1) {
+    if(sec <= 0 && usec <= 0) {
+      timerqueue_remove(a);
+    } else {
+      uint64_t old = timerqueue[a]->deadline;
+      timerqueue[a]->deadline = deadline;
+      timerqueue[a]->interval = interval;
+      if(deadline < old) {
+        timerqueue_sift_up(a);
       } else {
-        break;
+        timerqueue_sift_down(a);
       }
     }
-
-    return;
+    return 0;
   } else if(sec == 0 && usec == 0) {
-    return;
+    return 0;
   }
 
-  if((timerqueue = (struct timerqueue_t **)realloc(timerqueue, sizeof(struct timerqueue_t *)*(timerqueue_size+1))) == NULL) {
+  if(timerqueue_size == TIMERQUEUE_MAX) {
 #ifdef ESP8266
-    Serial1.printf("Out of memory %s:#%d\n", __FUNCTION__, __LINE__);
-    ESP.restart();
-    exit(-1);
+    Serial1.printf(PSTR("Timerqueue full %s:#%d\n"), __FUNCTION__, __LINE__);
 #else
-    fprintf(stderr, "Out of memory %s:#%d\n", __FUNCTION__, __LINE__);
-    exit(-1);
+    fprintf(stderr, "Timerqueue full %s:#%d\n", __FUNCTION__, __LINE__);
 #endif
+    return -1;
+  }
+
+  a = timerqueue_size++;
+  timerqueue[a]->deadline = deadline;
+  timerqueue[a]->interval = interval;
+  timerqueue[a]->nr = nr;
+  timerqueue_sift_up(a);
+
+  return 0;
+}
+
+/*
+ * Inserting an already existing timer
+ * reschedules it, a timeout of zero
+ * removes it from the queue.
+ */
+int timerqueue_insert(int sec, int usec, int nr) {
+  return timerqueue_schedule(sec, usec, 0, nr);
+}
+
+/*
+ * Same as timerqueue_insert, but the timer
+ * is rearmed each time it fires. Intervals
+ * are kept in whole milliseconds, rounded
+ * up, so they can't exceed about 49 days.
+ */
+int timerqueue_interval(int sec, int usec, int nr) {
+  uint64_t interval = 0;
+
+  if(sec < 0 || usec < 0) {
+    return timerqueue_schedule(0, 0, 0, nr);
   }
 
-  node = (struct timerqueue_t *)malloc(sizeof(struct timerqueue_t));
-  if(node == NULL) {
+  interval = ((uint64_t)sec * 1000) + ((usec + 999) / 1000);
+  if(interval > UINT32_MAX) {
 #ifdef ESP8266
-    Serial1.printf("Out of memory %s:#%d\n", __FUNCTION__, __LINE__);
-    ESP.restart();
-    exit(-1);
+    Serial1.printf(PSTR("Timerqueue interval too long %s:#%d\n"), __FUNCTION__, __LINE__);
 #else
-    fprintf(stderr, "Out of memory %s:#%d\n", __FUNCTION__, __LINE__);
-    exit(-1);
+    fprintf(stderr, "Timerqueue interval too long %s:#%d\n", __FUNCTION__, __LINE__);
 #endif
+    return -1;
   }
-  memset(node, 0, sizeof(struct timerqueue_t));
-  node->sec = sec;
-  node->usec = usec;
-  node->nr = nr;
+  return timerqueue_schedule(sec, usec, (uint32_t)interval, nr);
+}
 
-  timerqueue[timerqueue_size++] = node;
-  timerqueue_sort();
+void timerqueue_stats(unsigned long *fired, unsigned long *avgjitter, unsigned long *maxjitter) {
+  *fired = jitter_fired;
+  *avgjitter = (jitter_fired > 0) ? (unsigned long)(jitter_total / jitter_fired) : 0;
+  *maxjitter = jitter_max;
 }
 
-void timerqueue_update(void) {
-  struct timeval tv;
-  unsigned int curtime = 0;
+int timerqueue_remaining(int nr, int *sec, int *usec) {
+  uint64_t now = timerqueue_now(), diff = 0;
+  int a = 0;
 
-  curtime = micros();
+  if((a = timerqueue_find(nr)) == -1) {
+    return -1;
+  }
+  if(timerqueue[a]->deadline > now) {
+    diff = timerqueue[a]->deadline - now;
+  }
+  *sec = diff / 1000000;
+  *usec = diff % 1000000;
 
-  unsigned int diff = curtime - lasttime;
-  unsigned int sec = diff / 1000000;
-  unsigned int usec = diff - ((diff / 1000000) * 1000000);
-  int a = 0, x = 0;
+  return 0;
+}
 
-  lasttime = curtime;
+/*
+ * Each expired timer is popped before its
+ * callback is called, so callbacks are free
+ * to insert or remove any timer.
+ *
+ * Interval timers are rearmed relative to
+ * their previous deadline instead of the
+ * current time, so they don't drift. When
+ * whole periods were missed these are
+ * skipped instead of fired in a burst.
+ */
+void timerqueue_update(void) {
+  struct timerqueue_t *node = NULL;
+  uint64_t now = timerqueue_now();
 
-  for(a=0;a<timerqueue_size;a++) {
-    timerqueue[a]->sec -= sec;
-    timerqueue[a]->usec -= usec;
-    if(timerqueue[a]->usec < 0) {
-      timerqueue[a]->usec = 1000000 + timerqueue[a]->usec;
-      timerqueue[a]->sec -= 1;
-    }
+  while((node = timerqueue_peek()) != NULL && node->deadline <= now) {
+    uint64_t deadline = node->deadline;
+    uint64_t interval = (uint64_t)node->interval * 1000;
+    unsigned long jitter = now - deadline;
+    int nr = node->nr;
 
-    if(timerqueue[a]->sec < 0 || (timerqueue[a]->sec == 0 && timerqueue[a]->usec <= 0)) {
-      int nr = timerqueue[a]->nr;
-      if((calls = (unsigned int *)realloc(calls, (nrcalls+1)*sizeof(int))) == NULL) {
-#ifdef ESP8266
-        Serial1.printf("Out of memory %s:#%d\n", __FUNCTION__, __LINE__);
-        ESP.restart();
-        exit(-1);
-#else
-        fprintf(stderr, "Out of memory %s:#%d\n", __FUNCTION__, __LINE__);
-        exit(-1);
-#endif
-      }
-      calls[nrcalls++] = nr;
-    }
-  }
-  for(a=0;a<timerqueue_size;a++) {
-    if(timerqueue[a]->sec < 0 || (timerqueue[a]->sec == 0 && timerqueue[a]->usec == 0)) {
-      struct timerqueue_t *node = timerqueue_pop();
-      free(node);
-      a--;
+    jitter_fired++;
+    jitter_total += jitter;
+    if(jitter > jitter_max) {
+      jitter_max = jitter;
     }
-  }
-  while(nrcalls > 0) {
-    timer_cb(calls[0]);
-    if(nrcalls > 0) {
-      for(a=0;a<nrcalls-1;a++) {
-        calls[a] = calls[a+1];
+
+    node = timerqueue_pop();
+
+    if(interval > 0) {
+      deadline += interval;
+      if(deadline <= now) {
+        deadline += ((now - deadline) / interval + 1) * interval;
       }
-      nrcalls--;
+      node->deadline = deadline;
+      timerqueue_size++;
+      timerqueue_sift_up(timerqueue_size-1);
     }
+
+    timer_cb(nr);
   }
-  if(calls != NULL) {
-    free(calls);
-    calls = NULL;
-  }
-  nrcalls = 0;
 }
@@ -11,21 +11,31 @@
 
 #include <stdint.h>
 
+#ifndef TIMERQUEUE_MAX
+  #define TIMERQUEUE_MAX 32
+#endif
+
 typedef struct timerqueue_t {
-	int sec;
-	int usec;
+  uint64_t deadline;
+  uint32_t interval; // in ms, 0 for a one shot timer
   int nr;
-  int remove;
 } timerqueue_t;
 
-extern struct timerqueue_t **timerqueue;
-extern int timerqueue_size;
 extern void timer_cb(int nr);
 
+/*
+ * The node returned by timerqueue_pop stays
+ * valid until the next timerqueue_insert.
+ */
 struct timerqueue_t *timerqueue_pop();
 struct timerqueue_t *timerqueue_peek();
 void timerqueue_update(void);
-void timerqueue_insert(int sec, int usec, int nr);
-
-
-#endif
\ No newline at end of file
+int timerqueue_insert(int sec, int usec, int nr);
+int timerqueue_interval(int sec, int usec, int nr);
+int timerqueue_remaining(int nr, int *sec, int *usec);
+int timerqueue_count(void);
+struct timerqueue_t *timerqueue_get(int a);
+int timerqueue_restore(struct timerqueue_t *node);
+void timerqueue_stats(unsigned long *fired, unsigned long *avgjitter, unsigned long *maxjitter);
+
+#endif
@@ -71,18 +71,23 @@ static WiFiServer sync_server(0);
 static uint8_t *rbuffer = NULL;
 
 #if defined(ESP8266)
+/*
+ * lwip can't read from PROGMEM, so the content
+ * is copied through a small window on the stack.
+ */
 static uint16_t tcp_write_P(tcp_pcb *pcb, PGM_P buf, uint16_t len, uint8_t flags) {
-  char *str = (char *)malloc(len+1);
-  if(str == NULL) {
-    Serial1.printf(PSTR("Out of memory %s:#%d\n"), __FUNCTION__, __LINE__);
-    ESP.restart();
-    exit(-1);
+  unsigned char cpy[WEBSERVER_SEND_WINDOW];
+  uint16_t i = 0, n = 0;
+
+  while(i < len) {
+    n = MIN(len - i, sizeof(cpy));
+    memcpy_P(cpy, &buf[i], n);
+    if(tcp_write(pcb, cpy, n, flags | TCP_WRITE_FLAG_COPY) != ERR_OK) {
+      break;
+    }
+    i += n;
   }
-  memset(str, 0, len+1);
-  strncpy_P(str, buf, len);
-  uint16_t ret = tcp_write(pcb, str, len, flags);
-  free(str);
-  return ret;
+  return i;
 }
 #endif
 
@@ -381,6 +386,13 @@ static int webserver_parse_post(struct webserver_t *client, uint16_t size) {
         client->buffer[client->ptr] = 0;
 
       } else {
+        /*
+         * A name that fills the buffer
+         * leaves no room for its value.
+         */
+        if(pos+1 >= WEBSERVER_BUFFER_SIZE) {
+          return -1;
+        }
         int16_t pos2 = urldecode(client->buffer,
                   pos + 1,
                   client->buffer,
@@ -419,7 +431,6 @@ static int webserver_parse_post(struct webserver_t *client, uint16_t size) {
           client->buffer[pos] = c;
         }
 
-        memmove(&client->buffer[pos+1], &client->buffer[size], size-(pos+1));
         client->ptr = (pos+1);
 
         client->buffer[client->ptr] = 0;
@@ -471,11 +482,35 @@ static int webserver_parse_post(struct webserver_t *client, uint16_t size) {
   return 0;
 }
 
+/*
+ * The headers move through the buffer while they're
+ * parsed, so their end has to be looked up again after
+ * each one. Anything past it is the next pipelined request.
+ */
+static uint16_t http_header_end(struct webserver_t *client) {
+  if(client->ptr >= 2 && memcmp_P(client->buffer, PSTR("\r\n"), 2) == 0) {
+    return 0;
+  }
+  unsigned char *ptr = strnstr(client->buffer, "\r\n\r\n", client->ptr);
+  if(ptr != NULL) {
+    return ptr-client->buffer;
+  }
+  return client->ptr;
+}
+
 int8_t http_parse_request(struct webserver_t *client, uint8_t **buf, uint16_t *len) {
   uint16_t hasread = MIN(WEBSERVER_BUFFER_SIZE-client->ptr, *len);
 
   while(*len > 0) {
     hasread = MIN(WEBSERVER_BUFFER_SIZE-client->ptr, (*len));
+    /*
+     * A full buffer that couldn't be parsed
+     * any further won't get any better.
+     */
+    if(hasread == 0) {
+      client->step = WEBSERVER_CLIENT_CLOSE;
+      return -1;
+    }
     memcpy(&client->buffer[client->ptr], &(*buf)[0], hasread);
 
     client->ptr += hasread;
@@ -489,6 +524,7 @@ int8_t http_parse_request(struct webserver_t *client, uint8_t **buf, uint16_t *l
     if(client->substep == 0) {
       if(memcmp_P(client->buffer, PSTR("GET "), 4) == 0) {
         client->method = 0;
+        client->keepalive = (client->requests < WEBSERVER_CLIENT_KEEPALIVE_MAX-1);
         if(client->callback != NULL) {
           client->step = WEBSERVER_CLIENT_REQUEST_METHOD;
           if(client->callback != NULL) {
@@ -506,6 +542,11 @@ int8_t http_parse_request(struct webserver_t *client, uint8_t **buf, uint16_t *l
       if(memcmp_P(client->buffer, PSTR("POST "), 5) == 0) {
         client->method = 1;
         client->reqtype = 0;
+        /*
+         * The body is streamed into the callback,
+         * so there's no telling what follows it.
+         */
+        client->keepalive = 0;
         client->step = WEBSERVER_CLIENT_REQUEST_METHOD;
         if(client->callback != NULL) {
           if(client->callback(client, (void *)"POST") == -1) {
@@ -597,18 +638,19 @@ int8_t http_parse_request(struct webserver_t *client, uint8_t **buf, uint16_t *l
       }
     }
     if(client->substep == 4) {
-	  //look if end exists in buffer
-	  unsigned char *ptrEnd = strnstr(client->buffer, "\r\n\r\n", client->ptr);
-	  uint16_t posEnd = client->ptr;
-	  if (ptrEnd != NULL) {
-		  posEnd = (ptrEnd-client->buffer);
-	  }
-	  //don't search for more args past this end
-	  unsigned char *ptr = (unsigned char *)memchr(client->buffer, ':', posEnd);
+      //don't search for more args past the end of the headers
+      unsigned char *ptr = (unsigned char *)memchr(client->buffer, ':', http_header_end(client));
 
       while(ptr != NULL) {
         struct arguments_t args;
         uint16_t i = ptr-client->buffer, x = 0;
+        /*
+         * A header without a name
+         */
+        if(i == 0) {
+          client->step = WEBSERVER_CLIENT_CLOSE;
+          return -1;
+        }
         client->buffer[i] = 0;
         args.name = &client->buffer[0];
         args.value = NULL;
@@ -622,7 +664,7 @@ int8_t http_parse_request(struct webserver_t *client, uint8_t **buf, uint16_t *l
         while(i <= client->ptr-4) {
           if(memcmp_P(&client->buffer[i], PSTR("\r\n"), 2) == 0 ||
              (client->ptr == WEBSERVER_BUFFER_SIZE && i == WEBSERVER_BUFFER_SIZE-4)) {
-            while(client->buffer[x+1] == ' ') {
+            while(x+1 < i && client->buffer[x+1] == ' ') {
               x++;
             }
             args.value = &client->buffer[x+1];
@@ -637,6 +679,29 @@ int8_t http_parse_request(struct webserver_t *client, uint8_t **buf, uint16_t *l
               memcpy(tmp, &client->buffer[x+1], args.len);
               client->totallen = atoi(tmp);
             }
+            if(memcmp_P(args.name, PSTR("Connection"), 10) == 0) {
+              if(strncasestr(args.value, "close", args.len) != NULL) {
+                client->keepalive = 0;
+              }
+            }
+            if(memcmp_P(args.name, PSTR("Accept-Encoding"), 15) == 0) {
+              if(strncasestr(args.value, "gzip", args.len) != NULL) {
+                client->gzip = 1;
+              }
+            }
+            if(memcmp_P(args.name, PSTR("If-None-Match"), 13) == 0) {
+              char tmp[args.len+1];
+              uint16_t pos = 0;
+              memset(&tmp, 0, args.len+1);
+              memcpy(tmp, args.value, args.len);
+              if(strncmp_P(tmp, PSTR("W/"), 2) == 0) {
+                pos += 2;
+              }
+              if(tmp[pos] == '"') {
+                pos++;
+              }
+              client->etag = strtoul(&tmp[pos], NULL, 16);
+            }
             if(memcmp_P(args.name, PSTR("Sec-WebSocket-Version"), 21) == 0) {
               client->is_websocket = 1;
             }
@@ -644,6 +709,9 @@ int8_t http_parse_request(struct webserver_t *client, uint8_t **buf, uint16_t *l
               char tmp[args.len+1];
               memset(&tmp, 0, args.len+1);
               memcpy(tmp, &client->buffer[x+1], args.len);
+              if(client->data.websockkey != NULL) {
+                free(client->data.websockkey);
+              }
               if((client->data.websockkey = strdup(tmp)) == NULL) {
 #ifdef ESP8266
                 Serial1.printf(PSTR("Out of memory %s:#%d\n"), __FUNCTION__, __LINE__);
@@ -653,16 +721,23 @@ int8_t http_parse_request(struct webserver_t *client, uint8_t **buf, uint16_t *l
               }
             }
             if(memcmp_P(args.name, PSTR("Content-Type"), 12) == 0) {
-              if(strncasestr(&client->buffer[x+1], "multipart/form-data", client->ptr-(x+1)) != NULL) {
+              if(strncasestr(&client->buffer[x+1], "multipart/form-data", args.len) != NULL) {
                 client->reqtype = 1;
                 char tmp[args.len+1];
                 memset(&tmp, 0, args.len+1);
                 memcpy(tmp, &client->buffer[x+1], args.len);
                 {
                   char *ptr = strstr(tmp, "boundary=");
-                  uint8_t pos = (ptr-tmp)+strlen("boundary=");
+                  if(ptr == NULL || ptr[strlen("boundary=")] == 0) {
+                    client->step = WEBSERVER_CLIENT_CLOSE;
+                    return -1;
+                  }
+                  uint16_t pos = (ptr-tmp)+strlen("boundary=");
                   memmove(&tmp[0], &tmp[pos], args.len-pos);
                   tmp[args.len-pos] = 0;
+                  if(client->data.boundary != NULL) {
+                    free(client->data.boundary);
+                  }
                   if((client->data.boundary = strdup(tmp)) == NULL) {
 #ifdef ESP8266
                     Serial1.printf(PSTR("Out of memory %s:#%d\n"), __FUNCTION__, __LINE__);
@@ -699,7 +774,7 @@ int8_t http_parse_request(struct webserver_t *client, uint8_t **buf, uint16_t *l
           client->buffer[x] = ':';
           break;
         }
-        ptr = (unsigned char *)memchr(client->buffer, ':', posEnd);
+        ptr = (unsigned char *)memchr(client->buffer, ':', http_header_end(client));
       }
 
       if(client->ptr >= 2 && memcmp_P(client->buffer, PSTR("\r\n"), 2) == 0) {
@@ -745,6 +820,18 @@ int http_parse_body(struct webserver_t *client, char *buf, uint16_t len) {
     if(ret == 0) {
       break;
     }
+    /*
+     * A full buffer the post parser couldn't
+     * shrink won't get any better.
+     */
+    if(ret == 1 && client->ptr == toread) {
+      if(client->ptr == WEBSERVER_BUFFER_SIZE) {
+        return -1;
+      }
+      if(pos >= len) {
+        break;
+      }
+    }
   }
 
   return 0;
@@ -775,6 +862,9 @@ int http_parse_multipart_body(struct webserver_t *client, unsigned char *buf, ui
 
   while(rpos < len) {
     hasread = MIN(WEBSERVER_BUFFER_SIZE-client->ptr, len-rpos);
+    if(hasread == 0) {
+      return -1;
+    }
     memcpy(&client->buffer[client->ptr], &buf[rpos], hasread);
     client->ptr += hasread;
     rpos += hasread;
@@ -854,8 +944,9 @@ int http_parse_multipart_body(struct webserver_t *client, unsigned char *buf, ui
           unsigned char *ptr = strncasestr(client->buffer, "content-disposition:", client->ptr);
           if(ptr != NULL) {
             uint16_t pos = (ptr-client->buffer)+strlen("content-disposition:");
-            while(client->buffer[pos++] == ' ');
-            pos--;
+            while(pos < client->ptr && client->buffer[pos] == ' ') {
+              pos++;
+            }
             memmove(&client->buffer[0], &client->buffer[pos], client->ptr-(pos));
             client->ptr = client->ptr-(pos);
             client->buffer[client->ptr] = 0;
@@ -870,8 +961,9 @@ int http_parse_multipart_body(struct webserver_t *client, unsigned char *buf, ui
           unsigned char *ptr = (unsigned char *)memchr(client->buffer, ';', client->ptr);
           if(ptr != NULL) {
             uint16_t pos = (ptr-client->buffer+1);
-            while(client->buffer[pos++] == ' ');
-            pos--;
+            while(pos < client->ptr && client->buffer[pos] == ' ') {
+              pos++;
+            }
             memmove(&client->buffer[0], &client->buffer[pos], client->ptr-(pos));
             client->ptr -= pos;
             client->buffer[client->ptr] = 0;
@@ -904,7 +996,7 @@ int http_parse_multipart_body(struct webserver_t *client, unsigned char *buf, ui
               client->buffer[pos++] = '=';
               uint16_t pos1 = (ptr1-client->buffer);
               uint16_t newlen = client->ptr-((pos1+2)-pos);
-              memmove(&client->buffer[pos], &client->buffer[pos1+2], newlen);
+              memmove(&client->buffer[pos], &client->buffer[pos1+2], client->ptr-(pos1+2));
               client->ptr = newlen;
               client->readlen += (pos1+2);
               client->substep = 5;
@@ -926,7 +1018,7 @@ int http_parse_multipart_body(struct webserver_t *client, unsigned char *buf, ui
               if(ptr1 != NULL) {
                 uint16_t pos1 = (ptr1-client->buffer)+4;
                 uint16_t newlen = client->ptr-(pos1-pos);
-                memmove(&client->buffer[pos], &client->buffer[pos1], newlen);
+                memmove(&client->buffer[pos], &client->buffer[pos1], client->ptr-pos1);
                 client->ptr = newlen;
                 client->readlen += (pos1-pos);
                 client->substep = 7;
@@ -944,15 +1036,19 @@ int http_parse_multipart_body(struct webserver_t *client, unsigned char *buf, ui
         case 6: {
           if(client->ptr >= 2) {
             unsigned char *ptr = strnstr(client->buffer, "\";", client->ptr);
-            if(ptr != NULL) {
-              unsigned char *ptr1 = strnstr(client->buffer, "\r\n", client->ptr);
-              if(ptr1 != NULL) {
+            unsigned char *ptr1 = strnstr(client->buffer, "\"\r\n", client->ptr);
+            /*
+             * The "; of a filename can also be
+             * that of the part following this one.
+             */
+            if(ptr != NULL && (ptr1 == NULL || ptr < ptr1)) {
+              unsigned char *ptr2 = strnstr(ptr, "\r\n", client->ptr-(ptr-client->buffer));
+              if(ptr2 != NULL) {
                 client->substep = 4;
               } else {
                 loop = 0;
               }
             } else {
-              unsigned char *ptr1 = strnstr(client->buffer, "\"\r\n", client->ptr);
               if(ptr1 != NULL) {
                 uint16_t pos = (ptr1-client->buffer);
                 /*
@@ -990,7 +1086,7 @@ int http_parse_multipart_body(struct webserver_t *client, unsigned char *buf, ui
           if(ptr != NULL && client->substep != 8) {
             uint16_t pos = (ptr-client->buffer);
 
-            ptr = (unsigned char *)memchr(client->buffer, '=', client->ptr);
+            ptr = (unsigned char *)memchr(client->buffer, '=', pos);
             uint16_t vlen = 0;
 
             if(ptr != NULL) {
@@ -1009,7 +1105,7 @@ int http_parse_multipart_body(struct webserver_t *client, unsigned char *buf, ui
 				args.len = pos-(vlen+1);
 
 				if(client->callback != NULL) {
-					uint8_t ret = client->callback(client, &args);
+					int8_t ret = client->callback(client, &args);
 					if(ret == -1) {
 						return -1;
 					}
@@ -1037,6 +1133,14 @@ int http_parse_multipart_body(struct webserver_t *client, unsigned char *buf, ui
             if(ptr != NULL) {
               uint16_t pos = (ptr-client->buffer);
 
+              /*
+               * A name that fills the buffer
+               * leaves no room for its value.
+               */
+              if(pos+1+ending >= client->ptr) {
+                return -1;
+              }
+
               struct arguments_t args;
               client->buffer[pos] = 0;
 
@@ -1045,7 +1149,7 @@ int http_parse_multipart_body(struct webserver_t *client, unsigned char *buf, ui
               args.len = (WEBSERVER_BUFFER_SIZE-ending)-(pos+1);
 
               if(client->callback != NULL) {
-                uint8_t ret = client->callback(client, &args);
+                int8_t ret = client->callback(client, &args);
                 if(ret == -1) {
                   return -1;
                 }
@@ -1169,6 +1273,19 @@ static PGM_P code_to_text(uint16_t code) {
   /* LCOV_EXCL_STOP*/
 }
 
+/*
+ * Tells the client whether it can send its next
+ * request over this connection.
+ */
+static uint16_t webserver_connection_header(struct webserver_t *client, char *buf, uint16_t size) {
+  if(client->keepalive == 1) {
+    return snprintf_P(buf, size, PSTR("Keep-Alive: timeout=%d, max=%d\r\n"),
+      WEBSERVER_CLIENT_KEEPALIVE_TIMEOUT/1000, WEBSERVER_CLIENT_KEEPALIVE_MAX-1-client->requests);
+  } else {
+    return snprintf_P(buf, size, PSTR("Connection: close\r\n"));
+  }
+}
+
 static uint16_t webserver_create_header(struct webserver_t *client, uint16_t code, char *mimetype, uint16_t len) {
   uint16_t i = 0;
   unsigned char buffer[512], *p = buffer;
@@ -1189,6 +1306,11 @@ static uint16_t webserver_create_header(struct webserver_t *client, uint16_t cod
           header.ptr += snprintf_P((char *)&p[header.ptr], sizeof(buffer)-header.ptr, PSTR("\r\n\r\n"));
         }
       }
+      /*
+       * Without a length the response
+       * ends when the connection closes.
+       */
+      client->keepalive = 0;
       client->step = WEBSERVER_CLIENT_WRITE;
       i = header.ptr;
       return i;
@@ -1201,7 +1323,10 @@ static uint16_t webserver_create_header(struct webserver_t *client, uint16_t cod
     client->step = WEBSERVER_CLIENT_WRITE;
   }
   i += snprintf_P((char *)&p[i], sizeof(buffer) - i, PSTR("Server: ESP8266\r\n"));
-  i += snprintf_P((char *)&p[i], sizeof(buffer) - i, PSTR("Keep-Alive: timeout=15, max=100\r\n"));
+  i += webserver_connection_header(client, (char *)&p[i], sizeof(buffer) - i);
+  if(client->cached == 1) {
+    i += snprintf_P((char *)&p[i], sizeof(buffer) - i, PSTR("ETag: \"%08lx\"\r\nCache-Control: no-cache\r\n"), (unsigned long)client->etag);
+  }
   i += snprintf_P((char *)&p[i], sizeof(buffer) - i, PSTR("Content-Type: %s\r\n"), mimetype);
   i += snprintf_P((char *)&p[i], sizeof(buffer) - i, PSTR("Content-Length: %d\r\n\r\n"), len);
 
@@ -1220,336 +1345,390 @@ static uint16_t webserver_create_header(struct webserver_t *client, uint16_t cod
   return i;
 }
 
-static int webserver_process_send(struct webserver_t *client) {
-  struct sendlist_t *tmp = NULL;
-  uint16_t cpylen = client->totallen, i = 0, cpyptr = client->ptr;
-  unsigned char cpy[client->totallen+1];
-  memset(&cpy, 0, client->totallen+1);
+#if WEBSERVER_MAX_SENDLIST > 0
+static uint8_t webserver_sendlist_used(struct sendlist_t *node) {
+#if WEBSERVER_SENDLIST_BUFSIZE == 0
+  return (node->data.ptr != NULL);
+#else
+  return (node->type == 1 && node->data.ptr != NULL) ||
+         (node->type == 0 && strlen((char *)node->data.fixed) > 0);
+#endif
+}
+#endif
 
+static struct sendlist_t *webserver_sendlist_next(struct webserver_t *client, struct sendlist_t *node) {
 #if WEBSERVER_MAX_SENDLIST == 0
-  tmp = client->sendlist;
-#else
-  uint8_t x = 0, y = 0;
-  for(x=0;x<WEBSERVER_MAX_SENDLIST;x++) {
-    if(
-#if WEBSERVER_SENDLIST_BUFSIZE == 0
-      client->sendlist[x].data.ptr != NULL
+  if(node == NULL) {
+    return client->sendlist;
+  }
+  return node->next;
 #else
-      (client->sendlist[x].type == 1 && client->sendlist[x].data.ptr != NULL) ||
-      (client->sendlist[x].type == 0 && strlen((char *)client->sendlist[x].data.fixed) > 0)
+  uint8_t x = (node == NULL) ? 0 : (node - client->sendlist) + 1;
+  for(;x<WEBSERVER_MAX_SENDLIST;x++) {
+    if(webserver_sendlist_used(&client->sendlist[x])) {
+      return &client->sendlist[x];
+    }
+  }
+  return NULL;
+#endif
+}
+
+/*
+ * Nodes are taken from the client pool first and
+ * only allocated when the pool is exhausted.
+ */
+static struct sendlist_t *webserver_sendlist_alloc(struct webserver_t *client) {
+  struct sendlist_t *node = NULL;
+
+#if WEBSERVER_MAX_SENDLIST == 0
+#if WEBSERVER_SENDLIST_POOL > 0
+  uint8_t i = 0, x = 0;
+  for(i=0;i<WEBSERVER_SENDLIST_POOL;i++) {
+    x = (client->sendpool_ptr + i) % WEBSERVER_SENDLIST_POOL;
+    if(client->sendpool[x].used == 0) {
+      node = &client->sendpool[x];
+      memset(node, 0, sizeof(struct sendlist_t));
+      node->pooled = 1;
+      node->used = 1;
+      client->sendpool_ptr = (x + 1) % WEBSERVER_SENDLIST_POOL;
+      return node;
+    }
+  }
 #endif
-    ) {
-      tmp = &client->sendlist[x];
+  node = (struct sendlist_t *)malloc(sizeof(struct sendlist_t));
+  /*LCOV_EXCL_START*/
+  if(node == NULL) {
+  #ifdef ESP8266
+    Serial1.printf(PSTR("Out of memory %s:#%d\n"), __FUNCTION__, __LINE__);
+    ESP.restart();
+    exit(-1);
+  #endif
+  }
+  /*LCOV_EXCL_STOP*/
+#else
+  uint8_t i = 0;
+  for(i=0;i<WEBSERVER_MAX_SENDLIST;i++) {
+    if(!webserver_sendlist_used(&client->sendlist[i])) {
+      node = &client->sendlist[i];
       break;
     }
   }
+  if(node == NULL) {
+  #ifdef ESP8266
+    log_message(PSTR("Sendlist queue is full"));
+  #else
+    printf("Sendlist queue is full\n");
+  #endif
+    return NULL;
+  }
 #endif
+  memset(node, 0, sizeof(struct sendlist_t));
+  node->used = 1;
+  return node;
+}
 
-  if(client->chunked == 1) {
-    while(tmp != NULL && cpylen > 0) {
-      if(cpyptr == 0) {
-        if(cpylen >= tmp->size) {
-          cpyptr += tmp->size;
-          cpylen -= tmp->size;
+static void webserver_sendlist_append(struct webserver_t *client, struct sendlist_t *node) {
 #if WEBSERVER_MAX_SENDLIST == 0
-          tmp = tmp->next;
-#else
-          tmp = NULL;
-          for(y=x+1;y<WEBSERVER_MAX_SENDLIST;y++) {
-            if(
+  if(client->sendlist == NULL) {
+    client->sendlist = node;
+    client->sendlist_head = node;
+  } else {
+    client->sendlist_head->next = node;
+    client->sendlist_head = node;
+  }
+#endif
+}
+
+static void webserver_sendlist_free(struct sendlist_t *node) {
+  if(node->type == 0) {
 #if WEBSERVER_SENDLIST_BUFSIZE == 0
-              client->sendlist[y].data.ptr != NULL
+    if(node->heap == 1) {
+      free(node->data.ptr);
+    }
 #else
-              (client->sendlist[y].type == 1 && client->sendlist[y].data.ptr != NULL) ||
-              (client->sendlist[y].type == 0 && strlen((char *)client->sendlist[y].data.fixed) > 0)
+    memset(&node->data.fixed, 0, WEBSERVER_SENDLIST_BUFSIZE);
 #endif
-            ) {
-              tmp = &client->sendlist[y];
-              x = y;
-              break;
-            }
-          }
-#endif
-          cpyptr = 0;
-        } else {
-          cpyptr += cpylen;
-          cpylen = 0;
-        }
-      } else if(cpyptr+cpylen >= tmp->size) {
-        cpylen -= (tmp->size-cpyptr);
+  }
+  node->data.ptr = NULL;
+
 #if WEBSERVER_MAX_SENDLIST == 0
-          tmp = tmp->next;
-#else
-          tmp = NULL;
-          for(y=x+1;y<WEBSERVER_MAX_SENDLIST;y++) {
-            if(
-#if WEBSERVER_SENDLIST_BUFSIZE == 0
-              client->sendlist[y].data.ptr != NULL
+  if(node->pooled == 1) {
+    memset(node, 0, sizeof(struct sendlist_t));
+  } else {
+    free(node);
+  }
 #else
-              (client->sendlist[y].type == 1 && client->sendlist[y].data.ptr != NULL) ||
-              (client->sendlist[y].type == 0 && strlen((char *)client->sendlist[y].data.fixed) > 0)
+  memset(node, 0, sizeof(struct sendlist_t));
 #endif
-            ) {
-              tmp = &client->sendlist[y];
-              x = y;
-              break;
-            }
-          }
+}
+
+/*
+ * Removes the first node of the sendlist
+ * and returns the one following it.
+ */
+static struct sendlist_t *webserver_sendlist_pop(struct webserver_t *client, struct sendlist_t *node) {
+  struct sendlist_t *next = webserver_sendlist_next(client, node);
+
+#if WEBSERVER_MAX_SENDLIST == 0
+  client->sendlist = next;
+  if(next == NULL) {
+    client->sendlist_head = NULL;
+  }
 #endif
-        cpyptr = 0;
-      } else {
-        cpyptr += cpylen;
-        cpylen = 0;
-      }
-    }
+  webserver_sendlist_free(node);
 
-    unsigned char chunk_size[12];
-    size_t n = snprintf_P((char *)chunk_size, sizeof(chunk_size), PSTR("%X\r\n"), client->totallen - cpylen);
+  return next;
+}
 
-    if(client->async == 1) {
-      tcp_write(client->pcb, chunk_size, n, 0);
+/*
+ * Hands content straight to the network stack,
+ * content in PROGMEM is written through write_P
+ * or the tcp_write_P copy window. Returns the
+ * bytes the network stack took.
+ */
+static uint16_t webserver_send_data(struct webserver_t *client, unsigned char *ptr, uint16_t len, uint8_t progmem) {
+  uint16_t ret = 0;
+
+  if(client->async == 1) {
+    if(progmem == 1) {
+      ret = tcp_write_P(client->pcb, (PGM_P)ptr, len, TCP_WRITE_FLAG_MORE);
+    } else if(tcp_write(client->pcb, ptr, len, TCP_WRITE_FLAG_MORE | TCP_WRITE_FLAG_COPY) == ERR_OK) {
+      ret = len;
+    }
+  } else {
+    int n = 0;
+    if(progmem == 1) {
+      n = client->client->write_P((char *)ptr, len);
     } else {
-      if(client->client->write(chunk_size, n) > 0) {
-        if(client->is_websocket == 0) {
-          client->lastseen = millis();
-        }
+      n = client->client->write(ptr, len);
+    }
+    if(n > 0) {
+      ret = n;
+      if(client->is_websocket == 0) {
+        client->lastseen = millis();
       }
     }
-    i += n;
   }
+  return ret;
+}
+
+static uint16_t webserver_send_fragment(struct webserver_t *client, struct sendlist_t *node, uint16_t len) {
+  unsigned char *ptr = NULL;
 
-#if WEBSERVER_MAX_SENDLIST == 0
-  tmp = client->sendlist;
-#else
-  x = 0, y = 0;
-  for(x=0;x<WEBSERVER_MAX_SENDLIST;x++) {
-    if(
 #if WEBSERVER_SENDLIST_BUFSIZE == 0
-      client->sendlist[x].data.ptr != NULL
+  ptr = &((unsigned char *)node->data.ptr)[client->ptr];
 #else
-      (client->sendlist[x].type == 1 && client->sendlist[x].data.ptr != NULL) ||
-      (client->sendlist[x].type == 0 && strlen((char *)client->sendlist[x].data.fixed) > 0)
-#endif
-    ) {
-      tmp = &client->sendlist[x];
-      break;
-    }
+  if(node->type == 1) {
+    ptr = &((unsigned char *)node->data.ptr)[client->ptr];
+  } else {
+    ptr = &node->data.fixed[client->ptr];
   }
 #endif
-  if(tmp != NULL) {
-    while(tmp != NULL && client->totallen > 0) {
-      if(client->ptr == 0) {
-        if(client->totallen >= tmp->size) {
-          if(tmp->type == 1) {
-            memcpy_P(cpy, &((PGM_P)tmp->data.ptr)[client->ptr], tmp->size);
-            if(client->async == 1) {
-              tcp_write(client->pcb, cpy, tmp->size, TCP_WRITE_FLAG_MORE);
-            } else {
-              if(client->client->write(cpy, tmp->size) > 0) {
-                if(client->is_websocket == 0) {
-                  client->lastseen = millis();
-                }
-              }
-            }
-          } else {
-            if(client->async == 1) {
-#if WEBSERVER_SENDLIST_BUFSIZE == 0
-              tcp_write(client->pcb, &((unsigned char *)tmp->data.ptr)[client->ptr], tmp->size, TCP_WRITE_FLAG_MORE);
-#else
-              tcp_write(client->pcb, &((unsigned char *)tmp->data.fixed)[client->ptr], tmp->size, TCP_WRITE_FLAG_MORE);
-#endif
-            } else {
-#if WEBSERVER_SENDLIST_BUFSIZE == 0
-              if(client->client->write(&((unsigned char *)tmp->data.ptr)[client->ptr], tmp->size) > 0) {
-#else
-              if(client->client->write(&((unsigned char *)tmp->data.fixed)[client->ptr], tmp->size) > 0) {
-#endif
-                if(client->is_websocket == 0) {
-                  client->lastseen = millis();
-                }
-              }
-            }
-          }
-          i += tmp->size;
-          client->ptr += tmp->size;
-          client->totallen -= tmp->size;
 
-          if(tmp->type == 0) {
-#if WEBSERVER_SENDLIST_BUFSIZE == 0
-            free(tmp->data.ptr);
-#else
-            memset(&tmp->data.fixed, 0, WEBSERVER_SENDLIST_BUFSIZE);
-#endif
-          }
+  return webserver_send_data(client, ptr, len, node->type);
+}
+
+static void webserver_reset_request(struct webserver_t *client) {
+  client->readlen = 0;
+  client->reqtype = 0;
+  client->method = 0;
+  client->totallen = 0;
+  client->substep = 0;
+  client->chunked = 0;
+  client->gzip = 0;
+  client->cached = 0;
+  client->keepalive = 0;
+  client->complete = 0;
+  client->etag = 0;
+  client->ptr = 0;
+  client->chunkleft = 0;
+  client->route = 0;
+  client->content = 0;
+  client->userdata = NULL;
 
-          tmp->data.ptr = NULL;
 #if WEBSERVER_MAX_SENDLIST == 0
-          client->sendlist = client->sendlist->next;
-          free(tmp);
-          tmp = client->sendlist;
-#else
-          tmp = NULL;
-          for(y=x+1;y<WEBSERVER_MAX_SENDLIST;y++) {
-            if(
-#if WEBSERVER_SENDLIST_BUFSIZE == 0
-              client->sendlist[y].data.ptr != NULL
+  while(client->sendlist) {
+    webserver_sendlist_pop(client, client->sendlist);
+  }
 #else
-              (client->sendlist[y].type == 1 && client->sendlist[y].data.ptr != NULL) ||
-              (client->sendlist[y].type == 0 && strlen((char *)client->sendlist[y].data.fixed) > 0)
-#endif
-            ) {
-              tmp = &client->sendlist[y];
-              x = y;
-              break;
-            }
-          }
+  uint8_t i = 0;
+  for(i=0;i<WEBSERVER_MAX_SENDLIST;i++) {
+    if(webserver_sendlist_used(&client->sendlist[i])) {
+      webserver_sendlist_free(&client->sendlist[i]);
+    }
+  }
 #endif
-          client->ptr = 0;
-        } else {
-          if(tmp->type == 1) {
-            memcpy_P(cpy, &((PGM_P)tmp->data.ptr)[client->ptr], client->totallen);
-            if(client->async == 1) {
-              tcp_write(client->pcb, cpy, client->totallen, TCP_WRITE_FLAG_MORE);
-            } else {
-              if(client->client->write(cpy, client->totallen) > 0) {
-                if(client->is_websocket == 0) {
-                  client->lastseen = millis();
-                }
-              }
-            }
-          } else {
-            if(client->async == 1) {
-#if WEBSERVER_SENDLIST_BUFSIZE == 0
-              tcp_write(client->pcb, &((unsigned char *)tmp->data.ptr)[client->ptr], client->totallen, TCP_WRITE_FLAG_MORE);
-#else
-              tcp_write(client->pcb, &((unsigned char *)tmp->data.fixed)[client->ptr], client->totallen, TCP_WRITE_FLAG_MORE);
+#if WEBSERVER_SENDLIST_BUFSIZE == 0 && WEBSERVER_SENDLIST_ARENA > 0
+  client->sendarena_len = 0;
 #endif
-            } else {
-#if WEBSERVER_SENDLIST_BUFSIZE == 0
-              if(client->client->write(&((unsigned char *)tmp->data.ptr)[client->ptr], client->totallen) > 0) {
-#else
-              if(client->client->write(&((unsigned char *)tmp->data.fixed)[client->ptr], client->totallen) > 0) {
+  if(client->data.boundary != NULL) {
+    free(client->data.boundary);
+    client->data.boundary = NULL;
+  }
+  if(client->data.websockkey != NULL) {
+    free(client->data.websockkey);
+    client->data.websockkey = NULL;
+  }
+  if(client->pipeline != NULL) {
+    free(client->pipeline);
+    client->pipeline = NULL;
+  }
+  client->pipeline_len = 0;
+
+#if WEBSERVER_MAX_SENDLIST == 0
+  client->sendlist = NULL;
+  client->sendlist_head = NULL;
 #endif
-                if(client->is_websocket == 0) {
-                  client->lastseen = millis();
-                }
-              }
-            }
-          }
-          i += client->totallen;
-          client->ptr += client->totallen;
-          client->totallen = 0;
-        }
-      } else if(client->ptr+client->totallen >= tmp->size) {
-        if(tmp->type == 1) {
-          memcpy_P(cpy, &((PGM_P)tmp->data.ptr)[client->ptr], (tmp->size-client->ptr));
-          if(client->async == 1) {
-            tcp_write(client->pcb, cpy, (tmp->size-client->ptr), TCP_WRITE_FLAG_MORE);
-          } else {
-            if(client->client->write(cpy, (tmp->size-client->ptr)) > 0) {
-              if(client->is_websocket == 0) {
-                client->lastseen = millis();
-              }
-            }
-          }
-        } else {
-          if(client->async == 1) {
-#if WEBSERVER_SENDLIST_BUFSIZE == 0
-            tcp_write(client->pcb, &((unsigned char *)tmp->data.ptr)[client->ptr], (tmp->size-client->ptr), TCP_WRITE_FLAG_MORE);
-#else
-            tcp_write(client->pcb, &((unsigned char *)tmp->data.fixed)[client->ptr], (tmp->size-client->ptr), TCP_WRITE_FLAG_MORE);
-#endif
-          } else {
-#if WEBSERVER_SENDLIST_BUFSIZE == 0
-            if(client->client->write(&((unsigned char *)tmp->data.ptr)[client->ptr], (tmp->size-client->ptr)) > 0) {
-#else
-            if(client->client->write(&((unsigned char *)tmp->data.fixed)[client->ptr], (tmp->size-client->ptr)) > 0) {
-#endif
-              if(client->is_websocket == 0) {
-                client->lastseen = millis();
-              }
-            }
-          }
-        }
-        i += (tmp->size-client->ptr);
-        client->totallen -= (tmp->size-client->ptr);
+  client->data.boundary = NULL;
+  memset(&client->buffer, 0, WEBSERVER_BUFFER_SIZE);
+}
 
-        if(tmp->type == 0) {
-#if WEBSERVER_SENDLIST_BUFSIZE == 0
-            free(tmp->data.ptr);
-#else
-            memset(&tmp->data.fixed, 0, WEBSERVER_SENDLIST_BUFSIZE);
-#endif
-          }
+/*
+ * Keeps what came in after the request being answered.
+ * When that doesn't fit the connection closes after
+ * the response, the client then sends it again.
+ */
+static void webserver_pipeline_append(struct webserver_t *client, uint8_t *buf, uint16_t len) {
+  uint8_t *tmp = NULL;
+
+  if(client->keepalive == 0 || len == 0) {
+    return;
+  }
 
-        tmp->data.ptr = NULL;
-#if WEBSERVER_MAX_SENDLIST == 0
-        client->sendlist = client->sendlist->next;
-        free(tmp);
-        tmp = client->sendlist;
-#else
-        tmp = NULL;
-        for(y=x+1;y<WEBSERVER_MAX_SENDLIST;y++) {
-          if(
-#if WEBSERVER_SENDLIST_BUFSIZE == 0
-            client->sendlist[y].data.ptr != NULL
-#else
-            (client->sendlist[y].type == 1 && client->sendlist[y].data.ptr != NULL) ||
-            (client->sendlist[y].type == 0 && strlen((char *)client->sendlist[y].data.fixed) > 0)
-#endif
-          ) {
-            tmp = &client->sendlist[y];
-            x = y;
-            break;
-          }
-        }
-#endif
+  if(client->pipeline_len + len > WEBSERVER_READ_SIZE ||
+    (tmp = (uint8_t *)realloc(client->pipeline, client->pipeline_len + len)) == NULL) {
+    free(client->pipeline);
+    client->pipeline = NULL;
+    client->pipeline_len = 0;
+    client->keepalive = 0;
+    return;
+  }
+
+  client->pipeline = tmp;
+  memcpy(&client->pipeline[client->pipeline_len], buf, len);
+  client->pipeline_len += len;
+}
+
+/*
+ * Ends the request once its response went out. A connection
+ * kept alive waits for the next request, those pipelined
+ * behind this one are parsed right away.
+ */
+static void webserver_response_done(struct webserver_t *client) {
+  uint8_t *pipeline = client->pipeline;
+  uint16_t len = client->pipeline_len;
+
+  client->step = WEBSERVER_CLIENT_CLOSE;
+  if(client->keepalive == 0) {
+    return;
+  }
+
+  if(client->callback != NULL) {
+    client->callback(client, NULL);
+  }
+
+  client->pipeline = NULL;
+  client->pipeline_len = 0;
+  webserver_reset_request(client);
+
+  client->requests++;
+  client->lastseen = millis();
+  client->step = WEBSERVER_CLIENT_REQUEST_METHOD;
+
+  if(pipeline != NULL) {
+    webserver_sync_receive(client, pipeline, len);
+    free(pipeline);
+  }
+}
+
+/*
+ * A write callback returning -1 closes the connection,
+ * unless the response already went out in full.
+ */
+static void webserver_write_end(struct webserver_t *client) {
+  if(client->complete == 1) {
+    webserver_response_done(client);
+  } else {
+    client->step = WEBSERVER_CLIENT_CLOSE;
+  }
+}
+
+/*
+ * Content the network stack didn't take is
+ * written on the next call. A chunk that was
+ * cut short is finished first, before the
+ * next chunk header.
+ */
+static int webserver_process_send(struct webserver_t *client) {
+  struct sendlist_t *tmp = webserver_sendlist_next(client, NULL);
+  uint32_t room = client->totallen;
+  uint16_t i = 0, n = 0, w = 0;
+
+  if(client->chunked == 1 && tmp != NULL && client->chunkleft == 0) {
+    struct sendlist_t *node = tmp;
+    uint32_t len = 0;
+    uint16_t ptr = client->ptr;
+
+    while(node != NULL && len < client->totallen) {
+      len += node->size - ptr;
+      node = webserver_sendlist_next(client, node);
+      ptr = 0;
+    }
+
+    unsigned char chunk_size[12];
+    n = snprintf_P((char *)chunk_size, sizeof(chunk_size), PSTR("%X\r\n"), MIN(len, client->totallen));
+
+    if((w = webserver_send_data(client, chunk_size, n, 0)) == 0) {
+      return 0;
+    }
+    /*
+     * A partial header can't be taken
+     * back, so the response is lost.
+     */
+    if(w < n) {
+      client->step = WEBSERVER_CLIENT_CLOSE;
+      return -1;
+    }
+    client->chunkleft = MIN(len, client->totallen);
+    i += n;
+  }
+
+  if(client->chunked == 1 && tmp != NULL) {
+    room = MIN(room, client->chunkleft);
+  }
+
+  if(tmp != NULL) {
+    while(tmp != NULL && room > 0) {
+      n = MIN((uint32_t)(tmp->size - client->ptr), room);
+      w = webserver_send_fragment(client, tmp, n);
+
+      i += w;
+      client->ptr += w;
+      client->totallen -= w;
+      room -= w;
+      if(client->chunked == 1) {
+        client->chunkleft -= w;
+      }
+
+      if(client->ptr == tmp->size) {
+        tmp = webserver_sendlist_pop(client, tmp);
         client->ptr = 0;
-      } else {
-        if(tmp->type == 1) {
-          memcpy_P(cpy, &((PGM_P)tmp->data.ptr)[client->ptr], client->totallen);
-          if(client->async == 1) {
-            tcp_write(client->pcb, cpy, client->totallen, TCP_WRITE_FLAG_MORE);
-          } else {
-            if(client->client->write(cpy, client->totallen) > 0) {
-              if(client->is_websocket == 0) {
-                client->lastseen = millis();
-              }
-            }
-          }
-        } else {
-          if(client->async == 1) {
-#if WEBSERVER_SENDLIST_BUFSIZE == 0
-            tcp_write(client->pcb, &((unsigned char *)tmp->data.ptr)[client->ptr], client->totallen, TCP_WRITE_FLAG_MORE);
-#else
-            tcp_write(client->pcb, &((unsigned char *)tmp->data.fixed)[client->ptr], client->totallen, TCP_WRITE_FLAG_MORE);
-#endif
-          } else {
-#if WEBSERVER_SENDLIST_BUFSIZE == 0
-            if(client->client->write(&((unsigned char *)tmp->data.ptr)[client->ptr], client->totallen) > 0) {
-#else
-            if(client->client->write(&((unsigned char *)tmp->data.fixed)[client->ptr], client->totallen) > 0) {
-#endif
-              if(client->is_websocket == 0) {
-                client->lastseen = millis();
-              }
-            }
-          }
-        }
-        client->ptr += client->totallen;
-        client->totallen = 0;
+      }
+      if(w < n) {
+        break;
       }
     }
-    if(client->chunked == 1) {
+    if(client->chunked == 1 && client->chunkleft == 0) {
+      if(webserver_send_data(client, (unsigned char *)PSTR("\r\n"), 2, 1) < 2) {
+        client->step = WEBSERVER_CLIENT_CLOSE;
+        return -1;
+      }
+    }
+    if(client->chunked == 1 && client->chunkleft > 0) {
       if(client->async == 1) {
-        tcp_write_P(client->pcb, PSTR("\r\n"), 2, TCP_WRITE_FLAG_MORE);
-      } else {
-        if(client->client->write_P((char *)PSTR("\r\n"), 2) > 0) {
-          if(client->is_websocket == 0) {
-            client->lastseen = millis();
-          }
-        }
+        tcp_output(client->pcb);
       }
+      return i;
     }
   }
 
@@ -1557,17 +1736,12 @@ static int webserver_process_send(struct webserver_t *client) {
 #if WEBSERVER_MAX_SENDLIST > 0
     uint8_t x = 0;
     for(x=0;x<WEBSERVER_MAX_SENDLIST;x++) {
-      tmp = &client->sendlist[x];
-      if(tmp->type == 0) {
-        #if WEBSERVER_SENDLIST_BUFSIZE > 0
-          memset(&tmp->data.fixed, 0, WEBSERVER_SENDLIST_BUFSIZE+1);
-        #endif
-      }
-      tmp->data.ptr = NULL;
-      memset(tmp, 0, sizeof(struct sendlist_t));
+      memset(&client->sendlist[x], 0, sizeof(struct sendlist_t));
     }
 #endif
-    tmp = NULL;
+#if WEBSERVER_SENDLIST_BUFSIZE == 0 && WEBSERVER_SENDLIST_ARENA > 0
+    client->sendarena_len = 0;
+#endif
 
     client->content++;
     if(client->is_websocket == 1) {
@@ -1581,51 +1755,19 @@ static int webserver_process_send(struct webserver_t *client) {
         client->step = WEBSERVER_CLIENT_SENDING;
       }
 
-#if WEBSERVER_MAX_SENDLIST == 0
-      tmp = client->sendlist;
-#else
-      for(x=0;x<WEBSERVER_MAX_SENDLIST;x++) {
-        if(
-#if WEBSERVER_SENDLIST_BUFSIZE == 0
-          client->sendlist[x].data.ptr != NULL
-#else
-          (client->sendlist[x].type == 1 && client->sendlist[x].data.ptr != NULL) ||
-          (client->sendlist[x].type == 0 && strlen((char *)client->sendlist[x].data.fixed) > 0)
-#endif
-        ) {
-          tmp = &client->sendlist[x];
-          break;
-        }
-      }
-#endif
+      tmp = webserver_sendlist_next(client, NULL);
       if(tmp == NULL) {
         if(client->chunked == 1) {
-          if(client->async == 1) {
-            tcp_write_P(client->pcb, PSTR("0\r\n\r\n"), 5, 0);
-          } else {
-            if(client->client->write_P((char *)PSTR("0\r\n\r\n"), 5) > 0) {
-              if(client->is_websocket == 0) {
-                client->lastseen = millis();
-              }
-            }
+          if(webserver_send_data(client, (unsigned char *)PSTR("0\r\n\r\n"), 5, 1) < 5) {
+            client->step = WEBSERVER_CLIENT_CLOSE;
+            return -1;
           }
           i += 5;
-        } else {
-          if(client->async == 1) {
-            tcp_write_P(client->pcb, PSTR("\r\n\r\n"), 4, 0);
-          } else {
-            if(client->client->write_P((char *)PSTR("\r\n\r\n"), 4) > 0) {
-              if(client->is_websocket == 0) {
-                client->lastseen = millis();
-              }
-            }
-          }
-          i += 4;
         }
-        client->step = WEBSERVER_CLIENT_CLOSE;
         client->userdata = NULL;
         client->ptr = 0;
         client->content = 0;
+        webserver_response_done(client);
       }
     }
   }
@@ -1637,128 +1779,120 @@ static int webserver_process_send(struct webserver_t *client) {
 }
 
 void webserver_send_content_P(struct webserver_t *client, PGM_P buf, uint16_t size) {
-  struct sendlist_t *node = NULL;
+  struct sendlist_t *node = webserver_sendlist_alloc(client);
 
-#if WEBSERVER_MAX_SENDLIST == 0
-  node = (struct sendlist_t *)malloc(sizeof(struct sendlist_t));
-  /*LCOV_EXCL_START*/
   if(node == NULL) {
-  #ifdef ESP8266
-    Serial1.printf(PSTR("Out of memory %s:#%d\n"), __FUNCTION__, __LINE__);
-    ESP.restart();
-    exit(-1);
-  #endif
-  }
-#else
-  uint8_t i = 0;
-  for(i=0;i<WEBSERVER_MAX_SENDLIST;i++) {
-    if(
-#if WEBSERVER_SENDLIST_BUFSIZE == 0
-      client->sendlist[i].data.ptr == NULL
-#else
-      (client->sendlist[i].type == 1 && client->sendlist[i].data.ptr == NULL) ||
-      (client->sendlist[i].type == 0 && strlen((char *)client->sendlist[i].data.fixed) == 0)
-#endif
-    ) {
-      node = &client->sendlist[i];
-      break;
-    }
-  }
-  if(node == NULL) {
-  #ifdef ESP8266
-    log_message(PSTR("Sendlist queue is full"));
-  #else
-    printf("Sendlist queue is full\n");
-  #endif
     return;
   }
-#endif
 
-  /*LCOV_EXCL_STOP*/
-  memset(node, 0, sizeof(struct sendlist_t));
   node->data.ptr = (void *)buf;
   node->size = size;
   node->type = 1;
 
-#if WEBSERVER_MAX_SENDLIST == 0
-  if(client->sendlist == NULL) {
-    client->sendlist = node;
-    client->sendlist_head = node;
-  } else {
-    client->sendlist_head->next = node;
-    client->sendlist_head = node;
-  }
-#endif
+  webserver_sendlist_append(client, node);
 }
 
+/*
+ * Content outside PROGMEM is copied into the client
+ * arena, which is emptied once the sendlist drained.
+ */
 void webserver_send_content(struct webserver_t *client, char *buf, uint16_t size) {
-  struct sendlist_t *node = NULL;
+  struct sendlist_t *node = webserver_sendlist_alloc(client);
 
-#if WEBSERVER_MAX_SENDLIST == 0
-  node = (struct sendlist_t *)malloc(sizeof(struct sendlist_t));
-  /*LCOV_EXCL_START*/
   if(node == NULL) {
-  #ifdef ESP8266
-    Serial1.printf(PSTR("Out of memory %s:#%d\n"), __FUNCTION__, __LINE__);
-    ESP.restart();
-    exit(-1);
-  #endif
-  }
-#else
-  uint8_t i = 0;
-  for(i=0;i<WEBSERVER_MAX_SENDLIST;i++) {
-    if(
-#if WEBSERVER_SENDLIST_BUFSIZE == 0
-      client->sendlist[i].data.ptr == NULL
-#else
-      (client->sendlist[i].type == 1 && client->sendlist[i].data.ptr == NULL) ||
-      (client->sendlist[i].type == 0 && strlen((char *)client->sendlist[i].data.fixed) == 0)
-#endif
-    ) {
-      node = &client->sendlist[i];
-      break;
-    }
-  }
-  if(node == NULL) {
-  #ifdef ESP8266
-    log_message(PSTR("Sendlist queue is full"));
-  #else
-    printf("Sendlist queue is full\n");
-  #endif
     return;
   }
-#endif
-  memset(node, 0, sizeof(struct sendlist_t));
+
 #if WEBSERVER_SENDLIST_BUFSIZE > 0
   int x = 0;
   for(x=0;x<size && x<WEBSERVER_SENDLIST_BUFSIZE;x++) {
     node->data.fixed[x] = buf[x];
   }
 #else
-  if((node->data.ptr = malloc(size+1)) == NULL) {
-  #ifdef ESP8266
-    Serial1.printf(PSTR("Out of memory %s:#%d\n"), __FUNCTION__, __LINE__);
-    ESP.restart();
-    exit(-1);
-  #endif
+#if WEBSERVER_SENDLIST_ARENA > 0
+  if(client->sendarena_len + size <= WEBSERVER_SENDLIST_ARENA) {
+    node->data.ptr = &client->sendarena[client->sendarena_len];
+    client->sendarena_len += size;
+  } else {
+#endif
+    if((node->data.ptr = malloc(size+1)) == NULL) {
+    #ifdef ESP8266
+      Serial1.printf(PSTR("Out of memory %s:#%d\n"), __FUNCTION__, __LINE__);
+      ESP.restart();
+      exit(-1);
+    #endif
+    }
+    node->heap = 1;
+#if WEBSERVER_SENDLIST_ARENA > 0
   }
+#endif
   memcpy(node->data.ptr, buf, size);
 #endif
 
   node->size = size;
   node->type = 0;
 
-#if WEBSERVER_MAX_SENDLIST == 0
-  if(client->sendlist == NULL) {
-    client->sendlist = node;
-    client->sendlist_head = node;
-  } else {
-    client->sendlist_head->next = node;
-    client->sendlist_head = node;
+  webserver_sendlist_append(client, node);
+}
+
+/*
+ * Content that stays in place until it went
+ * out is queued as is, without a copy.
+ */
+static void webserver_send_content_ref(struct webserver_t *client, char *buf, uint16_t size) {
+#if WEBSERVER_SENDLIST_BUFSIZE > 0
+  webserver_send_content(client, buf, size);
+#else
+  struct sendlist_t *node = webserver_sendlist_alloc(client);
+
+  if(node == NULL) {
+    return;
   }
+
+  node->data.ptr = buf;
+  node->size = size;
+  node->type = 0;
+
+  webserver_sendlist_append(client, node);
 #endif
 }
 
+/*
+ * Answers with a bodyless 304 when the If-None-Match
+ * header of the request carries the same etag. Otherwise
+ * the etag is added to the headers of the response.
+ */
+int8_t webserver_send_etag(struct webserver_t *client, uint32_t etag) {
+  if(client->etag != 0 && client->etag == etag) {
+    char buffer[160];
+    uint16_t i = snprintf_P(buffer, sizeof(buffer),
+      PSTR("HTTP/1.1 304 %s\r\nServer: ESP8266\r\nETag: \"%08lx\"\r\nCache-Control: no-cache\r\n"),
+      code_to_text(304), (unsigned long)etag
+    );
+    i += webserver_connection_header(client, &buffer[i], sizeof(buffer)-i);
+    i += snprintf_P(&buffer[i], sizeof(buffer)-i, PSTR("\r\n"));
+
+    if(client->async == 1) {
+      tcp_write(client->pcb, buffer, i, TCP_WRITE_FLAG_COPY);
+      tcp_output(client->pcb);
+    } else {
+      if(client->client->write((unsigned char *)buffer, i) > 0) {
+        client->lastseen = millis();
+      }
+    }
+    /*
+     * The response is whole, so the connection
+     * can stay when the callback ends the request.
+     */
+    client->complete = 1;
+    return 1;
+  }
+
+  client->etag = etag;
+  client->cached = 1;
+  return 0;
+}
+
 int8_t webserver_send(struct webserver_t *client, uint16_t code, char *mimetype, uint16_t data_len) {
   uint16_t i = 0;
   if(data_len == 0) {
@@ -1781,6 +1915,7 @@ int8_t webserver_send(struct webserver_t *client, uint16_t code, char *mimetype,
             header.ptr += snprintf((char *)&p[header.ptr], sizeof(buffer)-header.ptr, PSTR("\r\n\r\n"));
           }
         }
+        client->keepalive = 0;
         client->step = WEBSERVER_CLIENT_WRITE;
         i = header.ptr;
         goto done;
@@ -1792,7 +1927,10 @@ int8_t webserver_send(struct webserver_t *client, uint16_t code, char *mimetype,
       client->step = WEBSERVER_CLIENT_WRITE;
     }
 
-    i += snprintf((char *)&p[i], sizeof(buffer)-i, PSTR("Keep-Alive: timeout=15, max=100\r\n"));
+    i += webserver_connection_header(client, (char *)&p[i], sizeof(buffer)-i);
+    if(client->cached == 1) {
+      i += snprintf_P((char *)&p[i], sizeof(buffer)-i, PSTR("ETag: \"%08lx\"\r\nCache-Control: no-cache\r\n"), (unsigned long)client->etag);
+    }
     i += snprintf((char *)&p[i], sizeof(buffer)-i, PSTR("Content-Type: %s\r\n"), mimetype);
     i += snprintf((char *)&p[i], sizeof(buffer)-i, PSTR("Transfer-Encoding: chunked\r\n\r\n"));
 
@@ -1821,28 +1959,61 @@ done:
 
 /* LCOV_EXCL_START*/
 static void webserver_client_close(struct webserver_t *client) {
+  client->step = WEBSERVER_CLIENT_CLOSE;
   if(client->callback != NULL) {
     client->callback(client, NULL);
   }
 #ifdef ESP8266
   char log_msg[256];
-  sprintf_P(log_msg, PSTR("Closing webserver client: %s:%d"), IPAddress(client->pcb->remote_ip.addr).toString().c_str(), client->pcb->remote_port);
-  log_message(log_msg);
+  if(client->async == 1) {
+    sprintf_P(log_msg, PSTR("Closing webserver client: %s:%d"), IPAddress(client->pcb->remote_ip.addr).toString().c_str(), client->pcb->remote_port);
+    log_message(log_msg);
 
-  client->step = 0;
+    client->step = 0;
 
-  tcp_recv(client->pcb, NULL);
-  tcp_sent(client->pcb, NULL);
-  tcp_poll(client->pcb, NULL, 0);
+    tcp_recv(client->pcb, NULL);
+    tcp_sent(client->pcb, NULL);
+    tcp_poll(client->pcb, NULL, 0);
 
-  tcp_close(client->pcb);
-  client->pcb = NULL;
+    tcp_close(client->pcb);
+    client->pcb = NULL;
+  } else {
+    sprintf_P(log_msg, PSTR("Closing webserver client: %s:%d"), client->client->remoteIP().toString().c_str(), client->client->remotePort());
+    log_message(log_msg);
+
+    client->client->stop();
+  }
 
   webserver_reset_client(client);
 #endif
 }
 /* LCOV_EXCL_STOP*/
 
+/*
+ * With all clients taken, the connection idling the
+ * longest between two requests makes room for the new
+ * one. Connections busy with a request are left alone.
+ */
+static void webserver_make_room(uint8_t async) {
+  uint8_t i = 0, idle = WEBSERVER_MAX_CLIENTS;
+
+  for(i=0;i<WEBSERVER_MAX_CLIENTS;i++) {
+    if((async == 1 && clients[i].data.pcb == NULL) || (async == 0 && clients[i].data.client == NULL)) {
+      return;
+    }
+    if(clients[i].data.step == WEBSERVER_CLIENT_REQUEST_METHOD) {
+      if(idle == WEBSERVER_MAX_CLIENTS ||
+        (unsigned long)(millis() - clients[i].data.lastseen) > (unsigned long)(millis() - clients[idle].data.lastseen)) {
+        idle = i;
+      }
+    }
+  }
+
+  if(idle < WEBSERVER_MAX_CLIENTS) {
+    webserver_client_close(&clients[idle].data);
+  }
+}
+
 #ifdef ESP8266
 err_t webserver_sent(void *arg, tcp_pcb *pcb, uint16_t len) {
   uint16_t i = 0;
@@ -1850,7 +2021,7 @@ err_t webserver_sent(void *arg, tcp_pcb *pcb, uint16_t len) {
     if(clients[i].data.pcb == pcb) {
       if(clients[i].data.step == WEBSERVER_CLIENT_WRITE) {
         if(clients[i].data.callback(&clients[i].data, NULL) == -1) {
-          clients[i].data.step = WEBSERVER_CLIENT_CLOSE;
+          webserver_write_end(&clients[i].data);
         } else {
           clients[i].data.step = WEBSERVER_CLIENT_SENDING;
         }
@@ -1877,7 +2048,10 @@ err_t webserver_sent(void *arg, tcp_pcb *pcb, uint16_t len) {
 static void send_websocket_handshake(struct webserver_t *client, const char *key) {
   char cpy[61] = { 0 };
   char input[20] = { 0 };
-  char encoded[20] = { 0 };
+  /*
+   * Base64 of the 20 bytes digest
+   */
+  char encoded[29] = { 0 };
 
   const char *magic = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
 
@@ -1934,6 +2108,122 @@ void websocket_write_all(char *data, uint16_t data_len) {
   }
 }
 
+/*
+ * Queues a log line for every websocket. Once a client
+ * lags behind, the lines that don't fit are dropped and
+ * counted until its queue was sent.
+ */
+void websocket_log(char *data, uint16_t data_len) {
+  struct websocket_log_t *log = NULL;
+  uint8_t i = 0, sep = 0;
+  for(i=0;i<WEBSERVER_MAX_CLIENTS;i++) {
+    if(clients[i].data.is_websocket == 0 || clients[i].data.step == WEBSERVER_CLIENT_CLOSE) {
+      continue;
+    }
+    if(clients[i].data.log == NULL) {
+      /*
+       * Without memory the console misses
+       * these lines, nothing else
+       */
+      if((clients[i].data.log = (struct websocket_log_t *)malloc(sizeof(struct websocket_log_t))) == NULL) {
+        continue;
+      }
+      clients[i].data.log->flushed = millis();
+      clients[i].data.log->len = 0;
+      clients[i].data.log->sent = 0;
+      clients[i].data.log->dropped = 0;
+    }
+    log = clients[i].data.log;
+    sep = (log->len > log->sent) ? 1 : 0;
+
+    /*
+     * Nothing is added behind dropped lines, so the
+     * marker ends up where the lines went missing.
+     */
+    if(log->dropped > 0 || log->len + sep + data_len > WEBSOCKET_LOG_BUFSIZE) {
+      if(log->dropped < 0xFFFF) {
+        log->dropped++;
+      }
+      continue;
+    }
+    if(sep == 1) {
+      log->buffer[log->len++] = '\n';
+    }
+    memcpy(&log->buffer[log->len], data, data_len);
+    log->len += data_len;
+  }
+}
+
+/*
+ * Sends the queued log lines as one frame, but only when
+ * the previous frame went out and the connection takes
+ * this one without blocking. Otherwise they are tried
+ * again on the next call. The frame is sent from the
+ * log buffer itself, new lines are added behind it.
+ */
+static void websocket_log_flush(struct webserver_t *client) {
+  struct websocket_log_t *log = client->log;
+  char marker[40];
+  uint16_t n = 0, len = 0;
+
+  if(log == NULL) {
+    return;
+  }
+  if(client->step != WEBSERVER_CLIENT_WEBSOCKET) {
+    return;
+  }
+  /*
+   * Pings and pongs are queued without
+   * being sent, that happens here.
+   */
+  if(webserver_sendlist_next(client, NULL) != NULL) {
+    client->step = WEBSERVER_CLIENT_SENDING;
+    return;
+  }
+  if(log->sent > 0) {
+    memmove(log->buffer, &log->buffer[log->sent], log->len - log->sent);
+    log->len -= log->sent;
+    log->sent = 0;
+  }
+  if(log->len == 0 && log->dropped == 0) {
+    return;
+  }
+  if((unsigned long)(millis() - log->flushed) < WEBSOCKET_LOG_INTERVAL) {
+    return;
+  }
+
+  if(log->dropped > 0) {
+    n = snprintf_P(marker, sizeof(marker), PSTR("%s-- %u log lines dropped --"), (log->len > 0) ? "\n" : "", log->dropped);
+  }
+  len = log->len + n;
+
+#ifdef ESP8266
+  /*
+   * Room for the frame header included
+   */
+  if(client->async == 1) {
+    if(tcp_sndbuf(client->pcb) < len + 4) {
+      return;
+    }
+  } else if(client->client->availableForWrite() < (size_t)(len + 4)) {
+    return;
+  }
+#endif
+
+  websocket_send_header(client, WEBSOCKET_OPCODE_TEXT, len);
+  if(log->len > 0) {
+    webserver_send_content_ref(client, log->buffer, log->len);
+  }
+  if(n > 0) {
+    webserver_send_content(client, marker, n);
+  }
+  client->step = WEBSERVER_CLIENT_SENDING;
+
+  log->sent = log->len;
+  log->dropped = 0;
+  log->flushed = millis();
+}
+
 void websocket_write_all_P(PGM_P data, uint16_t data_len) {
   uint8_t i = 0;
   for(i=0;i<WEBSERVER_MAX_CLIENTS;i++) {
@@ -2041,6 +2331,13 @@ int websocket_read(struct webserver_t *client, unsigned char *buf, ssize_t buf_l
 }
 
 uint8_t webserver_sync_receive(struct webserver_t *client, uint8_t *rbuffer, uint16_t size) {
+  if(client->step == WEBSERVER_CLIENT_REQUEST_METHOD && size > 0) {
+    client->step = WEBSERVER_CLIENT_READ_HEADER;
+  }
+  if(client->step == WEBSERVER_CLIENT_WRITE || client->step == WEBSERVER_CLIENT_SENDING) {
+    webserver_pipeline_append(client, rbuffer, size);
+    return 0;
+  }
   if(client->step == WEBSERVER_CLIENT_READ_HEADER) {
     if(http_parse_request(client, &rbuffer, &size) == 0) {
       if(client->is_websocket == 1 && client->data.websockkey != NULL) {
@@ -2074,6 +2371,16 @@ uint8_t webserver_sync_receive(struct webserver_t *client, uint8_t *rbuffer, uin
         }
       } else if(client->step != WEBSERVER_CLIENT_WEBSOCKET) {
         client->step = WEBSERVER_CLIENT_WRITE;
+        /*
+         * Anything after the headers is the next
+         * request, unless this one has a body.
+         */
+        if(client->totallen > 0) {
+          client->keepalive = 0;
+        }
+        webserver_pipeline_append(client, client->buffer, client->ptr);
+        webserver_pipeline_append(client, rbuffer, size);
+        client->ptr = 0;
       }
     }
   }
@@ -2136,11 +2443,14 @@ err_t webserver_async_receive(void *arg, tcp_pcb *pcb, struct pbuf *data, err_t
             client->totallen -= 16;
             if(client->callback != NULL) {
               if(client->callback(client, NULL) == -1) {
-                client->step = WEBSERVER_CLIENT_CLOSE;
-                return -1;
+                webserver_write_end(client);
+                if(client->step == WEBSERVER_CLIENT_CLOSE) {
+                  return -1;
+                }
+              } else {
+                client->content++;
+                client->ptr = 0;
               }
-              client->content++;
-              client->ptr = 0;
             } else {
               client->step = WEBSERVER_CLIENT_CLOSE;
               return -1;
@@ -2168,6 +2478,7 @@ err_t webserver_poll(void *arg, struct tcp_pcb *pcb) {
           websocket_send_header(&clients[i].data, WEBSOCKET_OPCODE_PING, 0);
           clients[i].data.lastping = millis();
         }
+        websocket_log_flush(&clients[i].data);
       }
       if((unsigned long)(millis() - clients[i].data.lastseen) > WEBSERVER_CLIENT_TIMEOUT) {
   #ifdef ESP8266
@@ -2177,6 +2488,9 @@ err_t webserver_poll(void *arg, struct tcp_pcb *pcb) {
   #endif
         clients[i].data.step = WEBSERVER_CLIENT_CLOSE;
         webserver_client_close(&clients[i].data);
+      } else if(clients[i].data.step == WEBSERVER_CLIENT_REQUEST_METHOD &&
+        (unsigned long)(millis() - clients[i].data.lastseen) > WEBSERVER_CLIENT_KEEPALIVE_TIMEOUT) {
+        webserver_client_close(&clients[i].data);
       }
       break;
     }
@@ -2198,72 +2512,25 @@ void webserver_reset_client(struct webserver_t *client) {
   }
 #endif
 
-  client->readlen = 0;
-  client->reqtype = 0;
-  client->method = 0;
+  webserver_reset_request(client);
+
+  if(client->log != NULL) {
+    free(client->log);
+    client->log = NULL;
+  }
+
   client->async = 0;
-  client->totallen = 0;
   client->step = 0;
-  client->substep = 0;
-  client->chunked = 0;
-  client->ptr = 0;
-  client->route = 0;
+  client->requests = 0;
   client->lastseen = 0;
   client->lastping = 0;
-  client->content = 0;
   client->is_websocket = 0;
-  client->userdata = NULL;
-
-  struct sendlist_t *tmp = NULL;
-#if WEBSERVER_MAX_SENDLIST == 0
-  while(client->sendlist) {
-    tmp = client->sendlist;
-    client->sendlist = client->sendlist->next;
-    if(tmp->type == 0) {
-      #if WEBSERVER_SENDLIST_BUFSIZE == 0
-        free(tmp->data.ptr);
-      #else
-        memset(&tmp->data.fixed, 0, WEBSERVER_SENDLIST_BUFSIZE);
-      #endif
-    }
-    tmp->data.ptr = NULL;
-    free(tmp);
-  }
-#else
-  uint8_t i = 0;
-  for(i=0;i<WEBSERVER_MAX_SENDLIST;i++) {
-    tmp = &client->sendlist[i];
-    if(tmp->type == 0) {
-      #if WEBSERVER_SENDLIST_BUFSIZE == 0
-        free(tmp->data.ptr);
-      #else
-        memset(&tmp->data.fixed, 0, WEBSERVER_SENDLIST_BUFSIZE);
-      #endif
-    }
-    tmp->data.ptr = NULL;
-    memset(tmp, 0, sizeof(struct sendlist_t));
-  }
-#endif
-  if(client->data.boundary != NULL) {
-    free(client->data.boundary);
-    client->data.boundary = NULL;
-  }
-  if(client->data.websockkey != NULL) {
-    free(client->data.websockkey);
-    client->data.websockkey = NULL;
-  }
-
-#if WEBSERVER_MAX_SENDLIST == 0
-  client->sendlist = NULL;
-  client->sendlist_head = NULL;
-#endif
-  client->data.boundary = NULL;
-  memset(&client->buffer, 0, WEBSERVER_BUFFER_SIZE);
 }
 
 #ifdef ESP8266
 err_t webserver_client(void *arg, tcp_pcb *pcb, err_t err) {
   uint8_t i = 0;
+  webserver_make_room(1);
   for(i=0;i<WEBSERVER_MAX_CLIENTS;i++) {
     if(clients[i].data.pcb == NULL) {
       webserver_reset_client(&clients[i].data);
@@ -2294,6 +2561,7 @@ void webserver_loop(void) {
     if(clients[i].data.step == 0 || clients[i].data.async == 1) {
       continue;
     }
+    size = 0;
     if(clients[i].data.is_websocket == 1) {
       if((unsigned long)(millis() - clients[i].data.lastping) > WEBSERVER_CLIENT_PING_INTERVAL) {
         websocket_send_header(&clients[i].data, WEBSOCKET_OPCODE_PING, 0);
@@ -2308,11 +2576,19 @@ void webserver_loop(void) {
 #endif
       clients[i].data.step = WEBSERVER_CLIENT_CLOSE;
     }
+    if(clients[i].data.step == WEBSERVER_CLIENT_REQUEST_METHOD &&
+      (unsigned long)(millis() - clients[i].data.lastseen) > WEBSERVER_CLIENT_KEEPALIVE_TIMEOUT) {
+      clients[i].data.step = WEBSERVER_CLIENT_CLOSE;
+    }
 
     if(!clients[i].data.client->connected()) {
       clients[i].data.step = WEBSERVER_CLIENT_CLOSE;
     }
 
+    if(clients[i].data.is_websocket == 1) {
+      websocket_log_flush(&clients[i].data);
+    }
+
     switch(clients[i].data.step) {
       case WEBSERVER_CLIENT_CONNECTING: {
         if(clients[i].data.client->available()) {
@@ -2321,9 +2597,15 @@ void webserver_loop(void) {
         clients[i].data.ptr = 0;
         memset(&clients[i].data.buffer, 0, WEBSERVER_BUFFER_SIZE);
       } break;
+      case WEBSERVER_CLIENT_REQUEST_METHOD:
       case WEBSERVER_CLIENT_ARGS:
       case WEBSERVER_CLIENT_WEBSOCKET:
       case WEBSERVER_CLIENT_READ_HEADER: {
+        /*
+         * Data is only read once the previous read was handled,
+         * e.g. flashed. Until then the receive window of the
+         * connection holds back the sender.
+         */
         if(clients[i].data.client->connected() || clients[i].data.client->available()) {
           if(clients[i].data.client->available()) {
             uint8_t *p = (uint8_t *)rbuffer;
@@ -2345,8 +2627,10 @@ void webserver_loop(void) {
       case WEBSERVER_CLIENT_WRITE: {
         if(clients[i].data.callback != NULL) {
           if(clients[i].data.step == WEBSERVER_CLIENT_WRITE) {
-            if(clients[i].data.callback(&clients[i].data, NULL) == -1) {
-              clients[i].data.step = WEBSERVER_CLIENT_CLOSE;
+            int8_t ret = clients[i].data.callback(&clients[i].data, NULL);
+            clients[i].data.ptr = 0;
+            if(ret == -1) {
+              webserver_write_end(&clients[i].data);
             } else if(clients[i].data.content > 0) {
               clients[i].data.step = WEBSERVER_CLIENT_SENDING;
             } else {
@@ -2354,7 +2638,6 @@ void webserver_loop(void) {
               clients[i].data.content++;
             }
           }
-          clients[i].data.ptr = 0;
         } else {
           clients[i].data.step = WEBSERVER_CLIENT_CLOSE;
           continue;
@@ -2370,16 +2653,7 @@ void webserver_loop(void) {
       } break;
 #ifdef ESP8266
       case WEBSERVER_CLIENT_CLOSE: {
-        if(clients[i].data.callback != NULL) {
-          clients[i].data.callback(&clients[i].data, NULL);
-        }
-
-        char log_msg[256];
-        sprintf_P(log_msg, PSTR("Closing webserver client: %s:%d"), clients[i].data.client->remoteIP().toString().c_str(), clients[i].data.client->remotePort());
-        log_message(log_msg);
-
-        clients[i].data.client->stop();
-        webserver_reset_client(&clients[i].data);
+        webserver_client_close(&clients[i].data);
       } break;
 #endif
     }
@@ -2387,6 +2661,7 @@ void webserver_loop(void) {
 
 #if defined(ESP8266)
   if(sync_server.hasClient()) {
+    webserver_make_room(0);
     for(i=0;i<WEBSERVER_MAX_CLIENTS;i++) {
       if(clients[i].data.client == NULL) {
         webserver_reset_client(&clients[i].data);
@@ -41,14 +41,64 @@
   #define WEBSERVER_SENDLIST_BUFSIZE 0
 #endif
 
+/*
+ * Number of sendlist nodes each client keeps
+ * in its own pool before falling back to malloc.
+ * A node takes 12 bytes on the ESP8266, so the
+ * pools of all clients take 960 bytes.
+ */
+#ifndef WEBSERVER_SENDLIST_POOL
+  #define WEBSERVER_SENDLIST_POOL 16
+#endif
+
+/*
+ * Bytes each client keeps to store copies of
+ * content not living in PROGMEM.
+ */
+#ifndef WEBSERVER_SENDLIST_ARENA
+  #define WEBSERVER_SENDLIST_ARENA 96
+#endif
+
+/*
+ * Size of the stack buffer used to copy PROGMEM
+ * content for the async tcp_write.
+ */
+#ifndef WEBSERVER_SEND_WINDOW
+  #define WEBSERVER_SEND_WINDOW 128
+#endif
+
 #ifndef WEBSERVER_CLIENT_TIMEOUT
   #define WEBSERVER_CLIENT_TIMEOUT 30000
 #endif
 
+/*
+ * Connections are kept open between requests for
+ * this long, and for at most this many requests.
+ */
+#ifndef WEBSERVER_CLIENT_KEEPALIVE_TIMEOUT
+  #define WEBSERVER_CLIENT_KEEPALIVE_TIMEOUT 15000
+#endif
+
+#ifndef WEBSERVER_CLIENT_KEEPALIVE_MAX
+  #define WEBSERVER_CLIENT_KEEPALIVE_MAX 100
+#endif
+
 #ifndef WEBSERVER_CLIENT_PING_INTERVAL
   #define WEBSERVER_CLIENT_PING_INTERVAL 3000
 #endif
 
+/*
+ * Log lines are collected per websocket and sent
+ * as one frame at most once every interval.
+ */
+#ifndef WEBSOCKET_LOG_BUFSIZE
+  #define WEBSOCKET_LOG_BUFSIZE 1024
+#endif
+
+#ifndef WEBSOCKET_LOG_INTERVAL
+  #define WEBSOCKET_LOG_INTERVAL 250
+#endif
+
 #ifndef __linux__
   #include <Arduino.h>
   #include "lwip/opt.h"
@@ -106,6 +156,9 @@ typedef struct sendlist_t {
 #endif
   uint16_t type:1;
   uint16_t size:15;
+  uint8_t used:1;
+  uint8_t pooled:1;
+  uint8_t heap:1;
 #if WEBSERVER_MAX_SENDLIST == 0
   struct sendlist_t *next;
 #endif
@@ -122,6 +175,18 @@ struct WiFiClient {
   #define PGM_P unsigned char *
 #endif
 
+typedef struct websocket_log_t {
+  unsigned long flushed;
+  uint16_t len;
+  /*
+   * Bytes at the start of the buffer that
+   * are still in the frame being sent.
+   */
+  uint16_t sent;
+  uint16_t dropped;
+  char buffer[WEBSOCKET_LOG_BUFSIZE];
+} websocket_log_t;
+
 typedef struct webserver_t {
   tcp_pcb *pcb;
   WiFiClient *client;
@@ -132,18 +197,37 @@ typedef struct webserver_t {
   uint8_t async:1;
   uint8_t method:1;
   uint8_t chunked:4;
+  uint8_t gzip:1;
+  uint8_t cached:1;
+  uint8_t keepalive:1;
+  uint8_t complete:1;
   uint8_t step:4;
   uint8_t substep:4;
   uint16_t ptr;
+  /*
+   * Bytes of the current chunk
+   * not yet written.
+   */
+  uint16_t chunkleft;
   uint32_t totallen;
   uint32_t readlen;
   uint16_t content;
   uint8_t route;
+  uint8_t requests;
+  uint32_t etag;
 #if WEBSERVER_MAX_SENDLIST == 0
   struct sendlist_t *sendlist;
   struct sendlist_t *sendlist_head;
+#if WEBSERVER_SENDLIST_POOL > 0
+  struct sendlist_t sendpool[WEBSERVER_SENDLIST_POOL];
+  uint8_t sendpool_ptr;
+#endif
 #else
   struct sendlist_t sendlist[WEBSERVER_MAX_SENDLIST];
+#endif
+#if WEBSERVER_SENDLIST_BUFSIZE == 0 && WEBSERVER_SENDLIST_ARENA > 0
+  unsigned char sendarena[WEBSERVER_SENDLIST_ARENA];
+  uint16_t sendarena_len;
 #endif
   webserver_cb_t *callback;
   unsigned char buffer[WEBSERVER_BUFFER_SIZE];
@@ -152,12 +236,27 @@ typedef struct webserver_t {
     char *websockkey;
   } data;
   void *userdata;
+  /*
+   * Pipelined requests received while
+   * the current one is answered.
+   */
+  uint8_t *pipeline;
+  uint16_t pipeline_len;
+  /*
+   * Log lines waiting to be sent to a websocket
+   */
+  struct websocket_log_t *log;
 } webserver_t;
 
 typedef struct webserver_client_t {
   struct webserver_t data;
 } webserver_client_t;
 
+/*
+ * A connection kept alive goes back to REQUEST_METHOD
+ * after each response, the callback is passed CLOSE
+ * for every request that ended.
+ */
 typedef enum {
   WEBSERVER_CLIENT_CONNECTING = 1,
   WEBSERVER_CLIENT_REQUEST_METHOD,
@@ -186,6 +285,7 @@ int8_t webserver_start(int port, webserver_cb_t *callback, uint8_t async);
 void webserver_loop(void);
 void websocket_write_all_P(PGM_P data, uint16_t data_len);
 void websocket_write_all(char *data, uint16_t data_len);
+void websocket_log(char *data, uint16_t data_len);
 void websocket_write_P(struct webserver_t *client, PGM_P data, uint16_t data_len);
 void websocket_write(struct webserver_t *client, char *data, uint16_t data_len);
 void websocket_send_header(struct webserver_t *client, uint8_t opcode, uint16_t data_len);
@@ -196,6 +296,7 @@ uint8_t webserver_sync_receive(struct webserver_t *client, uint8_t *rbuffer, uin
 void webserver_loop(void);
 int16_t urldecode(const unsigned char *src, int src_len, unsigned char *dst, int dst_len, int is_form_url_encoded);
 int8_t webserver_send(struct webserver_t *client, uint16_t code, char *mimetype, uint16_t data_len);
+int8_t webserver_send_etag(struct webserver_t *client, uint32_t etag);
 void webserver_client_stop(struct webserver_t *client);
 void webserver_reset_client(struct webserver_t *client);
 
@@ -32,8 +32,15 @@
 #include "functions/ceil.h"
 #include "functions/floor.h"
 #include "functions/settimer.h"
+#include "functions/settimerms.h"
+#include "functions/setinterval.h"
+#include "functions/setintervalms.h"
 #include "functions/isset.h"
 #include "functions/round.h"
+#include "functions/rollavg.h"
+#include "functions/rollmin.h"
+#include "functions/rollmax.h"
+#include "functions/rollslope.h"
 
 struct rule_function_t rule_functions[] = {
   { "max", rule_function_max_callback },
@@ -42,8 +49,15 @@ struct rule_function_t rule_functions[] = {
   { "floor", rule_function_floor_callback },
   { "coalesce", rule_function_coalesce_callback },
   { "settimer", rule_function_set_timer_callback },
+  { "settimerms", rule_function_set_timer_ms_callback },
+  { "setinterval", rule_function_set_interval_callback },
+  { "setintervalms", rule_function_set_interval_ms_callback },
   { "isset", rule_function_isset_callback },
-  { "round", rule_function_round_callback }
+  { "round", rule_function_round_callback },
+  { "rollavg", rule_function_rollavg_callback },
+  { "rollmin", rule_function_rollmin_callback },
+  { "rollmax", rule_function_rollmax_callback },
+  { "rollslope", rule_function_rollslope_callback }
 };
 
 unsigned int nr_rule_functions = sizeof(rule_functions)/sizeof(rule_functions[0]);
@@ -58,11 +58,18 @@ int rule_function_coalesce_callback(struct rules_t *obj, uint16_t argc, uint16_t
           obj->varstack.bufsize = MAX(obj->varstack.bufsize, alignedvarstack(obj->varstack.nrbytes));
           return 0;
         } break;
-        /* LCOV_EXCL_START*/
         case VCHAR: {
-          exit(-1);
+          unsigned int size = alignedbytes(obj->varstack.nrbytes+sizeof(struct vm_vchar_t));
+
+          struct vm_vchar_t *out = (struct vm_vchar_t *)&obj->varstack.buffer[obj->varstack.nrbytes];
+          struct vm_vchar_t *val = (struct vm_vchar_t *)&obj->varstack.buffer[argv[i]];
+          out->type = VCHAR;
+          out->ret = 0;
+          out->value = val->value;
+          obj->varstack.nrbytes = size;
+          obj->varstack.bufsize = MAX(obj->varstack.bufsize, alignedvarstack(obj->varstack.nrbytes));
+          return 0;
         } break;
-        /* LCOV_EXCL_STOP*/
         default: {
 
         } break;
@@ -70,5 +77,16 @@ int rule_function_coalesce_callback(struct rules_t *obj, uint16_t argc, uint16_t
     }
   }
 
+  /*
+   * All arguments were NULL
+   */
+  unsigned int size = alignedbytes(obj->varstack.nrbytes+sizeof(struct vm_vnull_t));
+
+  struct vm_vnull_t *out = (struct vm_vnull_t *)&obj->varstack.buffer[obj->varstack.nrbytes];
+  out->type = VNULL;
+  out->ret = 0;
+  obj->varstack.nrbytes = size;
+  obj->varstack.bufsize = MAX(obj->varstack.bufsize, alignedvarstack(obj->varstack.nrbytes));
+
   return 0;
 }
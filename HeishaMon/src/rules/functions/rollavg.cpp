@@ -0,0 +1,83 @@
+/*
+  Copyright (C) CurlyMo
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifdef ESP8266
+  #pragma GCC diagnostic warning "-fpermissive"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "../function.h"
+#include "../../common/mem.h"
+#include "../../common/rollstat.h"
+#include "../rules.h"
+
+/*
+ * Shared by rollavg, rollmin, rollmax and rollslope,
+ * which only differ in the figure taken from the
+ * window. Returns NULL while there is none.
+ */
+int rule_function_rollstat(struct rules_t *obj, uint16_t argc, uint16_t *argv, int *ret, int (*get)(struct rollstat_t *stat, float *out)) {
+  struct rollstat_t *stat = NULL;
+  float value = 0;
+
+  if(argc != 2) {
+    return -1;
+  }
+
+  /*
+   * The window is set up when the rules are
+   * parsed, so it's only found when both the
+   * topic and the size were constants.
+   */
+  if(obj->varstack.buffer[argv[0]] == VCHAR && obj->varstack.buffer[argv[1]] == VINTEGER) {
+    struct vm_vchar_t *name = (struct vm_vchar_t *)&obj->varstack.buffer[argv[0]];
+    struct vm_vinteger_t *window = (struct vm_vinteger_t *)&obj->varstack.buffer[argv[1]];
+
+    if(window->value >= ROLLSTAT_MIN_WINDOW && window->value <= ROLLSTAT_MAX_WINDOW) {
+      stat = rollstat_find(strpool_get(&rule_strings, name->value), window->value);
+    }
+  }
+
+  *ret = obj->varstack.nrbytes;
+
+  unsigned int size = 0;
+
+  if(stat != NULL && get(stat, &value) == 0) {
+    size = alignedbytes(obj->varstack.nrbytes+sizeof(struct vm_vfloat_t));
+
+    struct vm_vfloat_t *out = (struct vm_vfloat_t *)&obj->varstack.buffer[obj->varstack.nrbytes];
+    out->ret = 0;
+    out->type = VFLOAT;
+    out->value = value;
+  } else {
+    size = alignedbytes(obj->varstack.nrbytes+sizeof(struct vm_vnull_t));
+
+    struct vm_vnull_t *out = (struct vm_vnull_t *)&obj->varstack.buffer[obj->varstack.nrbytes];
+    out->ret = 0;
+    out->type = VNULL;
+  }
+
+  obj->varstack.nrbytes = size;
+  obj->varstack.bufsize = MAX(obj->varstack.bufsize, alignedvarstack(obj->varstack.nrbytes));
+
+  return 0;
+}
+
+int rule_function_rollavg_callback(struct rules_t *obj, uint16_t argc, uint16_t *argv, int *ret) {
+/* LCOV_EXCL_START*/
+#ifdef DEBUG
+  printf("%s\n", __FUNCTION__);
+#endif
+/* LCOV_EXCL_STOP*/
+
+  return rule_function_rollstat(obj, argc, argv, ret, rollstat_avg);
+}
@@ -0,0 +1,19 @@
+/*
+  Copyright (C) CurlyMo
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef _RULES_ROLLAVG_H_
+#define _RULES_ROLLAVG_H_
+
+#include <stdint.h>
+#include "../rules.h"
+#include "../../common/rollstat.h"
+
+int rule_function_rollstat(struct rules_t *obj, uint16_t argc, uint16_t *argv, int *ret, int (*get)(struct rollstat_t *stat, float *out));
+int rule_function_rollavg_callback(struct rules_t *obj, uint16_t argc, uint16_t *argv, int *ret);
+
+#endif
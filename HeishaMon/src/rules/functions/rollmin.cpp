@@ -0,0 +1,24 @@
+/*
+  Copyright (C) CurlyMo
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifdef DEBUG
+  #include <stdio.h>
+#endif
+
+#include "rollmin.h"
+#include "rollavg.h"
+
+int rule_function_rollmin_callback(struct rules_t *obj, uint16_t argc, uint16_t *argv, int *ret) {
+/* LCOV_EXCL_START*/
+#ifdef DEBUG
+  printf("%s\n", __FUNCTION__);
+#endif
+/* LCOV_EXCL_STOP*/
+
+  return rule_function_rollstat(obj, argc, argv, ret, rollstat_min);
+}
@@ -0,0 +1,14 @@
+/*
+  Copyright (C) CurlyMo
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "setinterval.h"
+#include "settimer.h"
+
+int rule_function_set_interval_callback(struct rules_t *obj, uint16_t argc, uint16_t *argv, int *ret) {
+  return rule_function_timer(obj, argc, argv, ret, 1, 1);
+}
@@ -23,10 +23,15 @@
 #include "../rules.h"
 #include "../../common/timerqueue.h"
 
-int rule_function_set_timer_callback(struct rules_t *obj, uint16_t argc, uint16_t *argv, int *ret) {
-  struct timerqueue_t *node = NULL;
-  struct itimerval it_val;
-  int i = 0, x = 0, sec = 0, usec = 0, nr = 0;
+/*
+ * Shared by settimer, settimerms, setinterval and
+ * setintervalms. The value is scaled to seconds by
+ * dividing through scale, 1 or 1000. With only the
+ * timer number the remaining time is returned in
+ * the same unit.
+ */
+int rule_function_timer(struct rules_t *obj, uint16_t argc, uint16_t *argv, int *ret, uint8_t interval, int scale) {
+  int sec = 0, usec = 0, nr = 0;
 
   if(argc > 2) {
     return -1;
@@ -44,10 +49,22 @@ int rule_function_set_timer_callback(struct rules_t *obj, uint16_t argc, uint16_
     nr = val->value;
 
     val = (struct vm_vinteger_t *)&obj->varstack.buffer[argv[1]];
-
-    timerqueue_insert(val->value, 0, nr);
-
-    logprintf_P(F("%s set timer #%d to %d seconds"), __FUNCTION__, nr, val->value);
+    sec = val->value / scale;
+    usec = (val->value % scale) * (1000000 / scale);
+
+    if(interval == 1) {
+      if(timerqueue_interval(sec, usec, nr) == -1) {
+        logprintf_P(F("%s failed to set interval #%d"), __FUNCTION__, nr);
+      } else {
+        logprintf_P(F("%s set interval #%d to %d %s"), __FUNCTION__, nr, val->value, (scale == 1) ? "seconds" : "milliseconds");
+      }
+    } else {
+      if(timerqueue_insert(sec, usec, nr) == -1) {
+        logprintf_P(F("%s failed to set timer #%d"), __FUNCTION__, nr);
+      } else {
+        logprintf_P(F("%s set timer #%d to %d %s"), __FUNCTION__, nr, val->value, (scale == 1) ? "seconds" : "milliseconds");
+      }
+    }
   }
 
   if(argc == 1) {
@@ -58,23 +75,18 @@ int rule_function_set_timer_callback(struct rules_t *obj, uint16_t argc, uint16_
     struct vm_vinteger_t *val = (struct vm_vinteger_t *)&obj->varstack.buffer[argv[0]];
     nr = val->value;
 
-   *ret = obj->varstack.nrbytes;
+    *ret = obj->varstack.nrbytes;
 
     unsigned int size = 0;
 
-    int a = 0;
-    for(a=0;a<timerqueue_size;a++) {
-      if(timerqueue[a]->nr == nr) {
-        size = alignedbytes(obj->varstack.nrbytes+sizeof(struct vm_vinteger_t));
+    if(timerqueue_remaining(nr, &sec, &usec) == 0) {
+      size = alignedbytes(obj->varstack.nrbytes+sizeof(struct vm_vinteger_t));
 
-        struct vm_vinteger_t *out = (struct vm_vinteger_t *)&obj->varstack.buffer[obj->varstack.nrbytes];
-        out->ret = 0;
-        out->type = VINTEGER;
-        out->value = timerqueue[a]->sec;
-        break;
-      }
-    }
-    if(size == 0) {
+      struct vm_vinteger_t *out = (struct vm_vinteger_t *)&obj->varstack.buffer[obj->varstack.nrbytes];
+      out->ret = 0;
+      out->type = VINTEGER;
+      out->value = (sec * scale) + (usec / (1000000 / scale));
+    } else {
       size = alignedbytes(obj->varstack.nrbytes+sizeof(struct vm_vnull_t));
 
       struct vm_vnull_t *out = (struct vm_vnull_t *)&obj->varstack.buffer[obj->varstack.nrbytes];
@@ -88,3 +100,7 @@ int rule_function_set_timer_callback(struct rules_t *obj, uint16_t argc, uint16_
 
   return 0;
 }
+
+int rule_function_set_timer_callback(struct rules_t *obj, uint16_t argc, uint16_t *argv, int *ret) {
+  return rule_function_timer(obj, argc, argv, ret, 0, 1);
+}
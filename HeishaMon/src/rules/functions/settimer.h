@@ -12,6 +12,7 @@
 #include <stdint.h>
 #include "../rules.h"
 
+int rule_function_timer(struct rules_t *obj, uint16_t argc, uint16_t *argv, int *ret, uint8_t interval, int scale);
 int rule_function_set_timer_callback(struct rules_t *obj, uint16_t argc, uint16_t *argv, int *ret);
 void inline timer_cb(void);
 
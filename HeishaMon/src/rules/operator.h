@@ -15,7 +15,7 @@ struct rule_operator_t {
   const char *name;
   int precedence;
   int associativity;
-  int (*callback)(struct rules_t *obj, int a, int b, int *ret);
+  int (*callback)(struct vm_register_t *a, struct vm_register_t *b, struct vm_register_t *out);
 } __attribute__((packed));
 
 extern struct rule_operator_t rule_operators[];
@@ -19,100 +19,37 @@
 #include "../../common/mem.h"
 #include "../rules.h"
 
-int rule_operator_mod_callback(struct rules_t *obj, int a, int b, int *ret) {
-  *ret = obj->varstack.nrbytes;
-
-  if((obj->varstack.buffer[a]) == VNULL || (obj->varstack.buffer[b]) == VNULL) {
-    unsigned int size = alignedbytes(obj->varstack.nrbytes+sizeof(struct vm_vnull_t));
-
-    struct vm_vnull_t *out = (struct vm_vnull_t *)&obj->varstack.buffer[obj->varstack.nrbytes];
-
-    out->ret = 0;
-    out->type = VNULL;
-
-/* LCOV_EXCL_START*/
-#ifdef DEBUG
-    printf("%s NULL\n", __FUNCTION__);
-#endif
-/* LCOV_EXCL_STOP*/
-
-    obj->varstack.nrbytes = size;
-    obj->varstack.bufsize = MAX(obj->varstack.bufsize, alignedvarstack(obj->varstack.nrbytes));
-  } else if((obj->varstack.buffer[a]) == VCHAR || (obj->varstack.buffer[b]) == VCHAR) {
-  } else if((obj->varstack.buffer[a]) == VFLOAT && (obj->varstack.buffer[b]) == VFLOAT) {
-    unsigned int size = alignedbytes(obj->varstack.nrbytes+sizeof(struct vm_vfloat_t));
-
-    struct vm_vfloat_t *out = (struct vm_vfloat_t *)&obj->varstack.buffer[obj->varstack.nrbytes];
-    struct vm_vfloat_t *na = (struct vm_vfloat_t *)&obj->varstack.buffer[a];
-    struct vm_vfloat_t *nb = (struct vm_vfloat_t *)&obj->varstack.buffer[b];
-
-    out->ret = 0;
-    out->type = VFLOAT;
-    out->value = fmod(na->value, nb->value);
-
-/* LCOV_EXCL_START*/
-#ifdef DEBUG
-    printf("%s %g %g\n", __FUNCTION__, na->value, nb->value);
-#endif
-/* LCOV_EXCL_STOP*/
-
-    obj->varstack.nrbytes = size;
-    obj->varstack.bufsize = MAX(obj->varstack.bufsize, alignedvarstack(obj->varstack.nrbytes));
-  } else if((obj->varstack.buffer[a]) == VFLOAT || (obj->varstack.buffer[b]) == VFLOAT) {
-
-    float f = 0;
-    int i = 0;
-    unsigned int size = alignedbytes(obj->varstack.nrbytes+sizeof(struct vm_vfloat_t));
-
-    struct vm_vfloat_t *out = (struct vm_vfloat_t *)&obj->varstack.buffer[obj->varstack.nrbytes];
-    out->ret = 0;
-    out->type = VFLOAT;
-
-    if((obj->varstack.buffer[a]) == VFLOAT) {
-      struct vm_vfloat_t *na = (struct vm_vfloat_t *)&obj->varstack.buffer[a];
-      f = na->value;
-    } else if((obj->varstack.buffer[a]) == VINTEGER) {
-      struct vm_vinteger_t *na = (struct vm_vinteger_t *)&obj->varstack.buffer[a];
-      i = na->value;
-      out->value = fmodf(f, (float)i);
-    }
-    if((obj->varstack.buffer[b]) == VFLOAT) {
-      struct vm_vfloat_t *nb = (struct vm_vfloat_t *)&obj->varstack.buffer[b];
-      f = nb->value;
-      out->value = fmodf(f, (float)i);
-    } else if((obj->varstack.buffer[b]) == VINTEGER) {
-      struct vm_vinteger_t *nb = (struct vm_vinteger_t *)&obj->varstack.buffer[b];
-      i = nb->value;
-      out->value = fmodf((float)i, f);
-    }
-
-/* LCOV_EXCL_START*/
-#ifdef DEBUG
-    printf("%s %g %d\n", __FUNCTION__, f, i);
-#endif
-/* LCOV_EXCL_STOP*/
-
-    obj->varstack.nrbytes = size;
-    obj->varstack.bufsize = MAX(obj->varstack.bufsize, alignedvarstack(obj->varstack.nrbytes));
-  } else {
-    unsigned int size = alignedbytes(obj->varstack.nrbytes+sizeof(struct vm_vinteger_t));
-
-    struct vm_vinteger_t *out = (struct vm_vinteger_t *)&obj->varstack.buffer[obj->varstack.nrbytes];
-    struct vm_vinteger_t *na = (struct vm_vinteger_t *)&obj->varstack.buffer[a];
-    struct vm_vinteger_t *nb = (struct vm_vinteger_t *)&obj->varstack.buffer[b];
-
-    out->ret = 0;
-    out->type = VINTEGER;
-    out->value = na->value % nb->value;
-
+int rule_operator_mod_callback(struct vm_register_t *a, struct vm_register_t *b, struct vm_register_t *out) {
 /* LCOV_EXCL_START*/
 #ifdef DEBUG
-    printf("%s %d %d\n", __FUNCTION__, na->value, nb->value);
+  printf("%s %d %d\n", __FUNCTION__, a->type, b->type);
 #endif
 /* LCOV_EXCL_STOP*/
 
-    obj->varstack.nrbytes = size;
-    obj->varstack.bufsize = MAX(obj->varstack.bufsize, alignedvarstack(obj->varstack.nrbytes));
+  switch(VM_TYPES(a->type, b->type)) {
+    case VM_TYPES(VINTEGER, VINTEGER): {
+      if(b->value.i == 0) {
+        out->type = VNULL;
+      } else {
+        out->type = VINTEGER;
+        out->value.i = a->value.i % b->value.i;
+      }
+    } break;
+    case VM_TYPES(VINTEGER, VFLOAT): {
+      out->type = VFLOAT;
+      out->value.f = fmodf((float)a->value.i, b->value.f);
+    } break;
+    case VM_TYPES(VFLOAT, VINTEGER): {
+      out->type = VFLOAT;
+      out->value.f = fmodf(a->value.f, (float)b->value.i);
+    } break;
+    case VM_TYPES(VFLOAT, VFLOAT): {
+      out->type = VFLOAT;
+      out->value.f = fmodf(a->value.f, b->value.f);
+    } break;
+    default: {
+      out->type = VNULL;
+    } break;
   }
 
   return 0;
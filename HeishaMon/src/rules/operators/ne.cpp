@@ -19,81 +19,32 @@
 #include "../../common/mem.h"
 #include "../rules.h"
 
-int rule_operator_ne_callback(struct rules_t *obj, int a, int b, int *ret) {
-  *ret = obj->varstack.nrbytes;
-
-  unsigned int size = alignedbytes(obj->varstack.nrbytes+sizeof(struct vm_vinteger_t));
-
-  struct vm_vinteger_t *out = (struct vm_vinteger_t *)&obj->varstack.buffer[obj->varstack.nrbytes];
-  out->ret = 0;
-  out->type = VINTEGER;
-
-  /*
-   * Values can only be equal when the type matches
-   */
-  if((obj->varstack.buffer[a]) != (obj->varstack.buffer[b])) {
-    out->value = 1;
-  } else {
-    switch(obj->varstack.buffer[a]) {
-      case VNULL: {
-        out->value = 1;
-
-/* LCOV_EXCL_START*/
-#ifdef DEBUG
-        printf("%s NULL\n", __FUNCTION__);
-#endif
-/* LCOV_EXCL_STOP*/
-      } break;
-      case VINTEGER: {
-        struct vm_vinteger_t *na = (struct vm_vinteger_t *)&obj->varstack.buffer[a];
-        struct vm_vinteger_t *nb = (struct vm_vinteger_t *)&obj->varstack.buffer[b];
-        if(na->value == nb->value) {
-          out->value = 0;
-        } else {
-          out->value = 1;
-        }
-
+int rule_operator_ne_callback(struct vm_register_t *a, struct vm_register_t *b, struct vm_register_t *out) {
 /* LCOV_EXCL_START*/
 #ifdef DEBUG
-        printf("%s %d %d\n", __FUNCTION__, na->value, nb->value);
+  printf("%s %d %d\n", __FUNCTION__, a->type, b->type);
 #endif
 /* LCOV_EXCL_STOP*/
 
-      } break;
-      case VFLOAT: {
-        struct vm_vfloat_t *na = (struct vm_vfloat_t *)&obj->varstack.buffer[a];
-        struct vm_vfloat_t *nb = (struct vm_vfloat_t *)&obj->varstack.buffer[b];
-        if(fabs((float)na->value-(float)nb->value) < EPSILON) {
-          out->value = 0;
-        } else {
-          out->value = 1;
-        }
+  out->type = VINTEGER;
 
-/* LCOV_EXCL_START*/
-#ifdef DEBUG
-        printf("%s %g %g\n", __FUNCTION__, na->value, nb->value);
-#endif
-/* LCOV_EXCL_STOP*/
-      } break;
-      /*
-       * FIXME
-       */
-      /* LCOV_EXCL_START*/
-      case VCHAR: {
-        struct vm_vchar_t *na = (struct vm_vchar_t *)&obj->varstack.buffer[a];
-        struct vm_vchar_t *nb = (struct vm_vchar_t *)&obj->varstack.buffer[b];
-        if(strcmp((char *)na->value, (char *)nb->value) == 0) {
-          out->value = 0;
-        } else {
-          out->value = 1;
-        }
-      } break;
-      /* LCOV_EXCL_STOP*/
-    }
+  switch(VM_TYPES(a->type, b->type)) {
+    case VM_TYPES(VINTEGER, VINTEGER): {
+      out->value.i = (a->value.i != b->value.i);
+    } break;
+    case VM_TYPES(VFLOAT, VFLOAT): {
+      out->value.i = (fabs(a->value.f - b->value.f) >= EPSILON);
+    } break;
+    case VM_TYPES(VNULL, VNULL): {
+      out->value.i = 1;
+    } break;
+    case VM_TYPES(VCHAR, VCHAR): {
+      out->value.i = (a->value.s != b->value.s);
+    } break;
+    default: {
+      out->value.i = 1;
+    } break;
   }
 
-  obj->varstack.nrbytes = size;
-  obj->varstack.bufsize = MAX(obj->varstack.bufsize, alignedvarstack(obj->varstack.nrbytes));
-
   return 0;
-}
\ No newline at end of file
+}
@@ -11,6 +11,6 @@
 
 #include "../rules.h"
 
-int rule_operator_ne_callback(struct rules_t *obj, int a, int b, int *ret);
+int rule_operator_ne_callback(struct vm_register_t *a, struct vm_register_t *b, struct vm_register_t *out);
 
 #endif
\ No newline at end of file
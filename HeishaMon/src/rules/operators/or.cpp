@@ -19,94 +19,30 @@
 #include "../../common/mem.h"
 #include "../rules.h"
 
+static int truthy(struct vm_register_t *r) {
+  switch(r->type) {
+    case VINTEGER: {
+      return (r->value.i > 0);
+    } break;
+    case VFLOAT: {
+      return (r->value.f > 0);
+    } break;
+    case VCHAR: {
+      return (r->value.s[0] != '\0');
+    } break;
+  }
+  return 0;
+}
 
-int rule_operator_or_callback(struct rules_t *obj, int a, int b, int *ret) {
-  *ret = obj->varstack.nrbytes;
-
-  unsigned int size = alignedbytes(obj->varstack.nrbytes+sizeof(struct vm_vinteger_t));
-
-  struct vm_vinteger_t *out = (struct vm_vinteger_t *)&obj->varstack.buffer[obj->varstack.nrbytes];
-  out->ret = 0;
-  out->type = VINTEGER;
-
-  if(obj->varstack.buffer[a] == VNULL && obj->varstack.buffer[b] == VNULL) {
-    out->value = 0;
-/* LCOV_EXCL_START*/
-#ifdef DEBUG
-    printf("%s NULL\n", __FUNCTION__);
-#endif
-/* LCOV_EXCL_STOP*/
-  } else {
-    /*
-     * Values can only be equal when the type matches
-     */
-    switch(obj->varstack.buffer[a]) {
-      case VINTEGER: {
-        struct vm_vinteger_t *n = (struct vm_vinteger_t *)&obj->varstack.buffer[a];
-        if(n->value > 0) {
-          out->value = 1;
-        } else {
-          out->value = 0;
-        }
-/* LCOV_EXCL_START*/
-#ifdef DEBUG
-        printf("%s %d\n", __FUNCTION__, n->value);
-#endif
-/* LCOV_EXCL_STOP*/
-
-      } break;
-      case VFLOAT: {
-        struct vm_vfloat_t *n = (struct vm_vfloat_t *)&obj->varstack.buffer[a];
-        if(n->value > 0) {
-          out->value = 1;
-        } else {
-          out->value = 0;
-        }
-      } break;
-      /*
-       * FIXME
-       */
-      /* LCOV_EXCL_START*/
-      case VCHAR: {
-        out->value = 1;
-      } break;
-      /* LCOV_EXCL_STOP*/
-    }
-    switch(obj->varstack.buffer[b]) {
-      case VINTEGER: {
-        struct vm_vinteger_t *n = (struct vm_vinteger_t *)&obj->varstack.buffer[b];
-        if(n->value > 0 || out->value == 1) {
-          out->value = 1;
-        } else {
-          out->value = 0;
-        }
+int rule_operator_or_callback(struct vm_register_t *a, struct vm_register_t *b, struct vm_register_t *out) {
 /* LCOV_EXCL_START*/
 #ifdef DEBUG
-        printf("%s %d\n", __FUNCTION__, n->value);
+  printf("%s %d %d\n", __FUNCTION__, a->type, b->type);
 #endif
 /* LCOV_EXCL_STOP*/
-      } break;
-      case VFLOAT: {
-        struct vm_vfloat_t *n = (struct vm_vfloat_t *)&obj->varstack.buffer[b];
-        if(n->value > 0 || out->value == 1) {
-          out->value = 1;
-        } else {
-          out->value = 0;
-        }
-      } break;
-      /*
-       * FIXME
-       */
-      /* LCOV_EXCL_START*/
-      case VCHAR: {
-        out->value = 1;
-      } break;
-      /* LCOV_EXCL_STOP*/
-    }
-  }
 
-  obj->varstack.nrbytes = size;
-  obj->varstack.bufsize = MAX(obj->varstack.bufsize, alignedvarstack(obj->varstack.nrbytes));
+  out->type = VINTEGER;
+  out->value.i = (truthy(a) || truthy(b));
 
   return 0;
-}
\ No newline at end of file
+}
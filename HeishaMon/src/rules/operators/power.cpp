@@ -19,98 +19,58 @@
 #include "../../common/mem.h"
 #include "../rules.h"
 
-int rule_operator_power_callback(struct rules_t *obj, int a, int b, int *ret) {
-  *ret = obj->varstack.nrbytes;
-
-  if((obj->varstack.buffer[a]) == VNULL || (obj->varstack.buffer[b]) == VNULL) {
-    unsigned int size = alignedbytes(obj->varstack.nrbytes+sizeof(struct vm_vnull_t));
-
-    struct vm_vnull_t *out = (struct vm_vnull_t *)&obj->varstack.buffer[obj->varstack.nrbytes];
-
-    out->ret = 0;
-    out->type = VNULL;
-
-/* LCOV_EXCL_START*/
-#ifdef DEBUG
-    printf("%s NULL\n", __FUNCTION__);
-#endif
-/* LCOV_EXCL_STOP*/
-
-    obj->varstack.nrbytes = size;
-    obj->varstack.bufsize = MAX(obj->varstack.bufsize, alignedvarstack(obj->varstack.nrbytes));
-  } else if((obj->varstack.buffer[a]) == VCHAR || (obj->varstack.buffer[b]) == VCHAR) {
-  } else if((obj->varstack.buffer[a]) == VFLOAT || (obj->varstack.buffer[b]) == VFLOAT) {
-    float f = 0;
-    int i = 0;
-    unsigned int size = alignedbytes(obj->varstack.nrbytes+sizeof(struct vm_vfloat_t));
-
-    struct vm_vfloat_t *out = (struct vm_vfloat_t *)&obj->varstack.buffer[obj->varstack.nrbytes];
-
-    if((obj->varstack.buffer[a]) == VFLOAT) {
-      struct vm_vfloat_t *na = (struct vm_vfloat_t *)&obj->varstack.buffer[a];
-      f = na->value;
-    } else if((obj->varstack.buffer[a]) == VINTEGER) {
-      struct vm_vinteger_t *na = (struct vm_vinteger_t *)&obj->varstack.buffer[a];
-      i = na->value;
+/*
+ * Exponentiation by squaring, so integer
+ * powers don't go through the float pow().
+ */
+static int ipow(int base, int exp) {
+  int out = 1;
+
+  if(exp < 0) {
+    if(base == 1 || base == -1) {
+      return (exp % 2 == 0) ? 1 : base;
     }
-    if((obj->varstack.buffer[b]) == VFLOAT) {
-      struct vm_vfloat_t *nb = (struct vm_vfloat_t *)&obj->varstack.buffer[b];
-      if((obj->varstack.buffer[a]) == VFLOAT) {
-        out->value = pow(f, nb->value);
-/* LCOV_EXCL_START*/
-#ifdef DEBUG
-        printf("1 %s %g %g\n", __FUNCTION__,f, nb->value);
-#endif
-/* LCOV_EXCL_STOP*/
-      } else if((obj->varstack.buffer[a]) == VINTEGER) {
-        out->value = pow(i, nb->value);
-/* LCOV_EXCL_START*/
-#ifdef DEBUG
-        printf("2 %s %d %g\n", __FUNCTION__,i, nb->value);
-#endif
-/* LCOV_EXCL_STOP*/
-      }
-    } else if((obj->varstack.buffer[b]) == VINTEGER) {
-      struct vm_vinteger_t *nb = (struct vm_vinteger_t *)&obj->varstack.buffer[b];
-      out->value = pow(f, nb->value);
-/* LCOV_EXCL_START*/
-#ifdef DEBUG
-      printf("3 %s %g %d\n", __FUNCTION__,f, nb->value);
-#endif
-/* LCOV_EXCL_STOP*/
+    return 0;
+  }
+  while(exp > 0) {
+    if(exp & 1) {
+      out *= base;
     }
+    if((exp >>= 1) > 0) {
+      base *= base;
+    }
+  }
+  return out;
+}
 
-    out->ret = 0;
-    out->type = VFLOAT;
-
+int rule_operator_power_callback(struct vm_register_t *a, struct vm_register_t *b, struct vm_register_t *out) {
 /* LCOV_EXCL_START*/
 #ifdef DEBUG
-    printf("%s %g %d\n", __FUNCTION__, f, i);
+  printf("%s %d %d\n", __FUNCTION__, a->type, b->type);
 #endif
 /* LCOV_EXCL_STOP*/
 
-    obj->varstack.nrbytes = size;
-    obj->varstack.bufsize = MAX(obj->varstack.bufsize, alignedvarstack(obj->varstack.nrbytes));
-  } else if((obj->varstack.buffer[a]) == VINTEGER && (obj->varstack.buffer[b]) == VINTEGER) {
-    unsigned int size = alignedbytes(obj->varstack.nrbytes+sizeof(struct vm_vinteger_t));
-
-    struct vm_vinteger_t *out = (struct vm_vinteger_t *)&obj->varstack.buffer[obj->varstack.nrbytes];
-
-    struct vm_vinteger_t *na = (struct vm_vinteger_t *)&obj->varstack.buffer[a];
-    struct vm_vinteger_t *nb = (struct vm_vinteger_t *)&obj->varstack.buffer[b];
-    out->ret = 0;
-    out->type = VINTEGER;
-    out->value = pow(na->value, nb->value);
-
-/* LCOV_EXCL_START*/
-#ifdef DEBUG
-    printf("4 %s %d %d\n", __FUNCTION__, na->value, nb->value);
-#endif
-/* LCOV_EXCL_STOP*/
-    obj->varstack.nrbytes = size;
-    obj->varstack.bufsize = MAX(obj->varstack.bufsize, alignedvarstack(obj->varstack.nrbytes));
+  switch(VM_TYPES(a->type, b->type)) {
+    case VM_TYPES(VINTEGER, VINTEGER): {
+      out->type = VINTEGER;
+      out->value.i = ipow(a->value.i, b->value.i);
+    } break;
+    case VM_TYPES(VINTEGER, VFLOAT): {
+      out->type = VFLOAT;
+      out->value.f = pow((float)a->value.i, b->value.f);
+    } break;
+    case VM_TYPES(VFLOAT, VINTEGER): {
+      out->type = VFLOAT;
+      out->value.f = pow(a->value.f, (float)b->value.i);
+    } break;
+    case VM_TYPES(VFLOAT, VFLOAT): {
+      out->type = VFLOAT;
+      out->value.f = pow(a->value.f, b->value.f);
+    } break;
+    default: {
+      out->type = VNULL;
+    } break;
   }
 
-
   return 0;
 }
@@ -32,6 +32,7 @@
 #include "../common/mem.h"
 #include "../common/log.h"
 #include "../common/strnicmp.h"
+#include "../common/symtab.h"
 #include "../common/mem.h"
 #include "../common/log.h"
 #include "rules.h"
@@ -46,6 +47,16 @@ struct vm_cache_t {
 } __attribute__((packed)) **vmcache;
 static unsigned int nrcache = 0;
 
+struct strpool_t rule_strings;
+
+/*
+ * Set while a rule is validated, also in
+ * the rules it calls from there. A call
+ * continues the caller in a new rule_run,
+ * so the validate argument is lost there.
+ */
+static uint8_t validating = 0;
+
 /*LCOV_EXCL_START*/
 #ifdef DEBUG
 static void print_tree(struct rules_t *obj);
@@ -87,23 +98,46 @@ void rules_gc(struct rules_t ***rules, unsigned int nrrules) {
 #endif
 }
 
-static int is_function(char *text, unsigned int *pos, unsigned int size) {
-  unsigned int i = 0, len = 0;
+/*
+ * Functions and operators share one hash index,
+ * operators are told apart by the SYMBOL_OPERATOR
+ * bit in their id.
+ */
+#define SYMBOL_OPERATOR 0x8000
+#define SYMBOLS_SIZE 64
+
+static uint16_t symbols_slots[SYMBOLS_SIZE];
+static struct symtab_t symbols = { symbols_slots, SYMBOLS_SIZE };
+static uint8_t symbols_init = 0;
+
+static void symbols_build(void) {
+  unsigned int i = 0;
+
+  memset(symbols_slots, 0, sizeof(symbols_slots));
   for(i=0;i<nr_rule_functions;i++) {
-    len = strlen(rule_functions[i].name);
-    if(size == len && strnicmp(&text[*pos], rule_functions[i].name, len) == 0) {
-      return i;
-    }
+    symtab_insert(&symbols, symtab_hash(rule_functions[i].name, strlen(rule_functions[i].name)), i+1);
   }
-
-  return -1;
+  for(i=0;i<nr_rule_operators;i++) {
+    symtab_insert(&symbols, symtab_hash(rule_operators[i].name, strlen(rule_operators[i].name)), (i+1) | SYMBOL_OPERATOR);
+  }
+  symbols_init = 1;
 }
 
-static int is_operator(char *text, unsigned int *pos, unsigned int size) {
-  unsigned int i = 0, len = 0;
-  for(i=0;i<nr_rule_operators;i++) {
-    len = strlen(rule_operators[i].name);
-    if(size == len && strnicmp(&text[*pos], rule_operators[i].name, len) == 0) {
+static int symbols_find(char *text, unsigned int size, uint16_t type) {
+  uint16_t hash = 0, probe = 0, id = 0;
+
+  if(symbols_init == 0) {
+    symbols_build();
+  }
+
+  hash = symtab_hash(text, size);
+  while((id = symtab_next(&symbols, hash, &probe)) > 0) {
+    if((id & SYMBOL_OPERATOR) != type) {
+      continue;
+    }
+    unsigned int i = (id & ~SYMBOL_OPERATOR) - 1;
+    const char *name = (type == SYMBOL_OPERATOR) ? rule_operators[i].name : rule_functions[i].name;
+    if(strlen(name) == size && strnicmp(text, name, size) == 0) {
       return i;
     }
   }
@@ -111,6 +145,14 @@ static int is_operator(char *text, unsigned int *pos, unsigned int size) {
   return -1;
 }
 
+static int is_function(char *text, unsigned int *pos, unsigned int size) {
+  return symbols_find(&text[*pos], size, 0);
+}
+
+static int is_operator(char *text, unsigned int *pos, unsigned int size) {
+  return symbols_find(&text[*pos], size, SYMBOL_OPERATOR);
+}
+
 static int lexer_parse_number(char *text, int *pos) {
 
   int i = 0, nrdot = 0, len = strlen(text);
@@ -151,63 +193,32 @@ static int lexer_parse_string(char *text, unsigned int *pos) {
   return 0;
 }
 
-// static int lexer_parse_quoted_string(struct rules_t *obj, struct lexer_t *lexer, int *start) {
-
-  // int x = lexer->current_char[0];
-  // if(lexer->current_char[0] == '\'' || lexer->current_char[0] == '"') {
-    // lexer->text[lexer->pos] = '\0';
-  // }
-  // *start = ++lexer->pos;
-  // if(lexer->pos < lexer->len) {
-
-    // while(lexer->pos < lexer->len) {
-      // if(x != '\'' && lexer->pos > 0 && lexer->text[lexer->pos] == '\'') {
-        // /*
-         // * Skip escape
-         // */
-        // lexer->current_char = &lexer->text[lexer->(*pos)++];
-      // } else if(x == '\'' && lexer->pos > 0 && lexer->text[lexer->pos] == '\\' && lexer->text[lexer->pos+1] == '\'') {
-        // /*
-         // * Remove escape
-         // */
-        // memmove(&lexer->text[lexer->pos], &lexer->text[lexer->pos+1], lexer->len-lexer->pos-1);
-        // lexer->text[lexer->len-1] = '\0';
-
-        // lexer->current_char = &lexer->text[lexer->(*pos)++];
-        // lexer->len--;
-      // } else if(x == '"' && lexer->pos > 0 && lexer->text[lexer->pos] == '\\' && lexer->text[lexer->pos+1] == '"') {
-        // /*
-         // * Remove escape
-         // */
-        // memmove(&lexer->text[lexer->pos], &lexer->text[lexer->pos+1], lexer->len-lexer->pos-1);
-        // lexer->text[lexer->len-1] = '\0';
-
-        // lexer->current_char = &lexer->text[lexer->(*pos)++];
-        // lexer->len--;
-      // } else if(x != '"' && lexer->pos > 0 && lexer->text[lexer->pos] == '"') {
-        // /*
-         // * Skip escape
-         // */
-        // lexer->current_char = &lexer->text[lexer->(*pos)++];
-      // } else if(lexer->text[lexer->pos] == x) {
-        // break;
-      // } else {
-        // lexer->(*pos)++;
-      // }
-    // }
-
-    // if(lexer->current_char[0] != '"' && lexer->current_char[0] != '\'') {
-      // printf("err: %s %d\n", __FUNCTION__, __LINE__);
-      // exit(-1);
-    // } else if(lexer->pos <= lexer->len) {
-      // lexer_isolate_token(obj, lexer, x, -1);
-      // return 0;
-    // } else {
-      // return -1;
-    // }
-  // }
-  // return -1;
-// }
+/*
+ * Quoted strings are unescaped in place, so the
+ * content starts right after the opening quote.
+ * The position is moved past the closing quote.
+ */
+static int lexer_parse_quoted_string(char *text, unsigned int len, unsigned int *pos) {
+  char quote = text[(*pos)++];
+  unsigned int start = *pos, n = 0;
+
+  while(*pos < len && text[*pos] != quote) {
+    if(text[*pos] == '\\' && (*pos)+1 < len &&
+       (text[(*pos)+1] == quote || text[(*pos)+1] == '\\')) {
+      (*pos)++;
+    }
+    if((unsigned char)text[*pos] < 32) {
+      return -1;
+    }
+    text[start+n++] = text[(*pos)++];
+  }
+  if(*pos >= len) {
+    return -1;
+  }
+  (*pos)++;
+
+  return n;
+}
 
 static int lexer_parse_skip_characters(char *text, unsigned int len, unsigned int *pos) {
   while(*pos <= len &&
@@ -220,8 +231,34 @@ static int lexer_parse_skip_characters(char *text, unsigned int len, unsigned in
   return 0;
 }
 
+/*
+ * Tokens that can end and start a value,
+ * two values can't follow each other without
+ * an operator in between.
+ */
+static int is_value_end(int type) {
+  switch(type) {
+    case TNUMBER1:
+    case TNUMBER2:
+    case TNUMBER3:
+    case VINTEGER:
+    case VFLOAT:
+    case TSTRING:
+    case TVAR:
+    case VNULL:
+    case RPAREN:
+      return 1;
+  }
+  return 0;
+}
+
+static int is_value_start(int type) {
+  return (is_value_end(type) == 1 && type != RPAREN) || type == LPAREN || type == TFUNCTION;
+}
+
 static int rule_prepare(char **text, unsigned int *nrbytes, unsigned int *len) {
-  unsigned int pos = 0, nrblocks = 0, tpos = 0;
+  unsigned int pos = 0, nrblocks = 0, nrparen = 0, tpos = 0, tstart = 0;
+  int last = -1, incond = 0, assigned = 0;
 
   *nrbytes = alignedbytes(sizeof(struct vm_tstart_t));
 #ifdef DEBUG
@@ -230,20 +267,35 @@ static int rule_prepare(char **text, unsigned int *nrbytes, unsigned int *len) {
 
   while(pos < *len) {
     lexer_parse_skip_characters(*text, *len, &pos);
+    if(pos >= *len) {
+      break;
+    }
+    tstart = tpos;
+
+    if((*text)[pos] == '"' || (*text)[pos] == '\'') {
+      unsigned int s = pos+1;
+      int n = lexer_parse_quoted_string((*text), *len, &pos);
+
+      if(n < 0) {
+        logprintf_P(F("ERROR: unterminated string"));
+        return -1;
+      }
+      if(n > 255) {
+        logprintf_P(F("ERROR: string is longer than 255 characters"));
+        return -1;
+      }
 
-    // if(lexer->current_char[0] == '\'' || lexer->current_char[0] == '"') {
-      // ret = lexer_parse_quoted_string(obj, lexer, &tpos);
-      // type = TSTRING;
-      // lexer->(*pos)++;
-      // if(lexer->text[lexer->pos] == ' ') {
-        // lexer->text[lexer->pos] = '\0';
-      // } else {
-        // printf("err: %s %d\n", __FUNCTION__, __LINE__);
-        // exit(-1);
-      // }
-    // } else
-
-    if(isdigit((*text)[pos]) || ((*text)[pos] == '-' && pos < *len && isdigit((*text)[(pos)+1]))) {
+      *nrbytes += alignedbytes(sizeof(struct vm_tstring_t)+n+1);
+#ifdef DEBUG
+      printf("TSTRING: %lu\n", sizeof(struct vm_tstring_t)+n+1);
+#endif
+
+      // printf("TSTRING: %d\n", tpos);
+      (*text)[tpos++] = TSTRING;
+      (*text)[tpos++] = n;
+      memmove(&(*text)[tpos], &(*text)[s], n);
+      tpos += n;
+    } else if(isdigit((*text)[pos]) || ((*text)[pos] == '-' && pos < *len && isdigit((*text)[(pos)+1]))) {
       int newlen = 0;
       lexer_parse_number(&(*text)[pos], &newlen);
 
@@ -292,7 +344,7 @@ static int rule_prepare(char **text, unsigned int *nrbytes, unsigned int *len) {
             (*text)[tpos++] = TNUMBER3;
           } break;
         }
-        memcpy(&(*text)[tpos], &(*text)[pos], newlen);
+        memmove(&(*text)[tpos], &(*text)[pos], newlen);
         tpos += newlen;
       } else {
 
@@ -356,6 +408,7 @@ static int rule_prepare(char **text, unsigned int *nrbytes, unsigned int *len) {
 
       pos+=2;
       nrblocks++;
+      incond = 1;
     } else if(strnicmp((char *)&(*text)[pos], "elseif", 6) == 0) {
       *nrbytes += alignedbytes(sizeof(struct vm_tif_t));
       *nrbytes += alignedbytes(sizeof(struct vm_ttrue_t));
@@ -380,8 +433,12 @@ static int rule_prepare(char **text, unsigned int *nrbytes, unsigned int *len) {
       // printf("TELSEIF: %d\n", tpos);
       (*text)[tpos++] = TELSEIF;
 
+      /*
+       * An ELSEIF shares the END of its IF
+       * block, so it doesn't open a new one.
+       */
       pos+=6;
-      nrblocks++;
+      incond = 1;
     } else if(strnicmp(&(*text)[pos], "on", 2) == 0) {
       pos+=2;
       lexer_parse_skip_characters((*text), *len, &pos);
@@ -398,7 +455,7 @@ static int rule_prepare(char **text, unsigned int *nrbytes, unsigned int *len) {
 #endif
         // printf("TEVENT: %d\n", tpos);
         (*text)[tpos++] = TEVENT;
-        memcpy(&(*text)[tpos], &(*text)[s], len);
+        memmove(&(*text)[tpos], &(*text)[s], len);
         tpos += len;
 
         /*
@@ -410,6 +467,7 @@ static int rule_prepare(char **text, unsigned int *nrbytes, unsigned int *len) {
 #endif
       }
       nrblocks++;
+      incond = 1;
     } else if(strnicmp((char *)&(*text)[pos], "else", 4) == 0) {
       *nrbytes += alignedbytes(sizeof(struct vm_ttrue_t));
 #ifdef DEBUG
@@ -418,6 +476,11 @@ static int rule_prepare(char **text, unsigned int *nrbytes, unsigned int *len) {
       pos+=4;
       (*text)[tpos++] = TELSE;
     } else if(strnicmp((char *)&(*text)[pos], "then", 4) == 0) {
+      if(nrparen > 0) {
+        logprintf_P(F("ERROR: missing ')'"));
+        return -1;
+      }
+      incond = 0;
       pos+=4;
       // printf("TTHEN: %d\n", tpos);
       (*text)[tpos++] = TTHEN;
@@ -453,15 +516,43 @@ static int rule_prepare(char **text, unsigned int *nrbytes, unsigned int *len) {
       // printf("LPAREN: %d\n", tpos);
       (*text)[tpos++] = LPAREN;
       pos++;
+      nrparen++;
     } else if((*text)[pos] == ')') {
+      /*
+       * The parser can't recover from
+       * unbalanced parenthesis.
+       */
+      if(nrparen == 0) {
+        logprintf_P(F("ERROR: unexpected ')'"));
+        return -1;
+      }
+      nrparen--;
       pos++;
       // printf("RPAREN: %d\n", tpos);
       (*text)[tpos++] = RPAREN;
     } else if((*text)[pos] == '=' && pos < *len && (*text)[(pos)+1] != '=') {
+      if(assigned == 1) {
+        logprintf_P(F("ERROR: Expected a semicolon"));
+        return -1;
+      }
+      assigned = 1;
       pos++;
       // printf("TASSIGN: %d\n", tpos);
       (*text)[tpos++] = TASSIGN;
     } else if((*text)[pos] == ';') {
+      if(nrparen > 0) {
+        logprintf_P(F("ERROR: missing ')'"));
+        return -1;
+      }
+      /*
+       * A condition running into a statement
+       * makes the parser loop forever.
+       */
+      if(incond == 1) {
+        logprintf_P(F("ERROR: Expected a 'then' token"));
+        return -1;
+      }
+      assigned = 0;
       /*
        * An additional TTRUE slot
        */
@@ -483,6 +574,15 @@ static int rule_prepare(char **text, unsigned int *nrbytes, unsigned int *len) {
         }
       }
 
+      /*
+       * A single character left at the end
+       * of the text can't be a valid token.
+       */
+      if(b == 0) {
+        logprintf_P(F("ERROR: unknown token '%.5s'"), &(*text)[pos]);
+        return -1;
+      }
+
       if((len1 = is_function((*text), &pos, b)) > -1) {
         *nrbytes += alignedbytes(sizeof(struct vm_tfunction_t)+sizeof(uint16_t));
         *nrbytes -= alignedbytes(sizeof(struct vm_lparen_t));
@@ -512,7 +612,7 @@ static int rule_prepare(char **text, unsigned int *nrbytes, unsigned int *len) {
 
         // printf("TVAR: %d\n", tpos);
         (*text)[tpos++] = TVAR;
-        memcpy(&(*text)[tpos], &(*text)[pos], len1);
+        memmove(&(*text)[tpos], &(*text)[pos], len1);
         tpos += len1;
         pos += len1;
       } else if(rule_options.is_event_cb != NULL && (len1 = rule_options.is_event_cb((*text), &pos, b)) > -1) {
@@ -530,7 +630,7 @@ static int rule_prepare(char **text, unsigned int *nrbytes, unsigned int *len) {
 #endif
             // printf("TCEVENT: %d\n", tpos);
             (*text)[tpos++] = TCEVENT;
-            memcpy(&(*text)[tpos], &(*text)[s], len);
+            memmove(&(*text)[tpos], &(*text)[s], len);
             tpos += len;
           }
           pos += 2;
@@ -552,6 +652,14 @@ static int rule_prepare(char **text, unsigned int *nrbytes, unsigned int *len) {
       }
     }
 
+    if(tpos > tstart) {
+      if(is_value_end(last) == 1 && is_value_start((*text)[tstart]) == 1) {
+        logprintf_P(F("ERROR: missing operator"));
+        return -1;
+      }
+      last = (*text)[tstart];
+    }
+
     if(nrblocks == 0) {
       /*
        * Remove one go slot because of the root
@@ -633,6 +741,10 @@ static int lexer_peek(char **text, int skip, int *type, int *start, int *len) {
       case VFLOAT: {
         i += 1+sizeof(float);
       } break;
+      case TSTRING: {
+        *len = (unsigned char)(*text)[i+1];
+        i += 2+*len;
+      } break;
       case TFUNCTION:
       case TOPERATOR: {
         i += 2;
@@ -778,6 +890,17 @@ static int vm_parent(char **text, struct rules_t *obj, int type, int start, int
       }
       (*text)[start+1+len] = tmp;
     } break;
+    case TSTRING: {
+      size = alignedbytes(ret+sizeof(struct vm_tstring_t)+len+1);
+      assert(size <= obj->ast.bufsize);
+      struct vm_tstring_t *node = (struct vm_tstring_t *)&obj->ast.buffer[ret];
+      node->type = TSTRING;
+      node->ret = 0;
+      memcpy(node->token, &(*text)[start+2], len);
+      node->token[len] = 0;
+
+      obj->ast.nrbytes = size;
+    } break;
     case TFALSE:
     case TTRUE: {
       size = alignedbytes(ret+sizeof(struct vm_ttrue_t)+(sizeof(uint16_t)*opt));
@@ -917,6 +1040,7 @@ static int vm_rewind3(struct rules_t *obj, int step, int type, int type2, int ty
         case TNUMBER3:
         case VINTEGER:
         case VFLOAT:
+        case TSTRING:
         case VNULL:
         default: {
           logprintf_P(F("FATAL: Internal error in %s #%d"), __FUNCTION__, __LINE__);
@@ -1043,7 +1167,8 @@ static int lexer_parse_math_order(char **text, int *length, struct rules_t *obj,
         case TNUMBER2:
         case TNUMBER3:
         case VINTEGER:
-        case VFLOAT: {
+        case VFLOAT:
+        case TSTRING: {
           right = vm_parent(text, obj, c, start, len, 0);
           (*pos)++;
         } break;
@@ -1077,6 +1202,10 @@ static int lexer_parse_math_order(char **text, int *length, struct rules_t *obj,
         struct vm_vfloat_t *node = (struct vm_vfloat_t *)&obj->ast.buffer[*step_out];
         node->ret = step;
       } break;
+      case TSTRING: {
+        struct vm_tstring_t *node = (struct vm_tstring_t *)&obj->ast.buffer[*step_out];
+        node->ret = step;
+      } break;
       case LPAREN: {
         struct vm_lparen_t *node = (struct vm_lparen_t *)&obj->ast.buffer[*step_out];
         node->ret = step;
@@ -1138,11 +1267,25 @@ static int lexer_parse_math_order(char **text, int *length, struct rules_t *obj,
 
       if(y > x || (x == y && a == 2)) {
         if(a == 1) {
+          /*
+           * Find the last operator on the right side
+           * that still binds less strong than this one.
+           */
+          int tmp = *step_out;
+          while((obj->ast.buffer[op1->right]) == TOPERATOR) {
+            op3 = (struct vm_toperator_t *)&obj->ast.buffer[op1->right];
+            if(rule_operators[op3->token].precedence >= y) {
+              break;
+            }
+            tmp = op1->right;
+            op1 = op3;
+          }
+
           op2->left = op1->right;
           op3 = (struct vm_toperator_t *)&obj->ast.buffer[op2->left];
           op3->ret = step;
           op1->right = step;
-          op2->ret = *step_out;
+          op2->ret = tmp;
         } else {
           /*
            * Find the last operator with an operator
@@ -1154,6 +1297,8 @@ static int lexer_parse_math_order(char **text, int *length, struct rules_t *obj,
              (obj->ast.buffer[tmp]) != TNUMBER &&
              (obj->ast.buffer[tmp]) != VFLOAT &&
              (obj->ast.buffer[tmp]) != VINTEGER &&
+             (obj->ast.buffer[tmp]) != TSTRING &&
+             (obj->ast.buffer[tmp]) != TVAR &&
              (obj->ast.buffer[tmp]) != VNULL) {
             while((obj->ast.buffer[tmp]) == TOPERATOR) {
               if((obj->ast.buffer[((struct vm_toperator_t *)&obj->ast.buffer[tmp])->right]) == TOPERATOR) {
@@ -1183,6 +1328,10 @@ static int lexer_parse_math_order(char **text, int *length, struct rules_t *obj,
               struct vm_vfloat_t *node = (struct vm_vfloat_t *)&obj->ast.buffer[*step_out];
               node->ret = step;
             } break;
+            case TSTRING: {
+              struct vm_tstring_t *node = (struct vm_tstring_t *)&obj->ast.buffer[*step_out];
+              node->ret = step;
+            } break;
             case TFUNCTION: {
               struct vm_tfunction_t *node = (struct vm_tfunction_t *)&obj->ast.buffer[tright];
               node->ret = step;
@@ -1191,6 +1340,14 @@ static int lexer_parse_math_order(char **text, int *length, struct rules_t *obj,
               struct vm_lparen_t *node = (struct vm_lparen_t *)&obj->ast.buffer[tright];
               node->ret = step;
             } break;
+            case TVAR: {
+              struct vm_tvar_t *node = (struct vm_tvar_t *)&obj->ast.buffer[tright];
+              node->ret = step;
+            } break;
+            case VNULL: {
+              struct vm_vnull_t *node = (struct vm_vnull_t *)&obj->ast.buffer[tright];
+              node->ret = step;
+            } break;
             /* LCOV_EXCL_START*/
             default: {
               logprintf_P(F("FATAL: Internal error in %s #%d"), __FUNCTION__, __LINE__);
@@ -1605,6 +1762,15 @@ static int rule_parse(char **text, int *length, struct rules_t *obj) {
               i->ret = step_out;
               pos = cache->end;
 
+              /*
+               * The ELSEIF block was closed by the END
+               * of the whole IF block. Step back so
+               * this IF block is closed by it as well.
+               */
+              if(cache->type == TELSEIF) {
+                pos--;
+              }
+
               switch(obj->ast.buffer[step_out]) {
                 case TFALSE:
                 case TTRUE: {
@@ -1649,12 +1815,6 @@ static int rule_parse(char **text, int *length, struct rules_t *obj) {
                 continue;
               }
 
-              if(cache->type == TELSEIF) {
-                if(type == TEOF) {
-                  lexer_peek(text, pos-1, &type, &start, &len);
-                  pos--;
-                }
-              }
               /*
                * After a cached IF block has been linked
                * it can be removed from cache
@@ -1933,7 +2093,7 @@ static int rule_parse(char **text, int *length, struct rules_t *obj) {
                 /*
                  * The ELSEIF block is attached to a seperate FALSE
                  * node and therefor doesn't count for the current TRUE
-                 * node.
+                 * node. It also ends the current TRUE node.
                  */
                 if(t == TFALSE) {
                   /* LCOV_EXCL_START*/
@@ -1941,8 +2101,7 @@ static int rule_parse(char **text, int *length, struct rules_t *obj) {
                   return -1;
                   /* LCOV_EXCL_STOP*/
                 }
-                y = cache->end;
-                continue;
+                break;
               }
               if(type == TEND) {
                 break;
@@ -2036,7 +2195,8 @@ static int rule_parse(char **text, int *length, struct rules_t *obj) {
               case TNUMBER2:
               case TNUMBER3:
               case VFLOAT:
-              case VINTEGER: {
+              case VINTEGER:
+              case TSTRING: {
                 step_out = vm_parent(text, obj, a, start, len, 0);
                 pos++;
               } break;
@@ -2192,10 +2352,8 @@ static int rule_parse(char **text, int *length, struct rules_t *obj) {
             step_out = step;
 
             if(lexer_peek(text, pos, &type, &start, &len) < 0 || type != TASSIGN) {
-              /* LCOV_EXCL_START*/
-              logprintf_P(F("FATAL: Internal error in %s #%d"), __FUNCTION__, __LINE__);
+              logprintf_P(F("ERROR: Expected an assignment"));
               return -1;
-              /* LCOV_EXCL_STOP*/
             }
 
             pos++;
@@ -2212,6 +2370,7 @@ static int rule_parse(char **text, int *length, struct rules_t *obj) {
               switch(type) {
                 case VINTEGER:
                 case VFLOAT:
+                case TSTRING:
                 case TNUMBER1:
                 case TNUMBER2:
                 case TNUMBER3: {
@@ -2250,7 +2409,7 @@ static int rule_parse(char **text, int *length, struct rules_t *obj) {
                         v->go = x->step;
 
                         int tmp = vm_rewind2(obj, step_out, TTRUE, TFALSE);
-                        int tmp1 = vm_rewind2(obj, tmp, TIF, TEVENT);
+                        int tmp1 = vm_rewind3(obj, tmp, TIF, TELSEIF, TEVENT);
 
                         go = obj->ast.buffer[tmp1];
                         step_out = tmp;
@@ -2285,8 +2444,9 @@ static int rule_parse(char **text, int *length, struct rules_t *obj) {
                       v->go = x->step;
 
                       int tmp = vm_rewind2(obj, step_out, TTRUE, TFALSE);
+                      int tmp1 = vm_rewind3(obj, tmp, TIF, TELSEIF, TEVENT);
 
-                      go = TIF;
+                      go = obj->ast.buffer[tmp1];
                       step_out = tmp;
 
                       pos = x->end + 1;
@@ -2441,6 +2601,7 @@ static int rule_parse(char **text, int *length, struct rules_t *obj) {
               case VNULL:
               case VINTEGER:
               case VFLOAT:
+              case TSTRING:
               case TNUMBER1:
               case TNUMBER2:
               case TNUMBER3: {
@@ -2698,6 +2859,8 @@ static int rule_parse(char **text, int *length, struct rules_t *obj) {
                   vm_cache_del(oldpos);
                 } break;
                 case VINTEGER:
+                case VFLOAT:
+                case TSTRING:
                 case VNULL:
                 case TVAR:
                 case TNUMBER1:
@@ -2981,6 +3144,11 @@ static void print_ast(struct rules_t *obj) {
         printf("\"%d\"[label=\"%s\"]\n", i, node->token);
         i+=sizeof(struct vm_tnumber_t)+strlen((char *)node->token);
       } break;
+      case TSTRING: {
+        struct vm_tstring_t *node = (struct vm_tstring_t *)&obj->ast.buffer[i];
+        printf("\"%d\"[label=\"\\\"%s\\\"\"]\n", i, node->token);
+        i+=sizeof(struct vm_tstring_t)+strlen((char *)node->token);
+      } break;
       case VINTEGER: {
         struct vm_vinteger_t *node = (struct vm_vinteger_t *)&obj->ast.buffer[i];
         printf("\"%d\"[label=\"%d\"]\n", i, node->value);
@@ -3174,6 +3342,15 @@ static void print_steps(struct rules_t *obj) {
         printf("\"%d-2\" -> \"%d-3\"\n", i, i);
         i+=sizeof(struct vm_tnumber_t)+strlen((char *)node->token)-1;
       } break;
+      case TSTRING: {
+        struct vm_tstring_t *node = (struct vm_tstring_t *)&obj->ast.buffer[i];
+        printf("\"%d-1\"[label=\"%d\" shape=square]\n", i, i);
+        printf("\"%d-2\"[label=\"\\\"%s\\\"\"]\n", i, node->token);
+        printf("\"%d-1\" -> \"%d-2\"\n", i, i);
+        printf("\"%d-3\"[label=\"%d\" shape=diamond]\n", i, node->ret);
+        printf("\"%d-2\" -> \"%d-3\"\n", i, i);
+        i+=sizeof(struct vm_tstring_t)+strlen((char *)node->token);
+      } break;
       case VINTEGER: {
         struct vm_vinteger_t *node = (struct vm_vinteger_t *)&obj->ast.buffer[i];
         printf("\"%d-1\"[label=\"%d\" shape=square]\n", i, i);
@@ -3218,28 +3395,47 @@ static void print_tree(struct rules_t *obj) {
 #endif
 /*LCOV_EXCL_STOP*/
 
+/*
+ * Outside the validation the varstack can't grow
+ * beyond the room reserved for it in the mempool.
+ */
+static int vm_value_room(struct rules_t *obj) {
+  if(validating == 0 && alignedbytes(obj->varstack.nrbytes+MAX_VARSTACK_NODE_SIZE) > obj->varstack.bufsize) {
+    logprintf_P(F("FATAL: varstack full in %s #%d"), __FUNCTION__, __LINE__);
+    return -1;
+  }
+  return 0;
+}
+
 static int vm_value_set(struct rules_t *obj, int step, int ret) {
   int out = obj->varstack.nrbytes;
 
+  if(vm_value_room(obj) == -1) {
+    return -1;
+  }
+
 #ifdef DEBUG
   printf("%s %d %d\n", __FUNCTION__, __LINE__, out);
 #endif
   switch(obj->ast.buffer[step]) {
     case TNUMBER: {
-      float var = 0;
       struct vm_tnumber_t *node = (struct vm_tnumber_t *)&obj->ast.buffer[step];
-      var = atof((char *)node->token);
+      /*
+       * Only integers are stored as TNUMBER,
+       * so there is no need for atof here.
+       */
+      int var = atoi((char *)node->token);
 
       unsigned int size = alignedbytes(obj->varstack.nrbytes+sizeof(struct vm_vinteger_t));
 
       struct vm_vinteger_t *value = (struct vm_vinteger_t *)&obj->varstack.buffer[obj->varstack.nrbytes];
       value->type = VINTEGER;
       value->ret = ret;
-      value->value = (int)var;
+      value->value = var;
       obj->varstack.nrbytes = size;
       obj->varstack.bufsize = MAX(obj->varstack.bufsize, alignedvarstack(obj->varstack.nrbytes));
 #ifdef DEBUG
-      printf("%s %d %d %d\n", __FUNCTION__, __LINE__, out, (int)var);
+      printf("%s %d %d %d\n", __FUNCTION__, __LINE__, out, var);
 #endif
     } break;
     case VFLOAT: {
@@ -3280,6 +3476,31 @@ static int vm_value_set(struct rules_t *obj, int step, int ret) {
       obj->varstack.bufsize = MAX(obj->varstack.bufsize, alignedvarstack(obj->varstack.nrbytes));
 #ifdef DEBUG
       printf("%s %d %d NULL\n", __FUNCTION__, __LINE__, out);
+#endif
+    } break;
+    case TSTRING: {
+      struct vm_tstring_t *node = (struct vm_tstring_t *)&obj->ast.buffer[step];
+      const char *str = strpool_intern(&rule_strings, (char *)node->token, strlen((char *)node->token));
+
+      /*
+       * With a full string pool the rule stops, a NULL
+       * instead would compare equal to any other NULL.
+       */
+      if(str == NULL) {
+        logprintf_P(F("FATAL: string pool full in %s #%d"), __FUNCTION__, __LINE__);
+        return -1;
+      } else {
+        unsigned int size = alignedbytes(obj->varstack.nrbytes+sizeof(struct vm_vchar_t));
+
+        struct vm_vchar_t *value = (struct vm_vchar_t *)&obj->varstack.buffer[obj->varstack.nrbytes];
+        value->type = VCHAR;
+        value->ret = ret;
+        value->value = strpool_offset(&rule_strings, str);
+        obj->varstack.nrbytes = size;
+      }
+      obj->varstack.bufsize = MAX(obj->varstack.bufsize, alignedvarstack(obj->varstack.nrbytes));
+#ifdef DEBUG
+      printf("%s %d %d %s\n", __FUNCTION__, __LINE__, out, node->token);
 #endif
     } break;
     /* LCOV_EXCL_START*/
@@ -3322,6 +3543,10 @@ static int vm_value_upd_pos(struct rules_t *obj, int val, int step) {
 static int vm_value_clone(struct rules_t *obj, unsigned char *val) {
   int ret = obj->varstack.nrbytes;
 
+  if(vm_value_room(obj) == -1) {
+    return -1;
+  }
+
   switch(val[0]) {
     case VINTEGER: {
       unsigned int size = alignedbytes(obj->varstack.nrbytes+sizeof(struct vm_vinteger_t));
@@ -3354,6 +3579,17 @@ static int vm_value_clone(struct rules_t *obj, unsigned char *val) {
       obj->varstack.nrbytes = size;
       obj->varstack.bufsize = MAX(obj->varstack.bufsize, alignedvarstack(obj->varstack.nrbytes));
     } break;
+    case VCHAR: {
+      unsigned int size = alignedbytes(obj->varstack.nrbytes+sizeof(struct vm_vchar_t));
+
+      struct vm_vchar_t *cpy = (struct vm_vchar_t *)&val[0];
+      struct vm_vchar_t *value = (struct vm_vchar_t *)&obj->varstack.buffer[obj->varstack.nrbytes];
+      value->type = VCHAR;
+      value->ret = 0;
+      value->value = cpy->value;
+      obj->varstack.nrbytes = size;
+      obj->varstack.bufsize = MAX(obj->varstack.bufsize, alignedvarstack(obj->varstack.nrbytes));
+    } break;
     /* LCOV_EXCL_START*/
     default: {
       logprintf_P(F("FATAL: Internal error in %s #%d"), __FUNCTION__, __LINE__);
@@ -3396,6 +3632,13 @@ static int vm_value_del(struct rules_t *obj, unsigned int idx) {
       obj->varstack.nrbytes -= ret;
       obj->varstack.bufsize = MAX(obj->varstack.bufsize, alignedvarstack(obj->varstack.nrbytes));
     } break;
+    case VCHAR: {
+      ret = alignedbytes(sizeof(struct vm_vchar_t));
+      memmove(&obj->varstack.buffer[idx], &obj->varstack.buffer[idx+ret], obj->varstack.nrbytes-idx-ret);
+
+      obj->varstack.nrbytes -= ret;
+      obj->varstack.bufsize = MAX(obj->varstack.bufsize, alignedvarstack(obj->varstack.nrbytes));
+    } break;
     /* LCOV_EXCL_START*/
     default: {
       logprintf_P(F("FATAL: Internal error in %s #%d"), __FUNCTION__, __LINE__);
@@ -3437,6 +3680,13 @@ static int vm_value_del(struct rules_t *obj, unsigned int idx) {
         }
         x += sizeof(struct vm_vnull_t)-1;
       } break;
+      case VCHAR: {
+        struct vm_vchar_t *node = (struct vm_vchar_t *)&obj->varstack.buffer[x];
+        if(node->ret > 0) {
+          vm_value_upd_pos(obj, x, node->ret);
+        }
+        x += sizeof(struct vm_vchar_t)-1;
+      } break;
       /* LCOV_EXCL_START*/
       default: {
         logprintf_P(F("FATAL: Internal error in %s #%d"), __FUNCTION__, __LINE__);
@@ -3449,6 +3699,207 @@ static int vm_value_del(struct rules_t *obj, unsigned int idx) {
   return ret;
 }
 
+/*
+ * Load an operand straight into a typed register.
+ * Constants and variables are read in place, so
+ * they don't have to be pushed on the varstack first.
+ * Intermediate results of child nodes stay where
+ * they are, their position is returned through idx
+ * so the caller can reuse or release the slot.
+ */
+static int vm_value_load(struct rules_t *obj, int step, struct vm_register_t *reg, unsigned int *idx) {
+  unsigned char *val = NULL;
+
+  *idx = 0;
+
+  switch(obj->ast.buffer[step]) {
+    case TNUMBER: {
+      struct vm_tnumber_t *node = (struct vm_tnumber_t *)&obj->ast.buffer[step];
+      reg->type = VINTEGER;
+      reg->value.i = atoi((char *)node->token);
+      return 0;
+    } break;
+    case TSTRING: {
+      struct vm_tstring_t *node = (struct vm_tstring_t *)&obj->ast.buffer[step];
+      reg->value.s = strpool_intern(&rule_strings, (char *)node->token, strlen((char *)node->token));
+      if(reg->value.s == NULL) {
+        logprintf_P(F("FATAL: string pool full in %s #%d"), __FUNCTION__, __LINE__);
+        return -1;
+      }
+      reg->type = VCHAR;
+      return 0;
+    } break;
+    case VINTEGER:
+    case VFLOAT:
+    case VNULL: {
+      val = &obj->ast.buffer[step];
+    } break;
+    case TOPERATOR: {
+      struct vm_toperator_t *tmp = (struct vm_toperator_t *)&obj->ast.buffer[step];
+      *idx = tmp->value;
+      tmp->value = 0;
+    } break;
+    case LPAREN: {
+      struct vm_lparen_t *tmp = (struct vm_lparen_t *)&obj->ast.buffer[step];
+      *idx = tmp->value;
+      tmp->value = 0;
+    } break;
+    case TFUNCTION: {
+      struct vm_tfunction_t *tmp = (struct vm_tfunction_t *)&obj->ast.buffer[step];
+      *idx = tmp->value;
+      tmp->value = 0;
+    } break;
+    case TVAR: {
+      if(rule_options.get_token_val_cb != NULL && rule_options.cpy_token_val_cb != NULL) {
+        rule_options.cpy_token_val_cb(obj, step);
+        val = rule_options.get_token_val_cb(obj, step);
+
+        /* LCOV_EXCL_START*/
+        if(val == NULL) {
+          logprintf_P(F("FATAL: 'get_token_val_cb' did not return a value"));
+          return -1;
+        }
+        /* LCOV_EXCL_STOP*/
+      } else {
+        /* LCOV_EXCL_START*/
+        logprintf_P(F("FATAL: No '[get|cpy]_token_val_cb' set to handle variables"));
+        return -1;
+        /* LCOV_EXCL_STOP*/
+      }
+    } break;
+    /* LCOV_EXCL_START*/
+    default: {
+      logprintf_P(F("FATAL: Internal error in %s #%d"), __FUNCTION__, __LINE__);
+      return -1;
+    } break;
+    /* LCOV_EXCL_STOP*/
+  }
+
+  if(val == NULL) {
+    /*
+     * A function that didn't return anything
+     */
+    if(*idx == 0) {
+      reg->type = VNULL;
+      return 0;
+    }
+    val = &obj->varstack.buffer[*idx];
+  }
+
+  switch(val[0]) {
+    case VINTEGER: {
+      struct vm_vinteger_t *node = (struct vm_vinteger_t *)&val[0];
+      reg->type = VINTEGER;
+      reg->value.i = node->value;
+    } break;
+    case VFLOAT: {
+      struct vm_vfloat_t *node = (struct vm_vfloat_t *)&val[0];
+      reg->type = VFLOAT;
+      reg->value.f = node->value;
+    } break;
+    case VNULL: {
+      reg->type = VNULL;
+    } break;
+    case VCHAR: {
+      struct vm_vchar_t *node = (struct vm_vchar_t *)&val[0];
+      reg->type = VCHAR;
+      reg->value.s = strpool_get(&rule_strings, node->value);
+    } break;
+    /* LCOV_EXCL_START*/
+    default: {
+      logprintf_P(F("FATAL: Internal error in %s #%d"), __FUNCTION__, __LINE__);
+      return -1;
+    } break;
+    /* LCOV_EXCL_STOP*/
+  }
+
+  return 0;
+}
+
+static unsigned int vm_value_size(int type) {
+  switch(type) {
+    case VINTEGER: {
+      return alignedbytes(sizeof(struct vm_vinteger_t));
+    } break;
+    case VFLOAT: {
+      return alignedbytes(sizeof(struct vm_vfloat_t));
+    } break;
+    case VNULL: {
+      return alignedbytes(sizeof(struct vm_vnull_t));
+    } break;
+    case VCHAR: {
+      return alignedbytes(sizeof(struct vm_vchar_t));
+    } break;
+  }
+  return 0;
+}
+
+/*
+ * Store the result register of an operator owned by
+ * node 'ret'. Operand slots are released first. When
+ * one of them has the same size as the result, it's
+ * overwritten in place, so no values have to be moved
+ * and relinked.
+ */
+static int vm_value_store(struct rules_t *obj, struct vm_register_t *reg, unsigned int a, unsigned int b, int ret) {
+  unsigned int out = 0;
+
+  if(a > 0 && b > 0) {
+    vm_value_del(obj, MAX(a, b));
+    out = MIN(a, b);
+  } else {
+    out = MAX(a, b);
+  }
+
+  if(out > 0 && vm_value_size(obj->varstack.buffer[out]) != vm_value_size(reg->type)) {
+    vm_value_del(obj, out);
+    out = 0;
+  }
+
+  if(out == 0) {
+    if(vm_value_room(obj) == -1) {
+      return -1;
+    }
+    out = obj->varstack.nrbytes;
+    obj->varstack.nrbytes = alignedbytes(obj->varstack.nrbytes + vm_value_size(reg->type));
+    obj->varstack.bufsize = MAX(obj->varstack.bufsize, alignedvarstack(obj->varstack.nrbytes));
+  }
+
+  switch(reg->type) {
+    case VINTEGER: {
+      struct vm_vinteger_t *value = (struct vm_vinteger_t *)&obj->varstack.buffer[out];
+      value->type = VINTEGER;
+      value->ret = ret;
+      value->value = reg->value.i;
+    } break;
+    case VFLOAT: {
+      struct vm_vfloat_t *value = (struct vm_vfloat_t *)&obj->varstack.buffer[out];
+      value->type = VFLOAT;
+      value->ret = ret;
+      value->value = reg->value.f;
+    } break;
+    case VNULL: {
+      struct vm_vnull_t *value = (struct vm_vnull_t *)&obj->varstack.buffer[out];
+      value->type = VNULL;
+      value->ret = ret;
+    } break;
+    case VCHAR: {
+      struct vm_vchar_t *value = (struct vm_vchar_t *)&obj->varstack.buffer[out];
+      value->type = VCHAR;
+      value->ret = ret;
+      value->value = strpool_offset(&rule_strings, reg->value.s);
+    } break;
+    /* LCOV_EXCL_START*/
+    default: {
+      logprintf_P(F("FATAL: Internal error in %s #%d"), __FUNCTION__, __LINE__);
+      return -1;
+    } break;
+    /* LCOV_EXCL_STOP*/
+  }
+
+  return out;
+}
+
 /*LCOV_EXCL_START*/
 void valprint(struct rules_t *obj, char *out, int size) {
   int x = 0, pos = 0;
@@ -3526,6 +3977,27 @@ void valprint(struct rules_t *obj, char *out, int size) {
           }
           x += sizeof(struct vm_vnull_t)-1;
         } break;
+        case VCHAR: {
+          struct vm_vchar_t *val = (struct vm_vchar_t *)&obj->varstack.buffer[x];
+          const char *str = strpool_get(&rule_strings, val->value);
+          switch(obj->ast.buffer[val->ret]) {
+            case TVAR: {
+              struct vm_tvar_t *node = (struct vm_tvar_t *)&obj->ast.buffer[val->ret];
+              pos += snprintf(&out[pos], size - pos, "%s = \"%s\"", node->token, str);
+            } break;
+            case TFUNCTION: {
+              struct vm_tfunction_t *node = (struct vm_tfunction_t *)&obj->ast.buffer[val->ret];
+              pos += snprintf(&out[pos], size - pos, "%s = \"%s\"", rule_functions[node->token].name, str);
+            } break;
+            case TOPERATOR: {
+              struct vm_toperator_t *node = (struct vm_toperator_t *)&obj->ast.buffer[val->ret];
+              pos += snprintf(&out[pos], size - pos, "%s = \"%s\"", rule_operators[node->token].name, str);
+            } break;
+            default: {
+            } break;
+          }
+          x += sizeof(struct vm_vchar_t)-1;
+        } break;
         default: {
           logprintf_P(F("FATAL: Internal error in %s #%d"), __FUNCTION__, __LINE__);
         } break;
@@ -3593,6 +4065,10 @@ static void vm_clear_values(struct rules_t *obj) {
         struct vm_tnumber_t *node = (struct vm_tnumber_t *)&obj->ast.buffer[i];
         i+=sizeof(struct vm_tnumber_t)+strlen((char *)node->token);
       } break;
+      case TSTRING: {
+        struct vm_tstring_t *node = (struct vm_tstring_t *)&obj->ast.buffer[i];
+        i+=sizeof(struct vm_tstring_t)+strlen((char *)node->token);
+      } break;
       case VINTEGER: {
         i+=sizeof(struct vm_vinteger_t)-1;
       } break;
@@ -3610,7 +4086,7 @@ static void vm_clear_values(struct rules_t *obj) {
   }
 }
 
-int rule_run(struct rules_t *obj, int validate) {
+int rule_run(struct rules_t *obj) {
 #ifdef DEBUG
   printf("----------\n");
   printf("%s %d\n", __FUNCTION__, obj->nr);
@@ -3618,6 +4094,7 @@ int rule_run(struct rules_t *obj, int validate) {
 #endif
 
   int go = 0, ret = -1, i = -1, start = -1;
+  unsigned int steps = 0;
   go = start = 0;
 
   while(go != -1) {
@@ -3625,6 +4102,22 @@ int rule_run(struct rules_t *obj, int validate) {
     ESP.wdtFeed();
 #endif
 
+    /*
+     * Once the budget is spent, store where
+     * we are just like a rule call does. The
+     * next rule_run continues from there. The
+     * start node is not counted so a resumed
+     * run always makes progress. Rules called
+     * while validating always run to the end.
+     */
+    if(validating == 0 && rule_options.max_steps > 0 && go > 0 && ret > -1 &&
+       ++steps > rule_options.max_steps) {
+      obj->cont.go = go;
+      obj->cont.ret = ret;
+      obj->suspended = 1;
+      return 1;
+    }
+
 /*LCOV_EXCL_START*/
 #ifdef DEBUG
     printf("goto: %d, ret: %d, bytes: %d\n", go, ret, obj->ast.nrbytes);
@@ -3650,6 +4143,7 @@ int rule_run(struct rules_t *obj, int validate) {
             ret = obj->cont.ret;
             obj->cont.go = 0;
             obj->cont.ret = 0;
+            obj->suspended = 0;
           } else {
             vm_clear_values(obj);
             go = node->go;
@@ -3713,7 +4207,7 @@ int rule_run(struct rules_t *obj, int validate) {
           ret = go;
           go = node->ret;
         } else if(node->true_ == ret) {
-          if(node->false_ != 0 && (val == 0 || validate == 1)) {
+          if(node->false_ != 0 && (val == 0 || validating == 1)) {
             go = node->false_;
             ret = go;
           } else {
@@ -3721,10 +4215,10 @@ int rule_run(struct rules_t *obj, int validate) {
             go = node->ret;
           }
         } else if(node->go == ret) {
-          if(node->false_ != 0 && val == 0 && validate == 0) {
+          if(node->false_ != 0 && val == 0 && validating == 0) {
             go = node->false_;
             ret = go;
-          } else if(val == 1 || validate == 1) {
+          } else if(val == 1 || validating == 1) {
             ret = go;
             go = node->true_;
           } else {
@@ -3765,7 +4259,8 @@ int rule_run(struct rules_t *obj, int validate) {
               switch(obj->ast.buffer[node->go[i+1]]) {
                 case TNUMBER:
                 case VINTEGER:
-                case VFLOAT: {
+                case VFLOAT:
+                case TSTRING: {
                   ret = go;
                   go = node->go[i+1];
                 } break;
@@ -3817,8 +4312,13 @@ int rule_run(struct rules_t *obj, int validate) {
             switch(obj->ast.buffer[node->go[i]]) {
               case TNUMBER:
               case VINTEGER:
-              case VFLOAT: {
-                values[i] = vm_value_set(obj, node->go[i], 0);
+              case VFLOAT:
+              case TSTRING: {
+                int val = vm_value_set(obj, node->go[i], 0);
+                if(val < 0) {
+                  return -1;
+                }
+                values[i] = val;
 
                 /*
                  * Reassign node due to possible reallocs
@@ -3847,7 +4347,11 @@ int rule_run(struct rules_t *obj, int validate) {
                 val->ret = 0;
               } break;
               case VNULL: {
-                values[i] = vm_value_set(obj, node->go[i], node->go[i]);
+                int val = vm_value_set(obj, node->go[i], node->go[i]);
+                if(val < 0) {
+                  return -1;
+                }
+                values[i] = val;
                 /*
                 * Reassign node due to possible reallocs
                 */
@@ -3863,7 +4367,11 @@ int rule_run(struct rules_t *obj, int validate) {
                     return -1;
                   }
                   /* LCOV_EXCL_STOP*/
-                  values[i] = vm_value_clone(obj, val);
+                  int cpy = vm_value_clone(obj, val);
+                  if(cpy < 0) {
+                    return -1;
+                  }
+                  values[i] = cpy;
 
                   /*
                    * Reassign node due to possible reallocs
@@ -3913,6 +4421,11 @@ int rule_run(struct rules_t *obj, int validate) {
                 tmp->ret = go;
                 node->value = c;
               } break;
+              case VCHAR: {
+                struct vm_vchar_t *tmp = (struct vm_vchar_t *)&obj->varstack.buffer[c];
+                tmp->ret = go;
+                node->value = c;
+              } break;
               /* LCOV_EXCL_START*/
               default: {
                 logprintf_P(F("FATAL: Internal error in %s #%d"), __FUNCTION__, __LINE__);
@@ -3928,7 +4441,8 @@ int rule_run(struct rules_t *obj, int validate) {
             switch(obj->varstack.buffer[values[i] - shift]) {
               case VFLOAT:
               case VNULL:
-              case VINTEGER: {
+              case VINTEGER:
+              case VCHAR: {
                 shift += vm_value_del(obj, values[i] - shift);
 
                 /*
@@ -3957,155 +4471,33 @@ int rule_run(struct rules_t *obj, int validate) {
               (
                 obj->ast.buffer[node->left] == VFLOAT ||
                 obj->ast.buffer[node->left] == VINTEGER ||
-                obj->ast.buffer[node->left] == TNUMBER
+                obj->ast.buffer[node->left] == TNUMBER ||
+                obj->ast.buffer[node->left] == TSTRING
               ) &&
               (
                 obj->ast.buffer[node->right] == VFLOAT ||
                 obj->ast.buffer[node->right] == VINTEGER ||
-                obj->ast.buffer[node->right] == TNUMBER
+                obj->ast.buffer[node->right] == TNUMBER ||
+                obj->ast.buffer[node->right] == TSTRING
               )
             )
            ) {
-          int a = 0, b = 0, c = 0, step = 0;
-          step = node->left;
-
-          switch(obj->ast.buffer[step]) {
-            case TNUMBER:
-            case VFLOAT:
-            case VINTEGER: {
-              a = vm_value_set(obj, step, step);
-              /*
-               * Reassign node due to possible reallocs
-               */
-              node = (struct vm_toperator_t *)&obj->ast.buffer[go];
-            } break;
-            case TOPERATOR: {
-              struct vm_toperator_t *tmp = (struct vm_toperator_t *)&obj->ast.buffer[step];
-              a = tmp->value;
-              tmp->value = 0;
-            } break;
-            case LPAREN: {
-              struct vm_lparen_t *tmp = (struct vm_lparen_t *)&obj->ast.buffer[step];
-              a = tmp->value;
-              tmp->value = 0;
-            } break;
-            case TFUNCTION: {
-              struct vm_tfunction_t *tmp = (struct vm_tfunction_t *)&obj->ast.buffer[step];
-              a = tmp->value;
-              tmp->value = 0;
-            } break;
-            case VNULL: {
-              a = vm_value_set(obj, step, step);
-              /*
-               * Reassign node due to possible reallocs
-               */
-              node = (struct vm_toperator_t *)&obj->ast.buffer[go];
-            } break;
-            case TVAR: {
-              /*
-               * If vars are seperate steps
-               */
-              // struct vm_tvar_t *tmp = (struct vm_tvar_t *)&obj->ast.buffer[step];
-              // a = tmp->value;
-
-              if(rule_options.get_token_val_cb != NULL && rule_options.cpy_token_val_cb != NULL) {
-                rule_options.cpy_token_val_cb(obj, step); // TESTME
-                unsigned char *val = rule_options.get_token_val_cb(obj, step);
+          struct vm_register_t ra, rb, rc;
+          unsigned int a = 0, b = 0, idx = node->token;
+          int c = 0;
 
-                /* LCOV_EXCL_START*/
-                if(val == NULL) {
-                  logprintf_P(F("FATAL: 'get_token_val_cb' did not return a value"));
-                  return -1;
-                }
-                /* LCOV_EXCL_STOP*/
-                a = vm_value_clone(obj, val);
-                /*
-                 * Reassign node due to possible reallocs
-                 */
-                node = (struct vm_toperator_t *)&obj->ast.buffer[go];
-              } else {
-                /* LCOV_EXCL_START*/
-                logprintf_P(F("FATAL: No '[get|cpy]_token_val_cb' set to handle variables"));
-                return -1;
-                /* LCOV_EXCL_STOP*/
-              }
-            } break;
-            /* LCOV_EXCL_START*/
-            default: {
-              logprintf_P(F("FATAL: Internal error in %s #%d"), __FUNCTION__, __LINE__);
-              return -1;
-            } break;
-            /* LCOV_EXCL_STOP*/
+          if(vm_value_load(obj, node->left, &ra, &a) != 0) {
+            return -1;
           }
+          /*
+           * Reassign node due to possible reallocs
+           */
+          node = (struct vm_toperator_t *)&obj->ast.buffer[go];
 
-          step = node->right;
-
-          switch(obj->ast.buffer[step]) {
-            case TNUMBER:
-            case VFLOAT:
-            case VINTEGER: {
-              b = vm_value_set(obj, step, step);
-              /*
-               * Reassign node due to possible reallocs
-               */
-              node = (struct vm_toperator_t *)&obj->ast.buffer[go];
-            } break;
-            case TOPERATOR: {
-              struct vm_toperator_t *tmp = (struct vm_toperator_t *)&obj->ast.buffer[step];
-              b = tmp->value;
-              tmp->value = 0;
-            } break;
-            case LPAREN: {
-              struct vm_lparen_t *tmp = (struct vm_lparen_t *)&obj->ast.buffer[step];
-              b = tmp->value;
-              tmp->value = 0;
-            } break;
-            case TFUNCTION: {
-              struct vm_tfunction_t *tmp = (struct vm_tfunction_t *)&obj->ast.buffer[step];
-              b = tmp->value;
-              tmp->value = 0;
-            } break;
-            case VNULL: {
-              b = vm_value_set(obj, step, step);
-              /*
-               * Reassign node due to possible reallocs
-               */
-              node = (struct vm_toperator_t *)&obj->ast.buffer[go];
-            } break;
-            case TVAR: {
-              /*
-               * If vars are seperate steps
-               */
-              if(rule_options.get_token_val_cb != NULL && rule_options.cpy_token_val_cb != NULL) {
-                rule_options.cpy_token_val_cb(obj, step); // TESTME
-                unsigned char *val = rule_options.get_token_val_cb(obj, step);
-
-                /* LCOV_EXCL_START*/
-                if(val == NULL) {
-                  logprintf_P(F("FATAL: 'get_token_val_cb' did not return a value"));
-                  return -1;
-                }
-                /* LCOV_EXCL_STOP*/
-                b = vm_value_clone(obj, val);
-                /*
-                 * Reassign node due to possible reallocs
-                 */
-                node = (struct vm_toperator_t *)&obj->ast.buffer[go];
-              } else {
-                /* LCOV_EXCL_START*/
-                logprintf_P(F("FATAL: No '[get|cpy]_token_val_cb' set to handle variables"));
-                return -1;
-                /* LCOV_EXCL_STOP*/
-              }
-            } break;
-            /* LCOV_EXCL_START*/
-            default: {
-              logprintf_P(F("FATAL: Internal error in %s #%d"), __FUNCTION__, __LINE__);
-              return -1;
-            } break;
-            /* LCOV_EXCL_STOP*/
+          if(vm_value_load(obj, node->right, &rb, &b) != 0) {
+            return -1;
           }
-          unsigned int idx = node->token;
+          node = (struct vm_toperator_t *)&obj->ast.buffer[go];
 
           /* LCOV_EXCL_START*/
           if(idx > nr_rule_operators) {
@@ -4114,68 +4506,19 @@ int rule_run(struct rules_t *obj, int validate) {
           }
           /* LCOV_EXCL_STOP*/
 
-          if(rule_operators[idx].callback(obj, a, b, &c) != 0) {
+          if(rule_operators[idx].callback(&ra, &rb, &rc) != 0) {
             /* LCOV_EXCL_START*/
             logprintf_P(F("FATAL: operator call '%s' failed"), rule_operators[idx].name);
             return -1;
             /* LCOV_EXCL_STOP*/
           }
 
-          /*
-           * Reassign node due to possible (unsigned char *)REALLOC's
-           * in the callbacks
-           */
-          node = (struct vm_toperator_t *)&obj->ast.buffer[go];
-
-          switch(obj->varstack.buffer[c]) {
-            case VINTEGER: {
-              struct vm_vinteger_t *tmp = (struct vm_vinteger_t *)&obj->varstack.buffer[c];
-              /*
-               * Reassign node due to possible reallocs
-               */
-              node = (struct vm_toperator_t *)&obj->ast.buffer[go];
-              tmp->ret = go;
-              node->value = c;
-            } break;
-            case VFLOAT: {
-              struct vm_vfloat_t *tmp = (struct vm_vfloat_t *)&obj->varstack.buffer[c];
-              /*
-               * Reassign node due to possible reallocs
-               */
-              node = (struct vm_toperator_t *)&obj->ast.buffer[go];
-              tmp->ret = go;
-              node->value = c;
-            } break;
-            case VNULL: {
-              struct vm_vnull_t *tmp = (struct vm_vnull_t *)&obj->varstack.buffer[c];
-              /*
-               * Reassign node due to possible reallocs
-               */
-              node = (struct vm_toperator_t *)&obj->ast.buffer[go];
-              tmp->ret = go;
-              node->value = c;
-            } break;
-            /* LCOV_EXCL_START*/
-            default: {
-              logprintf_P(F("FATAL: Internal error in %s #%d"), __FUNCTION__, __LINE__);
-              return -1;
-            } break;
-            /* LCOV_EXCL_STOP*/
+          if((c = vm_value_store(obj, &rc, a, b, go)) < 0) {
+            return -1;
           }
 
-          vm_value_del(obj, MAX(a, b));
-
-          /*
-           * Reassign node due to possible reallocs
-           */
-          node = (struct vm_toperator_t *)&obj->ast.buffer[go];
-
-          vm_value_del(obj, MIN(a, b));
-
-          /*
-           * Reassign node due to possible reallocs
-           */
           node = (struct vm_toperator_t *)&obj->ast.buffer[go];
+          node->value = c;
 
           ret = go;
           go = node->ret;
@@ -4338,8 +4681,11 @@ int rule_run(struct rules_t *obj, int validate) {
               } break;
               case TNUMBER:
               case VFLOAT:
-              case VINTEGER: {
-                idx = vm_value_set(obj, node->go, go);
+              case VINTEGER:
+              case TSTRING: {
+                if((idx = vm_value_set(obj, node->go, go)) < 0) {
+                  return -1;
+                }
 
                 /*
                  * Reassign node due to various (unsigned char *)REALLOC's
@@ -4347,7 +4693,9 @@ int rule_run(struct rules_t *obj, int validate) {
                 node = (struct vm_tvar_t *)&obj->ast.buffer[go];
               } break;
               case VNULL: {
-                idx = vm_value_set(obj, node->go, go);
+                if((idx = vm_value_set(obj, node->go, go)) < 0) {
+                  return -1;
+                }
                 /*
                  * Reassign node due to various (unsigned char *)REALLOC's
                  */
@@ -4366,7 +4714,9 @@ int rule_run(struct rules_t *obj, int validate) {
                     return -1;
                   }
                   /* LCOV_EXCL_STOP*/
-                  idx = vm_value_clone(obj, val);
+                  if((idx = vm_value_clone(obj, val)) < 0) {
+                    return -1;
+                  }
                 } else {
                   /* LCOV_EXCL_START*/
                   logprintf_P(F("FATAL: No '[get|cpy]_token_val_cb' set to handle variables"));
@@ -4507,6 +4857,14 @@ void print_bytecode(struct rules_t *obj) {
         i += sizeof(struct vm_tnumber_t)+strlen((char *)node->token);
       } break;
       /* LCOV_EXCL_STOP*/
+      case TSTRING: {
+        struct vm_tstring_t *node = (struct vm_tstring_t *)&obj->ast.buffer[i];
+        printf("(TSTRING)[%lu][", 3+strlen((char *)node->token)+1);
+        printf("type: %d, ", node->type);
+        printf("ret: %d, ", node->ret);
+        printf("token: %s]\n", node->token);
+        i += sizeof(struct vm_tstring_t)+strlen((char *)node->token);
+      } break;
       case VINTEGER: {
         struct vm_vinteger_t *node = (struct vm_vinteger_t *)&obj->ast.buffer[i];
         printf("(VINTEGER)[%lu][", sizeof(struct vm_vinteger_t));
@@ -4678,6 +5036,15 @@ int rule_initialize(struct pbuf *input, struct rules_t ***rules, int *nrrules, s
     obj->ast.buffer = (unsigned char *)&((unsigned char *)mempool->payload)[alignedbuffer(mempool->len)];
     mempool->len += obj->ast.bufsize;
 
+    /*
+     * The bytecode would run into the
+     * text of the rules still to parse.
+     */
+    if(mempool->len > input->len) {
+      logprintf_P(F("ERROR: not enough free space in rules mempool"));
+      return -1;
+    }
+
     suggested_varstack_size = (input->len-mempool->len);
 
     /*
@@ -4739,16 +5106,27 @@ int rule_initialize(struct pbuf *input, struct rules_t ***rules, int *nrrules, s
 #endif
 /*LCOV_EXCL_STOP*/
 
-  if(rule_run(obj, 1) == -1) {
+  validating = 1;
+  if(rule_run(obj) == -1) {
+    validating = 0;
     return -1;
   }
+  validating = 0;
 
   /*
    * Reserve space for the actual maximum
-   * varstack buffer size
+   * varstack buffer size. A real run can hold
+   * larger values than the validation did, so
+   * count each of them as the largest value.
    */
+  obj->varstack.bufsize = alignedvarstack(4 + ((obj->varstack.bufsize - 4) * MAX_VARSTACK_NODE_SIZE) / sizeof(struct vm_vnull_t));
   mempool->len += alignedbuffer(obj->varstack.bufsize);
 
+  if(mempool->len > input->len) {
+    logprintf_P(F("ERROR: not enough free space in rules mempool"));
+    return -1;
+  }
+
 /*LCOV_EXCL_START*/
 #if defined(DEBUG) or defined(ESP8266)
   #ifdef ESP8266
@@ -12,6 +12,8 @@
 
 #include <stdint.h>
 
+#include "../common/strpool.h"
+
 #ifndef ESP8266
   #define F
   #define MEMPOOL_SIZE 16000
@@ -33,7 +35,7 @@
 #define EPSILON  0.000001
 
 /*
- * max(sizeof(vm_vfloat_t), sizeof(vm_vinteger_t), sizeof(vm_vnull_t))
+ * max(sizeof(vm_vfloat_t), sizeof(vm_vinteger_t), sizeof(vm_vnull_t), sizeof(vm_vchar_t))
  */
 #define MAX_VARSTACK_NODE_SIZE 7
 
@@ -142,6 +144,11 @@ typedef struct rules_t {
     uint16_t ret;
   } cont;
 
+  /* Set when the run was suspended after
+   * spending its step budget.
+   */
+  uint8_t suspended;
+
   /* To which rule do we return after
    * being called from another rule.
    */
@@ -182,10 +189,22 @@ typedef struct rule_options_t {
    * Events
    */
   int (*event_cb)(struct rules_t *obj, char *name);
+
+  /*
+   * Maximum number of steps a single
+   * rule_run may take, 0 is unlimited.
+   */
+  unsigned int max_steps;
 } rule_options_t;
 
 extern struct rule_options_t rule_options;
 
+/*
+ * Strings created while running rules. The
+ * pool is emptied once a run has completed.
+ */
+extern struct strpool_t rule_strings;
+
 /*
  * Each position field is the closest
  * aligned width of 11 bits.
@@ -194,9 +213,13 @@ extern struct rule_options_t rule_options;
   uint8_t type; \
   uint16_t ret;
 
+/*
+ * String values only refer to their
+ * interned copy in rule_strings.
+ */
 typedef struct vm_vchar_t {
   VM_GENERIC_FIELDS
-  char value[];
+  uint16_t value;
 } __attribute__((packed)) vm_vchar_t;
 
 typedef struct vm_vnull_t {
@@ -213,6 +236,22 @@ typedef struct vm_vfloat_t {
   float value;
 } __attribute__((packed)) vm_vfloat_t;
 
+/*
+ * Typed operand register. Operators read their
+ * operands from and write their result into these
+ * instead of pushing temporary values on the varstack.
+ */
+typedef struct vm_register_t {
+  uint8_t type;
+  union {
+    int i;
+    float f;
+    const char *s;
+  } value;
+} vm_register_t;
+
+#define VM_TYPES(a, b) (((a) << 8) | (b))
+
 typedef struct vm_tgeneric_t {
   VM_GENERIC_FIELDS
 } __attribute__((packed)) vm_tgeneric_t;
@@ -240,6 +279,11 @@ typedef struct vm_tnumber_t {
   uint8_t token[];
 } __attribute__((packed)) vm_tnumber_t;
 
+typedef struct vm_tstring_t {
+  VM_GENERIC_FIELDS
+  uint8_t token[];
+} __attribute__((packed)) vm_tstring_t;
+
 typedef struct vm_ttrue_t {
   VM_GENERIC_FIELDS
   uint8_t nrgo;
@@ -287,7 +331,7 @@ typedef struct vm_teof_t {
 unsigned int alignedvarstack(int v);
 int rule_initialize(struct pbuf *input, struct rules_t ***rules, int *nrrules, struct pbuf *mempool, void *userdata);
 void rules_gc(struct rules_t ***obj, unsigned int nrrules);
-int rule_run(struct rules_t *obj, int validate);
+int rule_run(struct rules_t *obj);
 void valprint(struct rules_t *obj, char *out, int size);
 
 #endif
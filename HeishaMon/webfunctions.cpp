@@ -1,8 +1,11 @@
 #include "webfunctions.h"
+#include "webroutes.h"
 #include "decode.h"
 #include "version.h"
 #include "htmlcode.h"
+#include "htmlgzip.h"
 #include "commands.h"
+#include "rules.h"
 #include "src/common/progmem.h"
 #include "src/common/webserver.h"
 #include "src/common/timerqueue.h"
@@ -23,6 +26,107 @@ static uint8_t ntpservers = 0;
 void log_message(char* string);
 void log_message(const __FlashStringHelper *msg);
 
+/*
+ * Larger scripts and the stylesheet are served from
+ * their own url, so they can be sent gzipped.
+ */
+enum {
+  WEBASSET_CSS = 0,
+  WEBASSET_WEBSOCKET,
+  WEBASSET_REFRESH,
+  WEBASSET_SETTINGS,
+  WEBASSET_SCANWIFI,
+  WEBASSET_GETSETTINGS
+};
+
+struct webAssetStruct {
+  const char *uri;
+  const char *mimetype;
+  const char *data;
+  const uint8_t *gzip;
+  uint16_t gzip_len;
+};
+
+static const char webAssetCSS[] PROGMEM = "/css/heishamon.css";
+static const char webAssetWebsocket[] PROGMEM = "/js/websocket.js";
+static const char webAssetRefresh[] PROGMEM = "/js/refresh.js";
+static const char webAssetSettings[] PROGMEM = "/js/settings.js";
+static const char webAssetScanWifi[] PROGMEM = "/js/scanwifi.js";
+static const char webAssetGetSettings[] PROGMEM = "/js/getsettings.js";
+
+static const webAssetStruct webAssets[] PROGMEM = {
+  { webAssetCSS, "text/css", webCSS, webCSS_gz, sizeof(webCSS_gz) },
+  { webAssetWebsocket, "application/javascript", websocketJS, websocketJS_gz, sizeof(websocketJS_gz) },
+  { webAssetRefresh, "application/javascript", refreshJS, refreshJS_gz, sizeof(refreshJS_gz) },
+  { webAssetSettings, "application/javascript", settingsJS, settingsJS_gz, sizeof(settingsJS_gz) },
+  { webAssetScanWifi, "application/javascript", populatescanwifiJS, populatescanwifiJS_gz, sizeof(populatescanwifiJS_gz) },
+  { webAssetGetSettings, "application/javascript", populategetsettingsJS, populategetsettingsJS_gz, sizeof(populategetsettingsJS_gz) },
+};
+
+static void sendWebAssetTag(struct webserver_t *client, uint8_t nr) {
+  webAssetStruct asset;
+  memcpy_P(&asset, &webAssets[nr], sizeof(asset));
+
+  if (nr == WEBASSET_CSS) {
+    webserver_send_content_P(client, PSTR("<link rel=\"stylesheet\" href=\""), 29);
+    webserver_send_content_P(client, asset.uri, strlen_P(asset.uri));
+    webserver_send_content_P(client, PSTR("\">"), 2);
+  } else {
+    webserver_send_content_P(client, PSTR("<script src=\""), 13);
+    webserver_send_content_P(client, asset.uri, strlen_P(asset.uri));
+    webserver_send_content_P(client, PSTR("\"></script>"), 11);
+  }
+}
+
+int findWebAsset(struct webserver_t *client, const char *uri) {
+  for (uint8_t x = 0; x < sizeof(webAssets) / sizeof(webAssets[0]); x++) {
+    webAssetStruct asset;
+    memcpy_P(&asset, &webAssets[x], sizeof(asset));
+    if (strcmp_P(uri, asset.uri) == 0) {
+      client->userdata = (void *)&webAssets[x];
+      return 0;
+    }
+  }
+  return -1;
+}
+
+/*
+ * Assets only change with the firmware, so their
+ * etag is derived from the version string.
+ */
+static uint32_t webAssetETag(uint8_t gzip) {
+  uint32_t hash = 2166136261UL;
+  for (const char *p = heishamon_version; *p != '\0'; p++) {
+    hash = (hash ^ (uint8_t)*p) * 16777619UL;
+  }
+  return (hash & ~1UL) | gzip;
+}
+
+/*
+ * The compressed copy is only sent to clients
+ * announcing gzip in their Accept-Encoding.
+ */
+int handleWebAsset(struct webserver_t *client) {
+  if (client->content == 0) {
+    webAssetStruct asset;
+    memcpy_P(&asset, client->userdata, sizeof(asset));
+
+    if (webserver_send_etag(client, webAssetETag(client->gzip)) == 1) {
+      return -1;
+    }
+
+    if (client->gzip == 1) {
+      webserver_send(client, 200, (char *)asset.mimetype, asset.gzip_len);
+      webserver_send_content_P(client, (PGM_P)asset.gzip, asset.gzip_len);
+    } else {
+      uint16_t len = strlen_P(asset.data);
+      webserver_send(client, 200, (char *)asset.mimetype, len);
+      webserver_send_content_P(client, asset.data, len);
+    }
+  }
+  return 0;
+}
+
 int dBmToQuality(int dBm) {
   if (dBm == 31)
     return -1;
@@ -290,7 +394,7 @@ int handleFactoryReset(struct webserver_t *client) {
     case 0: {
         webserver_send(client, 200, (char *)"text/html", 0);
         webserver_send_content_P(client, webHeader, strlen_P(webHeader));
-        webserver_send_content_P(client, webCSS, strlen_P(webCSS));
+        sendWebAssetTag(client, WEBASSET_CSS);
         webserver_send_content_P(client, refreshMeta, strlen_P(refreshMeta));
       } break;
     case 1: {
@@ -312,7 +416,7 @@ int handleReboot(struct webserver_t *client) {
     case 0: {
         webserver_send(client, 200, (char *)"text/html", 0);
         webserver_send_content_P(client, webHeader, strlen_P(webHeader));
-        webserver_send_content_P(client, webCSS, strlen_P(webCSS));
+        sendWebAssetTag(client, WEBASSET_CSS);
         webserver_send_content_P(client, refreshMeta, strlen_P(refreshMeta));
       } break;
     case 1: {
@@ -547,16 +651,16 @@ int saveSettings(struct webserver_t *client, settingsStruct *heishamonSettings)
   }
 
   if (wrongPassword) {
-    client->route = 111;
+    client->route = ROUTE_SAVESETTINGS_PASSWORD;
     return 0;
   }
 
   if (reconnectWiFi) {
-    client->route = 112;
+    client->route = ROUTE_SAVESETTINGS_RECONNECT;
     return 0;
   }
 
-  client->route = 113;
+  client->route = ROUTE_SAVESETTINGS_REDIRECT;
   return 0;
 }
 
@@ -614,7 +718,7 @@ int settingsNewPassword(struct webserver_t *client, settingsStruct *heishamonSet
     case 0: {
         webserver_send(client, 200, (char *)"text/html", 0);
         webserver_send_content_P(client, webHeader, strlen_P(webHeader));
-        webserver_send_content_P(client, webCSS, strlen_P(webCSS));
+        sendWebAssetTag(client, WEBASSET_CSS);
         webserver_send_content_P(client, webBodyStart, strlen_P(webBodyStart));
       } break;
     case 1: {
@@ -637,7 +741,7 @@ int settingsReconnectWifi(struct webserver_t *client, settingsStruct *heishamonS
   if (client->content == 0) {
     webserver_send(client, 200, (char *)"text/html", 0);
     webserver_send_content_P(client, webHeader, strlen_P(webHeader));
-    webserver_send_content_P(client, webCSS, strlen_P(webCSS));
+    sendWebAssetTag(client, WEBASSET_CSS);
     webserver_send_content_P(client, webBodyStart, strlen_P(webBodyStart));
     webserver_send_content_P(client, webBodySettings1, strlen_P(webBodySettings1));
   } else if (client->content == 2) {
@@ -854,7 +958,7 @@ int handleSettings(struct webserver_t *client) {
   if (client->content == 0) {
     webserver_send(client, 200, (char *)"text/html", 0);
     webserver_send_content_P(client, webHeader, strlen_P(webHeader));
-    webserver_send_content_P(client, webCSS, strlen_P(webCSS));
+    sendWebAssetTag(client, WEBASSET_CSS);
     webserver_send_content_P(client, webBodyStart, strlen_P(webBodyStart));
   } else if (client->content == 1) {
     webserver_send_content_P(client, webBodySettings1, strlen_P(webBodySettings1));
@@ -863,10 +967,10 @@ int handleSettings(struct webserver_t *client) {
   } else if (client->content == 2) {
     webserver_send_content_P(client, settingsForm2, strlen_P(settingsForm2));
     webserver_send_content_P(client, menuJS, strlen_P(menuJS));
-    webserver_send_content_P(client, settingsJS, strlen_P(settingsJS));
-    webserver_send_content_P(client, populategetsettingsJS, strlen_P(populategetsettingsJS));
+    sendWebAssetTag(client, WEBASSET_SETTINGS);
+    sendWebAssetTag(client, WEBASSET_GETSETTINGS);
   } else if (client->content == 3) {
-    webserver_send_content_P(client, populatescanwifiJS, strlen_P(populatescanwifiJS));
+    sendWebAssetTag(client, WEBASSET_SCANWIFI);
     webserver_send_content_P(client, changewifissidJS, strlen_P(changewifissidJS));
     webserver_send_content_P(client, webFooter, strlen_P(webFooter));
   }
@@ -928,7 +1032,7 @@ int handleRoot(struct webserver_t *client, float readpercentage, int mqttReconne
     case 0: {
         webserver_send(client, 200, (char *)"text/html", 0);
         webserver_send_content_P(client, webHeader, strlen_P(webHeader));
-        webserver_send_content_P(client, webCSS, strlen_P(webCSS));
+        sendWebAssetTag(client, WEBASSET_CSS);
         webserver_send_content_P(client, webBodyStart, strlen_P(webBodyStart));
         webserver_send_content_P(client, webBodyRoot1, strlen_P(webBodyRoot1));
       } break;
@@ -992,34 +1096,143 @@ int handleRoot(struct webserver_t *client, float readpercentage, int mqttReconne
         webserver_send_content_P(client, menuJS, strlen_P(menuJS));
       } break;
     case 6: {
-        webserver_send_content_P(client, refreshJS, strlen_P(refreshJS));
+        sendWebAssetTag(client, WEBASSET_REFRESH);
         webserver_send_content_P(client, selectJS, strlen_P(selectJS));
-        webserver_send_content_P(client, websocketJS, strlen_P(websocketJS));
+        sendWebAssetTag(client, WEBASSET_WEBSOCKET);
         webserver_send_content_P(client, webFooter, strlen_P(webFooter));
       } break;
   }
   return 0;
 }
 
+/*
+ * Decoded value changes are collected per frame and pushed
+ * to the websocket clients that subscribed to them, so the
+ * root page can patch its table instead of polling it.
+ */
+static char wsValues[512];
+static uint16_t wsValuesLen = 0;
+
+static bool websocketValuesSubscribed(void) {
+  for (uint8_t i = 0; i < WEBSERVER_MAX_CLIENTS; i++) {
+    if (clients[i].data.is_websocket == 1 && clients[i].data.route == ROUTE_WEBSOCKET_VALUES && clients[i].data.step != WEBSERVER_CLIENT_CLOSE) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void websocketValuesFlush(void) {
+  if (wsValuesLen == 0) {
+    return;
+  }
+  wsValues[wsValuesLen++] = ']';
+  wsValues[wsValuesLen++] = '}';
+  for (uint8_t i = 0; i < WEBSERVER_MAX_CLIENTS; i++) {
+    if (clients[i].data.is_websocket == 1 && clients[i].data.route == ROUTE_WEBSOCKET_VALUES && clients[i].data.step != WEBSERVER_CLIENT_CLOSE) {
+      websocket_write(&clients[i].data, wsValues, wsValuesLen);
+    }
+  }
+  wsValuesLen = 0;
+}
+
+// appends str as a JSON string, returns the new length or -1 when it doesn't fit
+static int websocketJsonString(char *out, int len, int size, const char *str, bool progmem) {
+  if (len + 1 >= size) {
+    return -1;
+  }
+  out[len++] = '"';
+  for (int i = 0;; i++) {
+    char c = progmem ? pgm_read_byte(&str[i]) : str[i];
+    if (c == 0) {
+      break;
+    }
+    if (c == '"' || c == '\\') {
+      if (len + 2 >= size) {
+        return -1;
+      }
+      out[len++] = '\\';
+      out[len++] = c;
+    } else if ((unsigned char)c < 0x20) {
+      if (len + 6 >= size) {
+        return -1;
+      }
+      len += snprintf_P(&out[len], size - len, PSTR("\\u%04x"), c);
+    } else {
+      if (len + 1 >= size) {
+        return -1;
+      }
+      out[len++] = c;
+    }
+  }
+  if (len + 1 >= size) {
+    return -1;
+  }
+  out[len++] = '"';
+  return len;
+}
+
+void websocketValueChanged(bool extra, unsigned int topic, const char *value) {
+  if (!websocketValuesSubscribed()) {
+    return;
+  }
+
+  const char **description = extra ? xtopicDescription[topic] : topicDescription[topic];
+  int maxvalue = atoi(description[0]);
+  int nr = (maxvalue == 0) ? 0 : atoi(value);
+  const char *desc = ((nr < 0) || (nr > maxvalue)) ? _unknown : description[nr + 1];
+
+  // a record that doesn't fit is left out, a cut off one would break the whole message
+  char record[128];
+  int len = snprintf_P(record, sizeof(record), PSTR("[\"%sTOP%u\","), extra ? "X" : "", topic);
+  if (len < 0 || len >= (int)sizeof(record)) {
+    return;
+  }
+  if ((len = websocketJsonString(record, len, sizeof(record), value, false)) == -1) {
+    return;
+  }
+  record[len++] = ',';
+  if ((len = websocketJsonString(record, len, sizeof(record), desc, true)) == -1) {
+    return;
+  }
+  if (len + 1 >= (int)sizeof(record)) {
+    return;
+  }
+  record[len++] = ']';
+
+  // keep room for the separator and the closing "]}"
+  if (wsValuesLen > 0 && wsValuesLen + len + 3 > sizeof(wsValues)) {
+    websocketValuesFlush();
+  }
+  if (wsValuesLen == 0) {
+    strcpy_P(wsValues, PSTR("{\"values\":["));
+    wsValuesLen = strlen(wsValues);
+  } else {
+    wsValues[wsValuesLen++] = ',';
+  }
+  memcpy(&wsValues[wsValuesLen], record, len);
+  wsValuesLen += len;
+}
+
 int handleTableRefresh(struct webserver_t *client, char* actData, char* actDataExtra, bool extraDataBlockAvailable) {
   int ret = 0;
   int extraTopics = extraDataBlockAvailable ? NUMBER_OF_TOPICS_EXTRA : 0; //set to 0 if there is no datablock so we don't run table data for it
-  if (client->route == 11) {
+  if (client->route == ROUTE_TABLEREFRESH_DALLAS) {
     if (client->content == 0) {
       webserver_send(client, 200, (char *)"text/html", 0);
       dallasTableOutput(client);
     }
-  } else if (client->route == 12) {
+  } else if (client->route == ROUTE_TABLEREFRESH_S0) {
     if (client->content == 0) {
       webserver_send(client, 200, (char *)"text/html", 0);
       s0TableOutput(client);
     }
-  } else if (client->route == 13) {
+  } else if (client->route == ROUTE_TABLEREFRESH_OPENTHERM) {
     if (client->content == 0) {
       webserver_send(client, 200, (char *)"text/html", 0);
       openthermTableOutput(client);
     }
-  } else if (client->route == 10) {
+  } else if (client->route == ROUTE_TABLEREFRESH) {
     if (client->content == 0) {
       webserver_send(client, 200, (char *)"text/html", 0);
     }
@@ -1224,6 +1437,127 @@ int handleJsonOutput(struct webserver_t *client, char* actData, char* actDataExt
   return 0;
 }
 
+/*
+ * Prometheus text format, each metric family starts
+ * with its HELP and TYPE lines.
+ */
+static void sendMetricHeader(struct webserver_t *client, PGM_P name, PGM_P type, PGM_P help) {
+  char str[160];
+  int len = snprintf_P(str, sizeof(str), PSTR("# HELP %s %s\n# TYPE %s %s\n"), name, help, name, type);
+  if (len > 0) {
+    webserver_send_content(client, str, min(len, (int)sizeof(str) - 1));
+  }
+}
+
+static void sendMetric(struct webserver_t *client, PGM_P name, PGM_P type, PGM_P help, unsigned long value) {
+  char str[64];
+  sendMetricHeader(client, name, type, help);
+  int len = snprintf_P(str, sizeof(str), PSTR("%s %lu\n"), name, value);
+  if (len > 0) {
+    webserver_send_content(client, str, min(len, (int)sizeof(str) - 1));
+  }
+}
+
+static uint8_t sendTopicMetric(struct webserver_t *client, const char *prefix, unsigned int topic, PGM_P name, const String &value) {
+  char *end = NULL;
+  if (value.length() == 0) {
+    return 0;
+  }
+  strtod(value.c_str(), &end);
+  if (*end != '\0') { // only numeric topics can be a gauge
+    return 0;
+  }
+  char str[128];
+  int len = snprintf_P(str, sizeof(str), PSTR("heishamon_topic{topic=\"%s%u\",name=\"%s\"} %s\n"), prefix, topic, name, value.c_str());
+  if (len > 0) {
+    webserver_send_content(client, str, min(len, (int)sizeof(str) - 1));
+  }
+  return 1;
+}
+
+static void sendMetricsTail(struct webserver_t *client, settingsStruct *heishamonSettings) {
+  if (heishamonSettings->use_s0) {
+    s0MetricsOutput(client);
+  }
+  if (heishamonSettings->use_1wire) {
+    dallasMetricsOutput(client);
+  }
+}
+
+int handleMetrics(struct webserver_t *client, struct readStatsStruct *reads, int mqttReconnects, char* actData, char* actDataExtra, settingsStruct *heishamonSettings, bool extraDataBlockAvailable) {
+  int extraTopics = (extraDataBlockAvailable && actDataExtra[0] != '\0') ? NUMBER_OF_TOPICS_EXTRA : 0;
+  int mainTopics = (actData[0] != '\0') ? NUMBER_OF_TOPICS : 0;
+  char str[128];
+
+  if (client->content == 0) {
+    webserver_send(client, 200, (char *)"text/plain; version=0.0.4", 0);
+    sendMetric(client, PSTR("heishamon_uptime_seconds"), PSTR("counter"), PSTR("Seconds since boot."), millis() / 1000);
+    sendMetric(client, PSTR("heishamon_free_heap_bytes"), PSTR("gauge"), PSTR("Free heap."), ESP.getFreeHeap());
+    sendMetric(client, PSTR("heishamon_max_free_block_bytes"), PSTR("gauge"), PSTR("Largest free heap block."), ESP.getMaxFreeBlockSize());
+    sendMetric(client, PSTR("heishamon_heap_fragmentation_percent"), PSTR("gauge"), PSTR("Heap fragmentation."), ESP.getHeapFragmentation());
+    sendMetric(client, PSTR("heishamon_free_memory_percent"), PSTR("gauge"), PSTR("Free heap compared to boot."), getFreeMemory());
+    sendMetric(client, PSTR("heishamon_stack_free_min_bytes"), PSTR("gauge"), PSTR("Lowest free stack since boot."), ESP.getFreeContStack());
+    sendMetricHeader(client, PSTR("heishamon_voltage_volts"), PSTR("gauge"), PSTR("Supply voltage."));
+    char vcc[16];
+    dtostrf(ESP.getVcc() / 1024.0, 0, 3, vcc);
+    int len = snprintf_P(str, sizeof(str), PSTR("heishamon_voltage_volts %s\n"), vcc);
+    webserver_send_content(client, str, len);
+    sendMetricHeader(client, PSTR("heishamon_wifi_rssi_dbm"), PSTR("gauge"), PSTR("Wifi signal strength."));
+    len = snprintf_P(str, sizeof(str), PSTR("heishamon_wifi_rssi_dbm %d\n"), WiFi.RSSI());
+    webserver_send_content(client, str, len);
+    sendMetric(client, PSTR("heishamon_mqtt_reconnects_total"), PSTR("counter"), PSTR("MQTT reconnects."), mqttReconnects);
+  } else if (client->content == 1) {
+    sendMetric(client, PSTR("heishamon_reads_total"), PSTR("counter"), PSTR("Expected heatpump answers."), reads->total);
+    sendMetric(client, PSTR("heishamon_good_reads_total"), PSTR("counter"), PSTR("Heatpump answers with a valid header and checksum."), reads->good);
+    sendMetricHeader(client, PSTR("heishamon_bad_reads_total"), PSTR("counter"), PSTR("Rejected heatpump answers by reason."));
+    int len = snprintf_P(str, sizeof(str), PSTR("heishamon_bad_reads_total{reason=\"crc\"} %lu\nheishamon_bad_reads_total{reason=\"header\"} %lu\n"), reads->badcrc, reads->badheader);
+    webserver_send_content(client, str, len);
+    len = snprintf_P(str, sizeof(str), PSTR("heishamon_bad_reads_total{reason=\"too_short\"} %lu\nheishamon_bad_reads_total{reason=\"too_long\"} %lu\n"), reads->tooshort, reads->toolong);
+    webserver_send_content(client, str, len);
+    len = snprintf_P(str, sizeof(str), PSTR("heishamon_bad_reads_total{reason=\"timeout\"} %lu\n"), reads->timeout);
+    webserver_send_content(client, str, len);
+
+    unsigned long ruleInvocations = 0, ruleTime = 0, rulePreemptions = 0;
+    int slowestRule = -1;
+    rules_stats_summary(&ruleInvocations, &ruleTime, &slowestRule, &rulePreemptions);
+    sendMetric(client, PSTR("heishamon_rule_invocations_total"), PSTR("counter"), PSTR("Rule invocations."), ruleInvocations);
+    sendMetric(client, PSTR("heishamon_rule_time_microseconds_total"), PSTR("counter"), PSTR("Time spent in rules."), ruleTime);
+    sendMetric(client, PSTR("heishamon_rule_preemptions_total"), PSTR("counter"), PSTR("Rules stopped by the step budget."), rulePreemptions);
+
+    unsigned long timersFired = 0, avgJitter = 0, maxJitter = 0;
+    timerqueue_stats(&timersFired, &avgJitter, &maxJitter);
+    sendMetric(client, PSTR("heishamon_timers_fired_total"), PSTR("counter"), PSTR("Fired timers."), timersFired);
+    sendMetric(client, PSTR("heishamon_timer_jitter_avg_microseconds"), PSTR("gauge"), PSTR("Average timer jitter."), avgJitter);
+    sendMetric(client, PSTR("heishamon_timer_jitter_max_microseconds"), PSTR("gauge"), PSTR("Maximum timer jitter."), maxJitter);
+
+    sendMetricHeader(client, PSTR("heishamon_info"), PSTR("gauge"), PSTR("Firmware version."));
+    len = snprintf_P(str, sizeof(str), PSTR("heishamon_info{version=\"%s\"} 1\n"), heishamon_version);
+    webserver_send_content(client, str, min(len, (int)sizeof(str) - 1));
+  } else if ((client->content - 2) < (mainTopics + extraTopics)) {
+    uint16_t nr = client->content - 2;
+    uint8_t sent = 0;
+    if (nr == 0) {
+      sendMetricHeader(client, PSTR("heishamon_topic"), PSTR("gauge"), PSTR("Decoded heatpump values."));
+    }
+    while (nr < (mainTopics + extraTopics) && sent < 4) { //4 topics per webserver run
+      if (nr < mainTopics) {
+        sent += sendTopicMetric(client, "TOP", nr, topics[nr], getDataValue(actData, nr));
+      } else {
+        sent += sendTopicMetric(client, "XTOP", nr - mainTopics, xtopics[nr - mainTopics], getDataValueExtra(actDataExtra, nr - mainTopics));
+      }
+      nr++;
+    }
+    client->content = nr + 1; // The webserver also increases by 1
+    if (sent == 0) { // only non numeric topics were left, a run without output ends the response
+      sendMetricsTail(client, heishamonSettings);
+      client->content++;
+    }
+  } else if (client->content == (mainTopics + extraTopics + 2)) {
+    sendMetricsTail(client, heishamonSettings);
+  }
+  return 0;
+}
+
 
 int showRules(struct webserver_t *client) {
   uint16_t len = 0, len1 = 0;
@@ -1231,7 +1565,7 @@ int showRules(struct webserver_t *client) {
   if (client->content == 0) {
     webserver_send(client, 200, (char *)"text/html", 0);
     webserver_send_content_P(client, webHeader, strlen_P(webHeader));
-    webserver_send_content_P(client, webCSS, strlen_P(webCSS));
+    sendWebAssetTag(client, WEBASSET_CSS);
     webserver_send_content_P(client, webBodyStart, strlen_P(webBodyStart));
     webserver_send_content_P(client, showRulesPage1, strlen_P(showRulesPage1));
     if (LittleFS.begin()) {
@@ -1305,11 +1639,46 @@ int showRules(struct webserver_t *client) {
   return 0;
 }
 
+int showRulesStats(struct webserver_t *client) {
+  int count = rules_count();
+  if (client->content == 0) {
+    webserver_send(client, 200, (char *)"application/json", 0);
+    webserver_send_content_P(client, PSTR("["), 1);
+  } else if ((client->content - 1) < count) {
+    char str[512];
+    int len = rules_stats_json(client->content - 1, str, sizeof(str));
+    if (client->content > 1) {
+      webserver_send_content_P(client, PSTR(","), 1);
+    }
+    // Every step writes an element, so the array always closes
+    if (len > 0) {
+      webserver_send_content(client, str, len);
+    } else {
+      webserver_send_content_P(client, PSTR("null"), 4);
+    }
+  } else if ((client->content - 1) == count) {
+    webserver_send_content_P(client, PSTR("]"), 1);
+  }
+  return 0;
+}
+
+int showRulesMemory(struct webserver_t *client) {
+  if (client->content == 0) {
+    char str[160];
+    int len = rules_memory_json(str, sizeof(str));
+    webserver_send(client, 200, (char *)"application/json", 0);
+    if (len > 0) {
+      webserver_send_content(client, str, len);
+    }
+  }
+  return 0;
+}
+
 int showFirmware(struct webserver_t *client) {
   if (client->content == 0) {
     webserver_send(client, 200, (char *)"text/html", 0);
     webserver_send_content_P(client, webHeader, strlen_P(webHeader));
-    webserver_send_content_P(client, webCSS, strlen_P(webCSS));
+    sendWebAssetTag(client, WEBASSET_CSS);
     webserver_send_content_P(client, webBodyStart, strlen_P(webBodyStart));
   } else  if (client->content == 1) {
     webserver_send_content_P(client, showFirmwarePage, strlen_P(showFirmwarePage));
@@ -1328,6 +1697,49 @@ int showFirmwareSuccess(struct webserver_t *client) {
   return 0;
 }
 
+/*
+ * Upload progress is pushed to the websocket clients of the
+ * firmware page at most twice a second, and once more with
+ * the outcome and the md5 the updater calculated over the
+ * image while it was written.
+ */
+static unsigned long firmwareUploadStart = 0;
+static unsigned long firmwareUploadReported = 0;
+static uint32_t firmwareUploadFlashed = 0;
+
+void firmwareUploadBegin(void) {
+  firmwareUploadStart = millis();
+  firmwareUploadReported = 0;
+  firmwareUploadFlashed = 0;
+}
+
+void firmwareUploadProgress(struct webserver_t *client, uint8_t state) {
+  unsigned long now = millis();
+
+  // the updater forgets its progress once it ended
+  if (Update.isRunning()) {
+    firmwareUploadFlashed = Update.progress();
+  }
+  if (state == FIRMWARE_UPLOADING && (now - firmwareUploadReported) < 500) {
+    return;
+  }
+  firmwareUploadReported = now;
+
+  const char *states[] = { "uploading", "flashed", "failed" };
+  unsigned long ms = now - firmwareUploadStart;
+  bool md5 = (state == FIRMWARE_FLASHED) || (state == FIRMWARE_FAILED && Update.getError() == UPDATE_ERROR_MD5);
+  char str[192];
+  int len = snprintf_P(str, sizeof(str), PSTR("{\"firmware\":{\"state\":\"%s\",\"received\":%lu,\"flashed\":%lu,\"total\":%lu,\"rate\":%lu,\"md5\":\"%s\"}}"),
+                       states[state], (unsigned long)client->readlen, (unsigned long)firmwareUploadFlashed, (unsigned long)client->totallen,
+                       ms > 0 ? (unsigned long)client->readlen * 1000UL / ms : 0UL, md5 ? Update.md5String().c_str() : "");
+
+  for (uint8_t i = 0; i < WEBSERVER_MAX_CLIENTS; i++) {
+    if (clients[i].data.is_websocket == 1 && clients[i].data.route == ROUTE_WEBSOCKET_FIRMWARE && clients[i].data.step != WEBSERVER_CLIENT_CLOSE) {
+      websocket_write(&clients[i].data, str, len);
+    }
+  }
+}
+
 static void printUpdateError(char **out, uint8_t size) {
   uint8_t len = 0;
   len = snprintf_P(*out, size, PSTR("ERROR[%u]: "), Update.getError());
@@ -55,6 +55,23 @@ struct settingsStruct {
   gpioSettingsStruct gpioSettings;
 };
 
+struct readStatsStruct {
+  unsigned long total;
+  unsigned long good;
+  unsigned long badcrc;
+  unsigned long badheader;
+  unsigned long tooshort;
+  unsigned long toolong;
+  unsigned long timeout;
+};
+
+// Firmware upload states pushed to the firmware page
+enum {
+  FIRMWARE_UPLOADING,
+  FIRMWARE_FLASHED,
+  FIRMWARE_FAILED
+};
+
 struct websettings_t {
   String name;
   String value;
@@ -74,7 +91,10 @@ int8_t webserver_cb(struct webserver_t *client, void *data);
 void getWifiScanResults(int numSsid);
 int handleRoot(struct webserver_t *client, float readpercentage, int mqttReconnects, settingsStruct *heishamonSettings);
 int handleTableRefresh(struct webserver_t *client, char* actData, char* actDataExtra, bool extraDataBlockAvailable);
+void websocketValueChanged(bool extra, unsigned int topic, const char *value);
+void websocketValuesFlush(void);
 int handleJsonOutput(struct webserver_t *client, char* actData, char* actDataExtra, settingsStruct *heishamonSettings, bool extraDataBlockAvailable);
+int handleMetrics(struct webserver_t *client, struct readStatsStruct *reads, int mqttReconnects, char* actData, char* actDataExtra, settingsStruct *heishamonSettings, bool extraDataBlockAvailable);
 int handleFactoryReset(struct webserver_t *client);
 int handleReboot(struct webserver_t *client);
 int handleDebug(struct webserver_t *client, char *hex, byte hex_len);
@@ -90,6 +110,12 @@ int cacheSettings(struct webserver_t *client, struct arguments_t * args);
 int handleWifiScan(struct webserver_t *client);
 void webSocketEvent(uint8_t num, WStype_t type, uint8_t *payload, size_t length);
 int showRules(struct webserver_t *client);
+int showRulesStats(struct webserver_t *client);
+int showRulesMemory(struct webserver_t *client);
+int findWebAsset(struct webserver_t *client, const char *uri);
+int handleWebAsset(struct webserver_t *client);
 int showFirmware(struct webserver_t *client);
 int showFirmwareSuccess(struct webserver_t *client);
 int showFirmwareFail(struct webserver_t *client);
+void firmwareUploadBegin(void);
+void firmwareUploadProgress(struct webserver_t *client, uint8_t state);
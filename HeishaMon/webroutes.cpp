@@ -0,0 +1,233 @@
+#include "webroutes.h"
+#include "webfunctions.h"
+#include "src/common/progmem.h"
+
+// 2^WEBROUTE_BUCKET_BITS buckets, indexed by the top bits of the hash
+#define WEBROUTE_BUCKET_BITS 6
+#define WEBROUTE_BUCKETS (1 << WEBROUTE_BUCKET_BITS)
+#define WEBROUTE_EMPTY 0xFF
+
+static constexpr struct webRouteStruct webRoutes[] PROGMEM = {
+  { "/", ROUTE_ROOT, ROUTE_NOTFOUND, 0 },
+  { "/togglelog", ROUTE_TOGGLELOG, ROUTE_NOTFOUND, 0 },
+  { "/togglehexdump", ROUTE_TOGGLEHEXDUMP, ROUTE_NOTFOUND, 0 },
+  { "/tablerefresh", ROUTE_TABLEREFRESH, ROUTE_NOTFOUND, 0 },
+  { "/json", ROUTE_JSON, ROUTE_NOTFOUND, 0 },
+  { "/reboot", ROUTE_REBOOT, ROUTE_NOTFOUND, 0 },
+  { "/debug", ROUTE_DEBUG, ROUTE_NOTFOUND, 0 },
+  { "/wifiscan", ROUTE_WIFISCAN, ROUTE_NOTFOUND, 0 },
+  { "/hotspot-detect.html", ROUTE_CAPTIVE, ROUTE_NOTFOUND, 0 },
+  { "/fwlink", ROUTE_CAPTIVE, ROUTE_NOTFOUND, 0 },
+  { "/generate_204", ROUTE_CAPTIVE, ROUTE_NOTFOUND, 0 },
+  { "/gen_204", ROUTE_CAPTIVE, ROUTE_NOTFOUND, 0 },
+  { "/popup", ROUTE_CAPTIVE, ROUTE_NOTFOUND, 0 },
+  { "/factoryreset", ROUTE_FACTORYRESET, ROUTE_NOTFOUND, 0 },
+  { "/command", ROUTE_COMMAND, ROUTE_NOTFOUND, 1 },
+  { "/savesettings", ROUTE_NOTFOUND, ROUTE_SAVESETTINGS, 0 },
+  { "/settings", ROUTE_SETTINGS, ROUTE_NOTFOUND, 0 },
+  { "/getsettings", ROUTE_GETSETTINGS, ROUTE_NOTFOUND, 0 },
+  { "/firmware", ROUTE_FIRMWARE, ROUTE_FIRMWARE_UPLOAD, 0 },
+  { "/rules", ROUTE_RULES, ROUTE_NOTFOUND, 0 },
+  { "/saverules", ROUTE_NOTFOUND, ROUTE_SAVERULES, 0 },
+  { "/rules/stats", ROUTE_RULES_STATS, ROUTE_NOTFOUND, 0 },
+  { "/rules/memory", ROUTE_RULES_MEMORY, ROUTE_NOTFOUND, 0 },
+  { "/ruletrace", ROUTE_RULETRACE, ROUTE_NOTFOUND, 0 },
+  { "/stats", ROUTE_STATS, ROUTE_NOTFOUND, 0 },
+  { "/metrics", ROUTE_METRICS, ROUTE_NOTFOUND, 0 },
+};
+
+#define WEBROUTE_COUNT (sizeof(webRoutes) / sizeof(webRoutes[0]))
+
+static_assert(WEBROUTE_COUNT < WEBROUTE_BUCKETS, "Too many web routes for the route buckets");
+
+static constexpr uint32_t webRouteHash(const char *p, uint32_t seed) {
+  uint32_t hash = seed;
+  while (*p != '\0') {
+    hash = (hash ^ (uint8_t)*p++) * 16777619UL;
+  }
+  return hash;
+}
+
+static constexpr uint8_t webRouteBucket(const char *p, uint32_t seed) {
+  return webRouteHash(p, seed) >> (32 - WEBROUTE_BUCKET_BITS);
+}
+
+static constexpr bool webRouteSeedFits(uint32_t seed) {
+  bool used[WEBROUTE_BUCKETS] = {};
+  for (unsigned int i = 0; i < WEBROUTE_COUNT; i++) {
+    uint8_t bucket = webRouteBucket(webRoutes[i].path, seed);
+    if (used[bucket]) {
+      return false;
+    }
+    used[bucket] = true;
+  }
+  return true;
+}
+
+// The compiler searches the first seed that gives every path
+// its own bucket, so adding a route doesn't need any tuning.
+static constexpr uint32_t webRouteFindSeed(void) {
+  uint32_t seed = 2166136261UL;
+  while (!webRouteSeedFits(seed)) {
+    seed++;
+  }
+  return seed;
+}
+
+static constexpr uint32_t webRouteSeed = webRouteFindSeed();
+
+struct webRouteBucketsStruct {
+  uint8_t route[WEBROUTE_BUCKETS];
+};
+
+static constexpr struct webRouteBucketsStruct webRouteBuildBuckets(void) {
+  struct webRouteBucketsStruct buckets = {};
+  for (unsigned int i = 0; i < WEBROUTE_BUCKETS; i++) {
+    buckets.route[i] = WEBROUTE_EMPTY;
+  }
+  for (unsigned int i = 0; i < WEBROUTE_COUNT; i++) {
+    buckets.route[webRouteBucket(webRoutes[i].path, webRouteSeed)] = i;
+  }
+  return buckets;
+}
+
+static constexpr struct webRouteBucketsStruct webRouteBuckets PROGMEM = webRouteBuildBuckets();
+
+// Statistics are kept per route table entry, followed by
+// the web assets and everything that wasn't found.
+#define WEBROUTE_SLOT_ASSETS WEBROUTE_COUNT
+#define WEBROUTE_SLOT_NOTFOUND (WEBROUTE_COUNT + 1)
+#define WEBROUTE_SLOTS (WEBROUTE_COUNT + 2)
+
+struct webRouteStatsStruct {
+  uint32_t requests;
+  uint32_t total; // summed time to last byte in ms
+  uint32_t max;
+  uint32_t heap; // most heap a request used
+};
+
+static struct webRouteStatsStruct webRouteStats[WEBROUTE_SLOTS];
+
+static struct {
+  uint8_t slot; // stats slot + 1, 0 while no request is running
+  unsigned long start;
+  uint32_t heap; // free heap when the request started
+  uint32_t minheap; // lowest free heap seen while it ran
+} webRouteClients[WEBSERVER_MAX_CLIENTS];
+
+static uint8_t webRouteClient(struct webserver_t *client) {
+  return (struct webserver_client_t *)client - clients;
+}
+
+static uint8_t webRouteFind(const char *uri) {
+  uint8_t idx = pgm_read_byte(&webRouteBuckets.route[webRouteBucket(uri, webRouteSeed)]);
+  if (idx != WEBROUTE_EMPTY && strcmp_P(uri, webRoutes[idx].path) == 0) {
+    return idx;
+  }
+  return WEBROUTE_EMPTY;
+}
+
+int findWebRoute(struct webserver_t *client, const char *uri) {
+  uint8_t slot = WEBROUTE_SLOT_NOTFOUND;
+  uint8_t idx = webRouteFind(uri);
+
+  client->route = ROUTE_NOTFOUND;
+  if (idx != WEBROUTE_EMPTY) {
+    webRouteStruct route;
+    memcpy_P(&route, &webRoutes[idx], sizeof(route));
+    client->route = (client->method == 1) ? route.post : route.get;
+    if (client->route != ROUTE_NOTFOUND) {
+      slot = idx;
+      if (route.state > 0) {
+        if ((client->userdata = calloc(1, route.state)) == NULL) {
+          Serial1.printf(PSTR("Out of memory %s:#%d\n"), __FUNCTION__, __LINE__);
+          ESP.restart();
+          exit(-1);
+        }
+      }
+    }
+  } else if (client->method == 0 && findWebAsset(client, uri) == 0) {
+    client->route = ROUTE_WEBASSET;
+    slot = WEBROUTE_SLOT_ASSETS;
+  }
+
+  // Only known routes accept POST requests
+  if (client->method == 1 && client->route == ROUTE_NOTFOUND) {
+    return -1;
+  }
+
+  uint8_t nr = webRouteClient(client);
+  if (nr < WEBSERVER_MAX_CLIENTS) {
+    webRouteClients[nr].slot = slot + 1;
+    webRouteClients[nr].start = millis();
+    webRouteClients[nr].heap = ESP.getFreeHeap();
+    webRouteClients[nr].minheap = webRouteClients[nr].heap;
+  }
+  return 0;
+}
+
+void webRouteSample(struct webserver_t *client) {
+  uint8_t nr = webRouteClient(client);
+  if (nr >= WEBSERVER_MAX_CLIENTS || webRouteClients[nr].slot == 0) {
+    return;
+  }
+  uint32_t heap = ESP.getFreeHeap();
+  if (heap < webRouteClients[nr].minheap) {
+    webRouteClients[nr].minheap = heap;
+  }
+}
+
+void webRouteDone(struct webserver_t *client) {
+  uint8_t nr = webRouteClient(client);
+  if (nr >= WEBSERVER_MAX_CLIENTS || webRouteClients[nr].slot == 0) {
+    return;
+  }
+  webRouteSample(client);
+  uint8_t slot = webRouteClients[nr].slot - 1;
+  webRouteClients[nr].slot = 0;
+
+  // The lifetime of a websocket isn't a response time
+  if (client->is_websocket == 1) {
+    return;
+  }
+
+  uint32_t ms = millis() - webRouteClients[nr].start;
+  webRouteStats[slot].requests++;
+  webRouteStats[slot].total += ms;
+  if (ms > webRouteStats[slot].max) {
+    webRouteStats[slot].max = ms;
+  }
+  // Other clients allocating meanwhile are counted as well
+  uint32_t heap = webRouteClients[nr].heap - webRouteClients[nr].minheap;
+  if (heap > webRouteStats[slot].heap) {
+    webRouteStats[slot].heap = heap;
+  }
+}
+
+int showWebStats(struct webserver_t *client) {
+  if (client->content == 0) {
+    webserver_send(client, 200, (char *)"application/json", 0);
+    webserver_send_content_P(client, PSTR("["), 1);
+  } else if ((client->content - 1) < WEBROUTE_SLOTS) {
+    uint8_t slot = client->content - 1;
+    char path[sizeof(webRoutes[0].path)];
+    if (slot == WEBROUTE_SLOT_ASSETS) {
+      strcpy_P(path, PSTR("assets"));
+    } else if (slot == WEBROUTE_SLOT_NOTFOUND) {
+      strcpy_P(path, PSTR("notfound"));
+    } else {
+      strcpy_P(path, webRoutes[slot].path);
+    }
+
+    struct webRouteStatsStruct *stats = &webRouteStats[slot];
+    char str[160];
+    int len = snprintf_P(str, sizeof(str), PSTR("%s{\"route\":\"%s\",\"requests\":%lu,\"avg_ms\":%lu,\"max_ms\":%lu,\"max_heap\":%lu}"),
+                         slot > 0 ? "," : "", path, (unsigned long)stats->requests,
+                         (unsigned long)(stats->requests > 0 ? stats->total / stats->requests : 0), (unsigned long)stats->max,
+                         (unsigned long)stats->heap);
+    webserver_send_content(client, str, len);
+  } else if ((client->content - 1) == WEBROUTE_SLOTS) {
+    webserver_send_content_P(client, PSTR("]"), 1);
+  }
+  return 0;
+}
@@ -0,0 +1,58 @@
+#ifndef _WEBROUTES_H_
+#define _WEBROUTES_H_
+
+#include <Arduino.h>
+#include "src/common/webserver.h"
+
+// Route ids kept in client->route. Ids that aren't a multiple
+// of ten are picked while a request runs (arguments, settings
+// outcome) and are counted towards their parent route.
+enum {
+  ROUTE_NOTFOUND = 0,
+  ROUTE_ROOT = 1,
+  ROUTE_TOGGLELOG = 2,
+  ROUTE_TOGGLEHEXDUMP = 3,
+  ROUTE_TABLEREFRESH = 10,
+  ROUTE_TABLEREFRESH_DALLAS = 11,
+  ROUTE_TABLEREFRESH_S0 = 12,
+  ROUTE_TABLEREFRESH_OPENTHERM = 13,
+  ROUTE_JSON = 20,
+  ROUTE_REBOOT = 30,
+  ROUTE_DEBUG = 40,
+  ROUTE_WIFISCAN = 50,
+  ROUTE_CAPTIVE = 80,
+  ROUTE_FACTORYRESET = 90,
+  ROUTE_COMMAND = 100,
+  ROUTE_SAVESETTINGS = 110,
+  ROUTE_SAVESETTINGS_PASSWORD = 111,
+  ROUTE_SAVESETTINGS_RECONNECT = 112,
+  ROUTE_SAVESETTINGS_REDIRECT = 113,
+  ROUTE_SETTINGS = 120,
+  ROUTE_GETSETTINGS = 130,
+  ROUTE_FIRMWARE = 140,
+  ROUTE_FIRMWARE_UPLOAD = 150,
+  ROUTE_RULES = 160,
+  ROUTE_SAVERULES = 170,
+  ROUTE_RULES_STATS = 180,
+  ROUTE_RULETRACE = 190,
+  ROUTE_RULES_MEMORY = 200,
+  ROUTE_WEBASSET = 210,
+  ROUTE_WEBSOCKET_VALUES = 220,
+  ROUTE_STATS = 230,
+  ROUTE_METRICS = 240,
+  ROUTE_WEBSOCKET_FIRMWARE = 250
+};
+
+struct webRouteStruct {
+  char path[24];
+  uint8_t get;   // route for GET requests, ROUTE_NOTFOUND if not served
+  uint8_t post;  // route for POST requests, ROUTE_NOTFOUND if not accepted
+  uint8_t state; // bytes of zeroed userdata the route streams into
+};
+
+int findWebRoute(struct webserver_t *client, const char *uri);
+void webRouteSample(struct webserver_t *client);
+void webRouteDone(struct webserver_t *client);
+int showWebStats(struct webserver_t *client);
+
+#endif
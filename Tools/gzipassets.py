@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+#
+# Compresses the static web assets in HeishaMon/htmlcode.h
+# and writes them as PROGMEM blobs to HeishaMon/htmlgzip.h.
+#
+# Run after changing any of the assets listed below:
+#   python3 Tools/gzipassets.py
+#
+
+import gzip
+import os
+import re
+import sys
+
+ASSETS = [
+  'webCSS',
+  'websocketJS',
+  'refreshJS',
+  'settingsJS',
+  'populatescanwifiJS',
+  'populategetsettingsJS',
+]
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'HeishaMon')
+SOURCE = os.path.join(ROOT, 'htmlcode.h')
+TARGET = os.path.join(ROOT, 'htmlgzip.h')
+
+ESCAPES = {
+  'n': b'\n', 't': b'\t', 'r': b'\r', '"': b'"', '\'': b'\'', '\\': b'\\', '?': b'?',
+}
+
+
+def unescape(literal):
+  out = bytearray()
+  i = 0
+  while i < len(literal):
+    c = literal[i]
+    if c != '\\':
+      out += c.encode('utf-8')
+      i += 1
+      continue
+    c = literal[i + 1]
+    if c in ESCAPES:
+      out += ESCAPES[c]
+      i += 2
+    elif c == 'x':
+      m = re.match(r'[0-9a-fA-F]+', literal[i + 2:])
+      out.append(int(m.group(0), 16) & 0xff)
+      i += 2 + len(m.group(0))
+    elif c in '01234567':
+      m = re.match(r'[0-7]{1,3}', literal[i + 1:])
+      out.append(int(m.group(0), 8) & 0xff)
+      i += 1 + len(m.group(0))
+    else:
+      sys.exit('unsupported escape \\%s' % c)
+  return bytes(out)
+
+
+def extract(source, name):
+  m = re.search(r'^(?:static )?const char %s\[\] PROGMEM\s*=' % name, source, re.M)
+  if m is None:
+    sys.exit('asset %s not found in %s' % (name, SOURCE))
+
+  token = re.compile(r'\s+|//[^\n]*|/\*.*?\*/|"((?:[^"\\\n]|\\.)*)"|;', re.S)
+  pos = m.end()
+  out = b''
+  while True:
+    t = token.match(source, pos)
+    if t is None:
+      sys.exit('unexpected token in asset %s' % name)
+    pos = t.end()
+    if t.group(0) == ';':
+      return out
+    if t.group(1) is not None:
+      out += unescape(t.group(1))
+
+
+def main():
+  with open(SOURCE, encoding='utf-8') as f:
+    source = f.read()
+
+  lines = [
+    '/*',
+    ' * Generated by Tools/gzipassets.py from htmlcode.h, do not edit.',
+    ' */',
+    '',
+    '#ifndef _HTMLGZIP_H_',
+    '#define _HTMLGZIP_H_',
+    '',
+  ]
+
+  for name in ASSETS:
+    data = extract(source, name)
+    packed = gzip.compress(data, 9, mtime=0)
+    lines.append('/* %s: %d bytes, %d compressed */' % (name, len(data), len(packed)))
+    lines.append('static const uint8_t %s_gz[] PROGMEM = {' % name)
+    for i in range(0, len(packed), 16):
+      lines.append('  ' + ','.join('0x%02x' % b for b in packed[i:i + 16]) + ',')
+    lines.append('};')
+    lines.append('')
+
+  lines.append('#endif')
+
+  with open(TARGET, 'w', encoding='utf-8', newline='\n') as f:
+    f.write('\n'.join(lines) + '\n')
+
+
+if __name__ == '__main__':
+  main()
@@ -0,0 +1,28 @@
+/*
+  Copyright (C) CurlyMo
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/*
+ * The rules engine only needs log.h from the
+ * Arduino core when it's build on a host. Flash
+ * strings are plain strings there.
+ */
+
+#ifndef _ARDUINO_H_
+#define _ARDUINO_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef char __FlashStringHelper;
+
+#ifndef PSTR
+  #define PSTR(a) (a)
+#endif
+
+#endif
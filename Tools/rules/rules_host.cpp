@@ -0,0 +1,1294 @@
+/*
+  Copyright (C) CurlyMo
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/*
+ * Runs the rules engine on a host instead of on the ESP8266:
+ *
+ *   rules_host run <file> [event ...]
+ *   rules_host bench <file> [iterations] [event]
+ *   rules_host diff [seed] [count]
+ *   rules_host gen [seed]
+ *   rules_host fuzz <file> ...
+ *
+ * run parses a ruleset, runs the rules of the given events
+ * (System#Boot by default) and prints all variables afterwards.
+ *
+ * bench parses and runs a ruleset many times and prints the
+ * time it took per parse and per run, the size of the bytecode
+ * and the most string pool a run used.
+ *
+ * diff generates random rulesets with assignments, nested if,
+ * elseif and else blocks and calls to other rules. Each is run
+ * by the engine, with a random step budget so runs are also
+ * suspended and continued, and by a reference evaluator that
+ * walks the generated tree with the same operator callbacks.
+ * The first ruleset for which the variables differ is printed.
+ * gen prints the ruleset of a single seed.
+ *
+ * fuzz feeds files to the same entry point libFuzzer uses, so
+ * inputs found by AFL (afl-fuzz -i in -o out -- rules_host fuzz @@)
+ * or libFuzzer can be replayed.
+ *
+ * Local variables are kept per rule, global variables are shared.
+ * Other variables (@, ?, %) are NULL until a rule sets them. The
+ * rolling statistics have no samples here, so they return NULL.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <time.h>
+
+#include "../../HeishaMon/src/common/mem.h"
+#include "../../HeishaMon/src/common/log.h"
+#include "../../HeishaMon/src/common/stricmp.h"
+#include "../../HeishaMon/src/common/strnicmp.h"
+#include "../../HeishaMon/src/common/strpool.h"
+#include "../../HeishaMon/src/common/rollstat.h"
+#include "../../HeishaMon/src/common/timerqueue.h"
+#include "../../HeishaMon/src/rules/rules.h"
+#include "../../HeishaMon/src/rules/operator.h"
+
+#define HOST_VARS_MAX   128
+#define HOST_CALL_DEPTH 16
+#define HOST_RESUME_MAX 100000
+#define HOST_INPUT_MAX  (MEMPOOL_SIZE / 2)
+
+typedef struct host_var_t {
+  char name[32];
+  int rule;
+  /*
+   * Strings are owned copies, the string
+   * pool is emptied after each run.
+   */
+  struct vm_register_t reg;
+} host_var_t;
+
+typedef struct host_vars_t {
+  struct host_var_t list[HOST_VARS_MAX];
+  int nr;
+} host_vars_t;
+
+struct rule_options_t rule_options;
+
+static unsigned char mempool[MEMPOOL_SIZE];
+static struct rules_t **rules = NULL;
+static int nrrules = 0;
+static unsigned int bytecode = 0;
+static unsigned int strings = 0;
+static int depth = 0;
+static int quiet = 0;
+
+static struct host_vars_t vars;
+
+static struct vm_vinteger_t vinteger;
+static struct vm_vfloat_t vfloat;
+static struct vm_vnull_t vnull;
+static struct vm_vchar_t vchar;
+
+static void host_log(const char *fmt, va_list ap) {
+  if(quiet == 0) {
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+  }
+}
+
+void _logprintln(const char *file, unsigned int line, char *msg) {
+  if(quiet == 0) {
+    fprintf(stderr, "%s\n", msg);
+  }
+}
+
+void _logprintf(const char *file, unsigned int line, char *fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  host_log(fmt, ap);
+  va_end(ap);
+}
+
+void _logprintln_P(const char *file, unsigned int line, const __FlashStringHelper *msg) {
+  if(quiet == 0) {
+    fprintf(stderr, "%s\n", msg);
+  }
+}
+
+void _logprintf_P(const char *file, unsigned int line, const __FlashStringHelper *fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  host_log(fmt, ap);
+  va_end(ap);
+}
+
+/*
+ * Timers are set by the rules, but never fire.
+ */
+void timer_cb(int nr) {
+}
+
+static double host_micros(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec / 1e3;
+}
+
+static void host_vars_clear(struct host_vars_t *v) {
+  int i = 0;
+  for(i=0;i<v->nr;i++) {
+    if(v->list[i].reg.type == VCHAR) {
+      free((void *)v->list[i].reg.value.s);
+    }
+  }
+  v->nr = 0;
+}
+
+static struct host_var_t *host_var_find(struct host_vars_t *v, int rule, const char *name, int create) {
+  struct host_var_t *var = NULL;
+  int i = 0;
+
+  for(i=0;i<v->nr;i++) {
+    if(v->list[i].rule == rule && stricmp(v->list[i].name, name) == 0) {
+      return &v->list[i];
+    }
+  }
+  if(create == 0 || v->nr >= HOST_VARS_MAX || strlen(name) >= sizeof(var->name)) {
+    return NULL;
+  }
+  var = &v->list[v->nr++];
+  strcpy(var->name, name);
+  var->rule = rule;
+  var->reg.type = VNULL;
+  return var;
+}
+
+static void host_var_set(struct host_var_t *var, struct vm_register_t *reg) {
+  if(var->reg.type == VCHAR) {
+    free((void *)var->reg.value.s);
+  }
+  var->reg = *reg;
+  if(reg->type == VCHAR) {
+    var->reg.value.s = strdup(reg->value.s);
+  }
+}
+
+/*
+ * Local variables belong to the rule
+ * using them, all others are shared.
+ */
+static int host_var_scope(int rule, const char *name) {
+  return (name[0] == '$') ? rule : 0;
+}
+
+static int host_reg_prt(struct vm_register_t *reg, char *out, int size) {
+  switch(reg->type) {
+    case VINTEGER: {
+      return snprintf(out, size, "%d", reg->value.i);
+    } break;
+    case VFLOAT: {
+      return snprintf(out, size, "%g", reg->value.f);
+    } break;
+    case VCHAR: {
+      return snprintf(out, size, "\"%s\"", reg->value.s);
+    } break;
+  }
+  return snprintf(out, size, "NULL");
+}
+
+static int host_reg_cmp(struct vm_register_t *a, struct vm_register_t *b) {
+  if(a->type != b->type) {
+    return -1;
+  }
+  switch(a->type) {
+    case VINTEGER: {
+      return (a->value.i == b->value.i) ? 0 : -1;
+    } break;
+    case VFLOAT: {
+      if(isnan(a->value.f) && isnan(b->value.f)) {
+        return 0;
+      }
+      return (a->value.f == b->value.f) ? 0 : -1;
+    } break;
+    case VCHAR: {
+      return strcmp(a->value.s, b->value.s);
+    } break;
+  }
+  return 0;
+}
+
+static void host_vars_prt(struct host_vars_t *v, FILE *out) {
+  char buf[128];
+  int i = 0;
+
+  for(i=0;i<v->nr;i++) {
+    host_reg_prt(&v->list[i].reg, buf, sizeof(buf));
+    if(v->list[i].rule > 0) {
+      fprintf(out, "rule #%d %s = %s\n", v->list[i].rule, v->list[i].name, buf);
+    } else {
+      fprintf(out, "%s = %s\n", v->list[i].name, buf);
+    }
+  }
+}
+
+/*
+ * Variables that were never set are NULL, so
+ * a missing variable equals one set to NULL.
+ */
+static int host_vars_cmp(struct host_vars_t *a, struct host_vars_t *b, FILE *out) {
+  struct vm_register_t null;
+  char bufa[128], bufb[128];
+  int i = 0, x = 0, differ = 0;
+
+  null.type = VNULL;
+
+  for(x=0;x<2;x++) {
+    struct host_vars_t *from = (x == 0) ? a : b;
+    struct host_vars_t *to = (x == 0) ? b : a;
+
+    for(i=0;i<from->nr;i++) {
+      struct host_var_t *var = host_var_find(to, from->list[i].rule, from->list[i].name, 0);
+      struct vm_register_t *reg = (var == NULL) ? &null : &var->reg;
+
+      if(x == 1 && var != NULL) {
+        continue;
+      }
+      if(host_reg_cmp(&from->list[i].reg, reg) != 0) {
+        host_reg_prt((x == 0) ? &from->list[i].reg : reg, bufa, sizeof(bufa));
+        host_reg_prt((x == 0) ? reg : &from->list[i].reg, bufb, sizeof(bufb));
+        fprintf(out, "rule #%d %s is %s, expected %s\n", from->list[i].rule, from->list[i].name, bufa, bufb);
+        differ = 1;
+      }
+    }
+  }
+  return differ;
+}
+
+static unsigned char *host_value(struct vm_register_t *reg, uint16_t token) {
+  switch(reg->type) {
+    case VINTEGER: {
+      memset(&vinteger, 0, sizeof(struct vm_vinteger_t));
+      vinteger.type = VINTEGER;
+      vinteger.ret = token;
+      vinteger.value = reg->value.i;
+      return (unsigned char *)&vinteger;
+    } break;
+    case VFLOAT: {
+      memset(&vfloat, 0, sizeof(struct vm_vfloat_t));
+      vfloat.type = VFLOAT;
+      vfloat.ret = token;
+      vfloat.value = reg->value.f;
+      return (unsigned char *)&vfloat;
+    } break;
+    case VCHAR: {
+      const char *cpy = strpool_intern(&rule_strings, reg->value.s, strlen(reg->value.s));
+      if(cpy == NULL) {
+        logprintf_P(F("rules: string pool full, cannot store \"%s\""), reg->value.s);
+        return NULL;
+      }
+      memset(&vchar, 0, sizeof(struct vm_vchar_t));
+      vchar.type = VCHAR;
+      vchar.ret = token;
+      vchar.value = strpool_offset(&rule_strings, cpy);
+      return (unsigned char *)&vchar;
+    } break;
+  }
+  memset(&vnull, 0, sizeof(struct vm_vnull_t));
+  vnull.type = VNULL;
+  vnull.ret = token;
+  return (unsigned char *)&vnull;
+}
+
+static int host_value_load(unsigned char *val, struct vm_register_t *reg) {
+  switch(val[0]) {
+    case VINTEGER: {
+      reg->type = VINTEGER;
+      reg->value.i = ((struct vm_vinteger_t *)val)->value;
+    } break;
+    case VFLOAT: {
+      reg->type = VFLOAT;
+      reg->value.f = ((struct vm_vfloat_t *)val)->value;
+    } break;
+    case VCHAR: {
+      reg->type = VCHAR;
+      reg->value.s = strpool_get(&rule_strings, ((struct vm_vchar_t *)val)->value);
+    } break;
+    case VNULL: {
+      reg->type = VNULL;
+    } break;
+    default: {
+      return -1;
+    } break;
+  }
+  return 0;
+}
+
+static int is_variable(char *text, unsigned int *pos, unsigned int size) {
+  int i = 1;
+
+  if(text[*pos] == '$' || text[*pos] == '#' || text[*pos] == '@' || text[*pos] == '%' || text[*pos] == '?') {
+    if(text[*pos] == '@' || text[*pos] == '?') {
+      return size;
+    }
+    while(isalnum(text[*pos+i])) {
+      i++;
+    }
+    return i;
+  }
+  return -1;
+}
+
+static int is_event(char *text, unsigned int *pos, unsigned int size) {
+  return size;
+}
+
+static unsigned char *vm_value_get(struct rules_t *obj, uint16_t token) {
+  struct vm_tvar_t *node = (struct vm_tvar_t *)&obj->ast.buffer[token];
+  struct host_var_t *var = host_var_find(&vars, host_var_scope(obj->nr, (char *)node->token), (char *)node->token, 0);
+  struct vm_register_t null;
+
+  if(var == NULL) {
+    null.type = VNULL;
+    return host_value(&null, token);
+  }
+  return host_value(&var->reg, token);
+}
+
+static void vm_value_set(struct rules_t *obj, uint16_t token, uint16_t val) {
+  struct vm_tvar_t *node = (struct vm_tvar_t *)&obj->ast.buffer[token];
+  struct host_var_t *var = NULL;
+  struct vm_register_t reg;
+
+  if(host_value_load(&obj->varstack.buffer[val], &reg) == -1) {
+    logprintf_P(F("FATAL: Internal error in %s #%d"), __FUNCTION__, __LINE__);
+    return;
+  }
+  if((var = host_var_find(&vars, host_var_scope(obj->nr, (char *)node->token), (char *)node->token, 1)) == NULL) {
+    logprintf_P(F("rules: no room for variable %s"), (char *)node->token);
+    return;
+  }
+  host_var_set(var, &reg);
+}
+
+static void vm_value_cpy(struct rules_t *obj, uint16_t token) {
+}
+
+static void vm_value_clr(struct rules_t *obj, uint16_t token) {
+  struct vm_tvar_t *node = (struct vm_tvar_t *)&obj->ast.buffer[token];
+  node->value = 0;
+}
+
+static void vm_value_prt(struct rules_t *obj, char *out, int size) {
+  int i = 0, pos = 0;
+
+  for(i=0;i<vars.nr && pos < size;i++) {
+    if(vars.list[i].rule == obj->nr) {
+      pos += snprintf(&out[pos], size - pos, "%s = ", vars.list[i].name);
+      if(pos < size) {
+        pos += host_reg_prt(&vars.list[i].reg, &out[pos], size - pos);
+      }
+      if(pos < size) {
+        pos += snprintf(&out[pos], size - pos, "\n");
+      }
+    }
+  }
+}
+
+static int get_event(struct rules_t *obj) {
+  struct vm_tstart_t *start = (struct vm_tstart_t *)&obj->ast.buffer[0];
+  if(obj->ast.buffer[start->go] != TEVENT) {
+    return -1;
+  } else {
+    return start->go;
+  }
+}
+
+static const char *host_event_name(struct rules_t *obj) {
+  int x = get_event(obj);
+  if(x == -1) {
+    return NULL;
+  }
+  return (const char *)((struct vm_tevent_t *)&obj->ast.buffer[x])->token;
+}
+
+/*
+ * The same lookup as on the device, with a limit on
+ * how deep rules can call each other, because a rule
+ * calling itself never returns.
+ */
+static int event_cb(struct rules_t *obj, char *name) {
+  struct rules_t *called = NULL;
+  int x = 0;
+
+  if(obj->caller > 0 && name == NULL) {
+    called = rules[obj->caller-1];
+
+    obj->caller = 0;
+    depth--;
+
+    return rule_run(called);
+  }
+
+  if(++depth > HOST_CALL_DEPTH) {
+    logprintf_P(F("rules: calls nested deeper than %d"), HOST_CALL_DEPTH);
+    return -1;
+  }
+
+  for(x=0;x<nrrules;x++) {
+    const char *event = host_event_name(rules[x]);
+    if(event != NULL && strnicmp(name, (char *)event, strlen(event)) == 0) {
+      called = rules[x];
+      break;
+    }
+  }
+
+  if(called != NULL) {
+    called->caller = obj->nr;
+    return rule_run(called);
+  }
+  depth--;
+  return rule_run(obj);
+}
+
+static void host_setup(void) {
+  memset(&rule_options, 0, sizeof(struct rule_options_t));
+  rule_options.is_token_cb = is_variable;
+  rule_options.is_event_cb = is_event;
+  rule_options.set_token_val_cb = vm_value_set;
+  rule_options.get_token_val_cb = vm_value_get;
+  rule_options.prt_token_val_cb = vm_value_prt;
+  rule_options.cpy_token_val_cb = vm_value_cpy;
+  rule_options.clr_token_val_cb = vm_value_clr;
+  rule_options.event_cb = event_cb;
+  rule_options.max_steps = 0;
+}
+
+static void host_free(void) {
+  if(nrrules > 0) {
+    rules_gc(&rules, nrrules);
+  }
+  rules = NULL;
+  nrrules = 0;
+  bytecode = 0;
+  host_vars_clear(&vars);
+  strpool_init(&rule_strings, NULL, 0);
+  rollstat_init(NULL, 0);
+  while(timerqueue_pop() != NULL);
+}
+
+/*
+ * Lays out the mempool like rules_parse does on the
+ * device: the text at the end, the bytecode growing
+ * towards it and the string pool in what's left.
+ */
+static int host_parse(const char *text, unsigned int len) {
+  struct pbuf mem;
+  struct pbuf input;
+  unsigned int txtoffset = 0, pool = 0;
+  int ret = 0;
+
+  host_free();
+
+  if(len > HOST_INPUT_MAX) {
+    logprintf_P(F("rules: ruleset of %d bytes is too large"), len);
+    return -1;
+  }
+
+  memset(mempool, 0, MEMPOOL_SIZE);
+  txtoffset = alignedbuffer(MEMPOOL_SIZE-len-5);
+  memcpy(&mempool[txtoffset], text, len);
+
+  memset(&mem, 0, sizeof(struct pbuf));
+  memset(&input, 0, sizeof(struct pbuf));
+
+  mem.payload = mempool;
+  mem.len = 0;
+  mem.tot_len = MEMPOOL_SIZE;
+
+  input.payload = &mempool[txtoffset];
+  input.len = txtoffset;
+  input.tot_len = len;
+
+  depth = 0;
+  while((ret = rule_initialize(&input, &rules, &nrrules, &mem, NULL)) == 0) {
+    input.payload = &mempool[input.len];
+  }
+
+  if(ret == -1) {
+    if(nrrules > 0) {
+      rules_gc(&rules, nrrules);
+    }
+    rules = NULL;
+    nrrules = 0;
+    return -1;
+  }
+
+  /*
+   * Validating the rules ran their assignments,
+   * so drop what they left behind like the
+   * device does.
+   */
+  host_vars_clear(&vars);
+  while(timerqueue_pop() != NULL);
+
+  bytecode = mem.len;
+  pool = alignedbuffer(mem.len);
+  if(pool < MEMPOOL_SIZE) {
+    strpool_init(&rule_strings, &mempool[pool], MEMPOOL_SIZE-pool);
+  }
+  return 0;
+}
+
+/*
+ * Runs a rule to the end, continuing whichever
+ * rule was suspended when the step budget ran out.
+ */
+static int host_exec(struct rules_t *obj) {
+  int ret = 0, i = 0, n = 0;
+
+  depth = 0;
+  ret = rule_run(obj);
+  while(ret == 1 && ++n < HOST_RESUME_MAX) {
+    for(i=0;i<nrrules;i++) {
+      if(rules[i]->suspended == 1) {
+        break;
+      }
+    }
+    if(i == nrrules) {
+      break;
+    }
+    ret = rule_run(rules[i]);
+  }
+
+  strings = MAX(strings, (unsigned int)rule_strings.len);
+  strpool_reset(&rule_strings);
+  return ret;
+}
+
+static struct rules_t *host_rule(const char *event) {
+  int i = 0;
+  for(i=0;i<nrrules;i++) {
+    const char *name = host_event_name(rules[i]);
+    if(name != NULL && stricmp(name, event) == 0) {
+      return rules[i];
+    }
+  }
+  return NULL;
+}
+
+static char *host_read(const char *file, unsigned int *len) {
+  char *text = NULL;
+  FILE *fp = NULL;
+  long size = 0;
+
+  if((fp = fopen(file, "rb")) == NULL) {
+    fprintf(stderr, "cannot open %s\n", file);
+    return NULL;
+  }
+  fseek(fp, 0, SEEK_END);
+  size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+  if(size < 0 || (text = (char *)MALLOC(size+1)) == NULL) {
+    fclose(fp);
+    return NULL;
+  }
+  *len = fread(text, 1, size, fp);
+  text[*len] = 0;
+  fclose(fp);
+  return text;
+}
+
+/*
+ * Random rulesets for the differential run. The
+ * generated tree is both printed as a ruleset and
+ * evaluated directly by the reference evaluator.
+ */
+#define GEN_NODES_MAX 2048
+#define GEN_RULES_MAX 3
+/*
+ * The bytecode takes up to about two and a half
+ * times the text, both have to fit the mempool.
+ */
+#define GEN_TEXT_MAX  (MEMPOOL_SIZE / 5)
+
+typedef enum {
+  GEN_NUMBER = 1,
+  GEN_STRING,
+  GEN_VAR,
+  GEN_OP,
+  GEN_ASSIGN,
+  GEN_IF,
+  GEN_ELSE,
+  GEN_CALL
+} gen_types;
+
+typedef struct gen_node_t {
+  uint8_t type;
+  uint8_t op;
+  uint8_t paren;
+  char text[16];
+  /*
+   * Expressions: the operands, statements:
+   * the value or condition, the body and
+   * the elseif or else that follows.
+   */
+  int a;
+  int b;
+  int c;
+  int next;
+} gen_node_t;
+
+static struct gen_node_t gen_nodes[GEN_NODES_MAX];
+static int gen_nrnodes = 0;
+static int gen_rules[GEN_RULES_MAX];
+static int gen_nrrules = 0;
+static uint32_t gen_seed = 1;
+
+static const char *gen_locals[] = { "$a", "$b", "$c", "$d" };
+static const char *gen_globals[] = { "#g0", "#g1" };
+
+static uint32_t gen_rand(uint32_t n) {
+  gen_seed ^= gen_seed << 13;
+  gen_seed ^= gen_seed >> 17;
+  gen_seed ^= gen_seed << 5;
+  return gen_seed % n;
+}
+
+static int gen_node(int type) {
+  struct gen_node_t *node = NULL;
+
+  if(gen_nrnodes >= GEN_NODES_MAX) {
+    return -1;
+  }
+  node = &gen_nodes[gen_nrnodes];
+  memset(node, 0, sizeof(struct gen_node_t));
+  node->type = type;
+  node->a = -1;
+  node->b = -1;
+  node->c = -1;
+  node->next = -1;
+  return gen_nrnodes++;
+}
+
+static const char *gen_var(void) {
+  if(gen_rand(4) == 0) {
+    return gen_globals[gen_rand(sizeof(gen_globals)/sizeof(gen_globals[0]))];
+  }
+  return gen_locals[gen_rand(sizeof(gen_locals)/sizeof(gen_locals[0]))];
+}
+
+static int gen_op(const char *names[], int nr) {
+  const char *name = names[gen_rand(nr)];
+  unsigned int i = 0;
+  for(i=0;i<nr_rule_operators;i++) {
+    if(strcmp(rule_operators[i].name, name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static int gen_leaf(void) {
+  int n = 0, r = gen_rand(100);
+
+  if(r < 40) {
+    if((n = gen_node(GEN_VAR)) > -1) {
+      strcpy(gen_nodes[n].text, gen_var());
+    }
+  } else if(r < 75) {
+    if((n = gen_node(GEN_NUMBER)) > -1) {
+      snprintf(gen_nodes[n].text, sizeof(gen_nodes[n].text), "%d", gen_rand(150));
+    }
+  } else if(r < 92) {
+    static const char *fractions[] = { "25", "5", "75" };
+    if((n = gen_node(GEN_NUMBER)) > -1) {
+      snprintf(gen_nodes[n].text, sizeof(gen_nodes[n].text), "%d.%s", gen_rand(20), fractions[gen_rand(3)]);
+    }
+  } else {
+    if((n = gen_node(GEN_STRING)) > -1) {
+      snprintf(gen_nodes[n].text, sizeof(gen_nodes[n].text), "s%d", gen_rand(3));
+    }
+  }
+  return n;
+}
+
+static int gen_expr(int depth) {
+  static const char *ops[] = { "+", "-", "*", "/", "%", "^", "==", "!=", "<", ">", "<=", ">=", "&&", "||" };
+  int n = 0;
+
+  if(depth <= 0 || gen_rand(3) == 0) {
+    return gen_leaf();
+  }
+  if((n = gen_node(GEN_OP)) == -1) {
+    return -1;
+  }
+  gen_nodes[n].op = gen_op(ops, sizeof(ops)/sizeof(ops[0]));
+  gen_nodes[n].paren = (gen_rand(6) == 0);
+  gen_nodes[n].a = gen_expr(depth-1);
+  /*
+   * Keep powers small, they only
+   * have to be the same on both sides.
+   */
+  if(strcmp(rule_operators[gen_nodes[n].op].name, "^") == 0) {
+    int b = gen_node(GEN_NUMBER);
+    if(b > -1) {
+      snprintf(gen_nodes[b].text, sizeof(gen_nodes[b].text), "%d", gen_rand(4));
+    }
+    gen_nodes[n].b = b;
+  } else {
+    gen_nodes[n].b = gen_expr(depth-1);
+  }
+  if(gen_nodes[n].a == -1 || gen_nodes[n].b == -1) {
+    return -1;
+  }
+  return n;
+}
+
+/*
+ * An if only takes the value 1 as true, so a
+ * condition is always a comparison or logical
+ * operator, which both return 0 or 1.
+ */
+static int gen_cond(void) {
+  static const char *ops[] = { "==", "!=", "<", ">", "<=", ">=", "&&", "||" };
+  int n = 0;
+
+  if((n = gen_node(GEN_OP)) == -1) {
+    return -1;
+  }
+  gen_nodes[n].op = gen_op(ops, sizeof(ops)/sizeof(ops[0]));
+  gen_nodes[n].paren = (gen_rand(4) == 0);
+  gen_nodes[n].a = gen_expr(2);
+  gen_nodes[n].b = gen_expr(2);
+  if(gen_nodes[n].a == -1 || gen_nodes[n].b == -1) {
+    return -1;
+  }
+  return n;
+}
+
+static int gen_body(int rule, int depth);
+
+static int gen_stmt(int rule, int depth) {
+  int n = 0, r = gen_rand(100);
+
+  if(r < 15 && depth > 0) {
+    int x = 0, last = 0;
+
+    if((n = gen_node(GEN_IF)) == -1) {
+      return -1;
+    }
+    gen_nodes[n].a = gen_cond();
+    gen_nodes[n].b = gen_body(rule, depth-1);
+    last = n;
+    while(gen_rand(3) == 0) {
+      if((x = gen_node(GEN_IF)) == -1) {
+        return -1;
+      }
+      gen_nodes[x].a = gen_cond();
+      gen_nodes[x].b = gen_body(rule, depth-1);
+      gen_nodes[last].c = x;
+      last = x;
+    }
+    if(gen_rand(2) == 0) {
+      if((x = gen_node(GEN_ELSE)) == -1) {
+        return -1;
+      }
+      gen_nodes[x].b = gen_body(rule, depth-1);
+      gen_nodes[last].c = x;
+    }
+    return n;
+  }
+  /*
+   * A rule only calls rules generated after
+   * it, so there is no recursion.
+   */
+  if(r < 25 && rule+1 < gen_nrrules) {
+    if((n = gen_node(GEN_CALL)) > -1) {
+      gen_nodes[n].a = rule+1+gen_rand(gen_nrrules-rule-1);
+    }
+    return n;
+  }
+  if((n = gen_node(GEN_ASSIGN)) == -1) {
+    return -1;
+  }
+  strcpy(gen_nodes[n].text, gen_var());
+  gen_nodes[n].a = gen_expr(4);
+  return n;
+}
+
+static int gen_body(int rule, int depth) {
+  int i = 0, n = 0, first = -1, last = -1, count = 1+gen_rand(5);
+
+  for(i=0;i<count;i++) {
+    if((n = gen_stmt(rule, depth)) == -1) {
+      return first;
+    }
+    if(first == -1) {
+      first = n;
+    } else {
+      gen_nodes[last].next = n;
+    }
+    last = n;
+  }
+  return first;
+}
+
+static void gen_program(uint32_t seed) {
+  int i = 0, n = 0;
+
+  gen_seed = (seed * 2654435761u) | 1;
+  gen_nrnodes = 0;
+  gen_nrrules = 1+gen_rand(GEN_RULES_MAX);
+
+  for(i=0;i<gen_nrrules;i++) {
+    gen_rules[i] = gen_body(i, 3);
+  }
+
+  /*
+   * Start with known values, so most
+   * expressions aren't just NULL.
+   */
+  for(i=sizeof(gen_globals)/sizeof(gen_globals[0])-1;i>=0;i--) {
+    if((n = gen_node(GEN_ASSIGN)) == -1) {
+      break;
+    }
+    strcpy(gen_nodes[n].text, gen_globals[i]);
+    gen_nodes[n].a = gen_leaf();
+    gen_nodes[n].next = gen_rules[0];
+    gen_rules[0] = n;
+  }
+  for(i=sizeof(gen_locals)/sizeof(gen_locals[0])-1;i>=0;i--) {
+    if((n = gen_node(GEN_ASSIGN)) == -1) {
+      break;
+    }
+    strcpy(gen_nodes[n].text, gen_locals[i]);
+    gen_nodes[n].a = gen_leaf();
+    gen_nodes[n].next = gen_rules[0];
+    gen_rules[0] = n;
+  }
+}
+
+typedef struct gen_buf_t {
+  char *text;
+  int size;
+  int len;
+} gen_buf_t;
+
+static void gen_printf(struct gen_buf_t *out, const char *fmt, ...) {
+  va_list ap;
+  int n = 0;
+
+  if(out->len >= out->size) {
+    return;
+  }
+  va_start(ap, fmt);
+  n = vsnprintf(&out->text[out->len], out->size - out->len, fmt, ap);
+  va_end(ap);
+  out->len += n;
+}
+
+/*
+ * Parenthesis are only added where the precedence
+ * or associativity of the operators needs them, or
+ * where the generator randomly asked for them.
+ */
+static void gen_print_expr(struct gen_buf_t *out, int n, int precedence, int side) {
+  struct gen_node_t *node = &gen_nodes[n];
+  int paren = node->paren;
+
+  switch(node->type) {
+    case GEN_NUMBER:
+    case GEN_VAR: {
+      gen_printf(out, "%s", node->text);
+    } break;
+    case GEN_STRING: {
+      gen_printf(out, "\"%s\"", node->text);
+    } break;
+    case GEN_OP: {
+      struct rule_operator_t *op = &rule_operators[node->op];
+      if(op->precedence < precedence) {
+        paren = 1;
+      }
+      if(op->precedence == precedence && ((op->associativity == 1 && side == 1) || (op->associativity == 2 && side == 0))) {
+        paren = 1;
+      }
+      if(paren == 1) {
+        gen_printf(out, "(");
+      }
+      gen_print_expr(out, node->a, op->precedence, 0);
+      gen_printf(out, " %s ", op->name);
+      gen_print_expr(out, node->b, op->precedence, 1);
+      if(paren == 1) {
+        gen_printf(out, ")");
+      }
+    } break;
+  }
+}
+
+static void gen_print_body(struct gen_buf_t *out, int n, int indent) {
+  for(;n>-1;n=gen_nodes[n].next) {
+    struct gen_node_t *node = &gen_nodes[n];
+    int x = 0;
+
+    switch(node->type) {
+      case GEN_ASSIGN: {
+        gen_printf(out, "%*s%s = ", indent, "", node->text);
+        gen_print_expr(out, node->a, 0, 0);
+        gen_printf(out, ";\n");
+      } break;
+      case GEN_CALL: {
+        gen_printf(out, "%*shelper%d();\n", indent, "", node->a);
+      } break;
+      case GEN_IF: {
+        gen_printf(out, "%*sif ", indent, "");
+        gen_print_expr(out, node->a, 0, 0);
+        gen_printf(out, " then\n");
+        gen_print_body(out, node->b, indent+2);
+        for(x=node->c;x>-1;x=gen_nodes[x].c) {
+          if(gen_nodes[x].type == GEN_IF) {
+            gen_printf(out, "%*selseif ", indent, "");
+            gen_print_expr(out, gen_nodes[x].a, 0, 0);
+            gen_printf(out, " then\n");
+          } else {
+            gen_printf(out, "%*selse\n", indent, "");
+          }
+          gen_print_body(out, gen_nodes[x].b, indent+2);
+        }
+        gen_printf(out, "%*send\n", indent, "");
+      } break;
+    }
+  }
+}
+
+static int gen_print(char *text, int size) {
+  struct gen_buf_t out;
+  int i = 0;
+
+  out.text = text;
+  out.size = size;
+  out.len = 0;
+
+  for(i=0;i<gen_nrrules;i++) {
+    if(i == 0) {
+      gen_printf(&out, "on System#Boot then\n");
+    } else {
+      gen_printf(&out, "\non helper%d then\n", i);
+    }
+    gen_print_body(&out, gen_rules[i], 2);
+    gen_printf(&out, "end\n");
+  }
+  return (out.len < out.size) ? out.len : -1;
+}
+
+static struct host_vars_t ref;
+
+static int ref_expr(int n, int rule, struct vm_register_t *out) {
+  struct gen_node_t *node = &gen_nodes[n];
+
+  switch(node->type) {
+    case GEN_NUMBER: {
+      if(strchr(node->text, '.') != NULL) {
+        out->type = VFLOAT;
+        out->value.f = atof(node->text);
+      } else {
+        out->type = VINTEGER;
+        out->value.i = atoi(node->text);
+      }
+    } break;
+    case GEN_STRING: {
+      out->type = VCHAR;
+      if((out->value.s = strpool_intern(&rule_strings, node->text, strlen(node->text))) == NULL) {
+        return -1;
+      }
+    } break;
+    case GEN_VAR: {
+      struct host_var_t *var = host_var_find(&ref, host_var_scope(rule, node->text), node->text, 0);
+      out->type = VNULL;
+      if(var != NULL) {
+        *out = var->reg;
+        if(out->type == VCHAR && (out->value.s = strpool_intern(&rule_strings, out->value.s, strlen(out->value.s))) == NULL) {
+          return -1;
+        }
+      }
+    } break;
+    case GEN_OP: {
+      struct vm_register_t a, b;
+      if(ref_expr(node->a, rule, &a) == -1 || ref_expr(node->b, rule, &b) == -1) {
+        return -1;
+      }
+      return rule_operators[node->op].callback(&a, &b, out);
+    } break;
+  }
+  return 0;
+}
+
+static int ref_body(int n, int rule) {
+  for(;n>-1;n=gen_nodes[n].next) {
+    struct gen_node_t *node = &gen_nodes[n];
+    struct vm_register_t reg;
+    int x = 0;
+
+    switch(node->type) {
+      case GEN_ASSIGN: {
+        struct host_var_t *var = NULL;
+        if(ref_expr(node->a, rule, &reg) == -1) {
+          return -1;
+        }
+        if((var = host_var_find(&ref, host_var_scope(rule, node->text), node->text, 1)) == NULL) {
+          return -1;
+        }
+        host_var_set(var, &reg);
+      } break;
+      case GEN_CALL: {
+        if(ref_body(gen_rules[node->a], node->a+1) == -1) {
+          return -1;
+        }
+      } break;
+      case GEN_IF: {
+        for(x=n;x>-1;x=gen_nodes[x].c) {
+          if(gen_nodes[x].type == GEN_ELSE) {
+            if(ref_body(gen_nodes[x].b, rule) == -1) {
+              return -1;
+            }
+            break;
+          }
+          if(ref_expr(gen_nodes[x].a, rule, &reg) == -1) {
+            return -1;
+          }
+          if(reg.value.i == 1) {
+            if(ref_body(gen_nodes[x].b, rule) == -1) {
+              return -1;
+            }
+            break;
+          }
+          if(reg.value.i != 0) {
+            break;
+          }
+        }
+      } break;
+    }
+  }
+  return 0;
+}
+
+static int host_diff(uint32_t seed, int count) {
+  char *text = (char *)MALLOC(GEN_TEXT_MAX);
+  int n = 0, len = 0, differ = 0, skipped = 0;
+
+  if(text == NULL) {
+    return -1;
+  }
+
+  quiet = 1;
+  for(n=0;n<count;n++) {
+    gen_program(seed+n);
+    if((len = gen_print(text, GEN_TEXT_MAX)) == -1) {
+      skipped++;
+      continue;
+    }
+
+    rule_options.max_steps = (gen_rand(3) == 0) ? 0 : 1+gen_rand(50);
+
+    if(host_parse(text, len) == -1) {
+      printf("seed %u: ruleset does not parse\n%s", seed+n, text);
+      differ = 1;
+      break;
+    }
+    if(host_exec(rules[0]) != 0) {
+      printf("seed %u: ruleset failed to run (budget %d)\n%s", seed+n, rule_options.max_steps, text);
+      differ = 1;
+      break;
+    }
+
+    host_vars_clear(&ref);
+    if(ref_body(gen_rules[0], 1) == -1) {
+      strpool_reset(&rule_strings);
+      skipped++;
+      continue;
+    }
+    strpool_reset(&rule_strings);
+
+    if(host_vars_cmp(&vars, &ref, stdout) != 0) {
+      printf("seed %u, step budget %d\n%s", seed+n, rule_options.max_steps, text);
+      differ = 1;
+      break;
+    }
+  }
+  printf("%d rulesets, %d skipped, %s\n", n, skipped, (differ == 1) ? "differ" : "all equal");
+
+  host_vars_clear(&ref);
+  host_free();
+  FREE(text);
+  return differ;
+}
+
+static int host_run(const char *file, int argc, char **argv) {
+  unsigned int len = 0;
+  char *text = NULL;
+  const char *def = "System#Boot";
+  int i = 0, ret = 0;
+
+  if((text = host_read(file, &len)) == NULL) {
+    return -1;
+  }
+  if(host_parse(text, len) == -1) {
+    fprintf(stderr, "%s failed to parse\n", file);
+    FREE(text);
+    return -1;
+  }
+  printf("%d rules, %u bytes of bytecode\n", nrrules, bytecode);
+
+  for(i=0;i<((argc > 0) ? argc : 1);i++) {
+    const char *event = (argc > 0) ? argv[i] : def;
+    struct rules_t *obj = host_rule(event);
+    if(obj == NULL) {
+      fprintf(stderr, "no rule for %s\n", event);
+      ret = -1;
+      continue;
+    }
+    if(host_exec(obj) != 0) {
+      fprintf(stderr, "rule #%d (%s) failed\n", obj->nr, event);
+      ret = -1;
+    }
+  }
+  host_vars_prt(&vars, stdout);
+
+  host_free();
+  FREE(text);
+  return ret;
+}
+
+static int host_bench(const char *file, int iterations, const char *event) {
+  double start = 0, elapsed = 0, parse = 0, parsemin = 0, run = 0, runmin = 0;
+  struct rules_t *obj = NULL;
+  unsigned int len = 0;
+  char *text = NULL;
+  int i = 0;
+
+  if(iterations < 1) {
+    iterations = 1;
+  }
+  if((text = host_read(file, &len)) == NULL) {
+    return -1;
+  }
+
+  quiet = 1;
+  for(i=0;i<iterations;i++) {
+    start = host_micros();
+    if(host_parse(text, len) == -1) {
+      fprintf(stderr, "%s failed to parse\n", file);
+      FREE(text);
+      return -1;
+    }
+    elapsed = host_micros() - start;
+    parse += elapsed;
+    if(i == 0 || elapsed < parsemin) {
+      parsemin = elapsed;
+    }
+  }
+  printf("parse: %d rules, %u bytes of bytecode, %.2f us average, %.2f us minimum\n", nrrules, bytecode, parse / iterations, parsemin);
+
+  if((obj = host_rule(event)) == NULL) {
+    fprintf(stderr, "no rule for %s\n", event);
+    FREE(text);
+    return -1;
+  }
+  strings = 0;
+  for(i=0;i<iterations;i++) {
+    start = host_micros();
+    host_exec(obj);
+    elapsed = host_micros() - start;
+    run += elapsed;
+    if(i == 0 || elapsed < runmin) {
+      runmin = elapsed;
+    }
+  }
+  printf("run %s: %.2f us average, %.2f us minimum, %u bytes of string pool\n", event, run / iterations, runmin, strings);
+
+  host_free();
+  FREE(text);
+  return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  char *text = NULL;
+  int i = 0;
+
+  if(size > HOST_INPUT_MAX) {
+    return 0;
+  }
+  if(rule_options.event_cb == NULL) {
+    host_setup();
+  }
+  if((text = (char *)MALLOC(size+1)) == NULL) {
+    return 0;
+  }
+  memcpy(text, data, size);
+  text[size] = 0;
+
+  quiet = 1;
+  rule_options.max_steps = 16;
+  if(host_parse(text, strlen(text)) == 0) {
+    for(i=0;i<nrrules;i++) {
+      host_exec(rules[i]);
+    }
+  }
+  host_free();
+  FREE(text);
+  return 0;
+}
+
+#ifndef RULES_HOST_LIBFUZZER
+static int host_usage(void) {
+  fprintf(stderr,
+    "usage: rules_host run <file> [event ...]\n"
+    "       rules_host bench <file> [iterations] [event]\n"
+    "       rules_host diff [seed] [count]\n"
+    "       rules_host gen [seed]\n"
+    "       rules_host fuzz <file> ...\n"
+  );
+  return 2;
+}
+
+int main(int argc, char **argv) {
+  int i = 0, ret = 0;
+
+  if(argc < 2) {
+    return host_usage();
+  }
+
+  host_setup();
+
+  if(strcmp(argv[1], "run") == 0 && argc >= 3) {
+    ret = host_run(argv[2], argc-3, &argv[3]);
+  } else if(strcmp(argv[1], "bench") == 0 && argc >= 3) {
+    ret = host_bench(argv[2], (argc > 3) ? atoi(argv[3]) : 1000, (argc > 4) ? argv[4] : "System#Boot");
+  } else if(strcmp(argv[1], "diff") == 0) {
+    ret = host_diff((argc > 2) ? strtoul(argv[2], NULL, 10) : 1, (argc > 3) ? atoi(argv[3]) : 1000);
+  } else if(strcmp(argv[1], "gen") == 0) {
+    char text[GEN_TEXT_MAX];
+    gen_program((argc > 2) ? strtoul(argv[2], NULL, 10) : 1);
+    if(gen_print(text, sizeof(text)) > -1) {
+      printf("%s", text);
+    }
+  } else if(strcmp(argv[1], "fuzz") == 0 && argc >= 3) {
+    for(i=2;i<argc;i++) {
+      unsigned int len = 0;
+      char *text = host_read(argv[i], &len);
+      if(text != NULL) {
+        LLVMFuzzerTestOneInput((const uint8_t *)text, len);
+        FREE(text);
+      }
+    }
+  } else {
+    return host_usage();
+  }
+  return (ret == 0) ? 0 : 1;
+}
+#endif
@@ -0,0 +1,359 @@
+#!/usr/bin/env python3
+#
+# Load and robustness test for the HeishaMon webserver,
+# run against a device on the network:
+#
+#   python3 Tools/webload.py heishamon.local load --clients 4 --seconds 30
+#   python3 Tools/webload.py heishamon.local load --keepalive
+#   python3 Tools/webload.py heishamon.local slow
+#   python3 Tools/webload.py heishamon.local partial
+#   python3 Tools/webload.py heishamon.local pipeline
+#   python3 Tools/webload.py heishamon.local fuzz --cases 500
+#   python3 Tools/webload.py heishamon.local upload --rules rules.txt
+#
+# Every run ends with the per route counters of /stats (request
+# count, average and maximum time to last byte and the most heap a
+# request used) and the stack and heap gauges of /metrics.
+#
+# Only read only pages are requested. The upload mode replaces the
+# ruleset with the given file and multipart fuzzing (fuzz --multipart)
+# posts mangled rulesets to /saverules, so only use those on a device
+# where that is fine.
+#
+
+import argparse
+import json
+import random
+import socket
+import threading
+import time
+
+SAFE_PATHS = ['/json', '/tablerefresh', '/', '/stats', '/metrics', '/rules/stats']
+
+
+def connect(args):
+  return socket.create_connection((args.host, args.port), timeout=args.timeout)
+
+
+def read_response(sock, delay=0):
+  """Reads until the server closes, returns the raw bytes."""
+  data = b''
+  while True:
+    try:
+      chunk = sock.recv(1 if delay else 4096)
+    except socket.timeout:
+      break
+    if not chunk:
+      break
+    data += chunk
+    if delay:
+      time.sleep(delay)
+  return data
+
+
+def request(path, extra=b'Connection: close\r\n'):
+  return b'GET ' + path.encode() + b' HTTP/1.1\r\nHost: heishamon\r\n' + extra + b'\r\n'
+
+
+def read_one(sock, data):
+  """Reads a single response of a connection kept open, returns it and what followed."""
+  while b'\r\n\r\n' not in data:
+    chunk = sock.recv(4096)
+    if not chunk:
+      raise OSError('connection closed')
+    data += chunk
+  head, _, rest = data.partition(b'\r\n\r\n')
+  lower = head.lower()
+  if b'transfer-encoding: chunked' in lower:
+    while not (rest.startswith(b'0\r\n\r\n') or b'\r\n0\r\n\r\n' in rest):
+      chunk = sock.recv(4096)
+      if not chunk:
+        raise OSError('connection closed')
+      rest += chunk
+    end = 5 if rest.startswith(b'0\r\n\r\n') else rest.index(b'\r\n0\r\n\r\n') + 7
+  else:
+    end = 0
+    for line in lower.split(b'\r\n'):
+      if line.startswith(b'content-length:'):
+        end = int(line.split(b':')[1])
+    while len(rest) < end:
+      chunk = sock.recv(4096)
+      if not chunk:
+        raise OSError('connection closed')
+      rest += chunk
+  return head + b'\r\n\r\n' + rest[:end], rest[end:]
+
+
+def get(args, path):
+  sock = connect(args)
+  try:
+    sock.sendall(request(path))
+    return read_response(sock)
+  finally:
+    sock.close()
+
+
+def body(response):
+  """Returns the body of a response, without chunked framing."""
+  head, _, data = response.partition(b'\r\n\r\n')
+  if b'transfer-encoding: chunked' not in head.lower():
+    return data
+  plain = b''
+  while data:
+    size, _, data = data.partition(b'\r\n')
+    size = int(size.split(b';')[0] or b'0', 16)
+    if size == 0:
+      break
+    plain += data[:size]
+    data = data[size + 2:]
+  return plain
+
+
+def status(response):
+  try:
+    return int(response.split(b' ', 2)[1])
+  except (IndexError, ValueError):
+    return 0
+
+
+def alive(args):
+  try:
+    return status(get(args, '/stats')) == 200
+  except OSError:
+    return False
+
+
+def percentile(values, p):
+  if not values:
+    return 0
+  values = sorted(values)
+  return values[min(len(values) - 1, int(len(values) * p / 100))]
+
+
+def run_load(args):
+  lock = threading.Lock()
+  latencies = []
+  errors = [0]
+  end = time.time() + args.seconds
+
+  def worker():
+    sock, data = None, b''
+    while time.time() < end:
+      path = random.choice(args.paths)
+      start = time.time()
+      try:
+        if args.keepalive:
+          if sock is None:
+            sock, data = connect(args), b''
+          sock.sendall(request(path, b''))
+          response, data = read_one(sock, data)
+          if b'connection: close' in response.lower():
+            sock.close()
+            sock = None
+        else:
+          response = get(args, path)
+        ok = status(response) in (200, 304)
+      except OSError:
+        ok = False
+        if sock is not None:
+          sock.close()
+          sock = None
+      with lock:
+        if ok:
+          latencies.append((time.time() - start) * 1000)
+        else:
+          errors[0] += 1
+
+  threads = [threading.Thread(target=worker) for _ in range(args.clients)]
+  start = time.time()
+  for t in threads:
+    t.start()
+  for t in threads:
+    t.join()
+  elapsed = time.time() - start
+
+  print('requests: %d ok, %d failed in %.1fs' % (len(latencies), errors[0], elapsed))
+  print('requests per second: %.1f' % (len(latencies) / elapsed))
+  print('latency ms: p50 %.0f, p90 %.0f, p99 %.0f, max %.0f' % (
+    percentile(latencies, 50), percentile(latencies, 90), percentile(latencies, 99), percentile(latencies, 100)))
+
+
+def run_slow(args):
+  """Clients that read their response a byte at a time."""
+  def worker(nr):
+    sock = connect(args)
+    sock.settimeout(args.timeout * 4)
+    start = time.time()
+    sock.sendall(request(random.choice(args.paths)))
+    data = read_response(sock, delay=args.delay)
+    sock.close()
+    print('slow reader %d: %d bytes, status %d, %.1fs' % (nr, len(data), status(data), time.time() - start))
+
+  threads = [threading.Thread(target=worker, args=(i,)) for i in range(args.clients)]
+  for t in threads:
+    t.start()
+  for t in threads:
+    t.join()
+  print('device answers afterwards: %s' % alive(args))
+
+
+def run_partial(args):
+  """Headers sent in small fragments, and headers that never finish."""
+  for size in (1, 3, 7, 16):
+    sock = connect(args)
+    raw = request('/json')
+    for i in range(0, len(raw), size):
+      sock.sendall(raw[i:i + size])
+      time.sleep(args.delay)
+    data = read_response(sock)
+    sock.close()
+    print('fragments of %d bytes: status %d, %d bytes' % (size, status(data), len(data)))
+
+  socks = []
+  for _ in range(args.clients):
+    sock = connect(args)
+    sock.sendall(b'GET /json HTTP/1.1\r\nHost: heish')
+    socks.append(sock)
+  print('%d unfinished requests open, device answers meanwhile: %s' % (len(socks), alive(args)))
+  for sock in socks:
+    sock.close()
+  print('device answers afterwards: %s' % alive(args))
+
+
+def run_pipeline(args):
+  """Several requests in one write, counts the responses that come back."""
+  for depth in (2, 4, 8):
+    sock = connect(args)
+    # only the last request asks to close the connection afterwards
+    paths = [random.choice(args.paths) for _ in range(depth)]
+    sock.sendall(b''.join(request(path, b'') for path in paths[:-1]) + request(paths[-1]))
+    data = read_response(sock)
+    sock.close()
+    print('pipelined %d requests: %d responses' % (depth, data.count(b'HTTP/1.1 ')))
+  print('device answers afterwards: %s' % alive(args))
+
+
+def multipart(name, filename, content, boundary):
+  return (b'--' + boundary + b'\r\n' +
+          b'Content-Disposition: form-data; name="' + name + b'"; filename="' + filename + b'"\r\n' +
+          b'Content-Type: text/plain\r\n\r\n' + content + b'\r\n--' + boundary + b'--\r\n')
+
+
+def post(args, path, payload, boundary):
+  sock = connect(args)
+  try:
+    sock.sendall(b'POST ' + path.encode() + b' HTTP/1.1\r\nHost: heishamon\r\n' +
+                 b'Content-Type: multipart/form-data; boundary=' + boundary + b'\r\n' +
+                 b'Content-Length: ' + str(len(payload)).encode() + b'\r\n\r\n' + payload)
+    return read_response(sock)
+  finally:
+    sock.close()
+
+
+def run_upload(args):
+  with open(args.rules, 'rb') as f:
+    rules = f.read()
+  boundary = b'----heishamon' + str(random.randint(0, 1 << 30)).encode()
+  start = time.time()
+  data = post(args, '/saverules', multipart(b'rules', b'rules.txt', rules, boundary), boundary)
+  print('uploaded %d bytes: status %d in %.1fs' % (len(rules), status(data), time.time() - start))
+
+
+def mutate(raw):
+  raw = bytearray(raw)
+  for _ in range(random.randint(1, 8)):
+    op = random.randint(0, 3)
+    pos = random.randint(0, max(0, len(raw) - 1))
+    if op == 0 and raw:
+      raw[pos] = random.randint(0, 255)
+    elif op == 1:
+      raw[pos:pos] = bytes(random.randint(0, 255) for _ in range(random.randint(1, 64)))
+    elif op == 2 and raw:
+      del raw[pos:pos + random.randint(1, 16)]
+    else:
+      raw[pos:pos] = random.choice([b'\r\n', b'\r\n\r\n', b'%', b'&', b'=', b'?', b'"', b'--', b'\x00', b'A' * 300])
+  return bytes(raw)
+
+
+def run_fuzz(args):
+  """Mangled headers and arguments of a read only page, or mangled multipart bodies."""
+  boundary = b'----heishamonfuzz'
+  failures = 0
+  for nr in range(args.cases):
+    if args.multipart:
+      payload = mutate(multipart(b'rules', b'rules.txt', b'on @Heatpump_State then\n  #x = 1;\nend\n', boundary))
+      raw = (b'POST /saverules HTTP/1.1\r\nHost: heishamon\r\n' +
+             b'Content-Type: multipart/form-data; boundary=' + boundary + b'\r\n' +
+             b'Content-Length: ' + str(len(payload)).encode() + b'\r\n\r\n' + payload)
+    else:
+      # the path stays fixed, so a mutation can't reach /reboot or /factoryreset
+      headers = b'Host: heishamon\r\nConnection: close\r\nAccept-Encoding: gzip\r\nIf-None-Match: "00000000"\r\n\r\n'
+      raw = b'GET /json?' + mutate(b'1wire&s0=1') + b' HTTP/1.1\r\n' + mutate(headers)
+    try:
+      sock = connect(args)
+      # a mangled request may keep the connection open
+      sock.settimeout(min(args.timeout, 2))
+      sock.sendall(raw)
+      read_response(sock)
+      sock.close()
+    except OSError:
+      pass
+    if nr % 10 == 9 and not alive(args):
+      failures += 1
+      print('case %d left the device unresponsive: %r' % (nr, raw))
+      time.sleep(5)
+  print('%d cases, %d failures' % (args.cases, failures))
+
+
+def report(args):
+  try:
+    stats = json.loads(body(get(args, '/stats')).decode(errors='replace'))
+    metrics = body(get(args, '/metrics')).decode(errors='replace')
+  except (OSError, ValueError):
+    print('no /stats or /metrics available')
+    return
+
+  print()
+  print('%-22s %9s %8s %8s %9s' % ('route', 'requests', 'avg ms', 'max ms', 'max heap'))
+  for route in stats:
+    if route['requests'] > 0:
+      print('%-22s %9d %8d %8d %9d' % (route['route'], route['requests'], route['avg_ms'], route['max_ms'], route.get('max_heap', 0)))
+
+  for line in metrics.splitlines():
+    for name in ('heishamon_free_heap_bytes ', 'heishamon_max_free_block_bytes ', 'heishamon_stack_free_min_bytes '):
+      if line.startswith(name):
+        print(line)
+
+
+def main():
+  parser = argparse.ArgumentParser(description='Load and robustness test for the HeishaMon webserver')
+  parser.add_argument('host')
+  parser.add_argument('mode', choices=['load', 'slow', 'partial', 'pipeline', 'fuzz', 'upload'])
+  parser.add_argument('--port', type=int, default=80)
+  parser.add_argument('--clients', type=int, default=4)
+  parser.add_argument('--keepalive', action='store_true', help='load: reuse connections between requests')
+  parser.add_argument('--seconds', type=int, default=30)
+  parser.add_argument('--delay', type=float, default=0.05, help='seconds between bytes or fragments')
+  parser.add_argument('--timeout', type=float, default=10)
+  parser.add_argument('--paths', nargs='+', default=SAFE_PATHS)
+  parser.add_argument('--cases', type=int, default=200)
+  parser.add_argument('--multipart', action='store_true', help='fuzz multipart uploads to /saverules')
+  parser.add_argument('--rules', help='ruleset to upload')
+  args = parser.parse_args()
+
+  if args.mode == 'upload' and not args.rules:
+    parser.error('upload needs --rules')
+
+  {
+    'load': run_load,
+    'slow': run_slow,
+    'partial': run_partial,
+    'pipeline': run_pipeline,
+    'fuzz': run_fuzz,
+    'upload': run_upload,
+  }[args.mode](args)
+  report(args)
+
+
+if __name__ == '__main__':
+  main()
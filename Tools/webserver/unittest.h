@@ -0,0 +1,58 @@
+/*
+  Copyright (C) CurlyMo
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/*
+ * What the webserver needs from the Arduino core
+ * and lwip when it's build on a host. Flash strings
+ * are plain strings there, the clock and the tcp
+ * functions are provided by webserver_host.cpp.
+ */
+
+#ifndef _UNITTEST_H_
+#define _UNITTEST_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef char __FlashStringHelper;
+
+#ifndef PSTR
+  #define PSTR(a) (a)
+#endif
+#ifndef F
+  #define F(a) (a)
+#endif
+
+#define memcmp_P memcmp
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define strncmp_P strncmp
+#define strcpy_P strcpy
+#define strstr_P strstr
+#define sprintf_P sprintf
+#define snprintf_P snprintf
+
+#define TCP_WRITE_FLAG_COPY 0x01
+#define TCP_WRITE_FLAG_MORE 0x02
+
+unsigned long millis(void);
+unsigned long micros(void);
+
+/*
+ * Only used by async clients, which
+ * the host harness doesn't create.
+ */
+int tcp_write(struct tcp_pcb *pcb, const void *data, uint16_t len, uint8_t flags);
+uint16_t tcp_write_P(struct tcp_pcb *pcb, const unsigned char *buf, uint16_t len, uint8_t flags);
+int tcp_output(struct tcp_pcb *pcb);
+uint16_t tcp_sndbuf(struct tcp_pcb *pcb);
+void tcp_recved(struct tcp_pcb *pcb, uint16_t len);
+uint8_t pbuf_free(struct pbuf *p);
+
+#endif
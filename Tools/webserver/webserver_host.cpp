@@ -0,0 +1,1350 @@
+/*
+  Copyright (C) CurlyMo
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/*
+ * Runs the webserver core on a host instead of on the ESP8266:
+ *
+ *   webserver_host load [clients] [requests]
+ *   webserver_host pipeline [clients] [requests] [depth]
+ *   webserver_host slow [clients] [requests] [rate]
+ *   webserver_host partial [clients] [requests] [stuck]
+ *   webserver_host multipart [clients] [uploads] [size]
+ *   webserver_host mutate [seed] [count] [file]
+ *   webserver_host fuzz <file> ...
+ *
+ * The load modes drive webserver_loop() with simulated sync
+ * clients, through the WiFiClient function pointers of the
+ * __linux__ path in webserver.h. Each loop is one millisecond
+ * of device time. The requests are spread over the clients,
+ * which may be more than WEBSERVER_MAX_CLIENTS. The responses
+ * are parsed and checked against the expected status and
+ * length.
+ *
+ * load sends keep-alive requests one after another. pipeline
+ * sends depth requests at once. slow clients take rate bytes
+ * per millisecond, a write that doesn't fit their 2920 bytes
+ * receive window blocks the loop like WiFiClient::write does.
+ * partial clients send their requests a few bytes at a time,
+ * stuck of the requests stop halfway through the header and
+ * have to time out. multipart uploads files of size bytes,
+ * the route checks every byte it gets.
+ *
+ * Afterwards the requests per second, the allocations and
+ * bytes per request, the most heap in use at once and the
+ * stack high-water of a webserver_loop() call are printed.
+ * Sizes are those of the host, pointers take twice the room
+ * they take on the ESP8266.
+ *
+ * mutate feeds random mutations of a few valid requests to
+ * the entry point libFuzzer uses. With a file each input is
+ * written to it before it runs, so the one that crashed can
+ * be replayed with fuzz. fuzz replays files through
+ * it, so inputs found by AFL (afl-fuzz -i in -o out --
+ * webserver_host fuzz @@) or libFuzzer can be replayed. The
+ * first byte of an input picks the parser and the size of
+ * the pieces the rest is fed in.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+/*
+ * Heap use of the webserver is counted by
+ * replacing its allocation functions.
+ */
+typedef struct host_heap_t {
+  unsigned long allocs;
+  unsigned long bytes;
+  unsigned long live;
+  unsigned long peak;
+} host_heap_t;
+
+static struct host_heap_t heap;
+
+#define HOST_HEAP_HDR 16
+
+static void *host_malloc(size_t size) {
+  unsigned char *p = (unsigned char *)malloc(size + HOST_HEAP_HDR);
+  if(p == NULL) {
+    return NULL;
+  }
+  *(size_t *)p = size;
+  heap.allocs++;
+  heap.bytes += size;
+  heap.live += size;
+  if(heap.live > heap.peak) {
+    heap.peak = heap.live;
+  }
+  return &p[HOST_HEAP_HDR];
+}
+
+static void host_free(void *ptr) {
+  if(ptr == NULL) {
+    return;
+  }
+  unsigned char *p = (unsigned char *)ptr - HOST_HEAP_HDR;
+  heap.live -= *(size_t *)p;
+  free(p);
+}
+
+static void *host_realloc(void *ptr, size_t size) {
+  unsigned char *p = NULL;
+  size_t old = 0;
+
+  if(ptr == NULL) {
+    return host_malloc(size);
+  }
+  p = (unsigned char *)ptr - HOST_HEAP_HDR;
+  old = *(size_t *)p;
+  if((p = (unsigned char *)realloc(p, size + HOST_HEAP_HDR)) == NULL) {
+    return NULL;
+  }
+  *(size_t *)p = size;
+  heap.allocs++;
+  heap.bytes += size;
+  heap.live = heap.live - old + size;
+  if(heap.live > heap.peak) {
+    heap.peak = heap.live;
+  }
+  return &p[HOST_HEAP_HDR];
+}
+
+static char *host_strdup(const char *str) {
+  size_t len = strlen(str);
+  char *p = (char *)host_malloc(len + 1);
+  if(p != NULL) {
+    memcpy(p, str, len + 1);
+  }
+  return p;
+}
+
+#define malloc host_malloc
+#define realloc host_realloc
+#define free host_free
+#define strdup host_strdup
+
+/*
+ * Included instead of linked, so the harness can
+ * allocate the read buffer and close clients the
+ * way the ESP8266 parts of it do.
+ */
+#include "../../HeishaMon/src/common/webserver.cpp"
+
+#undef malloc
+#undef realloc
+#undef free
+#undef strdup
+
+#define HOST_WINDOW       2920
+#define HOST_CLIENTS_MAX  64
+#define HOST_EXPECT_MAX   16
+#define HOST_LINE_MAX     256
+#define HOST_TICKS_MAX    50000000UL
+#define HOST_STACK_PAINT  16384
+#define HOST_STACK_BYTE   0xa5
+#define HOST_BOUNDARY     "----hostboundary"
+#define HOST_INPUT_MAX    65536
+
+enum {
+  HOST_GET_ROOT = 0,
+  HOST_GET_JSON,
+  HOST_GET_SMALL,
+  HOST_GET_MISSING,
+  HOST_POST_UPLOAD,
+  HOST_STUCK
+};
+
+enum {
+  ROUTE_HOST_NONE = 0,
+  ROUTE_HOST_ROOT,
+  ROUTE_HOST_JSON,
+  ROUTE_HOST_SMALL,
+  ROUTE_HOST_UPLOAD
+};
+
+enum {
+  RESP_HEAD = 0,
+  RESP_BODY,
+  RESP_CHUNK,
+  RESP_CHUNK_DATA,
+  RESP_CHUNK_END,
+  RESP_TRAILER,
+  RESP_UNTIL_CLOSE
+};
+
+typedef struct host_expect_t {
+  int kind;
+  int status;
+  unsigned long len;
+} host_expect_t;
+
+/*
+ * A simulated browser. It holds at most one
+ * connection, the slot it takes in clients[].
+ */
+typedef struct host_client_t {
+  int slot;
+  int done;
+  int hangup;
+  int sink;
+
+  /*
+   * Bytes sent to the webserver
+   */
+  unsigned char *stream;
+  unsigned long stream_len;
+  unsigned long stream_pos;
+  unsigned long stream_size;
+  int feed;
+  int every;
+
+  /*
+   * Bytes written to the client that
+   * it didn't take yet.
+   */
+  unsigned long queued;
+  int rate;
+
+  int todo;
+  int depth;
+  int stuck;
+  struct host_expect_t expect[HOST_EXPECT_MAX];
+  int nrexpect;
+
+  /*
+   * Parser of the responses
+   */
+  int state;
+  int status;
+  int chunked;
+  long length;
+  unsigned long body;
+  unsigned long got;
+  char line[HOST_LINE_MAX];
+  int linelen;
+} host_client_t;
+
+typedef struct host_opts_t {
+  int clients;
+  int requests;
+  int depth;
+  int rate;
+  int feed;
+  int every;
+  int stuck;
+  int upload;
+} host_opts_t;
+
+typedef struct host_stats_t {
+  unsigned long answered;
+  unsigned long bad;
+  unsigned long retried;
+  unsigned long timedout;
+  unsigned long accepted;
+  unsigned long blocked;
+  unsigned long stack;
+} host_stats_t;
+
+typedef struct host_upload_t {
+  unsigned long received;
+  int mismatch;
+} host_upload_t;
+
+static struct WiFiClient wifi[WEBSERVER_MAX_CLIENTS];
+static struct host_client_t *slots[WEBSERVER_MAX_CLIENTS];
+static struct host_client_t hosts[HOST_CLIENTS_MAX];
+static struct host_stats_t stats;
+static unsigned long now = 0;
+static unsigned long ticks = 0;
+static int upload_size = 0;
+static int verbose = 0;
+
+static const char *page[] = {
+  "<!DOCTYPE html><html><head><title>HeishaMon</title>"
+  "<meta name=\"viewport\" content=\"width=device-width, initial-scale=1\">"
+  "<link rel=\"stylesheet\" href=\"/css\"></head><body>",
+  "<div class=\"w3-sidebar w3-bar-block w3-card w3-animate-left\" style=\"display:none\" id=\"leftMenu\">"
+  "<a href=\"/\" class=\"w3-bar-item w3-button\">Home</a>"
+  "<a href=\"/reboot\" class=\"w3-bar-item w3-button\">Reboot</a>"
+  "<a href=\"/firmware\" class=\"w3-bar-item w3-button\">Firmware</a>"
+  "<a href=\"/settings\" class=\"w3-bar-item w3-button\">Settings</a>"
+  "<a href=\"/rules\" class=\"w3-bar-item w3-button\">Rules</a></div>",
+  "<div class=\"w3-container w3-center\"><h2>Current heatpump values</h2>"
+  "<table class=\"w3-table-all\"><thead><tr class=\"w3-red\"><th>Topic</th><th>Name</th>"
+  "<th>Value</th><th>Description</th></tr></thead><tbody id=\"heishavalues\"></tbody></table></div>",
+  "<script src=\"/js\"></script></body></html>"
+};
+
+#define HOST_JSON_RECORDS 24
+
+static const char small[] = "Hello world\n";
+static const char missing[] = "404 Not found";
+
+unsigned long millis(void) {
+  return now;
+}
+
+unsigned long micros(void) {
+  return now * 1000;
+}
+
+int tcp_write(struct tcp_pcb *, const void *, uint16_t, uint8_t) {
+  return -1;
+}
+
+uint16_t tcp_write_P(struct tcp_pcb *, const unsigned char *, uint16_t, uint8_t) {
+  return 0;
+}
+
+int tcp_output(struct tcp_pcb *) {
+  return 0;
+}
+
+uint16_t tcp_sndbuf(struct tcp_pcb *) {
+  return 0;
+}
+
+void tcp_recved(struct tcp_pcb *, uint16_t) {
+}
+
+uint8_t pbuf_free(struct pbuf *) {
+  return 0;
+}
+
+void log_message(char *string) {
+  if(verbose == 1) {
+    printf("%lu: %s\n", now, string);
+  }
+}
+
+void log_message(const __FlashStringHelper *msg) {
+  if(verbose == 1) {
+    printf("%lu: %s\n", now, msg);
+  }
+}
+
+static double host_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int host_json_record(int i, char *out, int size) {
+  return snprintf(out, size, "%s{\"Topic\":\"TOP%d\",\"Name\":\"Value_%02d\",\"Value\":\"%d\"}",
+    (i == 0) ? "[" : ",", i, i, (i * 37) % 1000);
+}
+
+static unsigned long host_body_len(int kind) {
+  unsigned long len = 0;
+  char tmp[128];
+  unsigned int i = 0;
+
+  switch(kind) {
+    case HOST_GET_ROOT: {
+      for(i=0;i<sizeof(page)/sizeof(page[0]);i++) {
+        len += strlen(page[i]);
+      }
+    } break;
+    case HOST_GET_JSON: {
+      for(i=0;i<HOST_JSON_RECORDS;i++) {
+        len += host_json_record(i, tmp, sizeof(tmp));
+      }
+      len += 1;
+    } break;
+    case HOST_GET_SMALL: {
+      len = strlen(small);
+    } break;
+    case HOST_GET_MISSING: {
+      len = strlen(missing);
+    } break;
+    case HOST_POST_UPLOAD: {
+      len = 2;
+    } break;
+  }
+  return len;
+}
+
+static unsigned char host_upload_byte(unsigned long i) {
+  if((i % 64) == 62) {
+    return '\r';
+  }
+  if((i % 64) == 63) {
+    return '\n';
+  }
+  return 'a' + ((i * 7) % 26);
+}
+
+/*
+ * The routes behave like those of HeishaMon.ino: a
+ * page sent in steps from flash, a json document
+ * copied from the stack, a response of a known length
+ * and an upload streamed into the callback.
+ */
+static int8_t host_callback(struct webserver_t *client, void *data) {
+  switch(client->step) {
+    case WEBSERVER_CLIENT_REQUEST_URI: {
+      char *uri = (char *)data;
+      if(strcmp(uri, "/") == 0) {
+        client->route = ROUTE_HOST_ROOT;
+      } else if(strcmp(uri, "/json") == 0) {
+        client->route = ROUTE_HOST_JSON;
+      } else if(strcmp(uri, "/small") == 0) {
+        client->route = ROUTE_HOST_SMALL;
+      } else if(strcmp(uri, "/upload") == 0) {
+        client->route = ROUTE_HOST_UPLOAD;
+        struct host_upload_t *upload = (struct host_upload_t *)host_malloc(sizeof(struct host_upload_t));
+        if(upload == NULL) {
+          return -1;
+        }
+        memset(upload, 0, sizeof(struct host_upload_t));
+        client->userdata = upload;
+      } else {
+        client->route = ROUTE_HOST_NONE;
+      }
+    } break;
+    case WEBSERVER_CLIENT_ARGS: {
+      struct arguments_t *args = (struct arguments_t *)data;
+      if(client->route == ROUTE_HOST_UPLOAD && client->userdata != NULL &&
+        strcmp((char *)args->name, "file") == 0) {
+        struct host_upload_t *upload = (struct host_upload_t *)client->userdata;
+        uint16_t i = 0;
+        for(i=0;i<args->len;i++) {
+          if(args->value[i] != host_upload_byte(upload->received + i)) {
+            upload->mismatch = 1;
+          }
+        }
+        upload->received += args->len;
+      }
+    } break;
+    case WEBSERVER_CLIENT_CREATE_HEADER: {
+      struct header_t *header = (struct header_t *)data;
+      if(client->route != ROUTE_HOST_NONE) {
+        header->ptr += sprintf((char *)header->buffer, "Access-Control-Allow-Origin: *");
+      }
+    } break;
+    case WEBSERVER_CLIENT_WRITE: {
+      switch(client->route) {
+        case ROUTE_HOST_ROOT: {
+          if(client->content == 0) {
+            webserver_send(client, 200, (char *)"text/html", 0);
+          }
+          if(client->content < sizeof(page)/sizeof(page[0])) {
+            webserver_send_content_P(client, (PGM_P)page[client->content], strlen(page[client->content]));
+          }
+        } break;
+        case ROUTE_HOST_JSON: {
+          char tmp[128];
+          int n = 0;
+          if(client->content == 0) {
+            webserver_send(client, 200, (char *)"application/json", 0);
+          }
+          if(client->content < HOST_JSON_RECORDS) {
+            n = host_json_record(client->content, tmp, sizeof(tmp));
+            webserver_send_content(client, tmp, n);
+          } else if(client->content == HOST_JSON_RECORDS) {
+            webserver_send_content_P(client, (PGM_P)"]", 1);
+          }
+        } break;
+        case ROUTE_HOST_SMALL: {
+          if(client->content == 0) {
+            webserver_send(client, 200, (char *)"text/plain", strlen(small));
+            webserver_send_content_P(client, (PGM_P)small, strlen(small));
+          }
+        } break;
+        case ROUTE_HOST_UPLOAD: {
+          if(client->content == 0) {
+            struct host_upload_t *upload = (struct host_upload_t *)client->userdata;
+            if(upload != NULL && upload->mismatch == 0 && upload->received == (unsigned long)upload_size) {
+              webserver_send(client, 200, (char *)"text/plain", 2);
+              webserver_send_content_P(client, (PGM_P)"ok", 2);
+            } else {
+              webserver_send(client, 400, (char *)"text/plain", 2);
+              webserver_send_content_P(client, (PGM_P)"no", 2);
+            }
+            if(upload != NULL) {
+              host_free(upload);
+            }
+            client->userdata = NULL;
+          }
+        } break;
+        default: {
+          if(client->content == 0) {
+            webserver_send(client, 404, (char *)"text/plain", strlen(missing));
+            webserver_send_content_P(client, (PGM_P)missing, strlen(missing));
+          }
+        } break;
+      }
+    } break;
+    case WEBSERVER_CLIENT_CLOSE: {
+      if(client->route == ROUTE_HOST_UPLOAD && client->userdata != NULL) {
+        host_free(client->userdata);
+      }
+      client->userdata = NULL;
+    } break;
+  }
+  return 0;
+}
+
+static void host_stream_append(struct host_client_t *host, const void *data, unsigned long len) {
+  if(host->stream_len + len > host->stream_size) {
+    host->stream_size = (host->stream_len + len) * 2;
+    if((host->stream = (unsigned char *)realloc(host->stream, host->stream_size)) == NULL) {
+      fprintf(stderr, "out of memory\n");
+      exit(1);
+    }
+  }
+  memcpy(&host->stream[host->stream_len], data, len);
+  host->stream_len += len;
+}
+
+static void host_request(struct host_client_t *host, int kind) {
+  char buf[512];
+  int n = 0;
+  const char *uri = "/";
+
+  switch(kind) {
+    case HOST_GET_JSON: uri = "/json?refresh=1&sort=topic"; break;
+    case HOST_GET_SMALL: uri = "/small"; break;
+    case HOST_GET_MISSING: uri = "/favicon.ico"; break;
+  }
+
+  if(kind == HOST_POST_UPLOAD) {
+    char head[256];
+    int h = snprintf(head, sizeof(head),
+      "--" HOST_BOUNDARY "\r\n"
+      "Content-Disposition: form-data; name=\"file\"; filename=\"rules.txt\"\r\n"
+      "Content-Type: text/plain\r\n\r\n");
+    const char *tail = "\r\n--" HOST_BOUNDARY "--\r\n";
+    unsigned long len = h + upload_size + strlen(tail), i = 0;
+
+    n = snprintf(buf, sizeof(buf),
+      "POST /upload HTTP/1.1\r\n"
+      "Host: heishamon.local\r\n"
+      "Content-Type: multipart/form-data; boundary=" HOST_BOUNDARY "\r\n"
+      "Content-Length: %lu\r\n\r\n", len);
+    host_stream_append(host, buf, n);
+    host_stream_append(host, head, h);
+    for(i=0;i<(unsigned long)upload_size;i++) {
+      unsigned char c = host_upload_byte(i);
+      host_stream_append(host, &c, 1);
+    }
+    host_stream_append(host, tail, strlen(tail));
+  } else if(kind == HOST_STUCK) {
+    n = snprintf(buf, sizeof(buf), "GET /json HTTP/1.1\r\nHost: heisha");
+    host_stream_append(host, buf, n);
+  } else {
+    n = snprintf(buf, sizeof(buf),
+      "GET %s HTTP/1.1\r\n"
+      "Host: heishamon.local\r\n"
+      "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 Firefox/128.0\r\n"
+      "Accept: */*\r\n"
+      "Accept-Encoding: gzip, deflate\r\n"
+      "Connection: keep-alive\r\n\r\n", uri);
+    host_stream_append(host, buf, n);
+  }
+
+  host->expect[host->nrexpect].kind = kind;
+  host->expect[host->nrexpect].status = (kind == HOST_GET_MISSING) ? 404 : 200;
+  host->expect[host->nrexpect].len = host_body_len(kind);
+  host->nrexpect++;
+}
+
+static void host_response_reset(struct host_client_t *host) {
+  host->state = RESP_HEAD;
+  host->status = 0;
+  host->chunked = 0;
+  host->length = -1;
+  host->body = 0;
+  host->got = 0;
+  host->linelen = 0;
+}
+
+static void host_response_done(struct host_client_t *host) {
+  struct host_expect_t *e = &host->expect[0];
+
+  if(host->nrexpect == 0) {
+    if(verbose == 1) {
+      printf("%lu: response %d without a request\n", now, host->status);
+    }
+    stats.bad++;
+  } else {
+    if(host->status != e->status || host->body != e->len) {
+      if(verbose == 1) {
+        printf("%lu: response %d of %lu bytes, expected %d of %lu\n",
+          now, host->status, host->body, e->status, e->len);
+      }
+      stats.bad++;
+    }
+    stats.answered++;
+    host->nrexpect--;
+    memmove(&host->expect[0], &host->expect[1], sizeof(struct host_expect_t) * host->nrexpect);
+  }
+  host_response_reset(host);
+}
+
+/*
+ * Returns 1 once a full line is collected
+ */
+static int host_line(struct host_client_t *host, unsigned char c) {
+  if(c == '\n') {
+    if(host->linelen > 0 && host->line[host->linelen-1] == '\r') {
+      host->linelen--;
+    }
+    host->line[host->linelen] = 0;
+    host->linelen = 0;
+    return 1;
+  }
+  if(host->linelen < HOST_LINE_MAX-1) {
+    host->line[host->linelen++] = c;
+  }
+  return 0;
+}
+
+static void host_response(struct host_client_t *host, unsigned char *buf, unsigned long len) {
+  unsigned long i = 0;
+
+  for(i=0;i<len;i++) {
+    unsigned char c = buf[i];
+    host->got++;
+    switch(host->state) {
+      case RESP_HEAD: {
+        if(host_line(host, c) == 0) {
+          break;
+        }
+        if(host->status == 0) {
+          if(sscanf(host->line, "HTTP/1.1 %d", &host->status) != 1) {
+            host->status = -1;
+          }
+        } else if(host->line[0] == 0) {
+          if(host->chunked == 1) {
+            host->state = RESP_CHUNK;
+          } else if(host->length > 0) {
+            host->state = RESP_BODY;
+          } else if(host->length == 0) {
+            host_response_done(host);
+          } else {
+            host->state = RESP_UNTIL_CLOSE;
+          }
+        } else if(strncasecmp(host->line, "Content-Length:", 15) == 0) {
+          host->length = atol(&host->line[15]);
+        } else if(strncasecmp(host->line, "Transfer-Encoding:", 18) == 0 && strstr(host->line, "chunked") != NULL) {
+          host->chunked = 1;
+        }
+      } break;
+      case RESP_BODY: {
+        host->body++;
+        if((long)host->body == host->length) {
+          host_response_done(host);
+        }
+      } break;
+      case RESP_CHUNK: {
+        if(host_line(host, c) == 1) {
+          char *end = NULL;
+          host->length = strtol(host->line, &end, 16);
+          if(end == host->line || host->length < 0) {
+            host->status = -1;
+            host->state = RESP_UNTIL_CLOSE;
+          } else if(host->length == 0) {
+            host->state = RESP_TRAILER;
+          } else {
+            host->state = RESP_CHUNK_DATA;
+          }
+        }
+      } break;
+      case RESP_CHUNK_DATA: {
+        host->body++;
+        if(--host->length == 0) {
+          host->state = RESP_CHUNK_END;
+        }
+      } break;
+      case RESP_CHUNK_END: {
+        if(host_line(host, c) == 1) {
+          if(host->line[0] != 0) {
+            host->status = -1;
+            host->state = RESP_UNTIL_CLOSE;
+          } else {
+            host->state = RESP_CHUNK;
+          }
+        }
+      } break;
+      case RESP_TRAILER: {
+        if(host_line(host, c) == 1 && host->line[0] == 0) {
+          host_response_done(host);
+        }
+      } break;
+      case RESP_UNTIL_CLOSE: {
+        host->body++;
+      } break;
+    }
+  }
+}
+
+static int host_write(int slot, unsigned char *buf, int len) {
+  struct host_client_t *host = slots[slot];
+
+  if(host == NULL || host->hangup == 1 || len <= 0) {
+    return 0;
+  }
+  if(host->sink == 1) {
+    return len;
+  }
+  /*
+   * A write that doesn't fit the window of a
+   * slow reader waits until it does.
+   */
+  if(host->rate > 0) {
+    unsigned long room = (host->queued < HOST_WINDOW) ? HOST_WINDOW - host->queued : 0;
+    if((unsigned long)len > room) {
+      unsigned long ms = ((len - room) + host->rate - 1) / host->rate;
+      now += ms;
+      stats.blocked += ms;
+      host->queued = (host->queued > ms * host->rate) ? host->queued - ms * host->rate : 0;
+    }
+    host->queued += len;
+  }
+  host_response(host, buf, len);
+  return len;
+}
+
+static int host_available(int slot) {
+  struct host_client_t *host = slots[slot];
+
+  if(host == NULL || host->stream_pos >= host->stream_len) {
+    return 0;
+  }
+  if(host->every > 1 && (ticks % host->every) != 0) {
+    return 0;
+  }
+  return host->stream_len - host->stream_pos;
+}
+
+static int host_connected(int slot) {
+  struct host_client_t *host = slots[slot];
+
+  return (host != NULL && host->hangup == 0);
+}
+
+static int host_read(int slot, uint8_t *buf, int size) {
+  struct host_client_t *host = slots[slot];
+  int n = host_available(slot);
+
+  if(n > size) {
+    n = size;
+  }
+  if(host != NULL && host->feed > 0 && n > host->feed) {
+    n = 1 + (ticks % host->feed);
+  }
+  if(n > 0) {
+    memcpy(buf, &host->stream[host->stream_pos], n);
+    host->stream_pos += n;
+  }
+  return n;
+}
+
+/*
+ * The WiFiClient functions don't know the client
+ * they belong to, so each slot gets its own.
+ */
+template<int N> struct host_slot {
+  static int write(unsigned char *buf, int len) {
+    return host_write(N, buf, len);
+  }
+  static int write_P(const char *buf, int len) {
+    return host_write(N, (unsigned char *)buf, len);
+  }
+  static int available(void) {
+    return host_available(N);
+  }
+  static int connected(void) {
+    return host_connected(N);
+  }
+  static int read(uint8_t *buf, int size) {
+    return host_read(N, buf, size);
+  }
+  static void bind(struct WiFiClient *list) {
+    list[N].write = write;
+    list[N].write_P = write_P;
+    list[N].available = available;
+    list[N].connected = connected;
+    list[N].read = read;
+    host_slot<N-1>::bind(list);
+  }
+};
+
+template<> struct host_slot<-1> {
+  static void bind(struct WiFiClient *) {
+  }
+};
+
+/*
+ * What the ESP8266 parts of webserver_client_close
+ * do, the host path only tells the callback.
+ */
+static void host_disconnect(int slot) {
+  struct host_client_t *host = slots[slot];
+  struct webserver_t *client = &clients[slot].data;
+
+  webserver_client_close(client);
+  webserver_reset_client(client);
+  client->client = NULL;
+  slots[slot] = NULL;
+
+  if(host == NULL) {
+    return;
+  }
+  host->slot = -1;
+
+  if(host->state == RESP_UNTIL_CLOSE) {
+    host_response_done(host);
+  } else if(host->nrexpect > 0 && host->expect[0].kind == HOST_STUCK) {
+    stats.timedout++;
+    host->nrexpect--;
+    memmove(&host->expect[0], &host->expect[1], sizeof(struct host_expect_t) * host->nrexpect);
+  } else if(host->got > 0) {
+    if(verbose == 1) {
+      printf("%lu: connection closed in a response\n", now);
+    }
+    stats.bad++;
+  }
+  /*
+   * Requests not answered are sent again
+   * on a new connection, like browsers do.
+   */
+  if(host->nrexpect > 0) {
+    stats.retried += host->nrexpect;
+    host->todo += host->nrexpect;
+    host->nrexpect = 0;
+  }
+  host->stream_len = 0;
+  host->stream_pos = 0;
+  host->queued = 0;
+  host->hangup = 0;
+  host_response_reset(host);
+  if(host->todo == 0) {
+    host->done = 1;
+  }
+}
+
+static void host_close_sweep(void) {
+  int i = 0;
+
+  for(i=0;i<WEBSERVER_MAX_CLIENTS;i++) {
+    if(clients[i].data.client != NULL && clients[i].data.step == WEBSERVER_CLIENT_CLOSE) {
+      host_disconnect(i);
+    }
+  }
+}
+
+/*
+ * Like the accept at the end of webserver_loop
+ * on the ESP8266.
+ */
+static int host_accept(struct host_client_t *host) {
+  int i = 0;
+
+  webserver_make_room(0);
+  host_close_sweep();
+  for(i=0;i<WEBSERVER_MAX_CLIENTS;i++) {
+    if(clients[i].data.client == NULL) {
+      webserver_reset_client(&clients[i].data);
+      clients[i].data.client = &wifi[i];
+      clients[i].data.async = 0;
+      clients[i].data.lastseen = millis();
+      clients[i].data.step = WEBSERVER_CLIENT_CONNECTING;
+      slots[i] = host;
+      host->slot = i;
+      stats.accepted++;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+static void host_setup(void) {
+  int i = 0;
+
+  host_slot<WEBSERVER_MAX_CLIENTS-1>::bind(wifi);
+  if(rbuffer == NULL) {
+    rbuffer = (uint8_t *)malloc(WEBSERVER_READ_SIZE);
+  }
+  for(i=0;i<WEBSERVER_MAX_CLIENTS;i++) {
+    if(clients[i].data.client != NULL) {
+      webserver_reset_client(&clients[i].data);
+      clients[i].data.client = NULL;
+    }
+    webserver_reset_client(&clients[i].data);
+    clients[i].data.callback = host_callback;
+    clients[i].data.async = 0;
+    slots[i] = NULL;
+  }
+}
+
+#if defined(__SANITIZE_ADDRESS__)
+  #define HOST_STACK 0
+#elif defined(__has_feature)
+  #if __has_feature(address_sanitizer)
+    #define HOST_STACK 0
+  #endif
+#endif
+#ifndef HOST_STACK
+  #define HOST_STACK 1
+#endif
+
+#if HOST_STACK == 1
+static uintptr_t stack_low = 0;
+static uintptr_t stack_top = 0;
+
+/*
+ * The stack below the caller is painted before each
+ * webserver_loop(), the deepest byte changed is how
+ * far the loop went.
+ */
+static void __attribute__((noinline)) host_stack_paint(void) {
+  unsigned char buf[HOST_STACK_PAINT];
+  memset(buf, HOST_STACK_BYTE, sizeof(buf));
+  __asm__ volatile("" : : "r"(buf) : "memory");
+  stack_low = (uintptr_t)buf;
+}
+
+static unsigned long __attribute__((noinline)) host_stack_used(void) {
+  volatile unsigned char *p = (volatile unsigned char *)stack_low;
+
+  while((uintptr_t)p < stack_top && *p == HOST_STACK_BYTE) {
+    p++;
+  }
+  return stack_top - (uintptr_t)p;
+}
+#endif
+
+static void __attribute__((noinline)) host_loop(void) {
+  unsigned char top = 0;
+
+#if HOST_STACK == 1
+  stack_top = (uintptr_t)&top;
+  host_stack_paint();
+  webserver_loop();
+  unsigned long used = host_stack_used();
+  if(used > stats.stack) {
+    stats.stack = used;
+  }
+#else
+  (void)top;
+  webserver_loop();
+#endif
+}
+
+static int host_load(const char *mode, struct host_opts_t *opts) {
+  int i = 0, n = 0, busy = 1;
+  double start = 0, secs = 0;
+
+  host_setup();
+  memset(&stats, 0, sizeof(stats));
+  memset(&hosts, 0, sizeof(hosts));
+  memset(&heap, 0, sizeof(heap));
+  heap.live = heap.peak = 0;
+  upload_size = opts->upload;
+  now = 0;
+  ticks = 0;
+
+  if(opts->clients < 1 || opts->clients > HOST_CLIENTS_MAX) {
+    fprintf(stderr, "clients must be between 1 and %d\n", HOST_CLIENTS_MAX);
+    return -1;
+  }
+  if(opts->depth < 1 || opts->depth > HOST_EXPECT_MAX) {
+    fprintf(stderr, "depth must be between 1 and %d\n", HOST_EXPECT_MAX);
+    return -1;
+  }
+
+  for(i=0;i<opts->clients;i++) {
+    hosts[i].slot = -1;
+    hosts[i].todo = opts->requests / opts->clients + ((i < opts->requests % opts->clients) ? 1 : 0);
+    hosts[i].depth = opts->depth;
+    hosts[i].rate = opts->rate;
+    hosts[i].feed = opts->feed;
+    hosts[i].every = opts->every;
+    hosts[i].stuck = opts->stuck / opts->clients + ((i < opts->stuck % opts->clients) ? 1 : 0);
+    hosts[i].done = (hosts[i].todo == 0);
+    host_response_reset(&hosts[i]);
+  }
+
+  start = host_seconds();
+  while(busy == 1 && ticks < HOST_TICKS_MAX) {
+    busy = 0;
+    for(i=0;i<opts->clients;i++) {
+      struct host_client_t *host = &hosts[i];
+      if(host->done == 1) {
+        continue;
+      }
+      busy = 1;
+      if(host->slot == -1) {
+        host_accept(host);
+        continue;
+      }
+      if(host->rate > 0) {
+        host->queued = (host->queued > (unsigned long)host->rate) ? host->queued - host->rate : 0;
+      }
+      if(host->nrexpect > 0 || host->hangup == 1) {
+        continue;
+      }
+      if(host->todo == 0) {
+        host->hangup = 1;
+        continue;
+      }
+      if(host->stream_pos == host->stream_len) {
+        host->stream_len = 0;
+        host->stream_pos = 0;
+      }
+      if(host->stuck > 0 && host->todo % 4 == 0) {
+        host->stuck--;
+        host_request(host, HOST_STUCK);
+        continue;
+      }
+      for(n=0;n<host->depth && host->todo > 0;n++) {
+        host->todo--;
+        if(opts->upload > 0) {
+          host_request(host, HOST_POST_UPLOAD);
+        } else {
+          host_request(host, (host->todo + i) % 4);
+        }
+      }
+    }
+    host_loop();
+    host_close_sweep();
+    ticks++;
+    now++;
+  }
+  secs = host_seconds() - start;
+
+  if(busy == 1) {
+    printf("%s: not done after %lu loops\n", mode, ticks);
+    stats.bad++;
+  }
+
+  printf("%s: %d clients, %lu requests answered in %lu ms device time, %lu loops\n",
+    mode, opts->clients, stats.answered, now, ticks);
+  printf("  %.0f requests/s, %.2f us per loop\n",
+    (secs > 0) ? stats.answered / secs : 0, (ticks > 0) ? (secs * 1e6) / ticks : 0);
+  printf("  bad %lu, retried %lu, timed out %lu, connections %lu\n",
+    stats.bad, stats.retried, stats.timedout, stats.accepted);
+  if(opts->rate > 0) {
+    printf("  loop blocked in writes %lu ms, %.1f ms per request\n",
+      stats.blocked, (stats.answered > 0) ? (double)stats.blocked / stats.answered : 0);
+  }
+  printf("  heap %.1f allocations and %.0f bytes per request, at most %lu bytes at once\n",
+    (stats.answered > 0) ? (double)heap.allocs / stats.answered : 0,
+    (stats.answered > 0) ? (double)heap.bytes / stats.answered : 0,
+    heap.peak);
+#if HOST_STACK == 1
+  printf("  stack high-water of webserver_loop() %lu bytes\n", stats.stack);
+#endif
+  printf("  clients[] takes %lu bytes for %d clients\n",
+    (unsigned long)sizeof(clients), WEBSERVER_MAX_CLIENTS);
+
+  for(i=0;i<opts->clients;i++) {
+    free(hosts[i].stream);
+    hosts[i].stream = NULL;
+  }
+  return (stats.bad == 0 && busy == 0) ? 0 : -1;
+}
+
+/*
+ * The first byte picks the parser in the low bit
+ * and the size of the pieces in the others.
+ */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  struct host_client_t sink;
+  struct webserver_t *client = &clients[0].data;
+  size_t pos = 1;
+  uint16_t piece = 0;
+  int i = 0;
+
+  if(size < 1 || size > HOST_INPUT_MAX) {
+    return 0;
+  }
+  if(rbuffer == NULL) {
+    host_setup();
+  }
+
+  memset(&sink, 0, sizeof(sink));
+  sink.sink = 1;
+  sink.slot = 0;
+
+  webserver_reset_client(client);
+  client->client = &wifi[0];
+  client->async = 0;
+  client->lastseen = millis();
+  slots[0] = &sink;
+  piece = (data[0] >> 1) + 1;
+
+  if((data[0] & 1) == 0) {
+    client->step = WEBSERVER_CLIENT_READ_HEADER;
+    while(pos < size && client->step != WEBSERVER_CLIENT_CLOSE) {
+      uint16_t n = MIN(piece, size - pos);
+      memcpy(rbuffer, &data[pos], n);
+      webserver_sync_receive(client, rbuffer, n);
+      pos += n;
+    }
+    /*
+     * Let the loop answer what was parsed
+     */
+    for(i=0;i<1000 && client->step != WEBSERVER_CLIENT_CLOSE &&
+      client->step != WEBSERVER_CLIENT_REQUEST_METHOD &&
+      client->step != WEBSERVER_CLIENT_READ_HEADER &&
+      client->step != WEBSERVER_CLIENT_ARGS &&
+      client->step != WEBSERVER_CLIENT_WEBSOCKET;i++) {
+      webserver_loop();
+    }
+  } else {
+    client->method = 1;
+    client->reqtype = 1;
+    client->route = ROUTE_HOST_UPLOAD;
+    client->totallen = size - 1;
+    client->readlen = 0;
+    client->substep = 0;
+    client->step = WEBSERVER_CLIENT_ARGS;
+    client->data.boundary = host_strdup(HOST_BOUNDARY);
+    while(pos < size) {
+      uint16_t n = MIN(piece, size - pos);
+      memcpy(rbuffer, &data[pos], n);
+      if(http_parse_multipart_body(client, rbuffer, n) == -1) {
+        break;
+      }
+      pos += n;
+      /*
+       * Just like webserver_sync_receive stops
+       * parsing the body once it's all there.
+       */
+      if(client->readlen == client->totallen) {
+        break;
+      }
+    }
+  }
+
+  webserver_client_close(client);
+  webserver_reset_client(client);
+  client->client = NULL;
+  slots[0] = NULL;
+  return 0;
+}
+
+#ifndef WEBSERVER_HOST_LIBFUZZER
+static const char *seeds[] = {
+  "\x3e" "GET /json?refresh=1&sort=topic HTTP/1.1\r\nHost: heishamon.local\r\n"
+  "Accept-Encoding: gzip\r\nIf-None-Match: \"0000002a\"\r\nConnection: keep-alive\r\n\r\n"
+  "GET /small HTTP/1.1\r\n\r\nGET / HTTP/1.1\r\nConnection: close\r\n\r\n",
+  "\x08" "POST /upload HTTP/1.1\r\nHost: heishamon.local\r\n"
+  "Content-Type: multipart/form-data; boundary=" HOST_BOUNDARY "\r\nContent-Length: 150\r\n\r\n"
+  "--" HOST_BOUNDARY "\r\nContent-Disposition: form-data; name=\"file\"; filename=\"rules.txt\"\r\n"
+  "Content-Type: text/plain\r\n\r\non [System#Boot] then\r\n  #a = 1;\r\nend\r\n--" HOST_BOUNDARY "--\r\n",
+  "\x20" "POST /saverules HTTP/1.1\r\nContent-Length: 21\r\n"
+  "Content-Type: application/x-www-form-urlencoded\r\n\r\nrules=a%20b&c=d+e&f=",
+  "\x10" "GET /websocket HTTP/1.1\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+  "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n"
+  "\x81\x86\x01\x02\x03\x04" "w`jrdq",
+  "\x41" "--" HOST_BOUNDARY "\r\nContent-Disposition: form-data; name=\"md5\"\r\n\r\n"
+  "0123456789abcdef\r\n--" HOST_BOUNDARY "\r\nContent-Disposition: form-data; name=\"firmware\"; "
+  "filename=\"a.bin\"\r\nContent-Type: application/octet-stream\r\n\r\n\x01\x02\x03\r\n--"
+  HOST_BOUNDARY "--\r\n",
+};
+
+static const char *tokens[] = {
+  "\r\n", "\r\n\r\n", ":", "=", "&", "?", " ", "\"", ";", "--", "%", "%2", "+",
+  "boundary=", "name=\"", "\";", "Content-Length: ", "Content-Type: ",
+  "multipart/form-data", "content-disposition:", " HTTP/1.1", "GET ", "POST ",
+  "Sec-WebSocket-Key: ", "Connection: close", "If-None-Match: W/\"", HOST_BOUNDARY
+};
+
+static uint32_t rnd = 1;
+
+static uint32_t host_rand(uint32_t n) {
+  rnd ^= rnd << 13;
+  rnd ^= rnd >> 17;
+  rnd ^= rnd << 5;
+  return (n == 0) ? 0 : rnd % n;
+}
+
+static size_t host_mutate(unsigned char *buf, size_t len, size_t size) {
+  int i = 0, nr = 1 + host_rand(8);
+
+  for(i=0;i<nr;i++) {
+    size_t pos = (len > 0) ? host_rand(len) : 0;
+    switch(host_rand(6)) {
+      case 0: {
+        if(len > 0) {
+          buf[pos] = host_rand(256);
+        }
+      } break;
+      case 1: {
+        if(len > 1) {
+          size_t n = 1 + host_rand(MIN(len - pos, 16));
+          memmove(&buf[pos], &buf[pos+n], len - pos - n);
+          len -= n;
+        }
+      } break;
+      case 2: {
+        const char *t = tokens[host_rand(sizeof(tokens)/sizeof(tokens[0]))];
+        size_t n = strlen(t);
+        if(len + n <= size) {
+          memmove(&buf[pos+n], &buf[pos], len - pos);
+          memcpy(&buf[pos], t, n);
+          len += n;
+        }
+      } break;
+      case 3: {
+        size_t n = 1 + host_rand(200);
+        if(len + n <= size) {
+          memmove(&buf[pos+n], &buf[pos], len - pos);
+          memset(&buf[pos], (host_rand(2) == 0) ? 'A' : ' ', n);
+          len += n;
+        }
+      } break;
+      case 4: {
+        if(len > 0) {
+          len = pos + 1;
+        }
+      } break;
+      case 5: {
+        if(len > 0) {
+          buf[0] = host_rand(256);
+        }
+      } break;
+    }
+  }
+  return len;
+}
+
+static int host_mutations(uint32_t seed, int count, const char *save) {
+  unsigned char buf[4096];
+  int i = 0;
+
+  rnd = (seed == 0) ? 1 : seed;
+  for(i=0;i<count;i++) {
+    const char *s = seeds[host_rand(sizeof(seeds)/sizeof(seeds[0]))];
+    size_t len = MIN(strlen(s), sizeof(buf));
+    memcpy(buf, s, len);
+    len = host_mutate(buf, len, sizeof(buf));
+    if(save != NULL) {
+      FILE *fp = fopen(save, "wb");
+      if(fp != NULL) {
+        fwrite(buf, 1, len, fp);
+        fclose(fp);
+      }
+    }
+    /*
+     * An input the parsers hang on
+     * ends the run like a crash.
+     */
+    alarm(10);
+    LLVMFuzzerTestOneInput(buf, len);
+    alarm(0);
+  }
+  printf("mutate: %d inputs from seed %u\n", count, seed);
+  return 0;
+}
+
+static unsigned char *host_file(const char *file, size_t *len) {
+  FILE *fp = NULL;
+  unsigned char *buf = NULL;
+  long size = 0;
+
+  if((fp = fopen(file, "rb")) == NULL) {
+    fprintf(stderr, "cannot open %s\n", file);
+    return NULL;
+  }
+  fseek(fp, 0, SEEK_END);
+  size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+  if(size < 0 || (buf = (unsigned char *)malloc(size + 1)) == NULL) {
+    fclose(fp);
+    return NULL;
+  }
+  *len = fread(buf, 1, size, fp);
+  fclose(fp);
+  return buf;
+}
+
+static int host_usage(void) {
+  fprintf(stderr,
+    "usage: webserver_host load [clients] [requests]\n"
+    "       webserver_host pipeline [clients] [requests] [depth]\n"
+    "       webserver_host slow [clients] [requests] [rate]\n"
+    "       webserver_host partial [clients] [requests] [stuck]\n"
+    "       webserver_host multipart [clients] [uploads] [size]\n"
+    "       webserver_host mutate [seed] [count] [file]\n"
+    "       webserver_host fuzz <file> ...\n"
+    "set HOST_VERBOSE=1 to print the log and failed responses\n");
+  return 1;
+}
+
+int main(int argc, char **argv) {
+  struct host_opts_t opts;
+  int i = 0, ret = 0;
+
+  if(argc < 2) {
+    return host_usage();
+  }
+  if(getenv("HOST_VERBOSE") != NULL) {
+    verbose = 1;
+  }
+
+  memset(&opts, 0, sizeof(opts));
+  opts.clients = (argc > 2) ? atoi(argv[2]) : WEBSERVER_MAX_CLIENTS;
+  opts.requests = (argc > 3) ? atoi(argv[3]) : 10000;
+  opts.depth = 1;
+
+  if(strcmp(argv[1], "load") == 0) {
+    ret = host_load(argv[1], &opts);
+  } else if(strcmp(argv[1], "pipeline") == 0) {
+    opts.depth = (argc > 4) ? atoi(argv[4]) : 4;
+    ret = host_load(argv[1], &opts);
+  } else if(strcmp(argv[1], "slow") == 0) {
+    opts.requests = (argc > 3) ? atoi(argv[3]) : 1000;
+    opts.rate = (argc > 4) ? atoi(argv[4]) : 4;
+    ret = host_load(argv[1], &opts);
+  } else if(strcmp(argv[1], "partial") == 0) {
+    opts.requests = (argc > 3) ? atoi(argv[3]) : 1000;
+    opts.feed = 7;
+    opts.every = 3;
+    opts.stuck = (argc > 4) ? atoi(argv[4]) : 2;
+    ret = host_load(argv[1], &opts);
+  } else if(strcmp(argv[1], "multipart") == 0) {
+    opts.requests = (argc > 3) ? atoi(argv[3]) : 100;
+    opts.upload = (argc > 4) ? atoi(argv[4]) : 16384;
+    ret = host_load(argv[1], &opts);
+  } else if(strcmp(argv[1], "mutate") == 0) {
+    host_setup();
+    ret = host_mutations((argc > 2) ? strtoul(argv[2], NULL, 10) : 1, (argc > 3) ? atoi(argv[3]) : 100000, (argc > 4) ? argv[4] : NULL);
+  } else if(strcmp(argv[1], "fuzz") == 0 && argc >= 3) {
+    host_setup();
+    for(i=2;i<argc;i++) {
+      size_t len = 0;
+      unsigned char *buf = host_file(argv[i], &len);
+      if(buf != NULL) {
+        LLVMFuzzerTestOneInput(buf, len);
+        free(buf);
+      }
+    }
+  } else {
+    return host_usage();
+  }
+  return (ret == 0) ? 0 : 1;
+}
+#endif